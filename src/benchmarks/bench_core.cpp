@@ -0,0 +1,169 @@
+// benchmarks for the run storage, parameter containers, transformations and
+// objective function
+
+#include <cstdio>
+#include "RunStorage.h"
+#include "Transformable.h"
+#include "ParamTransformSeq.h"
+#include "ObjectiveFunc.h"
+#include "Regularization.h"
+#include "bench_problems.h"
+
+using namespace std;
+
+namespace
+{
+	vector<double> make_values(int n, double offset)
+	{
+		vector<double> vals(n);
+		for (int i = 0; i < n; ++i)
+			vals[i] = 1.0 + offset + 0.001 * i;
+		return vals;
+	}
+
+	//one run per realization, matching an ensemble batch
+	void run_storage_add(bench::State &state)
+	{
+		bench::Problem &prob = bench::get_problem(state.scale);
+		vector<double> pars = make_values(prob.par_names.size(), 0.0);
+		RunStorage rs("");
+		while (state.keep_running())
+		{
+			state.pause_timing();
+			rs.reset(prob.par_names, prob.obs_names, "bench_run_storage.rns");
+			state.resume_timing();
+			for (int i = 0; i < state.scale.n_real; ++i)
+				rs.add_run(pars);
+		}
+		state.set_items_processed(state.scale.n_real);
+		state.set_bytes_processed(int64_t(state.scale.n_real) * prob.par_names.size() * sizeof(double));
+	}
+	PESTPP_BENCHMARK(run_storage_add);
+
+	void run_storage_update(bench::State &state)
+	{
+		bench::Problem &prob = bench::get_problem(state.scale);
+		Parameters pars;
+		pars.insert(prob.par_names, make_values(prob.par_names.size(), 0.0));
+		Observations obs;
+		obs.insert(prob.obs_names, make_values(prob.obs_names.size(), 0.0));
+		RunStorage rs("");
+		rs.reset(prob.par_names, prob.obs_names, "bench_run_storage.rns");
+		for (int i = 0; i < state.scale.n_real; ++i)
+			rs.add_run(pars);
+		while (state.keep_running())
+		{
+			for (int i = 0; i < state.scale.n_real; ++i)
+				rs.update_run(i, pars, obs);
+		}
+		state.set_items_processed(state.scale.n_real);
+		state.set_bytes_processed(int64_t(state.scale.n_real) * prob.obs_names.size() * sizeof(double));
+	}
+	PESTPP_BENCHMARK(run_storage_update);
+
+	void run_storage_get(bench::State &state)
+	{
+		bench::Problem &prob = bench::get_problem(state.scale);
+		Parameters pars;
+		pars.insert(prob.par_names, make_values(prob.par_names.size(), 0.0));
+		Observations obs;
+		obs.insert(prob.obs_names, make_values(prob.obs_names.size(), 0.0));
+		RunStorage rs("");
+		rs.reset(prob.par_names, prob.obs_names, "bench_run_storage.rns");
+		for (int i = 0; i < state.scale.n_real; ++i)
+		{
+			rs.add_run(pars);
+			rs.update_run(i, pars, obs);
+		}
+		vector<double> par_vec, obs_vec;
+		while (state.keep_running())
+		{
+			for (int i = 0; i < state.scale.n_real; ++i)
+				rs.get_run(i, par_vec, obs_vec);
+			bench::do_not_optimize(obs_vec.data());
+		}
+		state.set_items_processed(state.scale.n_real);
+		state.set_bytes_processed(int64_t(state.scale.n_real) * (prob.par_names.size() + prob.obs_names.size()) * sizeof(double));
+	}
+	PESTPP_BENCHMARK(run_storage_get);
+
+	void transformable_get(bench::State &state)
+	{
+		bench::Problem &prob = bench::get_problem(state.scale);
+		Observations obs;
+		obs.insert(prob.obs_names, make_values(prob.obs_names.size(), 0.0));
+		while (state.keep_running())
+		{
+			vector<double> vals = obs.get_data_vec(prob.obs_names);
+			bench::do_not_optimize(vals.data());
+			double sum = 0.0;
+			for (auto &name : prob.obs_names)
+				sum += obs.get_rec(name);
+			bench::do_not_optimize(sum);
+		}
+		state.set_items_processed(2 * prob.obs_names.size());
+	}
+	PESTPP_BENCHMARK(transformable_get);
+
+	void transformable_update(bench::State &state)
+	{
+		bench::Problem &prob = bench::get_problem(state.scale);
+		Observations obs;
+		obs.insert(prob.obs_names, make_values(prob.obs_names.size(), 0.0));
+		vector<double> vals = make_values(prob.obs_names.size(), 1.0);
+		while (state.keep_running())
+		{
+			obs.update_without_clear(prob.obs_names, vals);
+			for (auto &name : prob.obs_names)
+				obs.update_rec(name, 2.0);
+		}
+		state.set_items_processed(2 * prob.obs_names.size());
+	}
+	PESTPP_BENCHMARK(transformable_update);
+
+	void par_transform_ctl2numeric(bench::State &state)
+	{
+		bench::Problem &prob = bench::get_problem(state.scale);
+		const ParamTransformSeq &pts = prob.pest.get_base_par_tran_seq();
+		const Parameters &ctl_pars = prob.pest.get_ctl_parameters();
+		while (state.keep_running())
+		{
+			Parameters pars = pts.ctl2numeric_cp(ctl_pars);
+			bench::do_not_optimize(pars.size());
+		}
+		state.set_items_processed(ctl_pars.size());
+	}
+	PESTPP_BENCHMARK(par_transform_ctl2numeric);
+
+	void par_transform_numeric2model(bench::State &state)
+	{
+		bench::Problem &prob = bench::get_problem(state.scale);
+		const ParamTransformSeq &pts = prob.pest.get_base_par_tran_seq();
+		Parameters numeric_pars = pts.ctl2numeric_cp(prob.pest.get_ctl_parameters());
+		while (state.keep_running())
+		{
+			Parameters pars = pts.numeric2model_cp(numeric_pars);
+			bench::do_not_optimize(pars.size());
+		}
+		state.set_items_processed(numeric_pars.size());
+	}
+	PESTPP_BENCHMARK(par_transform_numeric2model);
+
+	void objective_func_phi_comp(bench::State &state)
+	{
+		bench::Problem &prob = bench::get_problem(state.scale);
+		Pest &pest = prob.pest;
+		ObjectiveFunc obj_func(&pest.get_ctl_observations(), &pest.get_ctl_observation_info(), &pest.get_prior_info());
+		Observations sim_obs;
+		sim_obs.insert(prob.obs_names, make_values(prob.obs_names.size(), 0.01));
+		const Parameters &pars = pest.get_ctl_parameters();
+		DynamicRegularization dyn_reg;
+		while (state.keep_running())
+		{
+			PhiComponets phi = obj_func.get_phi_comp(sim_obs, pars, dyn_reg);
+			bench::do_not_optimize(phi.meas);
+		}
+		state.set_items_processed(prob.obs_names.size());
+	}
+	PESTPP_BENCHMARK(objective_func_phi_comp);
+}
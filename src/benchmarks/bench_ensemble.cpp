@@ -0,0 +1,94 @@
+// benchmarks for ensemble file input (csv through Ensemble::read_csv and the binary
+// jcb format)
+
+#include "Ensemble.h"
+#include "bench_problems.h"
+
+using namespace std;
+
+namespace
+{
+	string write_par_ensemble(bench::Problem &prob, const bench::Scale &scale, bool binary)
+	{
+		string filename = "bench_" + scale.name + (binary ? ".par.jcb" : ".par.csv");
+		Eigen::MatrixXd reals = bench::make_random_matrix(scale.n_real, prob.par_names.size(), 1);
+		reals = (reals.array().abs() * 0.1 + 1.0).matrix();
+		ParameterEnsemble pe(&prob.pest);
+		pe.from_eigen_mat(reals, bench::make_names("r", scale.n_real), prob.pest.get_ctl_ordered_par_names(),
+			ParameterEnsemble::transStatus::CTL);
+		if (binary)
+			pe.to_binary(filename);
+		else
+			pe.to_csv(filename);
+		return filename;
+	}
+
+	string write_obs_ensemble(bench::Problem &prob, const bench::Scale &scale, bool binary)
+	{
+		string filename = "bench_" + scale.name + (binary ? ".obs.jcb" : ".obs.csv");
+		Eigen::MatrixXd reals = bench::make_random_matrix(scale.n_real, prob.obs_names.size(), 2);
+		ObservationEnsemble oe(&prob.pest);
+		oe.from_eigen_mat(reals, bench::make_names("r", scale.n_real), prob.pest.get_ctl_ordered_obs_names());
+		if (binary)
+			oe.to_binary(filename);
+		else
+			oe.to_csv(filename);
+		return filename;
+	}
+
+	void par_ensemble_from_csv(bench::State &state)
+	{
+		bench::Problem &prob = bench::get_problem(state.scale);
+		string filename = write_par_ensemble(prob, state.scale, false);
+		while (state.keep_running())
+		{
+			ParameterEnsemble pe(&prob.pest);
+			pe.from_csv(filename);
+			bench::do_not_optimize(pe.shape());
+		}
+		state.set_items_processed(int64_t(state.scale.n_real) * prob.par_names.size());
+	}
+	PESTPP_BENCHMARK(par_ensemble_from_csv);
+
+	void par_ensemble_from_binary(bench::State &state)
+	{
+		bench::Problem &prob = bench::get_problem(state.scale);
+		string filename = write_par_ensemble(prob, state.scale, true);
+		while (state.keep_running())
+		{
+			ParameterEnsemble pe(&prob.pest);
+			pe.from_binary(filename);
+			bench::do_not_optimize(pe.shape());
+		}
+		state.set_items_processed(int64_t(state.scale.n_real) * prob.par_names.size());
+	}
+	PESTPP_BENCHMARK(par_ensemble_from_binary);
+
+	void obs_ensemble_from_csv(bench::State &state)
+	{
+		bench::Problem &prob = bench::get_problem(state.scale);
+		string filename = write_obs_ensemble(prob, state.scale, false);
+		while (state.keep_running())
+		{
+			ObservationEnsemble oe(&prob.pest);
+			oe.from_csv(filename);
+			bench::do_not_optimize(oe.shape());
+		}
+		state.set_items_processed(int64_t(state.scale.n_real) * prob.obs_names.size());
+	}
+	PESTPP_BENCHMARK(obs_ensemble_from_csv);
+
+	void obs_ensemble_from_binary(bench::State &state)
+	{
+		bench::Problem &prob = bench::get_problem(state.scale);
+		string filename = write_obs_ensemble(prob, state.scale, true);
+		while (state.keep_running())
+		{
+			ObservationEnsemble oe(&prob.pest);
+			oe.from_binary(filename);
+			bench::do_not_optimize(oe.shape());
+		}
+		state.set_items_processed(int64_t(state.scale.n_real) * prob.obs_names.size());
+	}
+	PESTPP_BENCHMARK(obs_ensemble_from_binary);
+}
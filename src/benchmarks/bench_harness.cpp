@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <regex>
+#include <sstream>
+#include <thread>
+#include "bench_harness.h"
+
+using namespace std;
+
+namespace bench
+{
+	namespace
+	{
+		struct Entry
+		{
+			string name;
+			BenchFunc func;
+		};
+
+		vector<Entry> &registry()
+		{
+			//function-local so registration from other translation units does not
+			//depend on static initialization order
+			static vector<Entry> entries;
+			return entries;
+		}
+
+		//swallows the progress messages the library writes to cout
+		class NullBuffer : public streambuf
+		{
+		protected:
+			virtual int overflow(int c) { return c; }
+		};
+
+		string json_escape(const string &str)
+		{
+			stringstream ss;
+			for (char c : str)
+			{
+				if ((c == '"') || (c == '\\'))
+					ss << '\\' << c;
+				else if (c == '\n')
+					ss << "\\n";
+				else if ((unsigned char)c < 0x20)
+					ss << ' ';
+				else
+					ss << c;
+			}
+			return ss.str();
+		}
+	}
+
+	State::State(const Scale &_scale, double _min_time, int _max_iters) : scale(_scale), min_time(_min_time),
+		max_iters(_max_iters), started(false), paused(false), total_time(0.0), paused_time(0.0),
+		items_processed(0), bytes_processed(0)
+	{
+	}
+
+	bool State::keep_running()
+	{
+		clock::time_point now = clock::now();
+		if (!skip_reason.empty())
+			return false;
+		if (started)
+		{
+			if (paused)
+				resume_timing();
+			double t = chrono::duration<double>(now - iter_start).count() - paused_time;
+			iter_times.push_back(t);
+			total_time += t;
+			if ((total_time >= min_time) || (iter_times.size() >= max_iters))
+				return false;
+		}
+		started = true;
+		paused_time = 0.0;
+		iter_start = clock::now();
+		return true;
+	}
+
+	void State::pause_timing()
+	{
+		if (paused)
+			return;
+		paused = true;
+		pause_start = clock::now();
+	}
+
+	void State::resume_timing()
+	{
+		if (!paused)
+			return;
+		paused = false;
+		paused_time += chrono::duration<double>(clock::now() - pause_start).count();
+	}
+
+	void State::skip(const string &reason)
+	{
+		skip_reason = reason;
+	}
+
+	int register_benchmark(const string &name, BenchFunc func)
+	{
+		registry().push_back(Entry{ name, func });
+		return int(registry().size());
+	}
+
+	vector<Result> run_benchmarks(const vector<Scale> &scales, const string &filter, double min_time, int max_iters,
+		ostream &fout)
+	{
+		vector<Entry> entries = registry();
+		sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.name < b.name; });
+		regex filter_re(filter.empty() ? string(".*") : filter);
+		vector<Result> results;
+		fout << left << setw(44) << "benchmark" << setw(8) << "scale" << right << setw(8) << "iters"
+			<< setw(14) << "mean(ms)" << setw(14) << "min(ms)" << setw(14) << "items/s" << endl;
+		for (auto &scale : scales)
+		{
+			for (auto &entry : entries)
+			{
+				if (!regex_search(entry.name, filter_re))
+					continue;
+				State state(scale, min_time, max_iters);
+				Result r;
+				r.name = entry.name;
+				r.scale = scale.name;
+				NullBuffer null_buf;
+				streambuf *cout_buf = cout.rdbuf(&null_buf);
+				try
+				{
+					entry.func(state);
+				}
+				catch (exception &e)
+				{
+					state.skip(string("error: ") + e.what());
+				}
+				cout.rdbuf(cout_buf);
+				r.label = state.get_label();
+				r.skipped = state.get_skip_reason();
+				vector<double> times = state.get_iter_times();
+				r.iterations = times.size();
+				r.mean_sec = r.median_sec = r.min_sec = r.stddev_sec = 0.0;
+				r.items_per_sec = r.bytes_per_sec = 0.0;
+				if ((r.skipped.empty()) && (times.size() > 0))
+				{
+					double total = accumulate(times.begin(), times.end(), 0.0);
+					r.mean_sec = total / times.size();
+					double ss = 0.0;
+					for (auto t : times)
+						ss += (t - r.mean_sec) * (t - r.mean_sec);
+					r.stddev_sec = (times.size() > 1) ? sqrt(ss / (times.size() - 1)) : 0.0;
+					sort(times.begin(), times.end());
+					r.min_sec = times[0];
+					r.median_sec = times[times.size() / 2];
+					if (total > 0.0)
+					{
+						r.items_per_sec = double(state.get_items_processed()) * times.size() / total;
+						r.bytes_per_sec = double(state.get_bytes_processed()) * times.size() / total;
+					}
+				}
+				fout << left << setw(44) << r.name << setw(8) << r.scale << right;
+				if (!r.skipped.empty())
+					fout << "  skipped: " << r.skipped << endl;
+				else
+				{
+					fout << setw(8) << r.iterations << setw(14) << setprecision(4) << r.mean_sec * 1000.0
+						<< setw(14) << r.min_sec * 1000.0 << setw(14) << setprecision(4) << r.items_per_sec;
+					if (!r.label.empty())
+						fout << "  " << r.label;
+					fout << endl;
+				}
+				results.push_back(r);
+			}
+		}
+		return results;
+	}
+
+	void write_json(ostream &fout, const vector<Result> &results, const vector<Scale> &scales, const string &commit)
+	{
+		time_t now = time(nullptr);
+		char date_buf[64];
+		strftime(date_buf, sizeof(date_buf), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+		fout << setprecision(9);
+		fout << "{" << endl;
+		fout << "  \"context\": {" << endl;
+		fout << "    \"date\": \"" << date_buf << "\"," << endl;
+		fout << "    \"commit\": \"" << json_escape(commit) << "\"," << endl;
+		fout << "    \"num_cpus\": " << thread::hardware_concurrency() << "," << endl;
+		fout << "    \"scales\": [";
+		for (size_t i = 0; i < scales.size(); ++i)
+		{
+			fout << (i > 0 ? ", " : "") << "{\"name\": \"" << scales[i].name << "\", \"n_par\": " << scales[i].n_par
+				<< ", \"n_obs\": " << scales[i].n_obs << ", \"n_real\": " << scales[i].n_real << "}";
+		}
+		fout << "]" << endl;
+		fout << "  }," << endl;
+		fout << "  \"benchmarks\": [" << endl;
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			const Result &r = results[i];
+			fout << "    {\"name\": \"" << json_escape(r.name) << "\", \"scale\": \"" << r.scale << "\"";
+			if (!r.skipped.empty())
+				fout << ", \"skipped\": \"" << json_escape(r.skipped) << "\"";
+			else
+			{
+				fout << ", \"iterations\": " << r.iterations
+					<< ", \"mean_sec\": " << r.mean_sec
+					<< ", \"median_sec\": " << r.median_sec
+					<< ", \"min_sec\": " << r.min_sec
+					<< ", \"stddev_sec\": " << r.stddev_sec
+					<< ", \"items_per_sec\": " << r.items_per_sec
+					<< ", \"bytes_per_sec\": " << r.bytes_per_sec;
+				if (!r.label.empty())
+					fout << ", \"label\": \"" << json_escape(r.label) << "\"";
+			}
+			fout << "}" << (i + 1 < results.size() ? "," : "") << endl;
+		}
+		fout << "  ]" << endl;
+		fout << "}" << endl;
+	}
+}
@@ -0,0 +1,105 @@
+#ifndef BENCH_HARNESS_H_
+#define BENCH_HARNESS_H_
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+// A small benchmark harness modeled on Google Benchmark.  Each benchmark is a
+// function taking a bench::State and running its timed section inside
+//
+//     while (state.keep_running()) { ... }
+//
+// The loop repeats until the minimum time has elapsed (and at least once), and
+// each pass is timed separately so the report carries min/median/stddev as well
+// as the mean.  Benchmarks register themselves with PESTPP_BENCHMARK() and run
+// once per problem scale.
+
+namespace bench
+{
+	struct Scale
+	{
+		std::string name;
+		int n_par;
+		int n_obs;
+		int n_real;
+	};
+
+	class State
+	{
+	public:
+		State(const Scale &_scale, double _min_time, int _max_iters);
+		bool keep_running();
+		void pause_timing();
+		void resume_timing();
+		void skip(const std::string &reason);
+		void set_items_processed(int64_t n) { items_processed = n; }
+		void set_bytes_processed(int64_t n) { bytes_processed = n; }
+		void set_label(const std::string &_label) { label = _label; }
+		const Scale &scale;
+		int64_t get_items_processed() const { return items_processed; }
+		int64_t get_bytes_processed() const { return bytes_processed; }
+		const std::vector<double> &get_iter_times() const { return iter_times; }
+		const std::string &get_label() const { return label; }
+		const std::string &get_skip_reason() const { return skip_reason; }
+	private:
+		typedef std::chrono::steady_clock clock;
+		double min_time;
+		int max_iters;
+		bool started;
+		bool paused;
+		double total_time;
+		double paused_time;
+		clock::time_point iter_start;
+		clock::time_point pause_start;
+		std::vector<double> iter_times;
+		int64_t items_processed;
+		int64_t bytes_processed;
+		std::string label;
+		std::string skip_reason;
+	};
+
+	typedef void(*BenchFunc)(State &state);
+
+	struct Result
+	{
+		std::string name;
+		std::string scale;
+		std::string label;
+		std::string skipped;
+		int64_t iterations;
+		double mean_sec;
+		double median_sec;
+		double min_sec;
+		double stddev_sec;
+		double items_per_sec;
+		double bytes_per_sec;
+	};
+
+	int register_benchmark(const std::string &name, BenchFunc func);
+	std::vector<Result> run_benchmarks(const std::vector<Scale> &scales, const std::string &filter, double min_time,
+		int max_iters, std::ostream &fout);
+	void write_json(std::ostream &fout, const std::vector<Result> &results, const std::vector<Scale> &scales,
+		const std::string &commit);
+
+	//keeps the optimizer from discarding a result that is otherwise unused
+	template<typename T>
+	inline void do_not_optimize(const T &value)
+	{
+#ifdef _MSC_VER
+		static const void * volatile sink;
+		sink = &value;
+#else
+		asm volatile("" : : "r,m"(value) : "memory");
+#endif
+	}
+}
+
+#define PESTPP_BENCH_CONCAT2(a, b) a##b
+#define PESTPP_BENCH_CONCAT(a, b) PESTPP_BENCH_CONCAT2(a, b)
+#define PESTPP_BENCHMARK(func) \
+	static int PESTPP_BENCH_CONCAT(bench_reg_, __LINE__) = bench::register_benchmark(#func, func)
+
+#endif /* BENCH_HARNESS_H_ */
@@ -0,0 +1,136 @@
+// benchmarks for the PANTHER message layer and model input/output processing
+
+#include <thread>
+#include <cstring>
+#include "network_wrapper.h"
+#include "network_package.h"
+#include "model_interface.h"
+#include "utilities.h"
+#include "bench_problems.h"
+
+using namespace std;
+
+extern "C"
+{
+	void mio_write_model_input_files_w_(int *, int *, char *, double *);
+	void mio_read_model_output_files_w_(int *, int *, char *, double *);
+}
+
+namespace
+{
+	//connected pair of loopback sockets
+	class LoopbackPair
+	{
+	public:
+		LoopbackPair() : server_fd(-1), client_fd(-1)
+		{
+			w_init();
+			int listen_fd = w_socket(AF_INET, SOCK_STREAM, 0);
+			sockaddr_in addr;
+			memset(&addr, 0, sizeof(addr));
+			addr.sin_family = AF_INET;
+			addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+			addr.sin_port = 0;
+			socklen_t addr_len = sizeof(addr);
+			if ((listen_fd < 0) || (w_bind(listen_fd, (sockaddr*)&addr, addr_len) != 0) ||
+				(w_listen(listen_fd, 1) != 0) || (getsockname(listen_fd, (sockaddr*)&addr, &addr_len) != 0))
+				throw runtime_error("unable to open loopback listener");
+			client_fd = w_socket(AF_INET, SOCK_STREAM, 0);
+			if ((client_fd < 0) || (w_connect(client_fd, (sockaddr*)&addr, addr_len) != 0))
+				throw runtime_error("unable to connect to loopback listener");
+			server_fd = w_accept(listen_fd, nullptr, nullptr);
+			w_close(listen_fd);
+			if (server_fd < 0)
+				throw runtime_error("unable to accept loopback connection");
+		}
+		~LoopbackPair()
+		{
+			if (client_fd >= 0)
+				w_close(client_fd);
+			if (server_fd >= 0)
+				w_close(server_fd);
+		}
+		int server_fd;
+		int client_fd;
+	};
+
+	//round trip of a run result sized message: the worker side echoes each package back
+	void net_package_send_recv(bench::State &state)
+	{
+		LoopbackPair sockets;
+		thread echo([&sockets]()
+		{
+			NetPackage pkg;
+			while (pkg.recv(sockets.server_fd) > 0)
+			{
+				if (pkg.get_type() == NetPackage::PackType::TERMINATE)
+					break;
+				const vector<int8_t> &data = pkg.get_data();
+				NetPackage reply(NetPackage::PackType::RUN_FINISHED, pkg.get_group_id(), pkg.get_run_id(), "");
+				if (reply.send(sockets.server_fd, data.data(), data.size()) < 1)
+					break;
+			}
+		});
+		vector<double> payload(state.scale.n_par + state.scale.n_obs, 1.0);
+		int64_t payload_bytes = payload.size() * sizeof(double);
+		int run_id = 0;
+		bool ok = true;
+		while ((ok) && (state.keep_running()))
+		{
+			NetPackage pkg(NetPackage::PackType::START_RUN, 0, run_id++, "bench");
+			ok = (pkg.send(sockets.client_fd, payload.data(), payload_bytes) > 0);
+			NetPackage reply;
+			ok = ok && (reply.recv(sockets.client_fd) > 0) && (reply.get_data().size() == payload_bytes);
+		}
+		NetPackage term(NetPackage::PackType::TERMINATE, 0, 0, "");
+		term.send(sockets.client_fd, nullptr, 0);
+		echo.join();
+		if (!ok)
+			state.skip("loopback send/recv failed");
+		state.set_items_processed(1);
+		state.set_bytes_processed(2 * payload_bytes);
+	}
+	PESTPP_BENCHMARK(net_package_send_recv);
+
+	//write the model input file from the template, as done before every model run
+	void template_write(bench::State &state)
+	{
+		bench::Problem &prob = bench::get_problem(state.scale);
+		ModelInterface mi(vector<string>{ prob.tpl_file }, vector<string>{ prob.in_file }, vector<string>{ prob.ins_file },
+			vector<string>{ prob.out_file }, vector<string>{ "true" });
+		mi.initialize(prob.par_names, prob.obs_names);
+		vector<double> par_vals(prob.par_names.size(), 1.2345);
+		int npar = par_vals.size();
+		int ifail = 0;
+		while ((ifail == 0) && (state.keep_running()))
+		{
+			mio_write_model_input_files_w_(&ifail, &npar,
+				pest_utils::StringvecFortranCharArray(prob.par_names, 200, pest_utils::TO_LOWER).get_prt(), par_vals.data());
+		}
+		if (ifail != 0)
+			state.skip("error writing model input file from template");
+		state.set_items_processed(npar);
+	}
+	PESTPP_BENCHMARK(template_write);
+
+	//read the model output file with the instruction file, as done after every model run
+	void instruction_read(bench::State &state)
+	{
+		bench::Problem &prob = bench::get_problem(state.scale);
+		ModelInterface mi(vector<string>{ prob.tpl_file }, vector<string>{ prob.in_file }, vector<string>{ prob.ins_file },
+			vector<string>{ prob.out_file }, vector<string>{ "true" });
+		mi.initialize(prob.par_names, prob.obs_names);
+		vector<double> obs_vals(prob.obs_names.size(), 0.0);
+		int nobs = obs_vals.size();
+		int ifail = 0;
+		while ((ifail == 0) && (state.keep_running()))
+		{
+			mio_read_model_output_files_w_(&ifail, &nobs,
+				pest_utils::StringvecFortranCharArray(prob.obs_names, 200, pest_utils::TO_LOWER).get_prt(), obs_vals.data());
+		}
+		if (ifail != 0)
+			state.skip("error reading model output file with instruction file");
+		state.set_items_processed(nobs);
+	}
+	PESTPP_BENCHMARK(instruction_read);
+}
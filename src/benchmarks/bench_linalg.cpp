@@ -0,0 +1,90 @@
+// benchmarks for Jacobian slicing and the sparse SVD packages
+
+#include <algorithm>
+#include <sstream>
+#include "FileManager.h"
+#include "Jacobian.h"
+#include "SVDPackage.h"
+#include "SVD_PROPACK.h"
+#include "bench_problems.h"
+
+using namespace std;
+
+namespace
+{
+	//fills the protected Jacobian members directly so no runs are needed
+	class BenchJacobian : public Jacobian
+	{
+	public:
+		BenchJacobian(FileManager &_file_manager, const vector<string> &obs_names, const vector<string> &par_names,
+			int bandwidth) : Jacobian(_file_manager)
+		{
+			base_sim_obs_names = obs_names;
+			base_numeric_par_names = par_names;
+			matrix = bench::make_banded_matrix(obs_names.size(), par_names.size(), bandwidth);
+		}
+	};
+
+	void jacobian_get_matrix(bench::State &state)
+	{
+		bench::Problem &prob = bench::get_problem(state.scale);
+		FileManager file_manager;
+		BenchJacobian jac(file_manager, prob.obs_names, prob.par_names, 25);
+		//reversed observations and every other parameter, so both permutations are exercised
+		vector<string> obs_names(prob.obs_names.rbegin(), prob.obs_names.rend());
+		vector<string> par_names;
+		for (size_t i = 0; i < prob.par_names.size(); i += 2)
+			par_names.push_back(prob.par_names[i]);
+		while (state.keep_running())
+		{
+			Eigen::SparseMatrix<double> mat = jac.get_matrix(obs_names, par_names);
+			bench::do_not_optimize(mat.nonZeros());
+		}
+		state.set_items_processed(jac.get_nonzero());
+	}
+	PESTPP_BENCHMARK(jacobian_get_matrix);
+
+	void svd_solve(bench::State &state, SVDPackage &svd)
+	{
+		int n_col = state.scale.n_par;
+		int n_row = min(state.scale.n_obs, 2 * n_col);
+		Eigen::SparseMatrix<double> mat = bench::make_banded_matrix(n_row, n_col, 25);
+		svd.set_max_sing(min(n_col / 2, 1000));
+		svd.set_eign_thres(1.0e-7);
+		Eigen::VectorXd sigma, sigma_trunc;
+		Eigen::SparseMatrix<double> U, VT;
+		stringstream ss;
+		ss << n_row << "x" << n_col << ", " << svd.get_max_sing() << " singular values";
+		state.set_label(ss.str());
+		while (state.keep_running())
+		{
+			state.pause_timing();
+			Eigen::SparseMatrix<double> A = mat;
+			state.resume_timing();
+			svd.solve_ip(A, sigma, U, VT, sigma_trunc);
+			bench::do_not_optimize(sigma.data());
+		}
+		state.set_items_processed(mat.nonZeros());
+	}
+
+	void svd_redsvd_solve(bench::State &state)
+	{
+		SVD_REDSVD svd;
+		svd_solve(state, svd);
+	}
+	PESTPP_BENCHMARK(svd_redsvd_solve);
+
+	void svd_propack_solve(bench::State &state)
+	{
+		SVD_PROPACK svd;
+		svd_solve(state, svd);
+	}
+	PESTPP_BENCHMARK(svd_propack_solve);
+
+	void svd_randomized_solve(bench::State &state)
+	{
+		SVD_RANDOMIZED svd;
+		svd_solve(state, svd);
+	}
+	PESTPP_BENCHMARK(svd_randomized_solve);
+}
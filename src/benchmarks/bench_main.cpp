@@ -0,0 +1,70 @@
+// bench_main.cpp : runs the PEST++ kernel benchmarks and writes the results as JSON
+//
+// usage: pestpp-bench [--filter=<regex>] [--scale=small,medium,large|all]
+//                     [--min_time=<sec>] [--max_iters=<n>] [--out=<json file>] [--commit=<id>]
+//
+// The synthetic problem files are written to the current directory.  The JSON
+// output can be compared across commits with compare_bench.py.
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include "bench_harness.h"
+#include "bench_problems.h"
+
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+	string filter;
+	string scale_names = "small,medium";
+	string out_file = "bench_results.json";
+	string commit = "unknown";
+	double min_time = 0.5;
+	int max_iters = 1000000;
+	for (int i = 1; i < argc; ++i)
+	{
+		string arg = argv[i];
+		size_t eq = arg.find('=');
+		string key = arg.substr(0, eq);
+		string value = (eq == string::npos) ? string() : arg.substr(eq + 1);
+		if (key == "--filter")
+			filter = value;
+		else if (key == "--scale")
+			scale_names = value;
+		else if (key == "--out")
+			out_file = value;
+		else if (key == "--commit")
+			commit = value;
+		else if (key == "--min_time")
+			min_time = atof(value.c_str());
+		else if (key == "--max_iters")
+			max_iters = atoi(value.c_str());
+		else
+		{
+			cerr << "unrecognized argument: " << arg << endl;
+			cerr << "usage: pestpp-bench [--filter=<regex>] [--scale=small,medium,large|all] [--min_time=<sec>]" << endl;
+			cerr << "                    [--max_iters=<n>] [--out=<json file>] [--commit=<id>]" << endl;
+			return 1;
+		}
+	}
+
+	try
+	{
+		vector<bench::Scale> scales = bench::get_scales(scale_names);
+		//cout is silenced while the benchmarks run, so the report gets its own stream on the same buffer
+		ostream report(cout.rdbuf());
+		vector<bench::Result> results = bench::run_benchmarks(scales, filter, min_time, max_iters, report);
+		ofstream fout(out_file);
+		if (!fout.good())
+			throw runtime_error("unable to open " + out_file + " for writing");
+		bench::write_json(fout, results, scales, commit);
+		cout << endl << "results written to " << out_file << endl;
+	}
+	catch (exception &e)
+	{
+		cerr << e.what() << endl;
+		return 1;
+	}
+	return 0;
+}
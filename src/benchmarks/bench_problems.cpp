@@ -0,0 +1,175 @@
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include "utilities.h"
+#include "bench_problems.h"
+
+using namespace std;
+
+namespace bench
+{
+	namespace
+	{
+		void write_problem_files(Problem &prob, const Scale &scale)
+		{
+			int n_par = prob.par_names.size();
+			int n_obs = prob.obs_names.size();
+			ofstream pst(prob.pst_file);
+			if (!pst.good())
+				throw runtime_error("unable to open " + prob.pst_file + " for writing");
+			pst << "pcf" << endl;
+			pst << "* control data" << endl;
+			pst << "restart estimation" << endl;
+			pst << n_par << " " << n_obs << " 1 0 1" << endl;
+			pst << "1 1 single point 1 0 0 noobsreref" << endl;
+			pst << "1.0 -4.0 0.3 0.03 10 999 lamforgive noderforgive" << endl;
+			pst << "5.0 5.0 1.0e-3 0 0" << endl;
+			pst << "0.1 1 1.1 noaui nosenreuse noboundscale" << endl;
+			pst << "1 5.0e-3 4 4 5.0e-3 4 0.0 1 -1.0" << endl;
+			pst << "1 1 1 0" << endl;
+			pst << "* parameter groups" << endl;
+			pst << "pg relative 1.0e-02 0.0 switch 2.0 parabolic" << endl;
+			pst << "* parameter data" << endl;
+			pst << scientific << setprecision(10);
+			for (int i = 0; i < n_par; ++i)
+			{
+				string trans = "log";
+				if (i % 50 == 49)
+					trans = "fixed";
+				else if (i % 5 == 4)
+					trans = "none";
+				double init = 1.0 + 0.001 * (i % 1000);
+				pst << prob.par_names[i] << " " << trans << " factor " << init << " " << init * 0.01 << " "
+					<< init * 100.0 << " pg 1.0 0.0 1" << endl;
+			}
+			pst << "* observation groups" << endl;
+			pst << "og" << endl;
+			pst << "* observation data" << endl;
+			for (int j = 0; j < n_obs; ++j)
+				pst << prob.obs_names[j] << " " << 1.0 + 0.001 * (j % 1000) << " " << 1.0 + (j % 3) << " og" << endl;
+			pst << "* model command line" << endl;
+			pst << "true" << endl;
+			pst << "* model input/output" << endl;
+			pst << prob.tpl_file << " " << prob.in_file << endl;
+			pst << prob.ins_file << " " << prob.out_file << endl;
+			pst.close();
+
+			ofstream tpl(prob.tpl_file);
+			tpl << "ptf ~" << endl;
+			for (auto &name : prob.par_names)
+				tpl << "~" << left << setw(22) << name << "~" << endl;
+			tpl.close();
+
+			ofstream ins(prob.ins_file);
+			ins << "pif ~" << endl;
+			for (auto &name : prob.obs_names)
+				ins << "l1 !" << name << "!" << endl;
+			ins.close();
+
+			ofstream out(prob.out_file);
+			out << scientific << setprecision(10);
+			for (int j = 0; j < n_obs; ++j)
+				out << "  " << 1.0 + 0.001 * (j % 1000) << endl;
+			out.close();
+		}
+	}
+
+	vector<Scale> get_scales(const string &names)
+	{
+		//the large scale is opt-in since the dense kernels need several GB at that size
+		vector<Scale> all{ { "small", 100, 500, 50 }, { "medium", 1000, 5000, 100 }, { "large", 10000, 50000, 200 } };
+		vector<string> tokens;
+		pest_utils::tokenize(names, tokens, ",");
+		vector<Scale> scales;
+		for (auto &tok : tokens)
+		{
+			bool found = false;
+			for (auto &s : all)
+			{
+				if ((tok == s.name) || (tok == "all"))
+				{
+					scales.push_back(s);
+					found = true;
+				}
+			}
+			if (!found)
+				throw runtime_error("unrecognized scale: " + tok + ", expected small, medium, large or all");
+		}
+		return scales;
+	}
+
+	Problem &get_problem(const Scale &scale)
+	{
+		static map<string, unique_ptr<Problem>> problems;
+		auto it = problems.find(scale.name);
+		if (it != problems.end())
+			return *it->second;
+
+		unique_ptr<Problem> prob(new Problem());
+		string base = "bench_" + scale.name;
+		prob->pst_file = base + ".pst";
+		prob->tpl_file = base + ".tpl";
+		prob->in_file = base + ".in";
+		prob->ins_file = base + ".ins";
+		prob->out_file = base + ".out";
+		prob->par_names = make_names("p", scale.n_par);
+		prob->obs_names = make_names("o", scale.n_obs);
+		write_problem_files(*prob, scale);
+		ifstream fin(prob->pst_file);
+		prob->pest.process_ctl_file(fin, prob->pst_file);
+		Problem &ref = *prob;
+		problems[scale.name] = move(prob);
+		return ref;
+	}
+
+	vector<string> make_names(const string &prefix, int n)
+	{
+		vector<string> names;
+		names.reserve(n);
+		for (int i = 0; i < n; ++i)
+		{
+			stringstream ss;
+			ss << prefix << setw(7) << setfill('0') << i;
+			names.push_back(ss.str());
+		}
+		return names;
+	}
+
+	double sens(long irow, long icol)
+	{
+		return 1.0 + 0.5 * sin(double(irow + 3 * icol));
+	}
+
+	Eigen::SparseMatrix<double> make_banded_matrix(int nrow, int ncol, int bandwidth)
+	{
+		vector<Eigen::Triplet<double>> triplets;
+		triplets.reserve(size_t(ncol) * (2 * bandwidth + 1));
+		for (int icol = 0; icol < ncol; ++icol)
+		{
+			long i_mid = long(double(icol) * nrow / ncol);
+			long i_beg = max(0L, i_mid - bandwidth);
+			long i_end = min(long(nrow), i_mid + bandwidth + 1);
+			for (long irow = i_beg; irow < i_end; ++irow)
+				triplets.push_back(Eigen::Triplet<double>(irow, icol, sens(irow, icol)));
+		}
+		Eigen::SparseMatrix<double> mat(nrow, ncol);
+		mat.setFromTriplets(triplets.begin(), triplets.end());
+		return mat;
+	}
+
+	Eigen::MatrixXd make_random_matrix(int nrow, int ncol, unsigned int seed)
+	{
+		mt19937 gen(seed);
+		normal_distribution<double> dist(0.0, 1.0);
+		Eigen::MatrixXd mat(nrow, ncol);
+		for (int j = 0; j < ncol; ++j)
+			for (int i = 0; i < nrow; ++i)
+				mat(i, j) = dist(gen);
+		return mat;
+	}
+}
@@ -0,0 +1,40 @@
+#ifndef BENCH_PROBLEMS_H_
+#define BENCH_PROBLEMS_H_
+
+#include <string>
+#include <vector>
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include "Pest.h"
+#include "bench_harness.h"
+
+// Synthetic problem generators shared by the benchmarks.  A problem is a
+// control file with one template and one instruction file, written to the
+// working directory and loaded once per scale.  The parameter mix (log,
+// none and fixed) and the banded sensitivity pattern follow the shape of
+// typical groundwater model problems.
+
+namespace bench
+{
+	struct Problem
+	{
+		std::string pst_file;
+		std::string tpl_file;
+		std::string in_file;
+		std::string ins_file;
+		std::string out_file;
+		std::vector<std::string> par_names;
+		std::vector<std::string> obs_names;
+		Pest pest;
+	};
+
+	std::vector<Scale> get_scales(const std::string &names);
+	Problem &get_problem(const Scale &scale);
+	std::vector<std::string> make_names(const std::string &prefix, int n);
+	double sens(long irow, long icol);
+	//nrow x ncol with "bandwidth" nonzeros either side of the scaled diagonal
+	Eigen::SparseMatrix<double> make_banded_matrix(int nrow, int ncol, int bandwidth);
+	Eigen::MatrixXd make_random_matrix(int nrow, int ncol, unsigned int seed);
+}
+
+#endif /* BENCH_PROBLEMS_H_ */
@@ -0,0 +1,49 @@
+"""compare two pestpp-bench JSON result files
+
+usage: python compare_bench.py <base.json> <new.json> [threshold]
+
+Prints the ratio of new to base median time for every benchmark found in both
+files and flags changes larger than the threshold (default 0.1, i.e. 10%).
+"""
+import json
+import sys
+
+
+def load(filename):
+    with open(filename) as f:
+        data = json.load(f)
+    results = {}
+    for b in data["benchmarks"]:
+        if "skipped" in b:
+            continue
+        results[(b["name"], b["scale"])] = b
+    return data["context"], results
+
+
+def main():
+    if len(sys.argv) < 3:
+        print(__doc__)
+        return 1
+    threshold = float(sys.argv[3]) if len(sys.argv) > 3 else 0.1
+    base_ctx, base = load(sys.argv[1])
+    new_ctx, new = load(sys.argv[2])
+    print("base: {0} ({1})".format(base_ctx.get("commit"), base_ctx.get("date")))
+    print("new:  {0} ({1})".format(new_ctx.get("commit"), new_ctx.get("date")))
+    print("{0:44s}{1:8s}{2:>14s}{3:>14s}{4:>10s}".format("benchmark", "scale", "base(ms)", "new(ms)", "ratio"))
+    for key in sorted(set(base.keys()) & set(new.keys())):
+        b = base[key]["median_sec"]
+        n = new[key]["median_sec"]
+        ratio = n / b if b > 0.0 else float("nan")
+        flag = ""
+        if ratio > 1.0 + threshold:
+            flag = "  slower"
+        elif ratio < 1.0 - threshold:
+            flag = "  faster"
+        print("{0:44s}{1:8s}{2:14.4f}{3:14.4f}{4:10.3f}{5}".format(key[0], key[1], b * 1000.0, n * 1000.0, ratio, flag))
+    for key in sorted(set(base.keys()) ^ set(new.keys())):
+        print("{0:44s}{1:8s}  only in {2}".format(key[0], key[1], "base" if key in base else "new"))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
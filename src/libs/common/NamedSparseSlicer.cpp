@@ -0,0 +1,231 @@
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include "NamedSparseSlicer.h"
+
+using namespace std;
+
+NamedSparseSlicer::NamedSparseSlicer(size_t _max_orderings) : max_orderings(max(_max_orderings, size_t(1)))
+{
+}
+
+NamedSparseSlicer::NamedSparseSlicer(const NamedSparseSlicer &other) : max_orderings(other.max_orderings)
+{
+	// the cache is derived data; copies start empty and rebuild on first use
+}
+
+NamedSparseSlicer& NamedSparseSlicer::operator=(const NamedSparseSlicer &other)
+{
+	if (this != &other)
+	{
+		clear();
+		max_orderings = other.max_orderings;
+	}
+	return *this;
+}
+
+void NamedSparseSlicer::clear()
+{
+	lock_guard<mutex> guard(cache_lock);
+	rows = Axis();
+	cols = Axis();
+}
+
+shared_ptr<const NamedSparseSlicer::Ordering> NamedSparseSlicer::get_ordering(Axis &axis, const vector<string> &src_names,
+	const vector<string> &new_names, bool &src_has_duplicates)
+{
+	// re-intern the source names if they have changed since the last call
+	if (axis.names != src_names)
+	{
+		axis = Axis();
+		axis.names = src_names;
+		axis.name2idx.reserve(src_names.size());
+		for (int i = 0; i < src_names.size(); ++i)
+		{
+			if (!axis.name2idx.emplace(src_names[i], i).second)
+				axis.has_duplicates = true;
+		}
+	}
+	src_has_duplicates = axis.has_duplicates;
+
+	for (auto it = axis.orderings.begin(); it != axis.orderings.end(); ++it)
+	{
+		if ((*it)->names == new_names)
+		{
+			shared_ptr<const Ordering> found = *it;
+			axis.orderings.erase(it);
+			axis.orderings.push_front(found);
+			return found;
+		}
+	}
+
+	shared_ptr<Ordering> ord = make_shared<Ordering>();
+	ord->names = new_names;
+	ord->identity = (!axis.has_duplicates) && (new_names == src_names);
+	int n_src = src_names.size();
+	int n_new = new_names.size();
+	ord->src2new.assign(n_src, -1);
+	ord->new2src.assign(n_new, -1);
+	if (ord->identity)
+	{
+		for (int i = 0; i < n_src; ++i)
+		{
+			ord->src2new[i] = i;
+			ord->new2src[i] = i;
+		}
+	}
+	else
+	{
+		// when a name is requested more than once the last occurrence receives the entries
+		unordered_map<string, int> new_name2idx;
+		new_name2idx.reserve(n_new);
+		for (int i = 0; i < n_new; ++i)
+			new_name2idx[new_names[i]] = i;
+		unordered_map<string, int>::const_iterator not_found = new_name2idx.end();
+		for (int i = 0; i < n_src; ++i)
+		{
+			unordered_map<string, int>::const_iterator found = new_name2idx.find(src_names[i]);
+			if (found != not_found)
+				ord->src2new[i] = found->second;
+		}
+		unordered_map<string, int>::const_iterator not_found_src = axis.name2idx.end();
+		for (int i = 0; i < n_new; ++i)
+		{
+			unordered_map<string, int>::const_iterator found = axis.name2idx.find(new_names[i]);
+			if (found == not_found_src)
+				ord->missing.push_back(new_names[i]);
+			else if (ord->src2new[found->second] == i)
+				ord->new2src[i] = found->second;
+		}
+	}
+	ord->monotone = true;
+	int last = -1;
+	for (int i = 0; i < n_src; ++i)
+	{
+		if (ord->src2new[i] < 0)
+			continue;
+		if (ord->src2new[i] <= last)
+		{
+			ord->monotone = false;
+			break;
+		}
+		last = ord->src2new[i];
+	}
+
+	axis.orderings.push_front(ord);
+	while (axis.orderings.size() > max_orderings)
+		axis.orderings.pop_back();
+	return ord;
+}
+
+vector<int> NamedSparseSlicer::row_index(const vector<string> &src_names, const vector<string> &new_names)
+{
+	bool dups;
+	lock_guard<mutex> guard(cache_lock);
+	return get_ordering(rows, src_names, new_names, dups)->new2src;
+}
+
+vector<int> NamedSparseSlicer::col_index(const vector<string> &src_names, const vector<string> &new_names)
+{
+	bool dups;
+	lock_guard<mutex> guard(cache_lock);
+	return get_ordering(cols, src_names, new_names, dups)->new2src;
+}
+
+Eigen::SparseMatrix<double> NamedSparseSlicer::slice(const Eigen::SparseMatrix<double> &matrix,
+	const vector<string> &src_row_names, const vector<string> &src_col_names,
+	const vector<string> &new_row_names, const vector<string> &new_col_names,
+	vector<string> *missing_rows, vector<string> *missing_cols)
+{
+	if ((matrix.rows() > src_row_names.size()) || (matrix.cols() > src_col_names.size()))
+		throw runtime_error("NamedSparseSlicer::slice() error: matrix is larger than the number of row/col names");
+
+	shared_ptr<const Ordering> row_ord;
+	shared_ptr<const Ordering> col_ord;
+	bool row_dups;
+	bool col_dups;
+	{
+		lock_guard<mutex> guard(cache_lock);
+		row_ord = get_ordering(rows, src_row_names, new_row_names, row_dups);
+		col_ord = get_ordering(cols, src_col_names, new_col_names, col_dups);
+	}
+	if (missing_rows)
+		*missing_rows = row_ord->missing;
+	if (missing_cols)
+		*missing_cols = col_ord->missing;
+
+	int n_rows = new_row_names.size();
+	int n_cols = new_col_names.size();
+	if (row_ord->identity && col_ord->identity && (matrix.rows() == n_rows) && (matrix.cols() == n_cols))
+		return matrix;
+
+	Eigen::SparseMatrix<double> new_matrix(n_rows, n_cols);
+	const vector<int> &row_src2new = row_ord->src2new;
+	if (row_dups || col_dups)
+	{
+		// duplicate source names map several source entries to one new entry, which are summed
+		const vector<int> &col_src2new = col_ord->src2new;
+		vector<Eigen::Triplet<double> > triplet_list;
+		for (int icol = 0; icol < matrix.outerSize(); ++icol)
+		{
+			int jcol = col_src2new[icol];
+			if (jcol < 0)
+				continue;
+			for (Eigen::SparseMatrix<double>::InnerIterator it(matrix, icol); it; ++it)
+			{
+				int irow = row_src2new[it.row()];
+				if (irow >= 0)
+					triplet_list.push_back(Eigen::Triplet<double>(irow, jcol, it.value()));
+			}
+		}
+		new_matrix.setFromTriplets(triplet_list.begin(), triplet_list.end());
+		return new_matrix;
+	}
+
+	const vector<int> &col_new2src = col_ord->new2src;
+	size_t nnz = 0;
+	for (int jcol = 0; jcol < n_cols; ++jcol)
+	{
+		int icol = col_new2src[jcol];
+		if ((icol < 0) || (icol >= matrix.outerSize()))
+			continue;
+		for (Eigen::SparseMatrix<double>::InnerIterator it(matrix, icol); it; ++it)
+		{
+			if (row_src2new[it.row()] >= 0)
+				++nnz;
+		}
+	}
+	new_matrix.reserve(nnz);
+	vector<pair<int, double> > col_buf;
+	for (int jcol = 0; jcol < n_cols; ++jcol)
+	{
+		new_matrix.startVec(jcol);
+		int icol = col_new2src[jcol];
+		if ((icol < 0) || (icol >= matrix.outerSize()))
+			continue;
+		if (row_ord->monotone)
+		{
+			for (Eigen::SparseMatrix<double>::InnerIterator it(matrix, icol); it; ++it)
+			{
+				int irow = row_src2new[it.row()];
+				if (irow >= 0)
+					new_matrix.insertBack(irow, jcol) = it.value();
+			}
+		}
+		else
+		{
+			col_buf.clear();
+			for (Eigen::SparseMatrix<double>::InnerIterator it(matrix, icol); it; ++it)
+			{
+				int irow = row_src2new[it.row()];
+				if (irow >= 0)
+					col_buf.push_back(make_pair(irow, it.value()));
+			}
+			sort(col_buf.begin(), col_buf.end());
+			for (auto &e : col_buf)
+				new_matrix.insertBack(e.first, jcol) = e.second;
+		}
+	}
+	new_matrix.finalize();
+	return new_matrix;
+}
@@ -0,0 +1,68 @@
+#ifndef NAMED_SPARSE_SLICER_H_
+#define NAMED_SPARSE_SLICER_H_
+
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <Eigen/Sparse>
+
+/* @brief Name-based row/column slicing of a sparse matrix with cached permutations
+
+ Interns the row and column names of a source matrix once and caches the
+ source-to-new index permutation for the most recently requested row and
+ column orderings.  Repeated slices with the same name lists are then index
+ only gathers, and a straight copy when the requested ordering matches the
+ source ordering.  Requested names that are not present in the source give
+ empty rows/columns; they are reported through the missing name vectors.
+ The cache is rebuilt automatically when the source names change, and is
+ not copied when the owning object is copied.
+*/
+class NamedSparseSlicer
+{
+public:
+	NamedSparseSlicer(size_t _max_orderings = 8);
+	NamedSparseSlicer(const NamedSparseSlicer &other);
+	NamedSparseSlicer& operator=(const NamedSparseSlicer &other);
+	Eigen::SparseMatrix<double> slice(const Eigen::SparseMatrix<double> &matrix,
+		const std::vector<std::string> &src_row_names, const std::vector<std::string> &src_col_names,
+		const std::vector<std::string> &new_row_names, const std::vector<std::string> &new_col_names,
+		std::vector<std::string> *missing_rows = nullptr, std::vector<std::string> *missing_cols = nullptr);
+	// index of each new name in the source names (-1 if not present)
+	std::vector<int> row_index(const std::vector<std::string> &src_names, const std::vector<std::string> &new_names);
+	std::vector<int> col_index(const std::vector<std::string> &src_names, const std::vector<std::string> &new_names);
+	void clear();
+	~NamedSparseSlicer() {}
+
+private:
+	class Ordering
+	{
+	public:
+		std::vector<std::string> names;
+		std::vector<int> src2new;  // new index for each source index, -1 if not requested
+		std::vector<int> new2src;  // source index for each new index, -1 if not in source
+		std::vector<std::string> missing;
+		bool identity;
+		bool monotone;  // src2new is increasing over the requested entries
+	};
+	class Axis
+	{
+	public:
+		Axis() : has_duplicates(false) {}
+		std::vector<std::string> names;
+		std::unordered_map<std::string, int> name2idx;
+		bool has_duplicates;
+		std::list<std::shared_ptr<const Ordering> > orderings;
+	};
+	size_t max_orderings;
+	Axis rows;
+	Axis cols;
+	std::mutex cache_lock;
+
+	std::shared_ptr<const Ordering> get_ordering(Axis &axis, const std::vector<std::string> &src_names,
+		const std::vector<std::string> &new_names, bool &src_has_duplicates);
+};
+
+#endif /* NAMED_SPARSE_SLICER_H_ */
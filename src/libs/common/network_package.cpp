@@ -3,6 +3,7 @@
 #include <cstring>
 #include "network_package.h"
 #include "network_wrapper.h"
+#include "perf_trace.h"
 #include <cassert>
 
 using namespace std;
@@ -10,6 +11,8 @@ using namespace std;
 //Static Memeber Initialization
 int64_t NetPackage::last_group_id = 0;
 int8_t NetPackage::security_code[5] = { 1, 5, 25, 50, 100 };
+std::atomic<int64_t> NetPackage::total_bytes_sent(0);
+std::atomic<int64_t> NetPackage::total_bytes_received(0);
 
 //Static Methods
 int NetPackage::get_new_group_id()
@@ -17,6 +20,19 @@ int NetPackage::get_new_group_id()
 	return ++last_group_id;
 }
 
+bool NetPackage::has_capability(const std::string &desc, const std::string &capability)
+{
+	//capabilities in a description are separated by spaces
+	stringstream ss(desc);
+	string tok;
+	while (ss >> tok)
+	{
+		if (tok == capability)
+			return true;
+	}
+	return false;
+}
+
 bool NetPackage::allowable_ascii_char(int8_t value)
 {
 	// This is for security resasons.  Only \0
@@ -140,46 +156,36 @@ void NetPackage::reset(PackType _type, int _group, int _run_id, const string &_d
 
 int NetPackage::send(int sockfd, const void *data, int64_t data_len_l)
 {
+	perf_trace::ScopedSpan span("NetPackage::send");
 	int n;
-
-	// first send security code
 	int64_t security_code_size = sizeof(security_code);
-	n = w_sendall(sockfd, &security_code[0], &security_code_size);
-	if (n<1) {
-		cerr << "NetPackage::send error: could not send security code" << endl;
-		return n;
-	}
-	int64_t buf_sz = 0;
-	//calculate the size of buffer
-	buf_sz += sizeof(buf_sz);
-	buf_sz += sizeof(type);
-	buf_sz += sizeof(group);
-	buf_sz += sizeof(run_id);
-	buf_sz += sizeof(desc);
-	buf_sz += data_len_l;
-	//pack information into buffer
-	//unique_ptr<char[]> buf(new char[buf_sz]);
-	vector<int8_t> buf;
-	buf.resize(buf_sz, '\0');
+	const int64_t header_sz = sizeof(int64_t) + sizeof(type) + sizeof(group) + sizeof(run_id) + sizeof(desc);
+	int64_t buf_sz = header_sz + data_len_l;
+	//pack the header; the security code, header and data then go out in a single gather write
+	//without copying the data
+	int8_t header[header_sz];
 	size_t i_start = 0;
-	w_memcpy_s(&buf[i_start], buf_sz-i_start, &buf_sz, sizeof(buf_sz));
+	w_memcpy_s(&header[i_start], header_sz - i_start, &buf_sz, sizeof(buf_sz));
 	i_start += sizeof(buf_sz);
-	w_memcpy_s(&buf[i_start], buf_sz-i_start, &type, sizeof(type));
+	w_memcpy_s(&header[i_start], header_sz - i_start, &type, sizeof(type));
 	i_start += sizeof(type);
-	w_memcpy_s(&buf[i_start], buf_sz-i_start, &group, sizeof(group));
+	w_memcpy_s(&header[i_start], header_sz - i_start, &group, sizeof(group));
 	i_start += sizeof(group);
-	w_memcpy_s(&buf[i_start], buf_sz-i_start, &run_id, sizeof(run_id));
+	w_memcpy_s(&header[i_start], header_sz - i_start, &run_id, sizeof(run_id));
 	i_start += sizeof(run_id);
-	w_memcpy_s(&buf[i_start], buf_sz-i_start, desc, sizeof(desc));
-	i_start += sizeof(desc);
-	if (data_len_l > 0) {
-		w_memcpy_s(&buf[i_start], buf_sz-i_start, data, data_len_l);
-		i_start += data_len_l;
+	w_memcpy_s(&header[i_start], header_sz - i_start, desc, sizeof(desc));
+	const int8_t *bufs[3] = { security_code, header, static_cast<const int8_t*>(data) };
+	int64_t buf_lens[3] = { security_code_size, header_sz, (data_len_l > 0) ? data_len_l : 0 };
+	int64_t n_sent = 0;
+	n = w_sendallv(sockfd, bufs, buf_lens, 3, &n_sent);
+	total_bytes_sent += n_sent;
+	perf_trace::add_count("NetPackage::bytes_sent", n_sent);
+	if (n < 1) {
+		cerr << "NetPackage::send error: could not send package" << endl;
 	}
-	n = w_sendall(sockfd, buf.data(), &buf_sz);
-	if (i_start != buf_sz) {
-		cerr << "NetPackage::send error: could only send" << i_start
-			<< " out of " << buf_sz << "bytes" << endl;
+	else if (n_sent != security_code_size + buf_sz) {
+		cerr << "NetPackage::send error: could only send" << n_sent
+			<< " out of " << security_code_size + buf_sz << "bytes" << endl;
 		n = -2;
 	}
 	return n;  // return -2 on corrupt send, -1 on failure, 0 closed connection or 1 on success
@@ -187,6 +193,7 @@ int NetPackage::send(int sockfd, const void *data, int64_t data_len_l)
 
 int  NetPackage::recv(int sockfd)
 {
+	perf_trace::ScopedSpan span("NetPackage::recv");
 	long n;
 	int64_t header_sz = 0;
 	int64_t buf_sz = 0;
@@ -232,7 +239,7 @@ int  NetPackage::recv(int sockfd)
 			// is use to represent a standard char
 			for (int i = 0; i < DESC_LEN; ++i)
 			{
-				if (!allowable_ascii_char(header_buf[i_start + 1]))
+				if (!allowable_ascii_char(header_buf[i_start + i]))
 				{
 					corrupt_desc = true;
 					n = -2;
@@ -240,7 +247,7 @@ int  NetPackage::recv(int sockfd)
 				}
 				else
 				{
-					desc[i] = header_buf[i_start + 1];
+					desc[i] = header_buf[i_start + i];
 				}
 			}
 			i_start += sizeof(desc);
@@ -259,6 +266,9 @@ int  NetPackage::recv(int sockfd)
 			}
 		}
 		if (n > 1) { n = 1; }
+		int64_t bytes_received = rcv_security_code_size + header_sz + ((n > 0) ? data_len : 0);
+		total_bytes_received += bytes_received;
+		perf_trace::add_count("NetPackage::bytes_received", bytes_received);
 	}
 	catch (exception& e)
 	{
@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <vector>
 #include <memory>
+#include <atomic>
 
 class NetPackage
 {
@@ -19,7 +20,15 @@ public:
 	static std::vector<int8_t> pack_string(InputIterator first, InputIterator last);
 	enum class PackType :uint32_t {
 		UNKN, OK, CONFIRM_OK, READY, REQ_RUNDIR, RUNDIR, REQ_LINPACK, LINPACK, PAR_NAMES, OBS_NAMES,
-		START_RUN, RUN_FINISHED, RUN_FAILED, RUN_KILLED, TERMINATE,PING,REQ_KILL,IO_ERROR,CORRUPT_MESG};
+		START_RUN, RUN_FINISHED, RUN_FAILED, RUN_KILLED, TERMINATE,PING,REQ_KILL,IO_ERROR,CORRUPT_MESG,
+		BASE_PARS, START_RUN_DELTA, RUN_FINISHED_DELTA, BASE_OBS, RUN_FINISHED_PACKED, DERIVATIVES};
+	//description of the START_RUN packages of runs that also execute the derivatives command
+	static constexpr const char *derivatives_desc = "derivatives";
+	//capability for BASE_PARS, START_RUN_DELTA and RUN_FINISHED_DELTA.  The master lists the capabilities it
+	//offers in the REQ_LINPACK description and the slave returns those it supports in the LINPACK description,
+	//so a slave that does not know the capability falls back to START_RUN and RUN_FINISHED
+	static constexpr const char *run_delta_capability = "run_delta_1";
+	static bool has_capability(const std::string &desc, const std::string &capability);
 	static int get_new_group_id();
 	NetPackage(PackType _type=PackType::UNKN, int _group=-1, int _run_id=-1, const std::string &desc_str="");
 	~NetPackage(){}
@@ -30,8 +39,12 @@ public:
 	PackType get_type() const {return type;}
 	int64_t get_run_id() const { return run_id; }
 	int64_t get_group_id() const { return group; }
+	std::string get_desc() const { return std::string((const char*)desc); }
 	const std::vector<int8_t> &get_data(){ return data; }
 	void print_header(std::ostream &fout);
+	//bytes moved by all packages in this process, including headers
+	static int64_t get_total_bytes_sent() { return total_bytes_sent; }
+	static int64_t get_total_bytes_received() { return total_bytes_received; }
 
 
 private:
@@ -42,6 +55,8 @@ private:
 	int64_t run_id;
 	int8_t desc[DESC_LEN];
 	static int8_t security_code[5];
+	static std::atomic<int64_t> total_bytes_sent;
+	static std::atomic<int64_t> total_bytes_received;
 	std::vector<int8_t> data;
 };
 
@@ -23,6 +23,8 @@
 #include<sys/wait.h>
 #include <errno.h>
 #include <signal.h>
+#include <sys/uio.h>
+#include <climits>
 #endif
 
 using namespace std;
@@ -187,6 +189,82 @@ int w_sendall(int sockfd, int8_t *buf, int64_t *len)
 	return n; // return -1 on failure, 0 closed connection or 1 on success
 }
 
+int w_set_nodelay(int sockfd)
+{
+	int flag = 1;
+	int n = setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, (const char*)&flag, sizeof(flag));
+	if (n < 0){
+		cerr << "setsockopt(TCP_NODELAY) error: " << w_get_error_msg() << endl;
+	}
+	return n;
+}
+
+int w_sendallv(int sockfd, const int8_t * const *bufs, const int64_t *buf_lens, int n_bufs, int64_t *len)
+{
+	// send several buffers with as few system calls as possible so a message
+	// is not split into small segments that wait on delayed acknowledgements
+	int64_t total_len = 0;
+	for (int i = 0; i < n_bufs; ++i)
+		total_len += buf_lens[i];
+	int64_t total = 0;
+	int i_buf = 0;
+	int64_t buf_offset = 0;
+	int n = 1;
+	while (total < total_len)
+	{
+		while (i_buf < n_bufs && buf_offset >= buf_lens[i_buf])
+		{
+			buf_offset -= buf_lens[i_buf];
+			++i_buf;
+		}
+#ifdef OS_WIN
+		vector<WSABUF> iov;
+		for (int i = i_buf; i < n_bufs; ++i)
+		{
+			WSABUF b;
+			int64_t offset = (i == i_buf) ? buf_offset : 0;
+			b.buf = (char*)bufs[i] + offset;
+			b.len = ULONG(buf_lens[i] - offset);
+			iov.push_back(b);
+		}
+		DWORD n_sent = 0;
+		if (WSASend(sockfd, iov.data(), DWORD(iov.size()), &n_sent, 0, NULL, NULL) != 0)
+		{
+			n = -1;
+			break;
+		}
+		int64_t n_bytes = n_sent;
+#else
+		vector<iovec> iov;
+		for (int i = i_buf; i < n_bufs && iov.size() < IOV_MAX; ++i)
+		{
+			iovec b;
+			int64_t offset = (i == i_buf) ? buf_offset : 0;
+			b.iov_base = (void*)(bufs[i] + offset);
+			b.iov_len = size_t(buf_lens[i] - offset);
+			iov.push_back(b);
+		}
+		int64_t n_bytes = writev(sockfd, iov.data(), int(iov.size()));
+		if (n_bytes == -1)
+		{
+			n = -1;
+			break;
+		}
+#endif
+		if (n_bytes == 0)
+		{
+			n = 0;
+			break;
+		}
+		total += n_bytes;
+		buf_offset += n_bytes;
+	}
+	*len = total; // return number actually sent here
+	if (n < 0){
+		cerr << "w_sendallv error: " << w_get_error_msg() << endl;
+	}
+	return n; // return -1 on failure, 0 closed connection or 1 on success
+}
 
 int w_recvall(int sockfd, int8_t *buf, int64_t *len)
 {
@@ -21,6 +21,9 @@
   #include <signal.h>
   #include <netdb.h>
   #include <sys/socket.h>
+  #include <sys/uio.h>
+  #include <netinet/in.h>
+  #include <netinet/tcp.h>
 #endif
 
 //common for all systems
@@ -42,7 +45,11 @@ int w_listen(int sockfd, int backlog);
 int w_accept(int sockfd, struct sockaddr *addr, socklen_t *addr_len);
 int w_send(int sockfd, int8_t *buf, int64_t len, int flags);
 int w_sendall(int sockfd, int8_t *buf, int64_t *len);
+//gather write of n_bufs buffers; *len returns the number of bytes sent
+int w_sendallv(int sockfd, const int8_t * const *bufs, const int64_t *buf_lens, int n_bufs, int64_t *len);
 int w_recv(int sockfd, int8_t *buf, int64_t len, int flags);
+//disable Nagle's algorithm; messages are written whole so small segments are not a concern
+int w_set_nodelay(int sockfd);
 int w_recvall(int sockfd, int8_t *buf, int64_t *len);
 int w_select(int numfds, fd_set *readfds, fd_set *writefds,
 		   fd_set *exceptfds, struct timeval *timeout);
@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "config_os.h"
+#include "perf_trace.h"
+
+#ifdef OS_LINUX
+#include <sys/resource.h>
+#endif
+#ifdef OS_WIN
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#endif
+
+using namespace std;
+
+namespace perf_trace
+{
+	atomic<bool> enabled_flag(false);
+
+	namespace
+	{
+		struct Event
+		{
+			const char *name;
+			int tid;
+			int64_t ts_us;
+			int64_t dur_us;
+			int64_t rss_kb;
+		};
+
+		struct RawStats
+		{
+			const char *parent;
+			SpanStats stats;
+		};
+
+		//the timeline stops growing after this many events; the summaries keep going
+		const size_t max_events = 1000000;
+
+		mutex trace_mutex;
+		unordered_map<const char*, RawStats> interval_spans;
+		unordered_map<const char*, RawStats> total_spans;
+		unordered_map<const char*, int64_t> interval_counts;
+		unordered_map<const char*, int64_t> total_counts;
+		vector<Event> events;
+		int64_t dropped_events = 0;
+		int next_tid = 0;
+		chrono::steady_clock::time_point epoch = chrono::steady_clock::now();
+
+		vector<const char*> &span_stack()
+		{
+			thread_local vector<const char*> stack;
+			return stack;
+		}
+
+		int thread_index()
+		{
+			thread_local int tid = -1;
+			if (tid < 0)
+			{
+				lock_guard<mutex> lock(trace_mutex);
+				tid = next_tid++;
+			}
+			return tid;
+		}
+
+		void add_stats(unordered_map<const char*, RawStats> &spans, const char *name, const char *parent,
+			int depth, double sec, int64_t rss_kb)
+		{
+			auto it = spans.find(name);
+			if (it == spans.end())
+			{
+				RawStats raw;
+				raw.parent = parent;
+				raw.stats.depth = depth;
+				it = spans.insert(make_pair(name, raw)).first;
+			}
+			SpanStats &s = it->second.stats;
+			s.calls++;
+			s.total_sec += sec;
+			s.max_sec = max(s.max_sec, sec);
+			s.peak_rss_kb = max(s.peak_rss_kb, rss_kb);
+		}
+
+		//spans are keyed by name pointer while collecting; merge them by name for reporting
+		void merge_spans(const unordered_map<const char*, RawStats> &raw_spans, map<string, SpanStats> &spans)
+		{
+			spans.clear();
+			for (auto &raw : raw_spans)
+			{
+				auto it = spans.find(raw.first);
+				if (it == spans.end())
+				{
+					SpanStats s = raw.second.stats;
+					s.parent = (raw.second.parent) ? raw.second.parent : "";
+					spans[raw.first] = s;
+					continue;
+				}
+				SpanStats &s = it->second;
+				s.calls += raw.second.stats.calls;
+				s.total_sec += raw.second.stats.total_sec;
+				s.max_sec = max(s.max_sec, raw.second.stats.max_sec);
+				s.peak_rss_kb = max(s.peak_rss_kb, raw.second.stats.peak_rss_kb);
+			}
+		}
+
+		void merge_counts(const unordered_map<const char*, int64_t> &raw_counts, map<string, int64_t> &counts)
+		{
+			counts.clear();
+			for (auto &raw : raw_counts)
+				counts[raw.first] += raw.second;
+		}
+
+		void write_json_string(ostream &fout, const char *str)
+		{
+			fout << '"';
+			for (const char *c = str; *c; ++c)
+			{
+				if ((*c == '"') || (*c == '\\'))
+					fout << '\\';
+				fout << *c;
+			}
+			fout << '"';
+		}
+	}
+
+	void set_enabled(bool flag)
+	{
+		lock_guard<mutex> lock(trace_mutex);
+		if ((flag) && (!enabled()) && (events.empty()))
+			epoch = chrono::steady_clock::now();
+		enabled_flag.store(flag);
+	}
+
+	void add_count(const char *name, int64_t n)
+	{
+		if (!enabled())
+			return;
+		lock_guard<mutex> lock(trace_mutex);
+		interval_counts[name] += n;
+		total_counts[name] += n;
+	}
+
+	int64_t peak_rss_kb()
+	{
+#ifdef OS_WIN
+		PROCESS_MEMORY_COUNTERS pmc;
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+			return int64_t(pmc.PeakWorkingSetSize / 1024);
+		return 0;
+#else
+		struct rusage usage;
+		if (getrusage(RUSAGE_SELF, &usage) != 0)
+			return 0;
+#ifdef __APPLE__
+		//reported in bytes on macOS
+		return int64_t(usage.ru_maxrss / 1024);
+#else
+		return int64_t(usage.ru_maxrss);
+#endif
+#endif
+	}
+
+	void take_interval(map<string, SpanStats> &spans, map<string, int64_t> &counts)
+	{
+		lock_guard<mutex> lock(trace_mutex);
+		merge_spans(interval_spans, spans);
+		merge_counts(interval_counts, counts);
+		interval_spans.clear();
+		interval_counts.clear();
+	}
+
+	void get_totals(map<string, SpanStats> &spans, map<string, int64_t> &counts)
+	{
+		lock_guard<mutex> lock(trace_mutex);
+		merge_spans(total_spans, spans);
+		merge_counts(total_counts, counts);
+	}
+
+	void write_chrome_trace(ostream &fout)
+	{
+		lock_guard<mutex> lock(trace_mutex);
+		fout << "{\"traceEvents\":[" << endl;
+		bool first = true;
+		for (auto &e : events)
+		{
+			if (!first)
+				fout << "," << endl;
+			first = false;
+			fout << "{\"name\":";
+			write_json_string(fout, e.name);
+			fout << ",\"cat\":\"pestpp\",\"ph\":\"X\",\"pid\":0,\"tid\":" << e.tid << ",\"ts\":" << e.ts_us
+				<< ",\"dur\":" << e.dur_us << "}";
+			if (e.rss_kb > 0)
+			{
+				fout << "," << endl << "{\"name\":\"peak_rss\",\"ph\":\"C\",\"pid\":0,\"ts\":" << e.ts_us + e.dur_us
+					<< ",\"args\":{\"peak_rss_mb\":" << double(e.rss_kb) / 1024.0 << "}}";
+			}
+		}
+		fout << endl << "],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":" << dropped_events << "}}" << endl;
+	}
+
+	ScopedSpan::ScopedSpan(const char *_name, bool _phase) : name(_name), parent(nullptr), active(enabled()),
+		phase(_phase), depth(0)
+	{
+		if (!active)
+			return;
+		vector<const char*> &stack = span_stack();
+		if (!stack.empty())
+			parent = stack.back();
+		depth = stack.size();
+		stack.push_back(name);
+		start = chrono::steady_clock::now();
+	}
+
+	ScopedSpan::~ScopedSpan()
+	{
+		if (!active)
+			return;
+		chrono::steady_clock::time_point end = chrono::steady_clock::now();
+		vector<const char*> &stack = span_stack();
+		if (!stack.empty())
+			stack.pop_back();
+		int64_t rss_kb = (phase) ? peak_rss_kb() : 0;
+		int tid = thread_index();
+		double sec = chrono::duration<double>(end - start).count();
+		lock_guard<mutex> lock(trace_mutex);
+		add_stats(interval_spans, name, parent, depth, sec, rss_kb);
+		add_stats(total_spans, name, parent, depth, sec, rss_kb);
+		if (events.size() < max_events)
+		{
+			Event e;
+			e.name = name;
+			e.tid = tid;
+			e.ts_us = chrono::duration_cast<chrono::microseconds>(start - epoch).count();
+			e.dur_us = chrono::duration_cast<chrono::microseconds>(end - start).count();
+			e.rss_kb = rss_kb;
+			events.push_back(e);
+		}
+		else
+			dropped_events++;
+	}
+}
@@ -0,0 +1,62 @@
+#ifndef PERF_TRACE_H_
+#define PERF_TRACE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+
+// Lightweight scoped timers and counters for the hot paths.  Collection is off
+// by default; a disabled ScopedSpan costs one relaxed atomic load.  Span names
+// must be string literals (or otherwise outlive the program) since the timeline
+// stores the pointer.  Statistics accumulate both for the current interval
+// (reset by take_interval(), normally once per iteration) and for the whole run.
+
+namespace perf_trace
+{
+	struct SpanStats
+	{
+		std::string parent;
+		int depth;
+		int64_t calls;
+		double total_sec;
+		double max_sec;
+		//peak resident set size seen at the end of this span, only for phase spans
+		int64_t peak_rss_kb;
+		SpanStats() : depth(0), calls(0), total_sec(0.0), max_sec(0.0), peak_rss_kb(0) {}
+	};
+
+	extern std::atomic<bool> enabled_flag;
+	inline bool enabled() { return enabled_flag.load(std::memory_order_relaxed); }
+	void set_enabled(bool flag);
+
+	void add_count(const char *name, int64_t n = 1);
+	int64_t peak_rss_kb();
+
+	//copies the statistics collected since the previous call and resets them
+	void take_interval(std::map<std::string, SpanStats> &spans, std::map<std::string, int64_t> &counts);
+	void get_totals(std::map<std::string, SpanStats> &spans, std::map<std::string, int64_t> &counts);
+	//writes the timeline in the chrome://tracing (Trace Event) JSON format
+	void write_chrome_trace(std::ostream &fout);
+
+	class ScopedSpan
+	{
+	public:
+		//phase spans also record the peak resident set size when they end
+		explicit ScopedSpan(const char *_name, bool _phase = false);
+		~ScopedSpan();
+	private:
+		const char *name;
+		const char *parent;
+		bool active;
+		bool phase;
+		int depth;
+		std::chrono::steady_clock::time_point start;
+		ScopedSpan(const ScopedSpan&) = delete;
+		ScopedSpan& operator=(const ScopedSpan&) = delete;
+	};
+}
+
+#endif /* PERF_TRACE_H_ */
@@ -7,9 +7,13 @@
 #include <algorithm>
 #include <list>
 #include <cstring>
+#include <cstdlib>
 #include <cmath>
+#include <cerrno>
 #include <cassert>
 #include <mutex>
+#include <thread>
+#include <exception>
 #include "config_os.h"
 #include "Transformable.h"
 #include "network_package.h"
@@ -24,6 +28,13 @@
 #include "utilities.h"
 #include "system_variables.h"
 
+#ifdef OS_LINUX
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 
 using namespace std;
 
@@ -153,6 +164,71 @@ string upper_cp(const string &s)
 	return s2;
 }
 
+void split_fields(const string &line, vector<pair<size_t, size_t> > &fields, const char *delimiters)
+{
+	fields.clear();
+	const char *data = line.data();
+	size_t n = line.size();
+	size_t i = 0;
+	while (i < n)
+	{
+		while ((i < n) && (strchr(delimiters, data[i]) != nullptr))
+			++i;
+		if (i == n)
+			break;
+		size_t first = i;
+		while ((i < n) && (strchr(delimiters, data[i]) == nullptr))
+			++i;
+		fields.push_back(make_pair(first, i));
+	}
+}
+
+double field_to_double(const string &line, const pair<size_t, size_t> &field)
+{
+	// strtod also accepts inf, nan and hexadecimal values; only accept the decimal
+	// numbers convert_ip would and reject values that overflow the same way
+	const char *first = line.c_str() + field.first;
+	const char *digits = first;
+	if (*digits == '+' || *digits == '-')
+		++digits;
+	bool decimal = (isdigit((unsigned char)digits[0]) || digits[0] == '.') &&
+		!(digits[0] == '0' && (digits[1] == 'x' || digits[1] == 'X'));
+	char *last = nullptr;
+	errno = 0;
+	double value = strtod(first, &last);
+	if ((field.second == field.first) || (!decimal) || (last != line.c_str() + field.second) ||
+		(errno == ERANGE && fabs(value) == HUGE_VAL))
+		throw PestConversionError(line.substr(field.first, field.second - field.first));
+	return value;
+}
+
+int field_to_int(const string &line, const pair<size_t, size_t> &field)
+{
+	const char *first = line.c_str() + field.first;
+	char *last = nullptr;
+	long value = strtol(first, &last, 10);
+	if ((field.second == field.first) || (last != line.c_str() + field.second))
+		throw PestConversionError(line.substr(field.first, field.second - field.first));
+	return int(value);
+}
+
+void field_to_upper(const string &line, const pair<size_t, size_t> &field, string &s)
+{
+	s.assign(line, field.first, field.second - field.first);
+	upper_ip(s);
+}
+
+uint64_t fnv1a_hash(const char *data, size_t n)
+{
+	uint64_t hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < n; ++i)
+	{
+		hash ^= uint64_t((unsigned char)data[i]);
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
 string upper(char *txt)
 {
 	string tmp = txt;
@@ -555,173 +631,408 @@ void  thread_exceptions::rethrow()
 	}
 }
 
-bool read_binary(const string &filename, vector<string> &row_names, vector<string> &col_names, Eigen::SparseMatrix<double> &matrix)
+// read-only view of an entire file.  The file is memory mapped where the platform
+// supports it, otherwise it is read into memory with a single bulk read.
+class BinaryFileView
 {
-
-	ifstream in;
-	in.open(filename.c_str(), ifstream::binary);
-	if (!in.good())
+public:
+	BinaryFileView(const string &filename) : ptr(nullptr), len(0), map_ptr(nullptr)
 	{
-		stringstream ss;
-		ss << "Mat::from_binary() error opening binary file " << filename << " for reading";
-		throw runtime_error(ss.str());
+#ifdef OS_LINUX
+		int fd = open(filename.c_str(), O_RDONLY);
+		if (fd < 0)
+		{
+			throw runtime_error("Mat::from_binary() error opening binary file " + filename + " for reading");
+		}
+		struct stat sb;
+		if (fstat(fd, &sb) != 0)
+		{
+			close(fd);
+			throw runtime_error("Mat::from_binary() error getting the size of binary file " + filename);
+		}
+		len = sb.st_size;
+		if (len > 0)
+		{
+			map_ptr = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (map_ptr == MAP_FAILED)
+			{
+				map_ptr = nullptr;
+			}
+			else
+			{
+				madvise(map_ptr, len, MADV_SEQUENTIAL);
+				ptr = static_cast<const char*>(map_ptr);
+			}
+		}
+		close(fd);
+		if (ptr != nullptr || len == 0)
+		{
+			return;
+		}
+#endif
+		ifstream in(filename.c_str(), ifstream::binary);
+		if (!in.good())
+		{
+			throw runtime_error("Mat::from_binary() error opening binary file " + filename + " for reading");
+		}
+		in.seekg(0, ios_base::end);
+		len = size_t(in.tellg());
+		in.seekg(0, ios_base::beg);
+		buffer.resize(len);
+		in.read(buffer.data(), len);
+		if (!in)
+		{
+			throw runtime_error("Mat::from_binary() error reading binary file " + filename);
+		}
+		ptr = buffer.data();
 	}
-
-	row_names.clear();
-	col_names.clear();
-	matrix.resize(0, 0);
-
-	int n_par;
-	int n_nonzero;
-	int n_obs_and_pi;
-	int i, j;
-	unsigned int n;
-	double data;
-	char col_name[12];
-	char row_name[20];
-
-	// read header
-	in.read((char*)&n_par, sizeof(n_par));
-	in.read((char*)&n_obs_and_pi, sizeof(n_obs_and_pi));
-	
-	bool is_new_format = false;
-	if (n_par > 0)
+	~BinaryFileView()
 	{
-		is_new_format = true;
-		char col_name[200];
-		char row_name[200];
-
-
-		if (n_par > 100000000)
-			throw runtime_error("pest_utils::read_binary() failed sanity check: npar > 100 mil");
-
-		////read number nonzero elements in jacobian (observations + prior information)
-		in.read((char*)&n_nonzero, sizeof(n_nonzero));
-
-		if ((n_par == 0) || (n_obs_and_pi == 0) || (n_nonzero == 0))
+#ifdef OS_LINUX
+		if (map_ptr != nullptr)
 		{
-			throw runtime_error("pest_utils::read_binary() npar, nobs and/or nnz is zero");
+			munmap(map_ptr, len);
 		}
+#endif
+	}
+	const char *data() const { return ptr; }
+	size_t size() const { return len; }
+private:
+	const char *ptr;
+	size_t len;
+	void *map_ptr;
+	vector<char> buffer;
+	BinaryFileView(const BinaryFileView &);
+	BinaryFileView& operator=(const BinaryFileView &);
+};
+
+// run func(i_thread, i_beg, i_end) over n_items split into contiguous chunks, one per thread
+template <typename Func>
+static void parallel_chunks(size_t n_items, int n_threads, Func func)
+{
+	if (n_threads < 2)
+	{
+		func(0, size_t(0), n_items);
+		return;
+	}
+	vector<thread> threads;
+	vector<exception_ptr> exception_ptrs(n_threads);
+	for (int i_thread = 0; i_thread < n_threads; ++i_thread)
+	{
+		size_t i_beg = n_items * i_thread / n_threads;
+		size_t i_end = n_items * (i_thread + 1) / n_threads;
+		threads.push_back(thread([&func, &exception_ptrs, i_thread, i_beg, i_end]()
+		{
+			try
+			{
+				func(i_thread, i_beg, i_end);
+			}
+			catch (...)
+			{
+				exception_ptrs[i_thread] = current_exception();
+			}
+		}));
+	}
+	for (auto &t : threads)
+	{
+		t.join();
+	}
+	for (auto &eptr : exception_ptrs)
+	{
+		if (eptr)
+		{
+			rethrow_exception(eptr);
+		}
+	}
+}
 
-		cout << "reading " << n_nonzero << " elements, " << n_obs_and_pi << " rows, " << n_par << " columns" << endl;
-
-		// record current position in file
-		streampos begin_sen_pos = in.tellg();
+// build a compressed column matrix directly from the sensitivity records of a binary file.
+// decode(i_rec, i, j, data) extracts the row index, column index and value of a record.
+template <typename Decode>
+static void build_csc_from_records(size_t n_nonzero, int n_rows, int n_cols, Decode decode, Eigen::SparseMatrix<double> &matrix)
+{
+	int n_threads = max(1, int(thread::hardware_concurrency()));
+	n_threads = int(min(size_t(n_threads), n_nonzero / 100000 + 1));
 
-		//advance to parameter names section
-		in.seekg(n_nonzero*(sizeof(double) + sizeof(int) + sizeof(int)), ios_base::cur);
+	// count the entries of each column found by each thread
+	vector<vector<int> > col_pos(n_threads, vector<int>(n_cols, 0));
+	parallel_chunks(n_nonzero, n_threads, [&](int i_thread, size_t i_beg, size_t i_end)
+	{
+		vector<int> &counts = col_pos[i_thread];
+		int i, j;
+		double data;
+		for (size_t i_rec = i_beg; i_rec < i_end; ++i_rec)
+		{
+			decode(i_rec, i, j, data);
+			if ((i >= n_rows) || (i < 0) || (j >= n_cols) || (j < 0))
+			{
+				stringstream ss;
+				ss << "pest_utils::read_binary() invalid index (" << i << "," << j << ") in record " << i_rec;
+				throw runtime_error(ss.str());
+			}
+			++counts[j];
+		}
+	});
 
-		//read parameter names
-		for (int i_rec = 0; i_rec<n_par; ++i_rec)
+	// convert the counts into the position where each thread starts writing in each column
+	vector<int> outer(n_cols + 1, 0);
+	int pos = 0;
+	for (int j = 0; j < n_cols; ++j)
+	{
+		outer[j] = pos;
+		for (int i_thread = 0; i_thread < n_threads; ++i_thread)
 		{
-			in.read(col_name, 200);
-			string temp_col = string(col_name, 200);
-			pest_utils::strip_ip(temp_col);
-			pest_utils::upper_ip(temp_col);
-			col_names.push_back(temp_col);
+			int n = col_pos[i_thread][j];
+			col_pos[i_thread][j] = pos;
+			pos += n;
 		}
-		//read observation and Prior info names
-		for (int i_rec = 0; i_rec<n_obs_and_pi; ++i_rec)
+	}
+	outer[n_cols] = pos;
+
+	vector<int> inner(n_nonzero);
+	vector<double> values(n_nonzero);
+	parallel_chunks(n_nonzero, n_threads, [&](int i_thread, size_t i_beg, size_t i_end)
+	{
+		vector<int> &cur_pos = col_pos[i_thread];
+		int i, j;
+		double data;
+		for (size_t i_rec = i_beg; i_rec < i_end; ++i_rec)
 		{
-			in.read(row_name, 200);
-			string temp_row = pest_utils::strip_cp(string(row_name, 200));
-			pest_utils::upper_ip(temp_row);
-			row_names.push_back(temp_row);
+			decode(i_rec, i, j, data);
+			int k = cur_pos[j]++;
+			inner[k] = i;
+			values[k] = data;
 		}
+	});
+	vector<vector<int> >().swap(col_pos);
 
-		//return to sensitivity section of file
-		in.seekg(begin_sen_pos, ios_base::beg);
+	// files written by PEST++ are already sorted by row within each column.  Sort any columns
+	// that are not and check for duplicate entries which must be summed
+	vector<int> has_duplicates(n_threads, 0);
+	parallel_chunks(n_cols, n_threads, [&](int i_thread, size_t j_beg, size_t j_end)
+	{
+		vector<pair<int, double> > col_entries;
+		for (size_t j = j_beg; j < j_end; ++j)
+		{
+			int k_beg = outer[j];
+			int k_end = outer[j + 1];
+			if (!is_sorted(inner.begin() + k_beg, inner.begin() + k_end))
+			{
+				col_entries.clear();
+				for (int k = k_beg; k < k_end; ++k)
+				{
+					col_entries.push_back(make_pair(inner[k], values[k]));
+				}
+				stable_sort(col_entries.begin(), col_entries.end(),
+					[](const pair<int, double> &a, const pair<int, double> &b) { return a.first < b.first; });
+				for (int k = k_beg; k < k_end; ++k)
+				{
+					inner[k] = col_entries[k - k_beg].first;
+					values[k] = col_entries[k - k_beg].second;
+				}
+			}
+			if (adjacent_find(inner.begin() + k_beg, inner.begin() + k_end) != inner.begin() + k_end)
+			{
+				has_duplicates[i_thread] = 1;
+			}
+		}
+	});
 
-		// read matrix
+	matrix.resize(n_rows, n_cols);
+	matrix.setZero();
+	if (find(has_duplicates.begin(), has_duplicates.end(), 1) != has_duplicates.end())
+	{
 		std::vector<Eigen::Triplet<double> > triplet_list;
 		triplet_list.reserve(n_nonzero);
-		for (int i_rec = 0; i_rec<n_nonzero; ++i_rec)
+		for (int j = 0; j < n_cols; ++j)
 		{
-			in.read((char*)&(i), sizeof(i));
-			in.read((char*)&(j), sizeof(j));
-			in.read((char*)&(data), sizeof(data));
-
-			if ((i >= n_obs_and_pi) || (i < 0))
-				cout << "invalid 'i':" << i << " at " << n << " data:" << data << " j: " << j << endl;
-			if ((j >= n_par) || (j < 0))
-				cout << "invalid 'j':" << j << " at " << n << " data:" << data << " i: " << i << endl;
-			triplet_list.push_back(Eigen::Triplet<double>(i, j, data));
+			for (int k = outer[j]; k < outer[j + 1]; ++k)
+			{
+				triplet_list.push_back(Eigen::Triplet<double>(inner[k], j, values[k]));
+			}
 		}
-		matrix.resize(n_obs_and_pi, n_par);
-		matrix.setZero();
 		matrix.setFromTriplets(triplet_list.begin(), triplet_list.end());
-		in.close();
+	}
+	else
+	{
+		matrix.resizeNonZeros(n_nonzero);
+		copy(outer.begin(), outer.end(), matrix.outerIndexPtr());
+		copy(inner.begin(), inner.end(), matrix.innerIndexPtr());
+		copy(values.begin(), values.end(), matrix.valuePtr());
+	}
+}
+
+static void read_binary_names(const char *names_ptr, int n_names, int name_len, vector<string> &names)
+{
+	names.clear();
+	names.reserve(n_names);
+	for (int i_rec = 0; i_rec < n_names; ++i_rec)
+	{
+		string temp_name = strip_cp(string(names_ptr + size_t(i_rec) * name_len, name_len));
+		upper_ip(temp_name);
+		names.push_back(temp_name);
+	}
+}
 
+bool read_binary(const string &filename, vector<string> &row_names, vector<string> &col_names, Eigen::SparseMatrix<double> &matrix)
+{
+	BinaryFileView in(filename);
+
+	row_names.clear();
+	col_names.clear();
+	matrix.resize(0, 0);
+
+	int n_par;
+	int n_nonzero;
+	int n_obs_and_pi;
+
+	// read header
+	size_t header_size = 3 * sizeof(int);
+	if (in.size() < header_size)
+	{
+		throw runtime_error("pest_utils::read_binary() file is too short to contain a header: " + filename);
+	}
+	memcpy(&n_par, in.data(), sizeof(int));
+	memcpy(&n_obs_and_pi, in.data() + sizeof(int), sizeof(int));
+	////read number nonzero elements in jacobian (observations + prior information)
+	memcpy(&n_nonzero, in.data() + 2 * sizeof(int), sizeof(int));
+
+	bool is_new_format = (n_par > 0);
+	size_t rec_size;
+	int col_name_len;
+	int row_name_len;
+	if (is_new_format)
+	{
+		// records are (row, column, value)
+		rec_size = sizeof(int) + sizeof(int) + sizeof(double);
+		col_name_len = 200;
+		row_name_len = 200;
 	}
 	else
 	{
-		char col_name[12];
-		char row_name[20];
+		// records are (1-based column major index, value)
 		n_par = -n_par;
 		n_obs_and_pi = -n_obs_and_pi;
+		rec_size = sizeof(int) + sizeof(double);
+		col_name_len = 12;
+		row_name_len = 20;
+	}
 
-		if (n_par > 100000000)
-			throw runtime_error("pest_utils::read_binary() failed sanity check: npar > 100 mil");
+	if (n_par > 100000000)
+		throw runtime_error("pest_utils::read_binary() failed sanity check: npar > 100 mil");
 
-		////read number nonzero elements in jacobian (observations + prior information)
-		in.read((char*)&n_nonzero, sizeof(n_nonzero));
+	if ((n_par == 0) || (n_obs_and_pi == 0) || (n_nonzero == 0))
+	{
+		throw runtime_error("pest_utils::read_binary() npar, nobs and/or nnz is zero");
+	}
 
-		if ((n_par == 0) || (n_obs_and_pi == 0) || (n_nonzero == 0))
-		{
-			throw runtime_error("pest_utils::read_binary() npar, nobs and/or nnz is zero");
-		}
+	size_t sen_size = size_t(n_nonzero) * rec_size;
+	size_t expected_size = header_size + sen_size + size_t(n_par) * col_name_len + size_t(n_obs_and_pi) * row_name_len;
+	if (in.size() < expected_size)
+	{
+		stringstream ss;
+		ss << "pest_utils::read_binary() file " << filename << " is truncated: expected " << expected_size << " bytes, found " << in.size();
+		throw runtime_error(ss.str());
+	}
 
-		cout << "reading " << n_nonzero << " elements, " << n_obs_and_pi << " rows, " << n_par << " columns" << endl;
+	cout << "reading " << n_nonzero << " elements, " << n_obs_and_pi << " rows, " << n_par << " columns" << endl;
 
-		// record current position in file
-		streampos begin_sen_pos = in.tellg();
+	const char *sen_ptr = in.data() + header_size;
+	const char *names_ptr = sen_ptr + sen_size;
 
-		//advance to parameter names section
-		in.seekg(n_nonzero*(sizeof(double) + sizeof(int)), ios_base::cur);
+	//read parameter names
+	read_binary_names(names_ptr, n_par, col_name_len, col_names);
+	//read observation and Prior info names
+	read_binary_names(names_ptr + size_t(n_par) * col_name_len, n_obs_and_pi, row_name_len, row_names);
 
-		//read parameter names
-		for (int i_rec = 0; i_rec<n_par; ++i_rec)
+	// read matrix
+	if (is_new_format)
+	{
+		build_csc_from_records(n_nonzero, n_obs_and_pi, n_par, [sen_ptr, rec_size](size_t i_rec, int &i, int &j, double &data)
 		{
-			in.read(col_name, 12);
-			string temp_col = string(col_name, 12);
-			pest_utils::strip_ip(temp_col);
-			pest_utils::upper_ip(temp_col);
-			col_names.push_back(temp_col);
-		}
-		//read observation and Prior info names
-		for (int i_rec = 0; i_rec<n_obs_and_pi; ++i_rec)
+			const char *rec = sen_ptr + i_rec * rec_size;
+			memcpy(&i, rec, sizeof(int));
+			memcpy(&j, rec + sizeof(int), sizeof(int));
+			memcpy(&data, rec + 2 * sizeof(int), sizeof(double));
+		}, matrix);
+	}
+	else
+	{
+		unsigned int n_rows = n_obs_and_pi;
+		build_csc_from_records(n_nonzero, n_obs_and_pi, n_par, [sen_ptr, rec_size, n_rows](size_t i_rec, int &i, int &j, double &data)
 		{
-			in.read(row_name, 20);
-			string temp_row = pest_utils::strip_cp(string(row_name, 20));
-			pest_utils::upper_ip(temp_row);
-			row_names.push_back(temp_row);
-		}
-
-		//return to sensitivity section of file
-		in.seekg(begin_sen_pos, ios_base::beg);
+			const char *rec = sen_ptr + i_rec * rec_size;
+			unsigned int n;
+			memcpy(&n, rec, sizeof(n));
+			n = n - 1;
+			memcpy(&data, rec + sizeof(int), sizeof(double));
+			j = int(n / n_rows); // column index
+			i = int(n % n_rows);  //row index
+		}, matrix);
+	}
+	return is_new_format;
+}
 
-		// read matrix
-		std::vector<Eigen::Triplet<double> > triplet_list;
-		triplet_list.reserve(n_nonzero);
-		for (int i_rec = 0; i_rec<n_nonzero; ++i_rec)
+void write_binary(const string &filename, const vector<string> &row_names, const vector<string> &col_names, const Eigen::SparseMatrix<double> &matrix, CASE_CONV name_conv)
+{
+	ofstream jout(filename.c_str(), ios::out | ios::binary);
+	if (!jout.good())
+	{
+		throw runtime_error("pest_utils::write_binary() error opening binary file " + filename + " for writing");
+	}
+	int n_par = col_names.size();
+	int n_obs_and_pi = row_names.size();
+	int tmp;
+
+	// write header
+	tmp = -n_par;
+	jout.write((char*)&tmp, sizeof(tmp));
+	tmp = -n_obs_and_pi;
+	jout.write((char*)&tmp, sizeof(tmp));
+
+	//write number nonzero elements in jacobian (includes prior information)
+	tmp = matrix.nonZeros();
+	jout.write((char*)&tmp, sizeof(tmp));
+
+	//write matrix.  Records are packed into a fixed size buffer that is written in bulk
+	const size_t rec_size = sizeof(int) + sizeof(double);
+	const size_t max_buf_recs = 1 << 20;
+	vector<char> buf(min(size_t(matrix.nonZeros()), max_buf_recs) * rec_size);
+	size_t buf_pos = 0;
+	unsigned int n_rows = matrix.rows();
+	for (int icol = 0; icol<matrix.outerSize(); ++icol)
+	{
+		for (Eigen::SparseMatrix<double>::InnerIterator it(matrix, icol); it; ++it)
 		{
-			in.read((char*)&(n), sizeof(n));
-			n = n - 1;
-			in.read((char*)&(data), sizeof(data));
-			j = int(n / (n_obs_and_pi)); // column index
-			i = (n - n_obs_and_pi * j) % n_obs_and_pi;  //row index
-			if ((i >= n_obs_and_pi) || (i < 0))
-				cout << "invalid 'i':" << i << " at " << n << " data:" << data << " j: " << j << endl;
-			if ((j >= n_par) || (j < 0))
-				cout << "invalid 'j':" << j << " at " << n << " data:" << data << " i: " << i << endl;
-			triplet_list.push_back(Eigen::Triplet<double>(i, j, data));
+			unsigned int n = it.row() + 1 + it.col() * n_rows;
+			double data = it.value();
+			memcpy(&buf[buf_pos], &n, sizeof(n));
+			memcpy(&buf[buf_pos + sizeof(n)], &data, sizeof(data));
+			buf_pos += rec_size;
+			if (buf_pos == buf.size())
+			{
+				jout.write(buf.data(), buf_pos);
+				buf_pos = 0;
+			}
 		}
-		matrix.resize(n_obs_and_pi, n_par);
-		matrix.setZero();
-		matrix.setFromTriplets(triplet_list.begin(), triplet_list.end());
-		in.close();
 	}
-	return is_new_format;
+	if (buf_pos > 0)
+	{
+		jout.write(buf.data(), buf_pos);
+	}
+
+	//save parameter names
+	StringvecFortranCharArray par_names(col_names, 12, name_conv);
+	jout.write(par_names.get_prt(), size_t(n_par) * 12);
+
+	//save observation and Prior information names
+	StringvecFortranCharArray obs_names(row_names, 20, name_conv);
+	jout.write(obs_names.get_prt(), size_t(n_obs_and_pi) * 20);
+	if (!jout.good())
+	{
+		throw runtime_error("pest_utils::write_binary() error writing binary file " + filename);
+	}
+	jout.close();
 }
 
 bool read_binary(const string &filename, vector<string> &row_names, vector<string> &col_names, Eigen::MatrixXd &matrix)
@@ -8,6 +8,7 @@
 */
 
 #include <string>
+#include <cstdint>
 #include <stdexcept>
 #include <sstream>
 #include <vector>
@@ -133,6 +134,34 @@ namespace pest_utils
 	*/
 	string upper_cp(const string &s);
 
+	/* @brief Find the whitespace delimited fields in a line without copying them
+
+		The [begin, end) offsets of each field in line are returned in fields.  fields is
+		cleared first, so its capacity is reused when it is passed to repeated calls.
+	*/
+	void split_fields(const string &line, vector<pair<size_t, size_t> > &fields,
+		const char *delimiters = " \t\n\r");
+
+	/* @brief Convert a field found with split_fields() to a double without an intermediate string
+
+		A PestConversionError exception is thrown if the entire field is not a valid number
+	*/
+	double field_to_double(const string &line, const pair<size_t, size_t> &field);
+
+	/* @brief Convert a field found with split_fields() to an int without an intermediate string
+
+		A PestConversionError exception is thrown if the entire field is not a valid integer
+	*/
+	int field_to_int(const string &line, const pair<size_t, size_t> &field);
+
+	/* @brief Copy a field found with split_fields() to s, converted to upper case
+	*/
+	void field_to_upper(const string &line, const pair<size_t, size_t> &field, string &s);
+
+	/* @brief 64-bit FNV-1a hash of a block of bytes
+	*/
+	uint64_t fnv1a_hash(const char *data, size_t n);
+
 		/* @brief Convert all the characters in a string to upper case.
 
 		All characters in string s are converted to lower case.
@@ -290,6 +319,10 @@ private:
 
 bool read_binary(const string &filename, vector<string> &row_names, vector<string> &col_names, Eigen::SparseMatrix<double> &matrix);
 
+/** @brief Writes a sparse matrix to a binary file in the PEST jco/jcb format using bulk buffered writes
+*/
+void write_binary(const string &filename, const vector<string> &row_names, const vector<string> &col_names, const Eigen::SparseMatrix<double> &matrix, CASE_CONV name_conv = NO_CONV);
+
 bool read_binary(const string &filename, vector<string> &row_names, vector<string> &col_names, Eigen::MatrixXd &matrix);
 
 }  // end namespace pest_utils
@@ -634,59 +634,7 @@ vector<string> Mat::read_namelist(ifstream &in, int &nitems)
 
 void Mat::to_binary(const string &filename)
 {
-	ofstream jout(filename, ios::out | ios::binary);
-	int n_par = col_names.size();
-	int n_obs_and_pi = row_names.size();
-	int n;
-	int tmp;
-	double data;
-	char par_name[12];
-	char obs_name[20];
-
-	// write header
-	tmp = -n_par;
-	jout.write((char*)&tmp, sizeof(tmp));
-	tmp = -n_obs_and_pi;
-	jout.write((char*)&tmp, sizeof(tmp));
-
-	//write number nonzero elements in jacobian (includes prior information)
-	n = matrix.nonZeros();
-	jout.write((char*)&n, sizeof(n));
-
-	//write matrix
-	n = 0;
-	map<string, double>::const_iterator found_pi_par;
-	map<string, double>::const_iterator not_found_pi_par;
-
-	Eigen::SparseMatrix<double> matrix_T(matrix);
-	matrix_T.transpose();
-	for (int icol = 0; icol<matrix.outerSize(); ++icol)
-	{
-		for (Eigen::SparseMatrix<double>::InnerIterator it(matrix_T, icol); it; ++it)
-		{
-			data = it.value();
-			n = it.row() + 1 + it.col() * matrix_T.rows();
-			jout.write((char*) &(n), sizeof(n));
-			jout.write((char*) &(data), sizeof(data));
-		}
-	}
-	//save parameter names
-	for (vector<string>::const_iterator b = col_names.begin(), e = col_names.end();
-		b != e; ++b) {
-		string l = pest_utils::lower_cp(*b);
-		pest_utils::string_to_fortran_char(l, par_name, 12);
-		jout.write(par_name, 12);
-	}
-
-	//save observation and Prior information names
-	for (vector<string>::const_iterator b = row_names.begin(), e = row_names.end();
-		b != e; ++b) {
-		string l = pest_utils::lower_cp(*b);
-		pest_utils::string_to_fortran_char(l, obs_name, 20);
-		jout.write(obs_name, 20);
-	}
-	//save observation names (part 2 prior information)
-	jout.close();
+	pest_utils::write_binary(filename, row_names, col_names, matrix, pest_utils::TO_LOWER);
 }
 
 void Mat::to_binary_new(const string &filename)
@@ -783,21 +731,13 @@ Mat Mat::get(const vector<string> &new_row_names, const vector<string> &new_col_
 	//check that every row and col name is listed
 	if (new_row_names.size() == 0) throw runtime_error("Mat::get() error: new_row_names is empty");
 	if (new_col_names.size() == 0) throw runtime_error("Mat::get() error: new_col_names is empty");
-	vector<string> row_not_found;
-	
-	if (update)
-		update_sets();
-	set<string>::iterator end = row_set.end();
-	for (auto &n : new_row_names)
-		if (row_set.find(n) == end)
-			row_not_found.push_back(n);
 
+	// the slicer re-interns the row/col names itself whenever they change, so the
+	// update flag is no longer needed to keep the name lookups current
+	vector<string> row_not_found;
 	vector<string> col_not_found;
-	//set<string> col_set(col_names.begin(), col_names.end());
-	end = col_set.end();
-	for (auto &n : new_col_names)
-		if (col_set.find(n) == end)
-			col_not_found.push_back(n);
+	Eigen::SparseMatrix<double> new_matrix = slicer.slice(matrix, row_names, col_names,
+		new_row_names, new_col_names, &row_not_found, &col_not_found);
 	if (row_not_found.size() != 0)
 	{
 		cout << "Mat::get() error: the following row names were not found:" << endl;
@@ -818,61 +758,6 @@ Mat Mat::get(const vector<string> &new_row_names, const vector<string> &new_col_
 	{
 		throw runtime_error("Mat::get() error: atleast one row or col name not found in Mat::get()");
 	}
-
-
-	int nrow = new_row_names.size();
-	int ncol = new_col_names.size();
-	int irow_new;
-	int icol_new;
-
-	unordered_map<string, int> row_name2new_index_map;
-	unordered_map<string, int> col_name2new_index_map;
-
-	// Build mapping of parameter names to column number in new matrix to be returned
-	icol_new = 0;
-	for (vector<string>::const_iterator b = new_col_names.begin(), e = new_col_names.end();
-		b != e; ++b, ++icol_new) {
-		col_name2new_index_map[(*b)] = icol_new;
-	}
-
-	// Build mapping of observation names to row  number in new matrix to be returned
-	irow_new = 0;
-	for (vector<string>::const_iterator b = new_row_names.begin(), e = new_row_names.end();
-		b != e; ++b, ++irow_new) {
-		row_name2new_index_map[(*b)] = irow_new;
-	}
-
-	unordered_map<string, int>::const_iterator found_col;
-	unordered_map<string, int>::const_iterator found_row;
-	unordered_map<string, int>::const_iterator not_found_col_map = col_name2new_index_map.end();
-	unordered_map<string, int>::const_iterator not_found_row_map = row_name2new_index_map.end();
-
-	const string *row_name;
-	const string *col_name;
-	col_names;
-	row_names;
-	std::vector<Eigen::Triplet<double> > triplet_list;
-	for (int icol = 0; icol<matrix.outerSize(); ++icol)
-	{
-		for (Eigen::SparseMatrix<double>::InnerIterator it(matrix, icol); it; ++it)
-		{
-			col_name = &col_names[it.col()];
-			row_name = &row_names[it.row()];
-			found_col = col_name2new_index_map.find(*col_name);
-			found_row = row_name2new_index_map.find(*row_name);
-			if (found_col != not_found_col_map && found_row != not_found_row_map)
-			{
-				triplet_list.push_back(Eigen::Triplet<double>(found_row->second, found_col->second, it.value()));
-			}
-		}
-	}
-	//if (triplet_list.size() == 0)
-		//throw runtime_error("Mat::get() error: triplet list is empty");
-
-	Eigen::SparseMatrix<double> new_matrix(nrow, ncol);
-	new_matrix.setZero();
-	if (triplet_list.size() > 0)
-		new_matrix.setFromTriplets(triplet_list.begin(), triplet_list.end());
 	return Mat(new_row_names,new_col_names,new_matrix,this->mattype);
 }
 
@@ -9,6 +9,7 @@
 #include "Pest.h"
 #include "logger.h"
 #include "FileManager.h"
+#include "NamedSparseSlicer.h"
 
 using namespace std;
 
@@ -100,6 +101,7 @@ protected:
 	set<string> col_set;
 	int icode = 2;
 	MatType mattype;
+	NamedSparseSlicer slicer;  // cached row/col permutations used by get()
 
 	vector<string> read_namelist(ifstream &in, int &nitems);
 };
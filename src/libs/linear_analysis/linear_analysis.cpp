@@ -1,6 +1,9 @@
 #include <vector>
 #include <string>
 #include <sstream>
+#include <thread>
+#include <atomic>
+#include <exception>
 #include "Pest.h"
 #include "utilities.h"
 #include "eigen_tools.h"
@@ -1011,8 +1014,7 @@ void linear_analysis::calc_posterior()
 	try
 	{
 		log->log("form JtQJ");
-		Covariance JtQJ(*parcov.rn_ptr(), (*jacobian.transpose().e_ptr() * *obscov.e_ptr() *
-			*jacobian.e_ptr()));
+		Covariance JtQJ(*parcov.rn_ptr(), calc_weighted_normal_matrix(*jacobian.e_ptr(), *obscov.e_ptr()));
 		log->log("form JtQJ");
 
 		log->log("invert parcov");
@@ -1420,8 +1422,7 @@ void linear_analysis::build_normal()
 	log->log("build_normal - MMM");
 	try
 	{
-		normal = Mat(jacobian.get_col_names(), jacobian.get_col_names(), jacobian.e_ptr()->transpose() * *obscov.e_ptr() *
-			*jacobian.e_ptr());
+		normal = Mat(jacobian.get_col_names(), jacobian.get_col_names(), calc_weighted_normal_matrix(*jacobian.e_ptr(), *obscov.e_ptr()));
 	}
 	catch (exception &e)
 	{
@@ -1659,6 +1660,222 @@ map<string, double> linear_analysis::third_prediction(int sv)
 	}
 }
 
+void linear_analysis::build_errvar_factors(ErrVarFactors &f)
+{
+	log->log("build_errvar_factors");
+	if (V.nrow() == 0)
+	{
+		try
+		{
+			svd();
+		}
+		catch (exception &e)
+		{
+			throw_error("linear_analysis::build_errvar_factors() error in svd() :" + string(e.what()));
+		}
+	}
+	try
+	{
+		f.V = Eigen::MatrixXd(*V.e_ptr());
+		f.s = S.e_ptr()->diagonal();
+		f.null = f.V.transpose() * (*parcov.e_ptr() * f.V);
+		Eigen::MatrixXd ojv = *obscov.e_ptr() * (*jacobian.e_ptr() * f.V);
+		f.solution = ojv.transpose() * (*obscov.e_ptr() * ojv);
+		if (omitted_jacobian.ncol() > 0)
+		{
+			f.W = ojv.transpose() * *omitted_jacobian.e_ptr();
+			f.omitted = f.W * (*omitted_parcov.e_ptr() * f.W.transpose());
+		}
+	}
+	catch (exception &e)
+	{
+		throw_error("linear_analysis::build_errvar_factors() error : " + string(e.what()));
+	}
+	log->log("build_errvar_factors");
+}
+
+map<string, vector<double>> linear_analysis::errvar_curves(const ErrVarFactors &f, const Eigen::VectorXd &y,
+	const Eigen::VectorXd *omitted_y, const vector<int> &sing_vals)
+{
+	int n = f.s.size();
+	//y in the singular vector basis and scaled by the inverse singular values (the rows of y^T G)
+	Eigen::VectorXd a = f.V.transpose() * y;
+	Eigen::VectorXd c = a.cwiseQuotient(f.s);
+
+	//each curve holds the component for 0..n singular values.  the null term (I-R) only
+	//loses singular vectors as sv grows, so it is accumulated from the back
+	vector<double> null_curve(n + 1, 0.0), solution_curve(n + 1, 0.0), omitted_curve(n + 1, 0.0);
+	for (int k = n - 1; k >= 0; --k)
+	{
+		double cross = f.null.col(k).tail(n - k - 1).dot(a.tail(n - k - 1));
+		null_curve[k] = null_curve[k + 1] + a[k] * (f.null(k, k) * a[k] + 2.0 * cross);
+	}
+	for (int k = 0; k < n; ++k)
+	{
+		double cross = f.solution.col(k).head(k).dot(c.head(k));
+		solution_curve[k + 1] = solution_curve[k] + c[k] * (f.solution(k, k) * c[k] + 2.0 * cross);
+	}
+	if (f.W.cols() > 0)
+	{
+		//(y^T G Zo - omitted_y^T) omitted_parcov (...)^T expanded into its quadratic, linear and constant parts
+		double quad = 0.0, lin = 0.0, con = 0.0;
+		Eigen::VectorXd q = Eigen::VectorXd::Zero(n);
+		if (omitted_y)
+		{
+			Eigen::VectorXd co_y = *omitted_parcov.e_ptr() * *omitted_y;
+			q = f.W * co_y;
+			con = omitted_y->dot(co_y);
+		}
+		omitted_curve[0] = con;
+		for (int k = 0; k < n; ++k)
+		{
+			double cross = f.omitted.col(k).head(k).dot(c.head(k));
+			quad += c[k] * (f.omitted(k, k) * c[k] + 2.0 * cross);
+			lin += c[k] * q[k];
+			omitted_curve[k + 1] = quad - 2.0 * lin + con;
+		}
+	}
+
+	map<string, vector<double>> result;
+	vector<double> &null_vals = result["null"], &solution_vals = result["solution"], &omitted_vals = result["omitted"];
+	for (auto sv : sing_vals)
+	{
+		if (sv >= n)
+		{
+			null_vals.push_back(0.0);
+			solution_vals.push_back(1.0E+20);
+			omitted_vals.push_back(1.0E+20);
+		}
+		else
+		{
+			null_vals.push_back(null_curve[sv]);
+			solution_vals.push_back(solution_curve[sv]);
+			omitted_vals.push_back(omitted_curve[sv]);
+		}
+	}
+	return result;
+}
+
+map<string, map<string, vector<double>>> linear_analysis::prediction_error_variance_components(vector<int> sing_vals, int num_threads)
+{
+	log->log("prediction_error_variance_components");
+	for (auto sv : sing_vals)
+	{
+		if (sv < 0)
+			throw_error("linear_analysis::prediction_error_variance_components() error: negative number of singular values");
+	}
+	ErrVarFactors f;
+	build_errvar_factors(f);
+
+	//dense copies of the predictions so that the threads only read shared data
+	vector<string> pred_names;
+	vector<Eigen::VectorXd> ys, omitted_ys;
+	for (auto &p : predictions)
+	{
+		pred_names.push_back(p.first);
+		ys.push_back(Eigen::MatrixXd(*p.second.e_ptr()).col(0));
+		auto opred = omitted_predictions.find(p.first);
+		if ((f.W.cols() > 0) && (opred != omitted_predictions.end()))
+			omitted_ys.push_back(Eigen::MatrixXd(*opred->second.e_ptr()).col(0));
+		else
+			omitted_ys.push_back(Eigen::VectorXd());
+	}
+
+	vector<map<string, vector<double>>> curves(pred_names.size());
+	int n_threads = num_threads;
+	if (n_threads < 1)
+	{
+		n_threads = max(1, int(thread::hardware_concurrency()));
+	}
+	n_threads = max(1, min(n_threads, int(pred_names.size())));
+	atomic<size_t> next_pred(0);
+	vector<exception_ptr> exception_ptrs(n_threads);
+	auto work = [&](int thread_id)
+	{
+		try
+		{
+			size_t i_pred;
+			while ((i_pred = next_pred++) < pred_names.size())
+			{
+				const Eigen::VectorXd *omitted_y = (omitted_ys[i_pred].size() > 0) ? &omitted_ys[i_pred] : nullptr;
+				curves[i_pred] = errvar_curves(f, ys[i_pred], omitted_y, sing_vals);
+			}
+		}
+		catch (...)
+		{
+			exception_ptrs[thread_id] = current_exception();
+		}
+	};
+	if (n_threads < 2)
+	{
+		work(0);
+	}
+	else
+	{
+		vector<thread> threads;
+		for (int i = 0; i < n_threads; ++i)
+		{
+			threads.push_back(thread(work, i));
+		}
+		for (auto &t : threads)
+		{
+			t.join();
+		}
+	}
+	for (auto &eptr : exception_ptrs)
+	{
+		if (eptr)
+		{
+			try
+			{
+				rethrow_exception(eptr);
+			}
+			catch (exception &e)
+			{
+				throw_error("linear_analysis::prediction_error_variance_components() error : " + string(e.what()));
+			}
+		}
+	}
+
+	map<string, map<string, vector<double>>> result;
+	for (size_t i = 0; i < pred_names.size(); ++i)
+		result[pred_names[i]] = curves[i];
+	log->log("prediction_error_variance_components");
+	return result;
+}
+
+map<string, vector<double>> linear_analysis::prediction_error_variance_components(vector<int> sing_vals, string &pred_name)
+{
+	string pname = pest_utils::upper_cp(pred_name);
+	if (predictions.find(pname) == predictions.end())
+		throw_error("linear_analysis::prediction_error_variance_components() error: prediction " + pname + " not found");
+	map<string, map<string, vector<double>>> result = prediction_error_variance_components(sing_vals, 1);
+	return result[pname];
+}
+
+map<string, vector<double>> linear_analysis::parameter_error_variance_components(vector<int> sing_vals, string &par_name)
+{
+	log->log("parameter_error_variance_components");
+	for (auto sv : sing_vals)
+	{
+		if (sv < 0)
+			throw_error("linear_analysis::parameter_error_variance_components() error: negative number of singular values");
+	}
+	ErrVarFactors f;
+	build_errvar_factors(f);
+	string pname = pest_utils::upper_cp(par_name);
+	const vector<string> *par_names = jacobian.cn_ptr();
+	auto it = find(par_names->begin(), par_names->end(), pname);
+	if (it == par_names->end())
+		throw_error("linear_analysis::parameter_error_variance_components() error: parameter " + pname + " not found");
+	//a parameter is a prediction with unit sensitivity to itself and none to the omitted parameters
+	Eigen::VectorXd y = Eigen::VectorXd::Zero(par_names->size());
+	y[it - par_names->begin()] = 1.0;
+	map<string, vector<double>> result = errvar_curves(f, y, nullptr, sing_vals);
+	log->log("parameter_error_variance_components");
+	return result;
+}
+
 void linear_analysis::extract_omitted(vector<string> &omitted_par_names)
 {
 	log->log("extract_omitted");
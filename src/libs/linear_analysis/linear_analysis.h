@@ -84,6 +84,9 @@ public:
 	map<string, vector<double>> parameter_error_variance_components(vector<int> sing_vals, string &par_name);
 	//<err_var_component("null","solution","omitted"),error_variance> for a set of singular values and a prediction
 	map<string, vector<double>> prediction_error_variance_components(vector<int> sing_vals, string &pred_name);
+	//<pred_name,<err_var_component,error_variance>> for a set of singular values and all predictions from a single svd.
+	//predictions are evaluated on num_threads threads (0 = one per core)
+	map<string, map<string, vector<double>>> prediction_error_variance_components(vector<int> sing_vals, int num_threads = 0);
 
 	//extract elements from the jacobian, parcov, and predictions and set them as omitted
 	void extract_omitted(vector<string> &omitted_par_names);
@@ -174,6 +177,23 @@ private:
 	void build_ImR(int sv);
 	void build_V1(int sv);
 
+	//dense factors shared by the error variance curves, all in the right singular vector basis
+	struct ErrVarFactors
+	{
+		Eigen::VectorXd s;
+		Eigen::MatrixXd V;
+		//V^T parcov V
+		Eigen::MatrixXd null;
+		//(obscov J V)^T obscov (obscov J V), the solution term of G obscov G^T
+		Eigen::MatrixXd solution;
+		//(obscov J V)^T omitted_jacobian and W omitted_parcov W^T
+		Eigen::MatrixXd W, omitted;
+	};
+	void build_errvar_factors(ErrVarFactors &f);
+	//error variance components of y for each entry in sing_vals, accumulated one singular value at a time.
+	//omitted_y is the sensitivity of y to the omitted parameters (nullptr if none)
+	map<string, vector<double>> errvar_curves(const ErrVarFactors &f, const Eigen::VectorXd &y,
+		const Eigen::VectorXd *omitted_y, const vector<int> &sing_vals);
 
 	Covariance condition_on(vector<string> &keep_par_names,vector<string> &cond_par_names);
 
@@ -13,11 +13,13 @@
 #include "ClpPresolve.hpp"
 #include <iomanip>
 #include "utilities.h"
+#include <chrono>
 
 sequentialLP::sequentialLP(Pest &_pest_scenario, RunManagerAbstract* _run_mgr_ptr,
 	Covariance &_parcov, FileManager* _file_mgr, OutputFileWriter _of_wr) : pest_scenario(_pest_scenario), run_mgr_ptr(_run_mgr_ptr),
 	parcov(_parcov), file_mgr_ptr(_file_mgr),jco(*_file_mgr,_of_wr), of_wr(_of_wr)
 {
+	jco.set_num_threads(pest_scenario.get_pestpp_options().get_jac_num_threads());
 	try
 	{
 		initialize_and_check();
@@ -126,6 +128,21 @@ void sequentialLP::initial_report()
 	string hotstart = pest_scenario.get_pestpp_options().get_hotstart_resfile();
 	if (!hotstart.empty())
 		f_rec << "-->hot start with residual file: " << hotstart << endl;
+	if (!pest_scenario.get_pestpp_options().get_opt_lp_warm_start())
+		f_rec << "-->warm start of the linear program from the previous iteration disabled (++opt_lp_warm_start)" << endl;
+	if ((sweep_risks.size() > 0) || (sweep_obj_coefs.size() > 0))
+	{
+		f_rec << "-->in-process LP sweep active, noptmax and the final model run are not used" << endl;
+		if (sweep_risks.size() > 0)
+		{
+			f_rec << "-->sweep risk values (++opt_risk_sweep): ";
+			for (auto &r : sweep_risks)
+				f_rec << r << " ";
+			f_rec << endl;
+		}
+		if (sweep_obj_coefs.size() > 0)
+			f_rec << "-->sweep objective function coefficient rows (++opt_obj_sweep_file): " << sweep_obj_coefs.size() << endl;
+	}
 	bool sf = pest_scenario.get_pestpp_options().get_opt_skip_final();
 	super_secret_option = false;
 	if (sf)
@@ -583,6 +600,11 @@ void sequentialLP::initialize_and_check()
 	model.passInMessageHandler(&coin_hr);
 
 	terminate = false;
+	lp_warm_start = pest_scenario.get_pestpp_options().get_opt_lp_warm_start();
+	lp_loaded = false;
+	cold_lp_pivots = -1;
+	cold_lp_secs = 0.0;
+	reuse_fosm = false;
 
 	iter_derinc_fac = pest_scenario.get_pestpp_options().get_opt_iter_derinc_fac();
 	if ((iter_derinc_fac > 1.0) || (iter_derinc_fac <= 0.0))
@@ -885,7 +907,20 @@ void sequentialLP::initialize_and_check()
 	//  ---  chance constratints and fosm  ---
 	//------------------------------------------
 	risk = pest_scenario.get_pestpp_options().get_opt_risk();
-	if (risk != 0.5)
+	sweep_risks = pest_scenario.get_pestpp_options().get_opt_risk_sweep();
+	for (auto &r : sweep_risks)
+	{
+		if ((r > 1.0) || (r < 0.0))
+			throw_sequentialLP_error("++opt_risk_sweep values must between 0.0 and 1.0");
+		if ((r > 0.999) || (r < 0.001))
+		{
+			double practical = (r > 0.999) ? 0.999 : 0.001;
+			f_rec << endl << "  ---  note: resetting sweep risk value of " << r << " to a practical value of " << practical << endl << endl;
+			r = practical;
+		}
+	}
+	//a risk sweep needs the FOSM components even if the base risk is neutral
+	if ((risk != 0.5) || (sweep_risks.size() > 0))
 	{
 		use_chance = true;
 		std_weights = pest_scenario.get_pestpp_options().get_opt_std_weights();
@@ -1070,6 +1105,10 @@ void sequentialLP::initialize_and_check()
 
 	}
 
+	string obj_sweep_file = pest_scenario.get_pestpp_options().get_opt_obj_sweep_file();
+	if (obj_sweep_file.size() > 0)
+		read_obj_sweep_file(obj_sweep_file);
+
 
 	jco.set_base_numeric_pars(all_pars_and_dec_vars);
 	jco.set_base_sim_obs(pest_scenario.get_ctl_observations());
@@ -1089,13 +1128,16 @@ void sequentialLP::calc_chance_constraint_offsets()
 		cout << endl << "  ---  reusing fosm offsets from previous iteration  ---  " << endl;
 		return;
 	}*/
-	cout << "  ---  calculating FOSM-based chance constraint components  ---  " << endl;
-	f_rec << "  ---  calculating FOSM-based chance constraint components  ---  " << endl;
+	if (!reuse_fosm)
+	{
+		cout << "  ---  calculating FOSM-based chance constraint components  ---  " << endl;
+		f_rec << "  ---  calculating FOSM-based chance constraint components  ---  " << endl;
+	}
 	prior_constraint_offset.clear();
 	prior_constraint_stdev.clear();
 	post_constraint_offset.clear();
 	post_constraint_stdev.clear();
-	if ((!std_weights) && ((slp_iter == 1) || ((slp_iter + 1) % pest_scenario.get_pestpp_options().get_opt_recalc_fosm_every() == 0)))
+	if ((!std_weights) && (!reuse_fosm) && ((slp_iter == 1) || ((slp_iter + 1) % pest_scenario.get_pestpp_options().get_opt_recalc_fosm_every() == 0)))
 	{
 		//the rows of the fosm jacobian include nonzero weight obs (for schur comp)
 		//plus the names of the names of constraints, which get treated as forecasts
@@ -1197,8 +1239,11 @@ void sequentialLP::calc_chance_constraint_offsets()
 
 	vector<string> names = iter_fosm.get_keys();
 	constraints_fosm.update_without_clear(names, iter_fosm.get_data_vec(names));
-	cout << "  ---   done with FOSM-based chance constraint calculations  ---  " << endl << endl;
-	f_rec << "  ---   done with FOSM-based chance constraint calculations  ---  " << endl << endl;
+	if (!reuse_fosm)
+	{
+		cout << "  ---   done with FOSM-based chance constraint calculations  ---  " << endl << endl;
+		f_rec << "  ---   done with FOSM-based chance constraint calculations  ---  " << endl << endl;
+	}
 	return;
 }
 
@@ -1319,20 +1364,27 @@ void sequentialLP::iter_solve()
 
 	ofstream &f_rec = file_mgr_ptr->rec_ofstream();
 
-	//convert Jacobian_1to1 to CoinPackedMatrix
+	//convert Jacobian_1to1 to column ordered arrays
 	cout << "  ---  forming LP model  --- " << endl;
-	CoinPackedMatrix matrix = jacobian_to_coinpackedmatrix();
+	vector<CoinBigIndex> col_starts;
+	vector<int> row_idx;
+	vector<double> elems;
+	jacobian_to_column_arrays(col_starts, row_idx, elems);
 
 	build_dec_var_bounds();
 
-	//load the linear simplex model
-	model.loadProblem(matrix, dec_var_lb, dec_var_ub, ctl_ord_obj_func_coefs, constraint_lb, constraint_ub);
-	for (int i = 0; i < num_obs_constraints(); ++i)
-		model.setRowName(i, ctl_ord_obs_constraint_names[i]);
-	for (int i = 0; i < ctl_ord_pi_constraint_names.size(); ++i)
-		model.setRowName(i+num_obs_constraints(), ctl_ord_pi_constraint_names[i]);
-	for (int i = 0; i < num_dec_vars(); ++i)
-		model.setColumnName(i, ctl_ord_dec_var_names[i]);
+	//update the linear simplex model of the previous iteration in place or load a new one
+	bool warm_start = false;
+	int num_changed = 0;
+	if ((lp_warm_start) && (lp_loaded) && (update_lp_problem(col_starts, row_idx, elems, num_changed)))
+	{
+		warm_start = true;
+		f_rec << "  ---  updated " << num_changed << " of " << elems.size() << " LP matrix coefficients in place  ---  " << endl;
+	}
+	else
+	{
+		warm_start = load_lp_problem(col_starts, row_idx, elems);
+	}
 
 	model.setOptimizationDirection(pest_scenario.get_pestpp_options().get_opt_direction());
 	//if maximum ++opt_coin_loglev, then also write iteration specific mps files
@@ -1347,40 +1399,29 @@ void sequentialLP::iter_solve()
 	cout << "  ---  solving linear program for iteration " << slp_iter << "  ---  " << endl;
 
 	//solve the linear program
-	ClpPresolve presolve_info;
-	ClpSimplex* presolved_model = presolve_info.presolvedModel(model);
-
-	//if presolvedModel is Null, then it is primal infeasible, so
-	//try the dual
-	if (!presolved_model)
+	chrono::system_clock::time_point solve_start = chrono::system_clock::now();
+	int pivots = 0;
+	bool solved = solve_lp_model(warm_start, pivots);
+	double solve_secs = pest_utils::get_duration_sec(solve_start);
+	stringstream ss;
+	ss << "  ---  " << (solved ? "warm" : "cold") << " started linear program solved with " << pivots << " simplex pivots in "
+		<< solve_secs << " sec";
+	if ((solved) && (cold_lp_pivots >= 0))
 	{
-		f_rec << "  ---  primal presolve model infeasible, crashing solution with additional dual and primal solves..." << endl;
-		cout << "  ---  primal presolve model infeasible, crashing solution..." << endl;
-
-		model.moveTowardsPrimalFeasible();
-		model.dual(1);
-		model.checkSolution();
-		model.primal(1);
+		ss << endl << "  ---  saved " << cold_lp_pivots - pivots << " pivots and " << cold_lp_secs - solve_secs
+			<< " sec compared to the last cold solve";
 	}
-
-	//update the status arrays of both the presolve and original models
-	presolve_info.postsolve(true);
-
-	//this seems to help with some test problems
-	model.dual(1);
-	//int all_slack_basis = model.crash(0.001,0);
-
-	//model.primal();
-	model.checkSolution();
-	if (!model.primalFeasible())
+	else if ((!solved) && (!warm_start))
 	{
-		model.dual(1);
-		model.checkSolution();
-		model.primal(1);
+		cold_lp_pivots = pivots;
+		cold_lp_secs = solve_secs;
 	}
+	f_rec << ss.str() << endl;
+	cout << ss.str() << endl;
 
-	//check the solution
-	model.checkSolution();
+	//check the solution, a warm solve was already checked
+	if (!solved)
+		model.checkSolution();
 	if (model.isProvenOptimal())
 	{
 		f_rec << " iteration " << slp_iter << " linear solution is proven optimal" << endl << endl;
@@ -1407,6 +1448,166 @@ void sequentialLP::iter_solve()
 	return;
 }
 
+bool sequentialLP::solve_lp_model(bool warm_start, int &pivots)
+{
+	ofstream &f_rec = file_mgr_ptr->rec_ofstream();
+	bool solved = false;
+	if (warm_start)
+	{
+		//dual simplex from the basis of the previous iteration, cleaned up with the primal
+		//if the changed objective left it dual infeasible.  The solution is checked against the
+		//unscaled model, the same as the cold solve below
+		model.dual(0);
+		pivots += model.numberIterations();
+		if (!model.isProvenOptimal())
+		{
+			model.primal(0);
+			pivots += model.numberIterations();
+		}
+		//checkSolution() does not recompute the reduced costs, so for a maximization it flags the
+		//optimal ones as dual infeasible.  Only its primal part is used to accept the warm solve
+		bool simplex_optimal = model.isProvenOptimal();
+		model.checkSolution();
+		if ((simplex_optimal) && (model.numberPrimalInfeasibilities() == 0))
+			model.setProblemStatus(0);
+		if (model.isProvenOptimal())
+			solved = true;
+		else
+		{
+			f_rec << "  ---  warm started linear program not optimal, reverting to a cold solve  ---  " << endl;
+			cout << "  ---  warm started linear program not optimal, reverting to a cold solve  ---  " << endl;
+			model.allSlackBasis(true);
+		}
+	}
+	if (!solved)
+	{
+		ClpPresolve presolve_info;
+		ClpSimplex* presolved_model = presolve_info.presolvedModel(model);
+
+		//if presolvedModel is Null, then it is primal infeasible, so
+		//try the dual
+		if (!presolved_model)
+		{
+			f_rec << "  ---  primal presolve model infeasible, crashing solution with additional dual and primal solves..." << endl;
+			cout << "  ---  primal presolve model infeasible, crashing solution..." << endl;
+
+			model.moveTowardsPrimalFeasible();
+			model.dual(1);
+			pivots += model.numberIterations();
+			model.checkSolution();
+			model.primal(1);
+			pivots += model.numberIterations();
+		}
+
+		//update the status arrays of both the presolve and original models
+		presolve_info.postsolve(true);
+
+		//this seems to help with some test problems
+		model.dual(1);
+		pivots += model.numberIterations();
+		//int all_slack_basis = model.crash(0.001,0);
+
+		//model.primal();
+		model.checkSolution();
+		if (!model.primalFeasible())
+		{
+			model.dual(1);
+			pivots += model.numberIterations();
+			model.checkSolution();
+			model.primal(1);
+			pivots += model.numberIterations();
+		}
+	}
+	return solved;
+}
+
+bool sequentialLP::load_lp_problem(const vector<CoinBigIndex> &col_starts, const vector<int> &row_idx, const vector<double> &elems)
+{
+	//save the basis of the previous iteration if the problem has the same shape
+	vector<unsigned char> prev_status;
+	if ((lp_warm_start) && (lp_loaded) && (model.statusExists()) && (model.numberRows() == num_constraints()) &&
+		(model.numberColumns() == num_dec_vars()))
+	{
+		prev_status.assign(model.statusArray(), model.statusArray() + num_constraints() + num_dec_vars());
+	}
+
+	vector<int> col_lengths(num_dec_vars());
+	for (int i = 0; i < num_dec_vars(); ++i)
+		col_lengths[i] = col_starts[i + 1] - col_starts[i];
+	CoinPackedMatrix matrix(true, num_constraints(), num_dec_vars(), elems.size(), elems.data(), row_idx.data(),
+		col_starts.data(), col_lengths.data());
+
+	//load the linear simplex model
+	model.loadProblem(matrix, dec_var_lb, dec_var_ub, ctl_ord_obj_func_coefs, constraint_lb, constraint_ub);
+	for (int i = 0; i < num_obs_constraints(); ++i)
+		model.setRowName(i, ctl_ord_obs_constraint_names[i]);
+	for (int i = 0; i < ctl_ord_pi_constraint_names.size(); ++i)
+		model.setRowName(i+num_obs_constraints(), ctl_ord_pi_constraint_names[i]);
+	for (int i = 0; i < num_dec_vars(); ++i)
+		model.setColumnName(i, ctl_ord_dec_var_names[i]);
+	lp_loaded = true;
+	if (prev_status.size() > 0)
+	{
+		model.copyinStatus(prev_status.data());
+		return true;
+	}
+	return false;
+}
+
+bool sequentialLP::update_lp_problem(const vector<CoinBigIndex> &col_starts, const vector<int> &row_idx, const vector<double> &elems,
+	int &num_changed)
+{
+	num_changed = 0;
+	if ((model.numberRows() != num_constraints()) || (model.numberColumns() != num_dec_vars()) || (!model.statusExists()))
+		return false;
+	//clp may have dropped tiny or duplicate elements when it last solved, so the locations are
+	//matched against its own copy of the matrix each time
+	CoinPackedMatrix *lp_matrix = model.matrix();
+	if ((!lp_matrix->isColOrdered()) || (lp_matrix->getNumElements() != CoinBigIndex(elems.size())))
+		return false;
+	const CoinBigIndex *lp_starts = lp_matrix->getVectorStarts();
+	const int *lp_lengths = lp_matrix->getVectorLengths();
+	const int *lp_rows = lp_matrix->getIndices();
+	double *lp_elems = lp_matrix->getMutableElements();
+	vector<CoinBigIndex> row_loc(num_constraints(), -1);
+	for (int j = 0; j < num_dec_vars(); ++j)
+	{
+		if (lp_lengths[j] != col_starts[j + 1] - col_starts[j])
+			return false;
+		for (CoinBigIndex k = lp_starts[j]; k < lp_starts[j] + lp_lengths[j]; ++k)
+			row_loc[lp_rows[k]] = k;
+		for (CoinBigIndex k = col_starts[j]; k < col_starts[j + 1]; ++k)
+		{
+			//a new zero also changes the pattern
+			if ((row_loc[row_idx[k]] < 0) || (elems[k] == 0.0))
+				return false;
+		}
+		for (CoinBigIndex k = col_starts[j]; k < col_starts[j + 1]; ++k)
+		{
+			CoinBigIndex loc = row_loc[row_idx[k]];
+			if (lp_elems[loc] != elems[k])
+			{
+				lp_elems[loc] = elems[k];
+				num_changed++;
+			}
+		}
+		for (CoinBigIndex k = lp_starts[j]; k < lp_starts[j] + lp_lengths[j]; ++k)
+			row_loc[lp_rows[k]] = -1;
+	}
+	//the scaled and row ordered copies of the matrix are stale now
+	model.setClpScaledMatrix(NULL);
+	model.setNewRowCopy(NULL);
+	model.setRowScale(NULL);
+	model.setColumnScale(NULL);
+	model.chgColumnLower(dec_var_lb);
+	model.chgColumnUpper(dec_var_ub);
+	model.chgRowLower(constraint_lb);
+	model.chgRowUpper(constraint_ub);
+	model.chgObjCoefficients(ctl_ord_obj_func_coefs);
+	model.setWhatsChanged(0);
+	return true;
+}
+
 int sequentialLP::num_nz_pi_constraint_elements()
 {
 	int num = 0;
@@ -1418,7 +1619,7 @@ int sequentialLP::num_nz_pi_constraint_elements()
 	return num;
 }
 
-CoinPackedMatrix sequentialLP::jacobian_to_coinpackedmatrix()
+void sequentialLP::jacobian_to_column_arrays(vector<CoinBigIndex> &col_starts, vector<int> &row_idx, vector<double> &elems)
 {
 
 	Eigen::SparseMatrix<double> eig_ord_jco = jco.get_matrix(ctl_ord_obs_constraint_names, ctl_ord_dec_var_names);
@@ -1431,14 +1632,30 @@ CoinPackedMatrix sequentialLP::jacobian_to_coinpackedmatrix()
 
 	//cout << eig_ord_jco << endl;
 
-	//the triplet elements to pass to the coinpackedmatrix constructor
-	int num_elems = eig_ord_jco.nonZeros() + num_nz_pi_constraint_elements();
-	int * row_idx = new int[num_elems];
-	int * col_idx = new int[num_elems];
-	double * elems = new double[num_elems];
-	int elem_count = 0;
+	//prior information constraint elements by decision variable
+	vector<vector<pair<int, double>>> pi_col_elems(num_dec_vars());
+	int irow = num_obs_constraints();
+	vector<string>::iterator start = ctl_ord_dec_var_names.begin();
+	vector<string>::iterator end = ctl_ord_dec_var_names.end();
+	for (auto &pi_name : ctl_ord_pi_constraint_names)
+	{
+		for (auto &pi_factor : constraints_pi.get_pi_rec_ptr(pi_name).get_atom_factors())
+		{
+			vector<string>::iterator it = find(start, end, pi_factor.first);
+			if (it == end)
+				throw_sequentialLP_error("prior information constraint " + pi_name + " references " + pi_factor.first + ", which is not a decision variable");
+			pi_col_elems[it - start].push_back(pair<int, double>(irow, pi_factor.second));
+		}
+		irow++;
+	}
 
-	//iterate through the eigen sparse matrix
+	//walk the columns of the eigen sparse matrix, appending the prior information elements to each
+	col_starts.clear();
+	row_idx.clear();
+	elems.clear();
+	row_idx.reserve(eig_ord_jco.nonZeros() + num_nz_pi_constraint_elements());
+	elems.reserve(eig_ord_jco.nonZeros() + num_nz_pi_constraint_elements());
+	col_starts.push_back(0);
 	int elems_par;
 	int npar_zelems = 0;
 	for (int i = 0; i < eig_ord_jco.outerSize(); ++i)
@@ -1446,64 +1663,41 @@ CoinPackedMatrix sequentialLP::jacobian_to_coinpackedmatrix()
 		elems_par = 0;
 		for (Eigen::SparseMatrix<double>::InnerIterator it(eig_ord_jco, i); it; ++it)
 		{
-			row_idx[elem_count] = it.row();
-			col_idx[elem_count] = it.col();
-			elems[elem_count] = it.value();
+			row_idx.push_back(it.row());
+			elems.push_back(it.value());
 			elems_par++;
-			elem_count++;
 		}
 		if (elems_par == 0)
 		{
 			//cout << "all zero elements for decision variable: " << ctl_ord_dec_var_names[i] << endl;
 			npar_zelems++;
 		}
+		for (auto &pi_elem : pi_col_elems[i])
+		{
+			row_idx.push_back(pi_elem.first);
+			elems.push_back(pi_elem.second);
+		}
+		col_starts.push_back(row_idx.size());
 	}
 	cout << "number of decision variables with all zero elements: " << npar_zelems << endl;
-	if (elem_count != eig_ord_jco.nonZeros())
-	{
-		throw_sequentialLP_error("sequentialLP::jacobian_to_coinpackedmatrix() error: wrong number of triplet components");
-	}
-
-	if (elem_count == 0)
+	if (elems.size() == num_nz_pi_constraint_elements())
 	{
-		throw_sequentialLP_error("sequentialLP::jacobian_to_coinpackedmatrix() error: zero triplets found");
+		throw_sequentialLP_error("sequentialLP::jacobian_to_column_arrays() error: zero triplets found");
 	}
-
-	//prior information constraints
-	int irow = num_obs_constraints();
-	int jcol;
-	vector<string>::iterator start = ctl_ord_dec_var_names.begin();
-	vector<string>::iterator end = ctl_ord_dec_var_names.end();
-
-	for (auto &pi_name : ctl_ord_pi_constraint_names)
-	{
-		for (auto &pi_factor : constraints_pi.get_pi_rec_ptr(pi_name).get_atom_factors())
-		{
-			jcol = find(start, end, pi_factor.first) - start;
-			row_idx[elem_count] = irow;
-			col_idx[elem_count] = jcol;
-			elems[elem_count] = pi_factor.second;
-			elem_count++;
-		}
-		irow++;
-	}
-	if (elem_count != num_elems)
-		throw_sequentialLP_error("problem packing prior information constraints into CoinPackedMatrix...");
-
-	CoinPackedMatrix matrix(true,row_idx,col_idx,elems,elem_count);
-
-	//this is useful for debugging
-//#ifdef _DEBUG
-//	cout << eig_ord_jco << endl << endl;
-//	matrix.dumpMatrix();
-//#endif
-	return matrix;
+	if (elems.size() != eig_ord_jco.nonZeros() + num_nz_pi_constraint_elements())
+		throw_sequentialLP_error("problem packing prior information constraints into the LP matrix...");
 }
 
 void sequentialLP::solve()
 {
 	ofstream &f_rec = file_mgr_ptr->rec_ofstream();
 
+	if ((sweep_risks.size() > 0) || (sweep_obj_coefs.size() > 0))
+	{
+		sweep_solve();
+		return;
+	}
+
 	slp_iter = 1;
 	while (true)
 	{
@@ -1553,6 +1747,163 @@ void sequentialLP::solve()
 	}
 }
 
+void sequentialLP::read_obj_sweep_file(const string &filename)
+{
+	ifstream f_in(filename);
+	if (!f_in.good())
+		throw_sequentialLP_error("unable to open ++opt_obj_sweep_file: " + filename);
+	string line;
+	vector<string> tokens;
+	//header: a label column followed by decision variable names
+	if (!getline(f_in, line))
+		throw_sequentialLP_error("++opt_obj_sweep_file is empty: " + filename);
+	pest_utils::tokenize(pest_utils::strip_cp(line), tokens, ",");
+	vector<string> names;
+	for (size_t i = 1; i < tokens.size(); ++i)
+		names.push_back(pest_utils::upper_cp(pest_utils::strip_cp(tokens[i])));
+	set<string> dec_set(ctl_ord_dec_var_names.begin(), ctl_ord_dec_var_names.end());
+	vector<string> missing;
+	for (auto &name : names)
+		if (dec_set.find(name) == dec_set.end())
+			missing.push_back(name);
+	if (missing.size() > 0)
+		throw_sequentialLP_error("the following ++opt_obj_sweep_file columns are not decision variables: ", missing);
+
+	sweep_obj_labels.clear();
+	sweep_obj_coefs.clear();
+	int lnum = 1;
+	while (getline(f_in, line))
+	{
+		lnum++;
+		pest_utils::strip_ip(line);
+		if (line.size() == 0)
+			continue;
+		tokens.clear();
+		pest_utils::tokenize(line, tokens, ",", false);
+		if (tokens.size() != names.size() + 1)
+		{
+			stringstream ss;
+			ss << "wrong number of entries on line " << lnum << " of ++opt_obj_sweep_file " << filename;
+			throw_sequentialLP_error(ss.str());
+		}
+		map<string, double> coefs;
+		for (size_t i = 0; i < names.size(); ++i)
+			coefs[names[i]] = pest_utils::convert_cp<double>(pest_utils::strip_cp(tokens[i + 1]));
+		sweep_obj_labels.push_back(pest_utils::strip_cp(tokens[0]));
+		sweep_obj_coefs.push_back(coefs);
+	}
+	if (sweep_obj_coefs.size() == 0)
+		throw_sequentialLP_error("no coefficient rows found in ++opt_obj_sweep_file " + filename);
+}
+
+void sequentialLP::sweep_solve()
+{
+	ofstream &f_rec = file_mgr_ptr->rec_ofstream();
+
+	slp_iter = 1;
+	f_rec << endl << endl << "  ---------------------------------" << endl;
+	f_rec << "  ---  starting LP sweep  ---  " << endl;
+	f_rec << "  ---------------------------------" << endl << endl << endl;
+	cout << endl << endl << "  ---------------------------------" << endl;
+	cout << "  ---  starting LP sweep  ---  " << endl;
+	cout << "  ---------------------------------" << endl << endl << endl;
+
+	//one response matrix and one FOSM posterior for every point of the sweep
+	iter_presolve();
+	reuse_fosm = true;
+
+	vector<double> risks = sweep_risks;
+	if (risks.size() == 0)
+		risks.push_back(risk);
+	vector<string> obj_labels = sweep_obj_labels;
+	vector<map<string, double>> obj_rows = sweep_obj_coefs;
+	if (obj_rows.size() == 0)
+	{
+		obj_labels.push_back("base");
+		obj_rows.push_back(map<string, double>());
+	}
+
+	cout << "  ---  forming LP model  --- " << endl;
+	vector<CoinBigIndex> col_starts;
+	vector<int> row_idx;
+	vector<double> elems;
+	jacobian_to_column_arrays(col_starts, row_idx, elems);
+	build_dec_var_bounds();
+	load_lp_problem(col_starts, row_idx, elems);
+	model.setOptimizationDirection(pest_scenario.get_pestpp_options().get_opt_direction());
+	vector<double> base_coefs(ctl_ord_obj_func_coefs, ctl_ord_obj_func_coefs + num_dec_vars());
+
+	ofstream &f_sweep = file_mgr_ptr->open_ofile_ext("sweep.csv");
+	f_sweep << "point,obj_coefs,risk,status,obj_func,pivots";
+	for (auto &name : ctl_ord_dec_var_names)
+		f_sweep << "," << pest_utils::lower_cp(name);
+	for (auto &name : ctl_ord_obs_constraint_names)
+		f_sweep << "," << pest_utils::lower_cp(name);
+	f_sweep << endl;
+	f_rec << endl << "  ---  LP sweep results (predicted constraint values are linear)  ---  " << endl;
+	f_rec << setw(10) << "point" << setw(20) << "obj coefs" << setw(10) << "risk" << setw(15) << "status"
+		<< setw(15) << "obj func" << setw(10) << "pivots" << endl;
+
+	int ipoint = 0;
+	int total_pivots = 0;
+	chrono::system_clock::time_point sweep_start = chrono::system_clock::now();
+	for (size_t iobj = 0; iobj < obj_rows.size(); ++iobj)
+	{
+		for (size_t i = 0; i < num_dec_vars(); ++i)
+		{
+			map<string, double>::iterator it = obj_rows[iobj].find(ctl_ord_dec_var_names[i]);
+			ctl_ord_obj_func_coefs[i] = (it == obj_rows[iobj].end()) ? base_coefs[i] : it->second;
+		}
+		for (auto r : risks)
+		{
+			//only the constraint bounds and the objective change between points
+			risk = r;
+			if (use_chance)
+				probit_val = get_probit();
+			build_constraint_bound_arrays();
+			model.chgRowLower(constraint_lb);
+			model.chgRowUpper(constraint_ub);
+			model.chgObjCoefficients(ctl_ord_obj_func_coefs);
+
+			int pivots = 0;
+			if (!solve_lp_model((lp_warm_start) && (ipoint > 0) && (model.statusExists()), pivots))
+				model.checkSolution();
+			total_pivots += pivots;
+			string status = "optimal";
+			if (!model.isProvenOptimal())
+				status = (model.primalFeasible()) ? "not_optimal" : "infeasible";
+
+			const double *dec_var_vals = model.getColSolution();
+			const double *row_act = model.getRowActivity();
+			double obj_val = 0.0;
+			vector<double> vals(num_dec_vars());
+			for (int i = 0; i < num_dec_vars(); ++i)
+			{
+				vals[i] = all_pars_and_dec_vars[ctl_ord_dec_var_names[i]] + dec_var_vals[i];
+				obj_val += ctl_ord_obj_func_coefs[i] * vals[i];
+			}
+			f_sweep << ipoint << "," << obj_labels[iobj] << "," << risk << "," << status << "," << obj_val << "," << pivots;
+			for (auto &val : vals)
+				f_sweep << "," << val;
+			for (int i = 0; i < num_obs_constraints(); ++i)
+				f_sweep << "," << constraints_sim[ctl_ord_obs_constraint_names[i]] + row_act[i];
+			f_sweep << endl;
+			f_rec << setw(10) << ipoint << setw(20) << obj_labels[iobj] << setw(10) << risk << setw(15) << status
+				<< setw(15) << obj_val << setw(10) << pivots << endl;
+			cout << "  ---  sweep point " << ipoint << " (" << obj_labels[iobj] << ", risk " << risk << "): " << status
+				<< ", objective function " << obj_val << endl;
+			ipoint++;
+		}
+	}
+	file_mgr_ptr->close_file("sweep.csv");
+	double sweep_secs = pest_utils::get_duration_sec(sweep_start);
+	stringstream ss;
+	ss << "  ---  solved " << ipoint << " sweep points with " << total_pivots << " simplex pivots in " << sweep_secs << " sec" << endl;
+	ss << "  ---  sweep results written to " << file_mgr_ptr->build_filename("sweep.csv");
+	f_rec << endl << ss.str() << endl;
+	cout << endl << ss.str() << endl;
+}
+
 void sequentialLP::iter_postsolve()
 {
 
@@ -1715,6 +2066,8 @@ bool sequentialLP::make_upgrade_run(Parameters &upgrade_pars, Observations &upgr
 {
 
 	cout << "  ---  running the model once with optimal decision variables  ---  " << endl;
+	//the response matrix runs are stored as parameter deltas, which can not hold a full upgrade vector
+	run_mgr_ptr->reinitialize();
 	int run_id = run_mgr_ptr->add_run(par_trans.ctl2model_cp(upgrade_pars));
 	run_mgr_ptr->run();
 	bool success = run_mgr_ptr->get_run(run_id, upgrade_pars, upgrade_obs);
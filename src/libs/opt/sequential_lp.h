@@ -49,6 +49,18 @@ private:
 
 	string obj_sense;
 	ClpSimplex model;
+	//reuse the LP model and its basis from the previous iteration
+	bool lp_warm_start;
+	bool lp_loaded;
+	//simplex pivots and seconds of the last cold LP solve, the reference for the warm start savings
+	int cold_lp_pivots;
+	double cold_lp_secs;
+	//risk values and objective coefficient rows of an in-process sweep
+	vector<double> sweep_risks;
+	vector<string> sweep_obj_labels;
+	vector<map<string, double>> sweep_obj_coefs;
+	//keep the FOSM constraint variances of the base point while sweeping
+	bool reuse_fosm;
 	CoinMessageHandler coin_hr;
 	FILE* coin_log_ptr;
 	Jacobian_1to1 jco;
@@ -143,6 +155,16 @@ private:
 	//solve the current LP problem
 	void iter_solve();
 
+	//run the simplex on the loaded LP problem.  returns true if the warm start from the current basis
+	//was optimal, otherwise the problem was solved cold
+	bool solve_lp_model(bool warm_start, int &pivots);
+
+	//read the rows of objective function coefficients for the sweep from a csv file
+	void read_obj_sweep_file(const string &filename);
+
+	//solve the LP once for each sweep risk and objective row, reusing one response matrix and FOSM posterior
+	void sweep_solve();
+
 	//report initial conditions to rec file
 	void initial_report();
 
@@ -170,8 +192,16 @@ private:
 	//process the LP solve, including check for convergence
 	void iter_postsolve();
 
-	//convert the jacobian to a coin packed matrix instance
-	CoinPackedMatrix jacobian_to_coinpackedmatrix();
+	//convert the jacobian and prior information constraints to column ordered arrays
+	void jacobian_to_column_arrays(vector<CoinBigIndex> &col_starts, vector<int> &row_idx, vector<double> &elems);
+
+	//load the LP problem into model.  returns true if the basis of the previous iteration was kept (same dimensions)
+	bool load_lp_problem(const vector<CoinBigIndex> &col_starts, const vector<int> &row_idx, const vector<double> &elems);
+
+	//update the coefficients, bounds and objective of the loaded LP problem in place.  returns false
+	//(leaving the problem to be reloaded) if the sparsity pattern of the response matrix has changed
+	bool update_lp_problem(const vector<CoinBigIndex> &col_starts, const vector<int> &row_idx, const vector<double> &elems,
+		int &num_changed);
 
 	//convert the constraint info from Transformable to double*
 	void build_constraint_bound_arrays();
@@ -1,5 +1,8 @@
 #include <random>
 #include <iomanip>
+#include <fstream>
+#include <map>
+#include <deque>
 #include "DifferentialEvolution.h"
 #include "RunManagerAbstract.h"
 #include "ModelRunPP.h"
@@ -385,6 +388,351 @@ int DifferentialEvolution::recombination(RunManagerAbstract &run_manager)
 	return best_run_idx;
 }
 
+void DifferentialEvolution::solve_async(RunManagerAbstract &run_manager,
+	RestartController &restart_controller,
+	int d, int max_gen, double f, double cr, bool dither_f, ModelRun &cur_run)
+{
+	ostream &os = file_manager.rec_ofstream();
+	ostream &fout_restart = file_manager.get_ofstream("rst");
+	string pop_filename = file_manager.build_filename("dpop");
+
+	int n_trials_max = max_gen * d;
+	int n_trials_done = 0;
+	bool restarted = false;
+	if (restart_controller.get_restart_option() != RestartController::RestartOption::NONE)
+	{
+		restarted = load_population(pop_filename, d, n_trials_done);
+		if (!restarted)
+		{
+			os << "  unable to read population file " << pop_filename << " - starting a new population" << endl;
+			cout << "  unable to read population file " << pop_filename << " - starting a new population" << endl;
+		}
+	}
+	if (restarted)
+	{
+		run_best_individual(run_manager);
+	}
+	else
+	{
+		initialize_population_matrix(run_manager, d);
+		save_population(pop_filename, n_trials_done);
+	}
+
+	Parameters tmp_pars;
+	Observations tmp_obs;
+	Parameters best_ctl_pars;
+	Observations best_obs;
+	run_manager.get_run(best_run_idx, best_ctl_pars, best_obs);
+	par_transform.model2ctl_ip(best_ctl_pars);
+
+	int n_trials_queued = n_trials_done;
+	int n_improved = 0;
+	int n_failed = 0;
+	int iter = n_trials_done / d;
+	// run_id -> (target index, numeric trial vector) for every trial that is out with the run manager
+	map<int, pair<int, Eigen::VectorXd>> pending_trials;
+	// each new trial reuses the run of a processed trial, so the run storage holds about d runs
+	deque<int> free_run_ids;
+	deque<int> idle_targets;
+	for (int i = 0; i < d; ++i)
+	{
+		idle_targets.push_back(i);
+	}
+
+	RestartController::write_start_iteration(fout_restart, solver_type_name, iter + 1, iter + 1);
+	cout << endl;
+	output_file_writer.iteration_report(cout, iter + 1, run_manager.get_total_runs(), "asynchronous differntial evolution");
+	os << endl;
+	output_file_writer.iteration_report(os, iter + 1, run_manager.get_total_runs(), "asynchronous differntial evolution");
+
+	run_manager.reinitialize();
+	while (true)
+	{
+		// queue a new trial vector for each target whose previous trial has been processed
+		while (!idle_targets.empty() && n_trials_queued < n_trials_max
+			&& best_phi > std::numeric_limits<double>::min())
+		{
+			int i_target = idle_targets.front();
+			idle_targets.pop_front();
+			Eigen::VectorXd x_trial = get_trial_vector(i_target, f, dither_f, cr);
+			int run_id;
+			if (free_run_ids.empty())
+			{
+				run_id = run_manager.add_run(get_model_pars(x_trial));
+			}
+			else
+			{
+				run_id = run_manager.replace_run(free_run_ids.front(), get_model_pars(x_trial));
+				free_run_ids.pop_front();
+			}
+			pending_trials[run_id] = make_pair(i_target, x_trial);
+			++n_trials_queued;
+		}
+		if (pending_trials.empty())
+		{
+			break;
+		}
+
+		run_manager.run_until(RunManagerAbstract::RUN_UNTIL_COND::NO_OPS, 1);
+
+		// per-individual selection for every trial that has come back, whatever its final status
+		int run_status;
+		int run_id;
+		while ((run_id = run_manager.get_next_completed_run(run_status)) >= 0)
+		{
+			auto it = pending_trials.find(run_id);
+			if (it == pending_trials.end())
+			{
+				continue;
+			}
+			int i_target = it->second.first;
+			if (run_status > 0 && run_manager.get_run(run_id, tmp_pars, tmp_obs))
+			{
+				double phi_trial = get_phi(tmp_pars, tmp_obs);
+				if (phi_trial < population_phi(i_target))
+				{
+					population.row(i_target) = it->second.second;
+					population_phi(i_target) = phi_trial;
+					++n_improved;
+				}
+				if (phi_trial < best_phi)
+				{
+					best_phi = phi_trial;
+					best_ctl_pars = tmp_pars;
+					best_obs = tmp_obs;
+				}
+			}
+			else
+			{
+				++n_failed;
+			}
+			idle_targets.push_back(i_target);
+			free_run_ids.push_back(run_id);
+			pending_trials.erase(it);
+			++n_trials_done;
+
+			// report once a population's worth of trials has been processed
+			if (n_trials_done % d == 0)
+			{
+				os << "  asynchronous generation " << iter + 1 << ": " << n_improved << " of " << d
+					<< " trials replaced their target, " << n_failed << " trials failed" << endl;
+				RestartController::write_start_parameters_updated(fout_restart, file_manager.build_filename("par"));
+				output_file_writer.write_par(file_manager.open_ofile_ext("par"), best_ctl_pars, *(par_transform.get_offset_ptr()),
+					*(par_transform.get_scale_ptr()));
+				file_manager.close_file("par");
+				RestartController::write_finish_parameters_updated(fout_restart, file_manager.build_filename("par"));
+				save_population(pop_filename, n_trials_done);
+				RestartController::write_iteration_complete(fout_restart);
+				PhiData phi_data = obj_func_ptr->phi_report(best_obs, best_ctl_pars, DynamicRegularization::get_unit_reg_instance());
+				output_file_writer.phi_report(cout, iter, run_manager.get_total_runs(), phi_data, DynamicRegularization::get_unit_reg_instance().get_weight(), true);
+				cout << endl;
+				output_file_writer.phi_report(os, iter, run_manager.get_total_runs(), phi_data, DynamicRegularization::get_unit_reg_instance().get_weight(), true);
+				os << endl;
+				n_improved = 0;
+				n_failed = 0;
+				++iter;
+				RestartController::write_start_iteration(fout_restart, solver_type_name, iter + 1, iter + 1);
+			}
+		}
+	}
+	cur_run.update_ctl(best_ctl_pars, best_obs);
+}
+
+void DifferentialEvolution::save_population(const string &filename, int n_trials_done)
+{
+	// numeric parameter values and phi of each individual, read by load_population() on a restart
+	ofstream fout(filename);
+	if (!fout.good())
+	{
+		throw PestFileError(filename);
+	}
+	fout << n_trials_done << " " << population.rows() << " " << population.cols() << endl;
+	for (const auto &ipar : par_list)
+	{
+		fout << ipar << endl;
+	}
+	fout << setprecision(numeric_limits<double>::digits10 + 2);
+	for (int i = 0; i < population.rows(); ++i)
+	{
+		fout << population_phi(i);
+		for (int j = 0; j < population.cols(); ++j)
+		{
+			fout << " " << population(i, j);
+		}
+		fout << endl;
+	}
+}
+
+bool DifferentialEvolution::load_population(const string &filename, int d, int &n_trials_done)
+{
+	ifstream fin(filename);
+	int n_rows = 0;
+	int n_cols = 0;
+	if (!(fin >> n_trials_done >> n_rows >> n_cols) || n_rows != d || n_cols != par_list.size())
+	{
+		return false;
+	}
+	string name;
+	for (const auto &ipar : par_list)
+	{
+		if (!(fin >> name) || name != ipar)
+		{
+			return false;
+		}
+	}
+	Eigen::MatrixXd pop(n_rows, n_cols);
+	Eigen::VectorXd pop_phi(n_rows);
+	for (int i = 0; i < n_rows; ++i)
+	{
+		fin >> pop_phi(i);
+		for (int j = 0; j < n_cols; ++j)
+		{
+			fin >> pop(i, j);
+		}
+	}
+	if (fin.fail())
+	{
+		return false;
+	}
+	population = pop;
+	population_phi = pop_phi;
+	return true;
+}
+
+void DifferentialEvolution::run_best_individual(RunManagerAbstract &run_manager)
+{
+	// the best individual of a restarted population is run again to recover its observations
+	int i_best;
+	best_phi = population_phi.minCoeff(&i_best);
+	if (best_phi >= std::numeric_limits<double>::max())
+	{
+		throw PestError("Error: Differential Evolution - no individual of the restart population has a successful model run");
+	}
+	run_manager.reinitialize();
+	best_run_idx = run_manager.add_run(get_model_pars(population.row(i_best)));
+	cout << endl;
+	cout << "  performing model run for the best individual of the restart population... ";
+	cout.flush();
+	run_manager.run();
+	Parameters tmp_pars;
+	Observations tmp_obs;
+	if (!run_manager.get_run(best_run_idx, tmp_pars, tmp_obs))
+	{
+		throw PestError("Error: Differential Evolution - model run for the best individual of the restart population failed");
+	}
+}
+
+void DifferentialEvolution::initialize_population_matrix(RunManagerAbstract &run_manager, int d)
+{
+	int n_par = par_list.size();
+	Parameters numeric_pars;
+	run_manager.reinitialize();
+	population.resize(d, n_par);
+	population_phi.setConstant(d, std::numeric_limits<double>::max());
+	for (int i = 0; i < d; ++i)
+	{
+		numeric_pars.clear();
+		initialize_vector(numeric_pars);
+		population.row(i) = numeric_pars.get_data_eigen_vec(par_list);
+		par_transform.numeric2model_ip(numeric_pars);
+		run_manager.add_run(numeric_pars);
+	}
+	cout << endl;
+	cout << "  performing initial population model runs... ";
+	cout.flush();
+	run_manager.run();
+
+	best_phi = std::numeric_limits<double>::max();
+	best_run_idx = -1;
+	Parameters tmp_pars;
+	Observations tmp_obs;
+	for (int i_run = 0; i_run < d; ++i_run)
+	{
+		if (run_manager.get_run(i_run, tmp_pars, tmp_obs))
+		{
+			population_phi(i_run) = get_phi(tmp_pars, tmp_obs);
+			if (population_phi(i_run) < best_phi)
+			{
+				best_phi = population_phi(i_run);
+				best_run_idx = i_run;
+			}
+		}
+	}
+	if (best_run_idx < 0)
+	{
+		throw PestError("Error: Differential Evolution - all initial population model runs failed");
+	}
+}
+
+Eigen::VectorXd DifferentialEvolution::get_trial_vector(int i_target, double f, bool dither_f, double cr)
+{
+	int d = population.rows();
+	int n_par = par_list.size();
+	std::uniform_int_distribution<int> uni_par(0, n_par - 1);
+	std::uniform_real_distribution<double> cr_prob(0.0, 1.0);
+	std::uniform_real_distribution<double> dither_f_prob(.5, 1.0);
+
+	// individuals that have a successful model run can be used as donors
+	vector<int> donor_ids;
+	for (int i = 0; i < d; ++i)
+	{
+		if (population_phi(i) < std::numeric_limits<double>::max())
+		{
+			donor_ids.push_back(i);
+		}
+	}
+	std::uniform_int_distribution<int> uni_donor(0, donor_ids.size() - 1);
+	int xa_id = donor_ids[uni_donor(rand_engine)];
+	int xb_id = donor_ids[uni_donor(rand_engine)];
+	while (xa_id == xb_id && donor_ids.size() > 1)
+	{
+		xb_id = donor_ids[uni_donor(rand_engine)];
+	}
+	int xc_id = donor_ids[uni_donor(rand_engine)];
+
+	//initialize trail vector with the target vector
+	Eigen::VectorXd x_trial = population.row(i_target);
+	int par_id_chg = uni_par(rand_engine);
+	for (int idx = 0; idx < n_par; ++idx)
+	{
+		const string &ipar = par_list[idx];
+		double delta = population(xa_id, idx) - population(xb_id, idx);
+		double tmp_f = f;
+		if (dither_f)
+		{
+			tmp_f = dither_f_prob(rand_engine);
+		}
+		double c_p = population(xc_id, idx) + tmp_f * delta;
+		// clamp purturbation if parameter is outside it's bounds
+		c_p = max(c_p, min_numeric_pars[ipar]);
+		c_p = min(c_p, max_numeric_pars[ipar]);
+		// do cross over
+		double rand_cr = cr_prob(rand_engine);
+		if (rand_cr > cr || idx == par_id_chg)
+		{
+			x_trial(idx) = c_p;
+		}
+	}
+	return x_trial;
+}
+
+Parameters DifferentialEvolution::get_model_pars(const Eigen::VectorXd &numeric_vec)
+{
+	Parameters model_pars(par_list, numeric_vec);
+	par_transform.numeric2model_ip(model_pars);
+	return model_pars;
+}
+
+double DifferentialEvolution::get_phi(Parameters &model_pars, const Observations &obs)
+{
+	// model_pars are converted to control file parameters in place
+	ModelRun tmp_run(obj_func_ptr);
+	Observations tmp_obs(obs);
+	par_transform.model2ctl_ip(model_pars);
+	tmp_run.update_ctl(model_pars, tmp_obs);
+	return tmp_run.get_phi(DynamicRegularization::get_unit_reg_instance());
+}
+
 void DifferentialEvolution::write_run_summary(std::ostream &os,
 	int nrun_par, double avg_par, double min_par, double max_par,
 	int nrun_can, double avg_can, double min_can, double max_can,
@@ -3,6 +3,7 @@
 
 #include <unordered_map>
 #include <random>
+#include <Eigen/Dense>
 #include "FileManager.h"
 #include "ObjectiveFunc.h"
 #include "OutputFileWriter.h"
@@ -23,6 +24,11 @@ public:
 	void initialize_population(RunManagerAbstract &run_manager, int d);
 	void solve(RunManagerAbstract &run_manager, RestartController &restart_controller,
 		int max_gen, double f, double cr, bool _dither_f, ModelRun &cur_run);
+	// steady-state variant of solve().  The population is held in memory and a new
+	// trial vector is queued as soon as the previous trial for the same target returns.
+	// The population is saved to the dpop file after each generation for restarts
+	void solve_async(RunManagerAbstract &run_manager, RestartController &restart_controller,
+		int d, int max_gen, double f, double cr, bool _dither_f, ModelRun &cur_run);
 	~DifferentialEvolution();
 private:
 	const static string solver_type_name;
@@ -45,10 +51,19 @@ private:
 	double best_phi;
 	double phi_avg_old;
 	double phi_avg_new;
+	Eigen::MatrixXd population;  //numeric parameter values, one row per individual (async mode)
+	Eigen::VectorXd population_phi;
 
 	void initialize_vector(Parameters &ctl_pars);
 	void mutation(RunManagerAbstract &run_manager, double f, bool dither_f, double cr);
 	int recombination(RunManagerAbstract &run_manager);
+	void initialize_population_matrix(RunManagerAbstract &run_manager, int d);
+	void save_population(const std::string &filename, int n_trials_done);
+	bool load_population(const std::string &filename, int d, int &n_trials_done);
+	void run_best_individual(RunManagerAbstract &run_manager);
+	Eigen::VectorXd get_trial_vector(int i_target, double f, bool dither_f, double cr);
+	Parameters get_model_pars(const Eigen::VectorXd &numeric_vec);
+	double get_phi(Parameters &model_pars, const Observations &obs);
 	void write_run_summary(std::ostream &os,
 		int nrun_par, double avg_par, double min_par, double max_par,
 		int nrun_can, double avg_can, double min_can, double max_can,
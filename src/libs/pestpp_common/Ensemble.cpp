@@ -1435,7 +1435,25 @@ ParameterEnsemble ParameterEnsemble::zeros_like()
 
 }
 
-map<int,int> ParameterEnsemble::add_runs(RunManagerAbstract *run_mgr_ptr,const vector<int> &real_idxs)
+vector<int> ParameterEnsemble::get_run_real_idxs(const vector<int> &real_idxs)
+{
+	//realization indices to run, in run order
+	vector<string> run_real_names;
+	if (real_idxs.size() > 0)
+		for (auto i : real_idxs)
+			run_real_names.push_back(real_names[i]);
+	else
+		run_real_names = real_names;
+	map<string, int> rmap;
+	for (int i = 0; i < real_names.size(); i++)
+		rmap[real_names[i]] = i;
+	vector<int> run_idxs;
+	for (auto &rname : run_real_names)
+		run_idxs.push_back(rmap[rname]);
+	return run_idxs;
+}
+
+map<int,int> ParameterEnsemble::add_runs(RunManagerAbstract *run_mgr_ptr,const vector<int> &real_idxs, const string &info_txt)
 {
 	//add runs to the run manager using int indices
 	map<int,int> real_run_ids;
@@ -1451,25 +1469,9 @@ map<int,int> ParameterEnsemble::add_runs(RunManagerAbstract *run_mgr_ptr,const v
 		par_transform.active_ctl2model_ip(pars);
 	}
 	Parameters pars_real = pars;
-	Eigen::VectorXd evec;
-	vector<double> svec;
 	int run_id;
-	vector<string> run_real_names;
-	if (real_idxs.size() > 0)
-		for (auto i : real_idxs)
-			run_real_names.push_back(real_names[i]);
-	else
-		run_real_names = real_names;
-	int idx;
-	map<string, int> rmap;
-
-	for (int i = 0; i < real_names.size(); i++)
-		rmap[real_names[i]] = i;
-	for (auto &rname : run_real_names)
+	for (auto idx : get_run_real_idxs(real_idxs))
 	{
-		//idx = find(real_names.begin(), real_names.end(), rname) - real_names.begin();
-		idx = rmap[rname];
-		//Eigen::VectorXd rvector = get_real_vector(idx);
 		pars_real = pars;
 		pars_real.update_without_clear(var_names, get_real_vector(idx));
 		//make sure the pars are in the right trans status
@@ -1477,13 +1479,39 @@ map<int,int> ParameterEnsemble::add_runs(RunManagerAbstract *run_mgr_ptr,const v
 			par_transform.active_ctl2model_ip(pars_real);
 		else if (tstat == ParameterEnsemble::transStatus::NUM)
 			par_transform.numeric2model_ip(pars_real);
-		replace_fixed(rname, pars_real);
-		run_id = run_mgr_ptr->add_run(pars_real);
+		replace_fixed(real_names[idx], pars_real);
+		//the realization index is stored with the run so the run can be matched on restart
+		run_id = run_mgr_ptr->add_run(pars_real, info_txt, idx);
 		real_run_ids[idx]  = run_id;
 	}
 	return real_run_ids;
 }
 
+map<int, int> ParameterEnsemble::reuse_runs(RunManagerAbstract *run_mgr_ptr, const vector<int> &real_idxs, int first_run_id,
+	const string &info_txt)
+{
+	//match realizations to runs already in the run manager storage, starting at first_run_id.
+	//each stored run must carry the same info text and realization index that add_runs()
+	//would give it, otherwise an empty map is returned
+	map<int, int> real_run_ids;
+	int run_id = first_run_id;
+	int n_runs = run_mgr_ptr->get_nruns();
+	int run_status;
+	string run_info_txt;
+	double run_info_value;
+	for (auto idx : get_run_real_idxs(real_idxs))
+	{
+		if (run_id >= n_runs)
+			return map<int, int>();
+		run_mgr_ptr->get_info(run_id, run_status, run_info_txt, run_info_value);
+		if ((run_info_txt != info_txt) || (run_info_value != idx))
+			return map<int, int>();
+		real_run_ids[idx] = run_id;
+		run_id++;
+	}
+	return real_run_ids;
+}
+
 void ParameterEnsemble::from_eigen_mat(Eigen::MatrixXd mat, const vector<string> &_real_names, const vector<string> &_var_names, ParameterEnsemble::transStatus _tstat)
 {
 	//create a par ensemble from components
@@ -128,7 +128,8 @@ public:
 	ParamTransformSeq get_par_transform() const { return par_transform; }
 	void transform_ip(transStatus to_tstat);
 	void set_pest_scenario(Pest *_pest_scenario);
-	map<int,int> add_runs(RunManagerAbstract *run_mgr_ptr,const vector<int> &real_idxs=vector<int>());
+	map<int,int> add_runs(RunManagerAbstract *run_mgr_ptr,const vector<int> &real_idxs=vector<int>(), const string &info_txt=string());
+	map<int,int> reuse_runs(RunManagerAbstract *run_mgr_ptr, const vector<int> &real_idxs, int first_run_id, const string &info_txt);
 
 	void draw(int num_reals, Parameters par, Covariance &cov, PerformanceLog *plog, int level);
 	Covariance get_diagonal_cov_matrix();
@@ -142,6 +143,7 @@ private:
 	vector<string> fixed_names;
 	map<pair<string, string>, double> fixed_map;
 	void replace_fixed(string real_name,Parameters &pars);
+	vector<int> get_run_real_idxs(const vector<int> &real_idxs);
 };
 
 class ObservationEnsemble : public Ensemble
@@ -732,11 +732,93 @@ void ParChangeSummarizer::summarize(ParameterEnsemble &pe)
 }
 
 
+namespace checkpoint_utils
+{
+	const char checkpoint_magic[8] = { 'I', 'E', 'S', 'C', 'H', 'K', '0', '1' };
+
+	template<typename T>
+	void write_val(ofstream &out, const T &val)
+	{
+		out.write(reinterpret_cast<const char*>(&val), sizeof(T));
+	}
+
+	template<typename T>
+	void read_val(ifstream &in, T &val)
+	{
+		in.read(reinterpret_cast<char*>(&val), sizeof(T));
+		if (!in.good())
+			throw runtime_error("unexpected end of checkpoint file");
+	}
+
+	int64_t read_size(ifstream &in)
+	{
+		int64_t n;
+		read_val(in, n);
+		if ((n < 0) || (n > int64_t(1) << 40))
+			throw runtime_error("invalid size in checkpoint file");
+		return n;
+	}
+
+	void write_string(ofstream &out, const string &str)
+	{
+		write_val(out, int64_t(str.size()));
+		out.write(str.data(), str.size());
+	}
+
+	void read_string(ifstream &in, string &str)
+	{
+		str.resize(read_size(in));
+		in.read(&str[0], str.size());
+		if (!in.good())
+			throw runtime_error("unexpected end of checkpoint file");
+	}
+
+	void write_names(ofstream &out, const vector<string> &names)
+	{
+		write_val(out, int64_t(names.size()));
+		for (auto &name : names)
+			write_string(out, name);
+	}
+
+	void read_names(ifstream &in, vector<string> &names)
+	{
+		names.resize(read_size(in));
+		for (auto &name : names)
+			read_string(in, name);
+	}
+
+	void write_ensemble(ofstream &out, const Ensemble &en)
+	{
+		write_names(out, en.get_real_names());
+		write_names(out, en.get_var_names());
+		const Eigen::MatrixXd *mat = en.get_eigen_ptr();
+		write_val(out, int64_t(mat->rows()));
+		write_val(out, int64_t(mat->cols()));
+		out.write(reinterpret_cast<const char*>(mat->data()), mat->size() * sizeof(double));
+	}
+
+	void read_ensemble(ifstream &in, Eigen::MatrixXd &mat, vector<string> &real_names, vector<string> &var_names)
+	{
+		read_names(in, real_names);
+		read_names(in, var_names);
+		int64_t rows = read_size(in);
+		int64_t cols = read_size(in);
+		if ((rows != real_names.size()) || (cols != var_names.size()))
+			throw runtime_error("ensemble shape does not match names in checkpoint file");
+		mat.resize(rows, cols);
+		in.read(reinterpret_cast<char*>(mat.data()), mat.size() * sizeof(double));
+		if (!in.good())
+			throw runtime_error("unexpected end of checkpoint file");
+	}
+}
+
+using namespace checkpoint_utils;
+
 IterEnsembleSmoother::IterEnsembleSmoother(Pest &_pest_scenario, FileManager &_file_manager,
 	OutputFileWriter &_output_file_writer, PerformanceLog *_performance_log,
 	RunManagerAbstract* _run_mgr_ptr) : pest_scenario(_pest_scenario), file_manager(_file_manager),
 	output_file_writer(_output_file_writer), performance_log(_performance_log),
-	run_mgr_ptr(_run_mgr_ptr)
+	run_mgr_ptr(_run_mgr_ptr), use_checkpoint(false), checkpoint_count(0), checkpoint_batch(0), resume_run_id(-1)
 {
 	pe.set_pest_scenario(&pest_scenario);
 	oe.set_pest_scenario(&pest_scenario);
@@ -1552,7 +1634,7 @@ void IterEnsembleSmoother::initialize_obscov()
 }
 
 
-void IterEnsembleSmoother::initialize()
+void IterEnsembleSmoother::initialize(bool restart)
 {
 	message(0, "initializing");
 	pp_args = pest_scenario.get_pestpp_options().get_passed_args();
@@ -1589,6 +1671,16 @@ void IterEnsembleSmoother::initialize()
 
 	use_localizer = localizer.initialize(performance_log);
 	num_threads = pest_scenario.get_pestpp_options().get_ies_num_threads();
+
+	use_checkpoint = ppo->get_ies_checkpoint();
+	checkpoint_filename = file_manager.get_base_filename() + ".ies.chk";
+	if ((use_checkpoint) || (restart))
+	{
+		if (pest_scenario.get_control_info().pestmode == ControlInfo::PestMode::PARETO)
+			throw_ies_error("checkpoint and restart are not supported in pareto mode");
+		if (use_checkpoint)
+			message(1, "saving iteration checkpoints to ", checkpoint_filename);
+	}
 	
 	iter = 0;
 	//ofstream &frec = file_manager.rec_ofstream();
@@ -1682,6 +1774,11 @@ void IterEnsembleSmoother::initialize()
 			message(1, "localizing by obseravtions");
 		else
 			message(1, "localizing by parameters");
+		if (localizer.get_use_distance())
+		{
+			message(1, "using distance-based localization with taper: ", pest_scenario.get_pestpp_options().get_ies_loc_taper());
+			message(1, "localization distance: ", localizer.get_distance());
+		}
 	}
 
 	bool echo = false;
@@ -1925,6 +2022,27 @@ void IterEnsembleSmoother::initialize()
 	//reorder this for later
 	pe_base.reorder(vector<string>(), act_par_names);
 
+	if (restart)
+	{
+		message(0, "restarting from checkpoint ", checkpoint_filename);
+		load_checkpoint();
+		if (best_mean_phis.size() > 0)
+		{
+			//the checkpoint was saved after the initial ensemble or at the end of an iteration,
+			//so there is nothing to rerun here
+			ph = PhiHandler(&pest_scenario, &file_manager, &oe_base, &pe_base, &parcov, &reg_factor, &weights);
+			ph.update(oe, pe);
+			message(0, "phi summary at restart after iteration ", iter);
+			ph.report();
+			//the phi csv files are restarted with the checkpoint state
+			ph.write(iter, run_mgr_ptr->get_total_runs());
+			message(1, "current lambda:", last_best_lam);
+			message(0, "initialization complete");
+			pcs = ParChangeSummarizer(&pe_base, &file_manager);
+			return;
+		}
+	}
+
 	message(1, "forming inverse sqrt obscov");
 	//obscov.inv_ip(echo);
 	/*obscov_inv_sqrt = obscov.inv().get_matrix().diagonal().cwiseSqrt().asDiagonal();
@@ -1941,6 +2059,8 @@ void IterEnsembleSmoother::initialize()
 	{
 		performance_log->log_event("running initial ensemble");
 		message(1, "running initial ensemble of size", oe.shape().first);
+		if ((use_checkpoint) && (!restart))
+			save_checkpoint();
 		vector<int> failed = run_ensemble(pe, oe);
 		if (pe.shape().first == 0)
 			throw_ies_error("all realizations failed during initial evaluation");
@@ -2026,6 +2146,8 @@ void IterEnsembleSmoother::initialize()
 	}
 
 	message(1, "current lambda:", last_best_lam);
+	if (use_checkpoint)
+		save_checkpoint();
 	message(0, "initialization complete");
 
 	pcs = ParChangeSummarizer(&pe_base, &file_manager);
@@ -2300,7 +2422,8 @@ void IterEnsembleSmoother::iterate_2_solution()
 	else
 	{
 		bool accept;
-		for (int i = 0; i < pest_scenario.get_control_info().noptmax; i++)
+		//iter is nonzero when restarting from a checkpoint
+		for (int i = iter; i < pest_scenario.get_control_info().noptmax; i++)
 		{
 			iter++;
 			message(0, "starting solve for iteration:", iter);
@@ -2318,6 +2441,11 @@ void IterEnsembleSmoother::iterate_2_solution()
 				consec_bad_lambda_cycles = 0;
 			else
 				consec_bad_lambda_cycles++;
+			if (use_checkpoint)
+				save_checkpoint();
+			ss.str("");
+			ss << "performance summary for iteration " << iter;
+			performance_log->log_perf_summary(ss.str());
 
 			if (should_terminate())
 				break;
@@ -2698,6 +2826,7 @@ LocalUpgradeThread::LocalUpgradeThread(map<string, Eigen::VectorXd> &_par_resid_
 
 void LocalUpgradeThread::work(int thread_id, int iter, double cur_lam)
 {
+	perf_trace::ScopedSpan span("LocalUpgradeThread::work");
 	class local_utils
 	{
 	public:
@@ -2754,6 +2883,7 @@ void LocalUpgradeThread::work(int thread_id, int iter, double cur_lam)
 	bool use_prior_scaling;
 	bool use_localizer = false;
 	bool loc_by_obs = true;
+	bool use_propack = false;
 
 	while (true)
 	{
@@ -2765,6 +2895,7 @@ void LocalUpgradeThread::work(int thread_id, int iter, double cur_lam)
 			use_prior_scaling = pe_upgrade.get_pest_scenario_ptr()->get_pestpp_options().get_ies_use_prior_scaling();
 			num_reals = pe_upgrade.shape().first;
 			verbose_level = pe_upgrade.get_pest_scenario_ptr()->get_pestpp_options().get_ies_verbose_level();
+			use_propack = pe_upgrade.get_pest_scenario_ptr()->get_pestpp_options().get_svd_pack() == PestppOptions::SVD_PACK::PROPACK;
 			ctrl_guard.unlock();
 			//if (pe_upgrade.get_pest_scenario_ptr()->get_pestpp_options().get_ies_localize_how()[0] == 'P')
 			if (how == Localizer::How::PARAMETERS)
@@ -2773,8 +2904,14 @@ void LocalUpgradeThread::work(int thread_id, int iter, double cur_lam)
 		}
 	}
 
+	//one svd engine per thread, reused for every case this thread solves so that
+	//the solve workspace is allocated once rather than once per case
+	SVD_REDSVD rsvd;
+	SVD_PROPACK psvd;
+
 	Eigen::MatrixXd par_resid, par_diff, Am;
-	Eigen::MatrixXd obs_resid, obs_diff, loc;
+	Eigen::MatrixXd obs_resid, obs_diff;
+	Eigen::VectorXd loc;
 	Eigen::DiagonalMatrix<double, Eigen::Dynamic> weights, parcov_inv;
 	vector<string> par_names, obs_names;
 	while (true)
@@ -2798,9 +2935,11 @@ void LocalUpgradeThread::work(int thread_id, int iter, double cur_lam)
 				obs_names = p.first;
 				if (localizer.get_use())
 				{
-					if ((loc_by_obs) && (par_names.size() == 1) && (k == par_names[0]))
+					//the localizing factors apply when the case is a single obs (localizing by obs)
+					//or a single par (localizing by pars) rather than a group
+					if ((loc_by_obs) && (obs_names.size() == 1) && (k == obs_names[0]))
 						use_localizer = true;
-					else if ((!loc_by_obs) && (obs_names.size() == 1) && (k == obs_names[0]))
+					else if ((!loc_by_obs) && (par_names.size() == 1) && (k == par_names[0]))
 					{
 						use_localizer = true;
 						//loc_by_obs = false;
@@ -2816,7 +2955,7 @@ void LocalUpgradeThread::work(int thread_id, int iter, double cur_lam)
 		par_diff.resize(0, 0);
 		obs_resid.resize(0, 0);
 		obs_diff.resize(0, 0);
-		loc.resize(0, 0);
+		loc.resize(0);
 		Am.resize(0, 0);
 		weights.resize(0);
 		parcov_inv.resize(0);
@@ -2831,8 +2970,6 @@ void LocalUpgradeThread::work(int thread_id, int iter, double cur_lam)
 		unique_lock<mutex> parcov_guard(parcov_lock, defer_lock);
 		unique_lock<mutex> am_guard(am_lock, defer_lock);
 
-		bool use_propack = false;
-
 		while (true)
 		{
 			if (((use_approx) || (par_resid.rows() > 0)) &&
@@ -2841,22 +2978,19 @@ void LocalUpgradeThread::work(int thread_id, int iter, double cur_lam)
 				(par_diff.rows() > 0) &&
 				(obs_resid.rows() > 0) &&
 				(obs_diff.rows() > 0) &&
-				((!use_localizer) || (loc.rows() > 0)) && 
+				((!use_localizer) || (loc.size() > 0)) && 
 				((use_approx) || (Am.rows() > 0)))
 				break;
-			if ((use_localizer) && (loc.rows() == 0) && (loc_guard.try_lock()))
+			if ((use_localizer) && (loc.size() == 0) && (loc_guard.try_lock()))
 			{
 				if (loc_by_obs)
-					loc = localizer.get_localizing_par_hadamard_matrix(num_reals, obs_names[0], par_names);
+					loc = localizer.get_localizing_par_vector(obs_names[0], par_names);
 				else
-					loc = localizer.get_localizing_obs_hadamard_matrix(num_reals, par_names[0], obs_names);
+					loc = localizer.get_localizing_obs_vector(par_names[0], obs_names);
 				loc_guard.unlock();
 			}
 			if ((obs_diff.rows() == 0) && (obs_diff_guard.try_lock()))
 			{
-				//piggy back here for thread safety
-				if (pe_upgrade.get_pest_scenario_ptr()->get_pestpp_options().get_svd_pack() == PestppOptions::SVD_PACK::PROPACK)
-					use_propack = true;
 				obs_diff = local_utils::get_matrix_from_map(num_reals, obs_names, obs_diff_map);
 				obs_diff_guard.unlock();
 			}
@@ -2930,10 +3064,11 @@ void LocalUpgradeThread::work(int thread_id, int iter, double cur_lam)
 		local_utils::save_mat(verbose_level, thread_id, iter, "obs_diff", obs_diff);
 		if (use_localizer)
 		{
+			//scale the rows of the deviations rather than forming a full hadamard matrix
 			if (loc_by_obs)
-				par_diff = par_diff.cwiseProduct(loc);
+				par_diff = loc.asDiagonal() * par_diff;
 			else	
-				obs_diff = obs_diff.cwiseProduct(loc);
+				obs_diff = loc.asDiagonal() * obs_diff;
 
 		}
 		
@@ -2950,12 +3085,10 @@ void LocalUpgradeThread::work(int thread_id, int iter, double cur_lam)
 		
 		if (!use_propack)
 		{
-			SVD_REDSVD rsvd;
 			rsvd.solve_ip(obs_diff, s, Ut, V, eigthresh, maxsing);
 		}
 		else
 		{
-			SVD_PROPACK psvd;
 			psvd.solve_ip(obs_diff, s, Ut, V, eigthresh, maxsing);
 		}
 
@@ -3062,6 +3195,7 @@ void upgrade_thread_function(int id, int iter,double cur_lam, LocalUpgradeThread
 
 ParameterEnsemble IterEnsembleSmoother::calc_localized_upgrade_threaded(double cur_lam)
 {
+	perf_trace::ScopedSpan span("IterEnsembleSmoother::calc_localized_upgrade", true);
 	stringstream ss;
 	
 	ObservationEnsemble oe_upgrade(oe.get_pest_scenario_ptr(), oe.get_eigen(vector<string>(), act_obs_names, false), oe.get_real_names(), act_obs_names);
@@ -3227,6 +3361,7 @@ ParameterEnsemble IterEnsembleSmoother::calc_localized_upgrade_threaded(double c
 
 bool IterEnsembleSmoother::solve_new()
 {
+	perf_trace::ScopedSpan span("IterEnsembleSmoother::solve", true);
 	stringstream ss;
 	ofstream &frec = file_manager.rec_ofstream();
 	if (pe.shape().first <= error_min_reals)
@@ -3451,7 +3586,9 @@ bool IterEnsembleSmoother::solve_new()
 		org_pe_idxs = remaining_pe_lam.get_real_names();
 		org_oe_idxs = remaining_oe_lam.get_real_names();
 		///run
-		vector<int> fails = run_ensemble(remaining_pe_lam, remaining_oe_lam);
+		//with checkpoints the remaining runs are added to the lambda runs in the run storage so both
+		//batches can be reused after a restart
+		vector<int> fails = run_ensemble(remaining_pe_lam, remaining_oe_lam, vector<int>(), use_checkpoint);
 
 		//for testing
 		if (pest_scenario.get_pestpp_options().get_ies_debug_fail_remainder())
@@ -3743,32 +3880,30 @@ void IterEnsembleSmoother::set_subset_idx(int size)
 
 vector<ObservationEnsemble> IterEnsembleSmoother::run_lambda_ensembles(vector<ParameterEnsemble> &pe_lams, vector<double> &lam_vals, vector<double> &scale_vals)
 {
+	perf_trace::ScopedSpan span("IterEnsembleSmoother::run_lambda_ensembles", true);
 	ofstream &frec = file_manager.rec_ofstream();
 	stringstream ss;
 	ss << "queuing " << pe_lams.size() << " ensembles";
 	performance_log->log_event(ss.str());
-	run_mgr_ptr->reinitialize();
 	
 	set_subset_idx(pe_lams[0].shape().first);
 	vector<map<int, int>> real_run_ids_vec;
-	//ParameterEnsemble pe_lam;
-	//for (int i=0;i<pe_lams.size();i++)
+	vector<ParameterEnsemble*> pe_lam_ptrs;
 	for (auto &pe_lam : pe_lams)
+		pe_lam_ptrs.push_back(&pe_lam);
+	try
 	{
-		try
-		{
-			real_run_ids_vec.push_back(pe_lam.add_runs(run_mgr_ptr,subset_idxs));
-		}
-		catch (const exception &e)
-		{
-			stringstream ss;
-			ss << "run_ensemble() error queueing runs: " << e.what();
-			throw_ies_error(ss.str());
-		}
-		catch (...)
-		{
-			throw_ies_error(string("run_ensembles() error queueing runs"));
-		}
+		real_run_ids_vec = queue_runs(pe_lam_ptrs, subset_idxs, false);
+	}
+	catch (const exception &e)
+	{
+		stringstream ss;
+		ss << "run_ensemble() error queueing runs: " << e.what();
+		throw_ies_error(ss.str());
+	}
+	catch (...)
+	{
+		throw_ies_error(string("run_ensembles() error queueing runs"));
 	}
 	performance_log->log_event("making runs");
 	try
@@ -3875,16 +4010,17 @@ vector<ObservationEnsemble> IterEnsembleSmoother::run_lambda_ensembles(vector<Pa
 }
 
 
-vector<int> IterEnsembleSmoother::run_ensemble(ParameterEnsemble &_pe, ObservationEnsemble &_oe, const vector<int> &real_idxs)
+vector<int> IterEnsembleSmoother::run_ensemble(ParameterEnsemble &_pe, ObservationEnsemble &_oe, const vector<int> &real_idxs, bool append)
 {
+	perf_trace::ScopedSpan span("IterEnsembleSmoother::run_ensemble", true);
 	stringstream ss;
 	ss << "queuing " << _pe.shape().first << " runs";
 	performance_log->log_event(ss.str());
-	run_mgr_ptr->reinitialize();
 	map<int, int> real_run_ids;
 	try
 	{
-		real_run_ids = _pe.add_runs(run_mgr_ptr,real_idxs);
+		vector<ParameterEnsemble*> pes{ &_pe };
+		real_run_ids = queue_runs(pes, real_idxs, append)[0];
 	}
 	catch (const exception &e)
 	{
@@ -3957,6 +4093,165 @@ vector<int> IterEnsembleSmoother::run_ensemble(ParameterEnsemble &_pe, Observati
 }
 
 
+vector<map<int, int>> IterEnsembleSmoother::queue_runs(vector<ParameterEnsemble*> &pes, const vector<int> &real_idxs, bool append)
+{
+	//queue the runs for one or more ensembles.  After a checkpoint restart, the runs already in the
+	//run storage are reused when they were queued for the same ensembles, so only the outstanding
+	//runs are sent out again.  The checkpoint count and batch number in the run info text identify
+	//the ensembles, since the state is replayed deterministically from the checkpoint
+	vector<map<int, int>> real_run_ids_vec;
+	vector<string> info_txts;
+	for (int i = 0; i < pes.size(); i++)
+	{
+		stringstream ss;
+		ss << "ies " << checkpoint_count << ":" << checkpoint_batch << ":" << i;
+		info_txts.push_back(ss.str());
+	}
+	checkpoint_batch++;
+	//once the stored runs have been used up, queue as usual
+	if ((resume_run_id >= 0) && (resume_run_id >= run_mgr_ptr->get_nruns()))
+		resume_run_id = -1;
+	if (resume_run_id >= 0)
+	{
+		int run_id = resume_run_id;
+		for (int i = 0; i < pes.size(); i++)
+		{
+			map<int, int> real_run_ids = pes[i]->reuse_runs(run_mgr_ptr, real_idxs, run_id, info_txts[i]);
+			if (real_run_ids.size() == 0)
+				break;
+			run_id += real_run_ids.size();
+			real_run_ids_vec.push_back(real_run_ids);
+		}
+		if (real_run_ids_vec.size() == pes.size())
+		{
+			message(1, "reusing runs stored before restart: ", run_id - resume_run_id);
+			message(1, "outstanding runs: ", run_mgr_ptr->get_outstanding_run_ids().size());
+			resume_run_id = run_id;
+			return real_run_ids_vec;
+		}
+		message(1, "stored runs do not match the restarted ensembles, requeuing all runs");
+		real_run_ids_vec.clear();
+		resume_run_id = -1;
+		append = false;
+	}
+	if (!append)
+		run_mgr_ptr->reinitialize();
+	for (int i = 0; i < pes.size(); i++)
+		real_run_ids_vec.push_back(pes[i]->add_runs(run_mgr_ptr, real_idxs, info_txts[i]));
+	return real_run_ids_vec;
+}
+
+void IterEnsembleSmoother::save_checkpoint()
+{
+	//save the iteration state.  The file is written under a temporary name and then renamed
+	//so an interruption while writing leaves the previous checkpoint in place
+	checkpoint_count++;
+	checkpoint_batch = 0;
+	string tmp_filename = checkpoint_filename + ".tmp";
+	ofstream out(tmp_filename, ios::binary);
+	if (!out.good())
+		throw_ies_error("unable to open checkpoint file " + tmp_filename + " for writing");
+	out.write(checkpoint_magic, 8);
+	write_val(out, int32_t(checkpoint_count));
+	write_val(out, int32_t(iter));
+	write_val(out, last_best_lam);
+	write_val(out, last_best_mean);
+	write_val(out, last_best_std);
+	write_val(out, int32_t(consec_bad_lambda_cycles));
+	write_val(out, int32_t(subset_size));
+	write_val(out, int8_t(use_subset));
+	write_val(out, int64_t(best_mean_phis.size()));
+	for (auto phi : best_mean_phis)
+		write_val(out, phi);
+	write_val(out, int64_t(subset_idxs.size()));
+	for (auto idx : subset_idxs)
+		write_val(out, int32_t(idx));
+	stringstream ss;
+	ss << Ensemble::rand_engine;
+	write_string(out, ss.str());
+	write_val(out, int8_t(pe.get_trans_status()));
+	write_ensemble(out, pe);
+	write_val(out, int8_t(pe_base.get_trans_status()));
+	write_ensemble(out, pe_base);
+	write_ensemble(out, oe);
+	write_ensemble(out, oe_base);
+	write_ensemble(out, weights);
+	out.close();
+	if (!out.good())
+		throw_ies_error("error writing checkpoint file " + tmp_filename);
+	remove(checkpoint_filename.c_str());
+	if (rename(tmp_filename.c_str(), checkpoint_filename.c_str()) != 0)
+		throw_ies_error("unable to rename " + tmp_filename + " to " + checkpoint_filename);
+	message(1, "saved checkpoint to ", checkpoint_filename);
+}
+
+void IterEnsembleSmoother::load_checkpoint()
+{
+	//restore the iteration state saved by save_checkpoint() and reuse the run storage
+	ifstream in(checkpoint_filename, ios::binary);
+	if (!in.good())
+		throw_ies_error("unable to open checkpoint file " + checkpoint_filename + ", restart requires a previous run with ies_checkpoint(true)");
+	try
+	{
+		char magic[8];
+		in.read(magic, 8);
+		if ((!in.good()) || (memcmp(magic, checkpoint_magic, 8) != 0))
+			throw runtime_error("not a pestpp-ies checkpoint file");
+		int32_t i32;
+		int8_t i8;
+		read_val(in, i32);
+		checkpoint_count = i32;
+		read_val(in, i32);
+		iter = i32;
+		read_val(in, last_best_lam);
+		read_val(in, last_best_mean);
+		read_val(in, last_best_std);
+		read_val(in, i32);
+		consec_bad_lambda_cycles = i32;
+		read_val(in, i32);
+		subset_size = i32;
+		read_val(in, i8);
+		use_subset = i8 != 0;
+		best_mean_phis.resize(read_size(in));
+		for (auto &phi : best_mean_phis)
+			read_val(in, phi);
+		subset_idxs.resize(read_size(in));
+		for (auto &idx : subset_idxs)
+		{
+			read_val(in, i32);
+			idx = i32;
+		}
+		string rand_state;
+		read_string(in, rand_state);
+		stringstream ss(rand_state);
+		ss >> Ensemble::rand_engine;
+
+		Eigen::MatrixXd mat;
+		vector<string> real_names, var_names;
+		read_val(in, i8);
+		read_ensemble(in, mat, real_names, var_names);
+		pe.from_eigen_mat(mat, real_names, var_names, ParameterEnsemble::transStatus(i8));
+		read_val(in, i8);
+		read_ensemble(in, mat, real_names, var_names);
+		pe_base.from_eigen_mat(mat, real_names, var_names, ParameterEnsemble::transStatus(i8));
+		//the obs ensembles may only hold the non-zero weighted obs, so the base class method is used
+		read_ensemble(in, mat, real_names, var_names);
+		oe.Ensemble::from_eigen_mat(mat, real_names, var_names);
+		read_ensemble(in, mat, real_names, var_names);
+		oe_base.Ensemble::from_eigen_mat(mat, real_names, var_names);
+		read_ensemble(in, mat, real_names, var_names);
+		weights.Ensemble::from_eigen_mat(mat, real_names, var_names);
+	}
+	catch (const exception &e)
+	{
+		throw_ies_error("error reading checkpoint file " + checkpoint_filename + ": " + e.what());
+	}
+	checkpoint_batch = 0;
+	resume_run_id = 0;
+	message(1, "restored state from checkpoint for iteration ", iter);
+	message(1, "runs in run storage: ", run_mgr_ptr->get_nruns());
+}
+
 void IterEnsembleSmoother::finalize()
 {
 
@@ -163,7 +163,7 @@ public:
 	IterEnsembleSmoother(Pest &_pest_scenario, FileManager &_file_manager,
 		OutputFileWriter &_output_file_writer, PerformanceLog *_performance_log,
 		RunManagerAbstract* _run_mgr_ptr);
-	void initialize();
+	void initialize(bool restart = false);
 	void iterate_2_solution();
 	void pareto_iterate_2_solution();
 	void finalize();
@@ -211,6 +211,11 @@ private:
 	vector<string> act_obs_names, act_par_names;
 	vector<int> subset_idxs;
 
+	bool use_checkpoint;
+	string checkpoint_filename;
+	int checkpoint_count, checkpoint_batch;
+	int resume_run_id;
+
 	ParameterEnsemble pe, pe_base;
 	ObservationEnsemble oe, oe_base, weights;
 	//Eigen::MatrixXd prior_pe_diff;
@@ -227,7 +232,10 @@ private:
 	ParameterEnsemble calc_localized_upgrade_threaded(double cur_lam);
 
 	//EnsemblePair run_ensemble(ParameterEnsemble &_pe, ObservationEnsemble &_oe);
-	vector<int> run_ensemble(ParameterEnsemble &_pe, ObservationEnsemble &_oe, const vector<int> &real_idxs=vector<int>());
+	vector<int> run_ensemble(ParameterEnsemble &_pe, ObservationEnsemble &_oe, const vector<int> &real_idxs=vector<int>(), bool append=false);
+	vector<map<int, int>> queue_runs(vector<ParameterEnsemble*> &pes, const vector<int> &real_idxs, bool append);
+	void save_checkpoint();
+	void load_checkpoint();
 	vector<ObservationEnsemble> run_lambda_ensembles(vector<ParameterEnsemble> &pe_lams, vector<double> &lam_vals, vector<double> &scale_vals);
 	//map<string, double> get_phi_vec_stats(map<string,PhiComponets> &phi_info);
 	//map<string,PhiComponets> get_phi_info(ObservationEnsemble &_oe);
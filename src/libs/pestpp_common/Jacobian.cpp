@@ -22,6 +22,7 @@
 #include <fstream>
 #include <iomanip>
 #include "Jacobian.h"
+#include "perf_trace.h"
 #include "Transformable.h"
 #include "ParamTransformSeq.h"
 #include "pest_error.h"
@@ -57,6 +58,109 @@ void Jacobian::set_base_sim_obs(Observations _base_sim_obs)
 Jacobian::~Jacobian() {
 }
 
+int Jacobian::secant_update(const Parameters &base_numeric_pars, const Observations &base_obs,
+	const vector<Parameters> &numeric_pars_vec, const vector<Observations> &obs_vec, bool keep_pattern)
+{
+	perf_trace::ScopedSpan span("Jacobian::secant_update");
+	//prior information rows are exact and are not updated
+	vector<int> rows;
+	for (int irow = 0; irow < base_sim_obs_names.size(); ++irow)
+	{
+		if (base_obs.find(base_sim_obs_names[irow]) != base_obs.end())
+			rows.push_back(irow);
+	}
+	int n_par = base_numeric_par_names.size();
+	int n_row = rows.size();
+	MatrixXd del_par(n_par, numeric_pars_vec.size());
+	MatrixXd del_obs(n_row, numeric_pars_vec.size());
+	int n_secant = 0;
+	for (size_t i = 0; i < numeric_pars_vec.size(); ++i)
+	{
+		for (int j = 0; j < n_par; ++j)
+		{
+			const string &pname = base_numeric_par_names[j];
+			auto iter = numeric_pars_vec[i].find(pname);
+			del_par(j, n_secant) = (iter == numeric_pars_vec[i].end()) ? 0.0 : iter->second - base_numeric_pars.get_rec(pname);
+		}
+		if (del_par.col(n_secant).squaredNorm() == 0.0)
+			continue;
+		for (int r = 0; r < n_row; ++r)
+		{
+			const string &oname = base_sim_obs_names[rows[r]];
+			del_obs(r, n_secant) = obs_vec[i].get_rec(oname) - base_obs.get_rec(oname);
+		}
+		++n_secant;
+	}
+	if ((n_secant == 0) || (n_row == 0))
+		return 0;
+	del_par.conservativeResize(n_par, n_secant);
+	del_obs.conservativeResize(n_row, n_secant);
+
+	if (!keep_pattern)
+	{
+		//J += (dY - J dP) pinv(dP), which satisfies all the secant conditions at once
+		MatrixXd jdp = matrix * del_par;
+		MatrixXd resid(n_row, n_secant);
+		for (int r = 0; r < n_row; ++r)
+			resid.row(r) = del_obs.row(r) - jdp.row(rows[r]);
+		JacobiSVD<MatrixXd> svd_fac(del_par, ComputeThinU | ComputeThinV);
+		VectorXd s = svd_fac.singularValues();
+		VectorXd s_inv = VectorXd::Zero(s.size());
+		for (int i = 0; i < s.size(); ++i)
+		{
+			if (s[i] > s[0] * 1.0e-8)
+				s_inv[i] = 1.0 / s[i];
+		}
+		MatrixXd pinv = svd_fac.matrixV() * s_inv.asDiagonal() * svd_fac.matrixU().transpose();
+		//the update is added as triplets so only the rows with a secant residual are filled in
+		vector<Triplet<double> > triplet_list;
+		triplet_list.reserve(matrix.nonZeros());
+		for (int icol = 0; icol < matrix.outerSize(); ++icol)
+		{
+			for (SparseMatrix<double>::InnerIterator it(matrix, icol); it; ++it)
+				triplet_list.push_back(Triplet<double>(it.row(), it.col(), it.value()));
+		}
+		RowVectorXd update_row(n_par);
+		for (int r = 0; r < n_row; ++r)
+		{
+			if (resid.row(r).squaredNorm() == 0.0)
+				continue;
+			update_row.noalias() = resid.row(r) * pinv;
+			for (int j = 0; j < n_par; ++j)
+			{
+				if (update_row[j] != 0.0)
+					triplet_list.push_back(Triplet<double>(rows[r], j, update_row[j]));
+			}
+		}
+		SparseMatrix<double> new_matrix(matrix.rows(), matrix.cols());
+		new_matrix.setFromTriplets(triplet_list.begin(), triplet_list.end());
+		matrix.swap(new_matrix);
+	}
+	else
+	{
+		//one secant at a time, each row scaled by the parameter changes on its own nonzero columns
+		SparseMatrix<double, RowMajor> row_matrix = matrix;
+		for (int i = 0; i < n_secant; ++i)
+		{
+			VectorXd dp = del_par.col(i);
+			VectorXd jdp = row_matrix * dp;
+			for (int r = 0; r < n_row; ++r)
+			{
+				double denom = 0.0;
+				for (SparseMatrix<double, RowMajor>::InnerIterator it(row_matrix, rows[r]); it; ++it)
+					denom += dp[it.col()] * dp[it.col()];
+				if (denom == 0.0)
+					continue;
+				double fac = (del_obs(r, i) - jdp[rows[r]]) / denom;
+				for (SparseMatrix<double, RowMajor>::InnerIterator it(row_matrix, rows[r]); it; ++it)
+					it.valueRef() += fac * dp[it.col()];
+			}
+		}
+		matrix = row_matrix;
+	}
+	return n_secant;
+}
+
 
 void Jacobian::remove_cols(std::set<string> &rm_parameter_names)
 {
@@ -148,62 +252,9 @@ unordered_map<string, int> Jacobian::get_obs2row_map() const
 
 Eigen::SparseMatrix<double> Jacobian::get_matrix(const vector<string> &obs_names, const vector<string> & par_names) const
 {
-	int n_rows = obs_names.size();
-	int n_cols = par_names.size();
-	int irow_new;
-	int icol_new;
-
-	unordered_map<string, int> obs_name2newindex_map;
-	unordered_map<string, int> par_name2new_index_map;
-
-	// Build mapping of parameter names to column number in new matrix to be returned
-	icol_new = 0;
-	for (vector<string>::const_iterator b = par_names.begin(), e = par_names.end();
-		b != e; ++b, ++icol_new) {
-		par_name2new_index_map[(*b)] = icol_new;
-	}
-
-	// Build mapping of observation names to row  number in new matrix to be returned
-	irow_new = 0;
-	for (vector<string>::const_iterator b = obs_names.begin(), e = obs_names.end();
-		b != e; ++b, ++irow_new) {
-		obs_name2newindex_map[(*b)] = irow_new;
-	}
-
-	//build jacobian
-	unordered_map<string, int>::const_iterator found_par;
-	unordered_map<string, int>::const_iterator found_obs;
-	unordered_map<string, int>::const_iterator not_found_par_map = par_name2new_index_map.end();
-	unordered_map<string, int>::const_iterator not_found_obs_map = obs_name2newindex_map.end();
-
-	//unordered_map<string, int>::const_iterator not_found_par2col_map = par2col_map.end();
-	//map<string, map<string, double>>::const_iterator found_prior_info;
-	//map<string, map<string, double>>::const_iterator not_found_prior_info = prior_info_sen.end();
-
-	double data;
-	const string *obs_name;
-	const string *par_name;
-	std::vector<Eigen::Triplet<double> > triplet_list;
-	for (int icol = 0; icol < matrix.outerSize(); ++icol)
-	{
-		for (SparseMatrix<double>::InnerIterator it(matrix, icol); it; ++it)
-		{
-			data = it.value();
-			par_name = &base_numeric_par_names[it.col()];
-			obs_name = &base_sim_obs_names[it.row()];
-			found_par = par_name2new_index_map.find(*par_name);
-			found_obs = obs_name2newindex_map.find(*obs_name);
-
-			if (found_par != not_found_par_map && found_obs != not_found_obs_map)
-			{
-				triplet_list.push_back(Eigen::Triplet<double>(found_obs->second, found_par->second, data));
-			}
-		}
-	}
-	Eigen::SparseMatrix<double> new_matrix(n_rows, n_cols);
-	new_matrix.setZero();  // initialize all entries to 0
-	new_matrix.setFromTriplets(triplet_list.begin(), triplet_list.end());
-	return new_matrix;
+	// the slicer caches the name permutations so repeated requests for the same
+	// obs/par ordering do not rehash every non-zero
+	return slicer.slice(matrix, base_sim_obs_names, base_numeric_par_names, obs_names, par_names);
 }
 
 
@@ -287,6 +338,7 @@ bool Jacobian::process_runs(ParamTransformSeq &par_transform,
 		const ParameterGroupInfo &group_info,
 		RunManagerAbstract &run_manager, const PriorInformation &prior_info, bool splitswh_flag)
 {
+	perf_trace::ScopedSpan span("Jacobian::process_runs", true);
 	// calculate jacobian
   base_sim_obs_names = run_manager.get_obs_name_vec();
 	vector<string> prior_info_name = prior_info.get_keys();
@@ -706,59 +758,7 @@ void Jacobian::print(std::ostream &fout) const
 
 void Jacobian::save(const string &ext) const
 {
-	ofstream &jout = file_manager.open_ofile_ext(ext, ios::out |ios::binary);
-	int n_par = base_numeric_par_names.size();
-	int n_obs_and_pi = base_sim_obs_names.size();
-	int n;
-	int tmp;
-	double data;
-	char par_name[12];
-	char obs_name[20];
-
-	// write header
-	tmp  = -n_par;
-	jout.write((char*) &tmp, sizeof(tmp));
-	tmp = -n_obs_and_pi;
-	jout.write((char*) &tmp, sizeof(tmp));
-
-	//write number nonzero elements in jacobian (includes prior information)
-	n = matrix.nonZeros();
-	jout.write((char*)&n, sizeof(n));
-
-	//write matrix
-	n = 0;
-	map<string, double>::const_iterator found_pi_par;
-	map<string, double>::const_iterator not_found_pi_par;
-
-	Eigen::SparseMatrix<double> matrix_T(matrix);
-	matrix_T.transpose();
-	for (int icol=0; icol<matrix.outerSize(); ++icol)
-	{
-		for (SparseMatrix<double>::InnerIterator it(matrix_T, icol); it; ++it)
-		{
-			data = it.value();
-			n = it.row() + 1 + it.col() * matrix_T.rows();
-			jout.write((char*) &(n), sizeof(n));
-			jout.write((char*) &(data), sizeof(data));
-			}
-	}
-	//save parameter names
-	for(vector<string>::const_iterator b=base_numeric_par_names.begin(), e=base_numeric_par_names.end();
-		b!=e; ++b) {
-		string l = lower_cp(*b);
-		string_to_fortran_char(l, par_name, 12);
-		jout.write(par_name, 12);
-	}
-
-	//save observation and Prior information names
-	for(vector<string>::const_iterator b=base_sim_obs_names.begin(), e=base_sim_obs_names.end();
-		b!=e; ++b) {
-		string l = lower_cp(*b);
-		string_to_fortran_char(l, obs_name, 20);
-		jout.write(obs_name, 20);
-	}
-	//save observation names (part 2 prior information)
-	file_manager.close_file(ext);
+	write_binary(file_manager.build_filename(ext), base_sim_obs_names, base_numeric_par_names, matrix, TO_LOWER);
 }
 
 
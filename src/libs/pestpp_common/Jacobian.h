@@ -28,6 +28,7 @@
 #include<Eigen/Sparse>
 #include "Transformable.h"
 #include "Transformation.h"
+#include "NamedSparseSlicer.h"
 
 class ParamTransformSeq;
 class ParameterInfo;
@@ -103,6 +104,11 @@ public:
 
 	void set_base_numeric_pars(Parameters _base_numeric_pars);
 	void set_base_sim_obs(Observations _base_sim_obs);
+	//secant update of the simulated observation rows from runs made away from base_numeric_pars.  A rank-k
+	//Broyden update is applied, or when keep_pattern is true a Schubert update that only changes the nonzero
+	//entries of each row.  Returns the number of secant directions used
+	int secant_update(const Parameters &base_numeric_pars, const Observations &base_obs,
+		const vector<Parameters> &numeric_pars_vec, const vector<Observations> &obs_vec, bool keep_pattern);
 
 protected:
 	vector<string> base_numeric_par_names;  //ordered names of base parameters used to calculate the jacobian
@@ -115,6 +121,7 @@ protected:
 	//const vector<string> &ctl_file_ordered_pi_names;
 	Eigen::SparseMatrix<double> matrix;
 	FileManager &file_manager;  // filemanger used to get name of jaobian file
+	mutable NamedSparseSlicer slicer;  // cached obs/par permutations used by get_matrix()
 
 	virtual std::vector<Eigen::Triplet<double> > calc_derivative(const string &numeric_par_name, double base_numeric_par_value, int jcol, list<JacobianRun> &run_list, const ParameterGroupInfo &group_info,
 		const PriorInformation &prior_info, bool splitswh_flag);
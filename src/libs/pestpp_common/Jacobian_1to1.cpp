@@ -24,6 +24,9 @@
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
+#include <thread>
+#include <atomic>
+#include <exception>
 #include "Jacobian_1to1.h"
 #include "Transformable.h"
 #include "ParamTransformSeq.h"
@@ -36,12 +39,16 @@
 #include "FileManager.h"
 #include "PriorInformation.h"
 #include "debug.h"
+#include "perf_trace.h"
 #include "OutputFileWriter.h"
 
 using namespace std;
 using namespace pest_utils;
 
-Jacobian_1to1::Jacobian_1to1(FileManager &_file_manager, OutputFileWriter &_output_file_writer) : Jacobian(_file_manager)
+const size_t Jacobian_1to1::max_obs_block_bytes = 256 * 1024 * 1024;
+
+Jacobian_1to1::Jacobian_1to1(FileManager &_file_manager, OutputFileWriter &_output_file_writer) : Jacobian(_file_manager), num_threads(0), n_carry_forward_runs(0),
+	use_ext_derivatives(false), n_ext_check(0), ext_checked(false), ext_base_run_id(0)
 {
 	output_file_writer_ptr = &_output_file_writer;
 }
@@ -55,64 +62,43 @@ bool Jacobian_1to1::build_runs(Parameters &ctl_pars, Observations &ctl_obs, vect
 {
 	Parameters model_parameters(par_transform.ctl2model_cp(ctl_pars));
 	base_numeric_parameters = par_transform.ctl2numeric_cp(ctl_pars);
-	run_manager.reinitialize(file_manager.build_filename("rnj"));
 	debug_msg("Jacobian_1to1::build_runs begin");
 
 	failed_parameter_names.clear();
 	failed_ctl_parameters.clear();
+	build_par_names = numeric_par_names;
+	n_carry_forward_runs = 0;
+	set_ext_par_names(numeric_par_names, ctl_par_info);
+
+	vector<string> delta_par_names;
+	vector<double> delta_par_values;
+	vector<Parameters> delta_model_pars;
+	int max_n_delta = build_delta_runs(numeric_par_names, par_transform, group_info, ctl_par_info, phiredswh_flag,
+		delta_par_names, delta_par_values, delta_model_pars);
+
+	// the base parameters are stored once and each perturbation run only records the model parameters it changes
+	run_manager.reinitialize_delta(model_parameters, max_n_delta, file_manager.build_filename("rnj"));
 	// add base run
-	int run_id = run_manager.add_run(model_parameters, "", 0);
+	int run_id = run_manager.add_run(model_parameters, ext_par_names.empty() ? "" : RunManagerAbstract::derivatives_info_txt, 0);
+	ext_base_run_id = run_id;
 	//if base run is has already been complete, update it and mark it as complete
 	// compute runs for to jacobain calculation as it is influenced by derivative type( forward or central)
-	if (!calc_init_obs) {
+	//the base run is always made when the model supplies derivatives as these are written by the same run
+	if (!ext_par_names.empty())
+	{
+		run_manager.request_derivatives(run_id);
+	}
+	else if (!calc_init_obs) {
 		const Observations &init_obs = ctl_obs;
 		run_manager.update_run(run_id, model_parameters, init_obs);
 	}
 
-	Parameters new_derivative_pars;
-	bool success;
-	Parameters base_derivative_parameters = par_transform.numeric2active_ctl_cp(base_numeric_parameters);
-	Parameters base_model_parameters = par_transform.numeric2model_cp(base_numeric_parameters);
-	//Loop through derivative parameters and build the parameter sets necessary for computing the jacobian
 	std::map<string, vector<int>> par_run_map;
-	for (auto &i_name : numeric_par_names)
+	for (int i = 0; i < delta_par_names.size(); ++i)
 	{
-		assert(base_derivative_parameters.find(i_name) != base_derivative_parameters.end());
-		vector<double> tmp_del_numeric_par_vec;
-		double derivative_par_value = base_derivative_parameters.get_rec(i_name);
-		success = get_derivative_parameters(i_name, derivative_par_value, par_transform, group_info, ctl_par_info,
-			tmp_del_numeric_par_vec, phiredswh_flag);
-		if (success && !tmp_del_numeric_par_vec.empty())
-		{
-			// update changed model parameters in model_parameters
-			for (const auto &par : tmp_del_numeric_par_vec)
-			{
-				Parameters new_pars;
-				new_pars.insert(make_pair(i_name, par));
-				par_transform.active_ctl2model_ip(new_pars);
-				for (auto &ipar : new_pars)
-				{
-					model_parameters[ipar.first] = ipar.second;
-				}
-				int id = run_manager.add_run(model_parameters, i_name, par);
-				if (par_run_map.count(i_name) == 0)
-					par_run_map[i_name] = vector<int>{ id };
-				else
-					par_run_map[i_name].push_back(id);
-				//reset the perturbed parameters back to the values associated with the base condition
-				for (const auto &ipar : new_pars)
-				{
-					model_parameters[ipar.first] = base_model_parameters[ipar.first];
-				}
-			}
-		}
-		else
-		{
-			cout << endl << " warning: failed to compute parameter deriviative for " << i_name << endl;
-			file_manager.rec_ofstream() << " warning: failed to compute parameter deriviative for " << i_name << endl;
-			failed_parameter_names.insert(i_name);
-			failed_to_increment_parmaeters.insert(i_name, derivative_par_value);
-		}
+		const string &i_name = delta_par_names[i];
+		int id = run_manager.add_run_delta(delta_model_pars[i], i_name, delta_par_values[i]);
+		par_run_map[i_name].push_back(id);
 	}
 	output_file_writer_ptr->write_jco_run_id(run_manager.get_cur_groupid(), par_run_map);
 	ofstream &fout_restart = file_manager.get_ofstream("rst");
@@ -133,65 +119,43 @@ bool Jacobian_1to1::build_runs(ModelRun &init_model_run, vector<string> numeric_
 	//return build_runs(pars, obs, numeric_par_names, par_transform, group_info, ctl_par_info, run_manager, out_of_bound_par, phiredswh_flag, calc_init_obs);
 	Parameters model_parameters(par_transform.ctl2model_cp(init_model_run.get_ctl_pars()));
 	base_numeric_parameters = par_transform.ctl2numeric_cp(init_model_run.get_ctl_pars());
-	run_manager.reinitialize(file_manager.build_filename("rnj"));
 	debug_msg("Jacobian_1to1::build_runs begin");
 
 	failed_parameter_names.clear();
 	failed_ctl_parameters.clear();
+	build_par_names = numeric_par_names;
+	n_carry_forward_runs = 0;
+	set_ext_par_names(numeric_par_names, ctl_par_info);
+
+	vector<string> delta_par_names;
+	vector<double> delta_par_values;
+	vector<Parameters> delta_model_pars;
+	int max_n_delta = build_delta_runs(numeric_par_names, par_transform, group_info, ctl_par_info, phiredswh_flag,
+		delta_par_names, delta_par_values, delta_model_pars);
+
+	// the base parameters are stored once and each perturbation run only records the model parameters it changes
+	run_manager.reinitialize_delta(model_parameters, max_n_delta, file_manager.build_filename("rnj"));
 	// add base run
-	int run_id = run_manager.add_run(model_parameters, "", 0);
+	int run_id = run_manager.add_run(model_parameters, ext_par_names.empty() ? "" : RunManagerAbstract::derivatives_info_txt, 0);
+	ext_base_run_id = run_id;
 	//if base run is has already been complete, update it and mark it as complete
 	// compute runs for to jacobain calculation as it is influenced by derivative type( forward or central)
-	if (!calc_init_obs) {
+	//the base run is always made when the model supplies derivatives as these are written by the same run
+	if (!ext_par_names.empty())
+	{
+		run_manager.request_derivatives(run_id);
+	}
+	else if (!calc_init_obs) {
 		const Observations &init_obs = init_model_run.get_obs();
 		run_manager.update_run(run_id, model_parameters, init_obs);
 	}
 
-	Parameters new_derivative_pars;
-	bool success;
-	Parameters base_derivative_parameters = par_transform.numeric2active_ctl_cp(base_numeric_parameters);
-	Parameters base_model_parameters = par_transform.numeric2model_cp(base_numeric_parameters);
-	//Loop through derivative parameters and build the parameter sets necessary for computing the jacobian
 	std::map<string, vector<int>> par_run_map;
-	for (auto &i_name : numeric_par_names)
+	for (int i = 0; i < delta_par_names.size(); ++i)
 	{
-		assert(base_derivative_parameters.find(i_name) != base_derivative_parameters.end());
-		vector<double> tmp_del_numeric_par_vec;
-		double derivative_par_value = base_derivative_parameters.get_rec(i_name);
-		success = get_derivative_parameters(i_name, derivative_par_value, par_transform, group_info, ctl_par_info,
-			tmp_del_numeric_par_vec, phiredswh_flag);
-		if (success && !tmp_del_numeric_par_vec.empty())
-		{
-			// update changed model parameters in model_parameters
-			for (const auto &par : tmp_del_numeric_par_vec)
-			{
-				Parameters new_pars;
-				new_pars.insert(make_pair(i_name, par));
-				par_transform.active_ctl2model_ip(new_pars);
-				for (auto &ipar : new_pars)
-				{
-					model_parameters[ipar.first] = ipar.second;
-				}
-				int id = run_manager.add_run(model_parameters, i_name, par);
-
-				if (par_run_map.count(i_name) == 0)
-					par_run_map[i_name] = vector<int>{ id };
-				else
-					par_run_map[i_name].push_back(id);
-				//reset the perturbed parameters back to the values associated with the base condition
-				for (const auto &ipar : new_pars)
-				{
-					model_parameters[ipar.first] = base_model_parameters[ipar.first];
-				}
-			}
-		}
-		else
-		{
-			cout << endl << " warning: failed to compute parameter deriviative for " << i_name << endl;
-			file_manager.rec_ofstream() << " warning: failed to compute parameter deriviative for " << i_name << endl;
-			failed_parameter_names.insert(i_name);
-			failed_to_increment_parmaeters.insert(i_name, derivative_par_value);
-		}
+		const string &i_name = delta_par_names[i];
+		int id = run_manager.add_run_delta(delta_model_pars[i], i_name, delta_par_values[i]);
+		par_run_map[i_name].push_back(id);
 	}
 	output_file_writer_ptr->write_jco_run_id(run_manager.get_cur_groupid(), par_run_map);
 
@@ -216,15 +180,22 @@ bool Jacobian_1to1::process_runs(ParamTransformSeq &par_transform,
 		const ParameterGroupInfo &group_info,
 		RunManagerAbstract &run_manager, const PriorInformation &prior_info, bool splitswh_flag)
 {
+	perf_trace::ScopedSpan span("Jacobian::process_runs", true);
 	debug_msg("Jacobian_1to1::process_runs begin");
-       base_sim_obs_names = run_manager.get_obs_name_vec();
+	// keep the current matrix for the columns that are carried forward
+	Eigen::SparseMatrix<double> prev_matrix;
+	vector<string> prev_sim_obs_names;
+	unordered_map<string, int> prev_par2col_map;
+	if (!carry_forward_pars.empty())
+	{
+		prev_matrix.swap(matrix);
+		prev_sim_obs_names = base_sim_obs_names;
+		prev_par2col_map = get_par2col_map();
+	}
+	base_sim_obs_names = run_manager.get_obs_name_vec();
+	size_t n_obs = base_sim_obs_names.size();
 	vector<string> prior_info_name = prior_info.get_keys();
 	base_sim_obs_names.insert(base_sim_obs_names.end(), prior_info_name.begin(), prior_info_name.end());
-	std::vector<Eigen::Triplet<double> > triplet_list;
-
-	unordered_map<string, int> par2col_map = get_par2col_map();
-	unordered_map<string, int>::iterator found;
-	unordered_map<string, int>::iterator not_found = par2col_map.end();
 
 	JacobianRun base_run;
 	int i_run = 0;
@@ -239,10 +210,21 @@ bool Jacobian_1to1::process_runs(ParamTransformSeq &par_transform,
 	base_numeric_parameters = par_transform.ctl2numeric_cp(base_run.ctl_pars);
 	++i_run;
 
-	// process the parameter pertubation runs
+	// the external columns are computed by finite differences if the derivatives file is missing or unreadable
+	bool merge_cols = !carry_forward_pars.empty() || !ext_par_names.empty();
+	Eigen::MatrixXd ext_der_mat;
+	if (!ext_par_names.empty() && !load_ext_derivatives(run_manager, ext_der_mat))
+	{
+		make_ext_fd_runs(run_manager);
+	}
+
+	// group the parameter pertubation runs by parameter.  Only the parameters that changed
+	// are read back so the perturbed value (which reflects roundoff errors) can be recovered
 	int nruns = run_manager.get_nruns();
 	base_numeric_par_names.clear();
-	int icol = 0;
+	bool delta_runs = run_manager.get_runstorage_ref().is_delta();
+	vector<JacobianColumnRuns> col_runs_vec;
+	vector<JacobianColumnRuns> check_col_runs_vec;
 	int r_status;
 	vector<string>par_name_vec;
 	string cur_par_name;
@@ -250,29 +232,43 @@ bool Jacobian_1to1::process_runs(ParamTransformSeq &par_transform,
 	int run_status_next;
 	double par_value_next;
 	double cur_numeric_par_value;
-
-	list<JacobianRun> run_list;
+	JacobianColumnRuns cur_col;
 	for(; i_run<nruns; ++i_run)
 	{
-		run_list.push_back(JacobianRun());
-		run_manager. get_info(i_run, r_status, cur_par_name, cur_numeric_par_value);
-		run_manager.get_model_parameters(i_run,  run_list.back().ctl_pars);
-	    bool success = run_manager.get_observations_vec(i_run, run_list.back().obs_vec);
-		run_list.back().numeric_derivative_par = cur_numeric_par_value;
-
-		if (success)
+		run_manager.get_info(i_run, r_status, cur_par_name, cur_numeric_par_value);
+		if (r_status > 0)
 		{
-			par_transform.model2ctl_ip(run_list.back().ctl_pars);
+			Parameters ctl_pars;
+			if (delta_runs)
+			{
+				run_manager.get_model_parameter_delta(i_run, ctl_pars);
+			}
+			if (!delta_runs || ctl_pars.find(cur_par_name) == ctl_pars.end())
+			{
+				run_manager.get_model_parameters(i_run, ctl_pars);
+			}
+			par_transform.model2ctl_ip(ctl_pars);
 			// get the updated parameter value which reflects roundoff errors
 			par_name_vec.clear();
 			par_name_vec.push_back(cur_par_name);
-			Parameters numeric_pars(run_list.back().ctl_pars, par_name_vec);
+			Parameters numeric_pars(ctl_pars, par_name_vec);
 			par_transform.ctl2numeric_ip(numeric_pars);
-			run_list.back().numeric_derivative_par = numeric_pars.get_rec(cur_par_name);
-		}
-		else
-		{
-			run_list.pop_back();
+			cur_col.run_ids.push_back(i_run);
+			cur_col.numeric_par_values.push_back(numeric_pars.get_rec(cur_par_name));
+			if (prior_info.size() > 0)
+			{
+				// only keep the control parameters that differ from the base run for the prior information
+				Parameters ctl_delta;
+				for (const auto &ipar : ctl_pars)
+				{
+					auto found = base_run.ctl_pars.find(ipar.first);
+					if (found == base_run.ctl_pars.end() || found->second != ipar.second)
+					{
+						ctl_delta.insert(ipar.first, ipar.second);
+					}
+				}
+				cur_col.ctl_par_deltas.push_back(ctl_delta);
+			}
 		}
 
 		// read information associated with the next model run;
@@ -283,24 +279,174 @@ bool Jacobian_1to1::process_runs(ParamTransformSeq &par_transform,
 
 		if( i_run+1>=nruns || (cur_par_name !=par_name_next) )
 		{
-			if (!run_list.empty())
+			if (ext_check_pars.find(cur_par_name) != ext_check_pars.end())
 			{
+				// finite difference check of an external derivative column, not part of the matrix
+				if (!cur_col.run_ids.empty())
+				{
+					cur_col.par_name = cur_par_name;
+					cur_col.icol = check_col_runs_vec.size();
+					cur_col.base_numeric_par_value = base_numeric_parameters.get_rec(cur_par_name);
+					check_col_runs_vec.push_back(cur_col);
+				}
+			}
+			else if (!cur_col.run_ids.empty())
+			{
+				cur_col.par_name = cur_par_name;
+				cur_col.icol = base_numeric_par_names.size();
+				cur_col.base_numeric_par_value = base_numeric_parameters.get_rec(cur_par_name);
 				base_numeric_par_names.push_back(cur_par_name);
-				base_run.numeric_derivative_par = base_numeric_parameters.get_rec(cur_par_name);
-				double cur_numeric_value = base_run.numeric_derivative_par;
-				run_list.push_front(base_run);
-				std::vector<Eigen::Triplet<double> > tmp_triplet_vec = calc_derivative(cur_par_name, cur_numeric_value, icol, run_list, group_info, prior_info, splitswh_flag);
-				triplet_list.insert( triplet_list.end(), tmp_triplet_vec.begin(), tmp_triplet_vec.end() );
-				icol++;
+				col_runs_vec.push_back(cur_col);
 			}
 			else
 			{
 				failed_parameter_names.insert(cur_par_name);
 				failed_ctl_parameters.insert(cur_par_name, cur_numeric_par_value);
 			}
-			run_list.clear();
+			cur_col = JacobianColumnRuns();
 		}
 	}
+
+	// rows computed from prior information instead of model observations
+	vector<const PriorInformationRec*> row_pi(base_sim_obs_names.size(), nullptr);
+	for (size_t irow = 0; irow < base_sim_obs_names.size(); ++irow)
+	{
+		auto found = prior_info.find(base_sim_obs_names[irow]);
+		if (found != prior_info.end())
+		{
+			row_pi[irow] = &(found->second);
+		}
+	}
+
+	// compute the derivatives one block of columns at a time.  The observations of each block are read
+	// from the run storage in a single pass and the columns of the block are computed in parallel
+	int n_threads = num_threads;
+	if (n_threads < 1)
+	{
+		n_threads = max(1, int(thread::hardware_concurrency()));
+	}
+	vector<vector<Eigen::Triplet<double> > > thread_triplets(n_threads);
+	Eigen::MatrixXd obs_block;
+	size_t max_block_runs = max(size_t(1), max_obs_block_bytes / max(size_t(1), n_obs * sizeof(double)));
+	size_t i_col_beg = 0;
+	while (i_col_beg < col_runs_vec.size())
+	{
+		size_t i_col_end = i_col_beg + 1;
+		while (i_col_end < col_runs_vec.size() &&
+			size_t(col_runs_vec[i_col_end].run_ids.back() - col_runs_vec[i_col_beg].run_ids.front() + 1) <= max_block_runs)
+		{
+			++i_col_end;
+		}
+		int first_run_id = col_runs_vec[i_col_beg].run_ids.front();
+		int n_block_runs = col_runs_vec[i_col_end - 1].run_ids.back() - first_run_id + 1;
+		run_manager.get_observations_block(first_run_id, n_block_runs, obs_block);
+
+		atomic<size_t> next_col(i_col_beg);
+		vector<exception_ptr> exception_ptrs(n_threads);
+		auto work = [&](int thread_id)
+		{
+			try
+			{
+				Parameters pi_pars;
+				if (prior_info.size() > 0)
+				{
+					pi_pars = base_run.ctl_pars;
+				}
+				size_t i_col;
+				while ((i_col = next_col++) < i_col_end)
+				{
+					calc_derivative_column(col_runs_vec[i_col], obs_block, first_run_id, base_run.obs_vec, base_run.ctl_pars, pi_pars,
+						row_pi, group_info, splitswh_flag, thread_triplets[thread_id]);
+				}
+			}
+			catch (...)
+			{
+				exception_ptrs[thread_id] = current_exception();
+			}
+		};
+		int n_block_threads = min(n_threads, int(i_col_end - i_col_beg));
+		if (n_block_threads < 2)
+		{
+			work(0);
+		}
+		else
+		{
+			vector<thread> threads;
+			for (int i = 0; i < n_block_threads; ++i)
+			{
+				threads.push_back(thread(work, i));
+			}
+			for (auto &t : threads)
+			{
+				t.join();
+			}
+		}
+		for (auto &eptr : exception_ptrs)
+		{
+			if (eptr)
+			{
+				rethrow_exception(eptr);
+			}
+		}
+		i_col_beg = i_col_end;
+	}
+	obs_block.resize(0, 0);
+
+	// merge the per-thread triplet buffers
+	std::vector<Eigen::Triplet<double> > triplet_list;
+	size_t n_triplets = 0;
+	for (const auto &t_list : thread_triplets)
+	{
+		n_triplets += t_list.size();
+	}
+	triplet_list.reserve(n_triplets);
+	for (auto &t_list : thread_triplets)
+	{
+		triplet_list.insert(triplet_list.end(), t_list.begin(), t_list.end());
+		vector<Eigen::Triplet<double> >().swap(t_list);
+	}
+	if (!ext_par_names.empty())
+	{
+		calc_ext_derivative_columns(ext_der_mat, run_manager, par_transform, base_run, row_pi, group_info, check_col_runs_vec, triplet_list);
+		ext_der_mat.resize(0, 0);
+	}
+	if (merge_cols)
+	{
+		// merge the carried forward and external columns in the parameter order requested by build_runs
+		set<string> computed_pars(base_numeric_par_names.begin(), base_numeric_par_names.end());
+		vector<string> merged_par_names;
+		unordered_map<string, int> merged_par2col_map;
+		for (const auto &par_name : build_par_names)
+		{
+			if (computed_pars.find(par_name) != computed_pars.end() ||
+				(carry_forward_pars.find(par_name) != carry_forward_pars.end() && prev_par2col_map.find(par_name) != prev_par2col_map.end()))
+			{
+				merged_par2col_map[par_name] = merged_par_names.size();
+				merged_par_names.push_back(par_name);
+			}
+		}
+		for (auto &t : triplet_list)
+		{
+			t = Eigen::Triplet<double>(t.row(), merged_par2col_map[base_numeric_par_names[t.col()]], t.value());
+		}
+		unordered_map<string, int> obs2row_map = get_obs2row_map();
+		for (const auto &par_name : merged_par_names)
+		{
+			if (computed_pars.find(par_name) != computed_pars.end())
+				continue;
+			int icol = merged_par2col_map[par_name];
+			for (Eigen::SparseMatrix<double>::InnerIterator it(prev_matrix, prev_par2col_map[par_name]); it; ++it)
+			{
+				auto found = obs2row_map.find(prev_sim_obs_names[it.row()]);
+				if (found != obs2row_map.end())
+				{
+					triplet_list.push_back(Eigen::Triplet<double>(found->second, icol, it.value()));
+				}
+			}
+		}
+		base_numeric_par_names = merged_par_names;
+		carry_forward_pars.clear();
+	}
 	matrix.resize(base_sim_obs_names.size(), base_numeric_par_names.size());
 	matrix.setZero();
 	matrix.setFromTriplets(triplet_list.begin(), triplet_list.end());
@@ -312,6 +458,488 @@ bool Jacobian_1to1::process_runs(ParamTransformSeq &par_transform,
 	return true;
 }
 
+int Jacobian_1to1::build_delta_runs(const vector<string> &numeric_par_names, const ParamTransformSeq &par_transform,
+	const ParameterGroupInfo &group_info, const ParameterInfo &ctl_par_info, bool phiredswh_flag,
+	vector<string> &delta_par_names, vector<double> &delta_par_values, vector<Parameters> &delta_model_pars)
+{
+	bool success;
+	Parameters base_derivative_parameters = par_transform.numeric2active_ctl_cp(base_numeric_parameters);
+	Parameters base_model_parameters = par_transform.numeric2model_cp(base_numeric_parameters);
+	//Loop through derivative parameters and build the model parameter deltas necessary for computing the jacobian.
+	//The runs of the external derivative columns are kept aside in case the derivatives file is not written
+	ext_fd_runs.clear();
+	int max_n_delta = 1;
+	for (auto &i_name : numeric_par_names)
+	{
+		assert(base_derivative_parameters.find(i_name) != base_derivative_parameters.end());
+		bool ext_par = find(ext_par_names.begin(), ext_par_names.end(), i_name) != ext_par_names.end();
+		bool ext_fd_only = ext_par && ext_check_pars.find(i_name) == ext_check_pars.end();
+		vector<double> tmp_del_numeric_par_vec;
+		double derivative_par_value = base_derivative_parameters.get_rec(i_name);
+		success = get_derivative_parameters(i_name, derivative_par_value, par_transform, group_info, ctl_par_info,
+			tmp_del_numeric_par_vec, phiredswh_flag);
+		if (success && carry_forward_pars.find(i_name) != carry_forward_pars.end())
+		{
+			n_carry_forward_runs += tmp_del_numeric_par_vec.size();
+			continue;
+		}
+		if (success && !tmp_del_numeric_par_vec.empty())
+		{
+			for (const auto &par : tmp_del_numeric_par_vec)
+			{
+				Parameters model_delta = get_model_par_delta(i_name, par, par_transform, base_model_parameters);
+				max_n_delta = max(max_n_delta, int(model_delta.size()));
+				if (ext_fd_only)
+				{
+					ext_fd_runs.push_back(ExtFdRun{ i_name, par, model_delta });
+					continue;
+				}
+				delta_par_names.push_back(i_name);
+				delta_par_values.push_back(par);
+				delta_model_pars.push_back(model_delta);
+			}
+		}
+		else if (!ext_par)
+		{
+			cout << endl << " warning: failed to compute parameter deriviative for " << i_name << endl;
+			file_manager.rec_ofstream() << " warning: failed to compute parameter deriviative for " << i_name << endl;
+			failed_parameter_names.insert(i_name);
+			failed_to_increment_parmaeters.insert(i_name, derivative_par_value);
+		}
+	}
+	return max_n_delta;
+}
+
+void Jacobian_1to1::restart_build(const vector<string> &numeric_par_names, const ParamTransformSeq &par_transform,
+	const ParameterGroupInfo &group_info, const ParameterInfo &ctl_par_info, RunManagerAbstract &run_manager, bool phiredswh_flag)
+{
+	// build_runs is skipped when the jacobian runs are resumed from the run storage file.  Rebuild the state
+	// process_runs needs from the base run, which is the first run in the storage file
+	Parameters base_ctl_pars;
+	run_manager.get_model_parameters(0, base_ctl_pars);
+	par_transform.model2ctl_ip(base_ctl_pars);
+	base_numeric_parameters = par_transform.ctl2numeric_cp(base_ctl_pars);
+	failed_parameter_names.clear();
+	failed_ctl_parameters.clear();
+	build_par_names = numeric_par_names;
+	n_carry_forward_runs = 0;
+	ext_base_run_id = 0;
+	set_ext_par_names(numeric_par_names, ctl_par_info);
+	vector<string> delta_par_names;
+	vector<double> delta_par_values;
+	vector<Parameters> delta_model_pars;
+	build_delta_runs(numeric_par_names, par_transform, group_info, ctl_par_info, phiredswh_flag,
+		delta_par_names, delta_par_values, delta_model_pars);
+}
+
+bool Jacobian_1to1::load_ext_derivatives(RunManagerAbstract &run_manager, Eigen::MatrixXd &der_mat)
+{
+	string der_filename = run_manager.get_derivatives_file(ext_base_run_id);
+	string msg;
+	if (der_filename.empty())
+	{
+		msg = "the derivatives command did not produce a derivatives file for the base run";
+	}
+	else
+	{
+		try
+		{
+			read_ext_derivatives(der_filename, run_manager.get_obs_name_vec(), run_manager.get_par_name_vec(), der_mat);
+			return true;
+		}
+		catch (exception &e)
+		{
+			msg = e.what();
+		}
+	}
+	file_manager.rec_ofstream() << endl << " warning: " << msg << endl;
+	file_manager.rec_ofstream() << "   the model supplied derivatives will be computed by finite differences" << endl;
+	cout << endl << " warning: " << msg << ", computing these derivatives by finite differences" << endl;
+	return false;
+}
+
+void Jacobian_1to1::make_ext_fd_runs(RunManagerAbstract &run_manager)
+{
+	// finite difference runs for the columns that were to come from the derivatives file.  The check columns
+	// already have their runs so all of the external columns are processed as ordinary columns
+	set<string> fd_pars;
+	for (const auto &fd_run : ext_fd_runs)
+	{
+		run_manager.add_run_delta(fd_run.model_delta, fd_run.par_name, fd_run.numeric_par_value);
+		fd_pars.insert(fd_run.par_name);
+	}
+	for (const auto &par_name : ext_par_names)
+	{
+		if (fd_pars.find(par_name) == fd_pars.end() && ext_check_pars.find(par_name) == ext_check_pars.end())
+		{
+			cout << endl << " warning: failed to compute parameter deriviative for " << par_name << endl;
+			file_manager.rec_ofstream() << " warning: failed to compute parameter deriviative for " << par_name << endl;
+			failed_parameter_names.insert(par_name);
+			failed_to_increment_parmaeters.insert(par_name, base_numeric_parameters.get_rec(par_name));
+		}
+	}
+	ext_par_names.clear();
+	ext_check_pars.clear();
+	ext_fd_runs.clear();
+	if (!fd_pars.empty())
+	{
+		run_manager.run();
+	}
+}
+
+void Jacobian_1to1::set_ext_par_names(const vector<string> &numeric_par_names, const ParameterInfo &ctl_par_info)
+{
+	ext_par_names.clear();
+	ext_check_pars.clear();
+	if (!use_ext_derivatives)
+		return;
+	for (const auto &i_name : numeric_par_names)
+	{
+		const ParameterRec *par_rec = ctl_par_info.get_parameter_rec_ptr(i_name);
+		if (par_rec != nullptr && par_rec->dercom == 0 && carry_forward_pars.find(i_name) == carry_forward_pars.end())
+		{
+			ext_par_names.push_back(i_name);
+		}
+	}
+	// spot check an evenly spaced subset of the external columns against finite differences the first time through
+	if (!ext_checked && n_ext_check > 0 && !ext_par_names.empty())
+	{
+		int n_check = min(n_ext_check, int(ext_par_names.size()));
+		for (int i = 0; i < n_check; ++i)
+		{
+			ext_check_pars.insert(ext_par_names[(i * ext_par_names.size()) / n_check]);
+		}
+	}
+}
+
+void Jacobian_1to1::read_ext_derivatives(const string &filename, const vector<string> &obs_names, const vector<string> &model_par_names,
+	Eigen::MatrixXd &der_mat) const
+{
+	// derivatives of the model outputs with respect to the model parameter values, either as a PEST binary
+	// jacobian (.jco/.jcb) or as "obs_name par_name derivative" triplets.  Entries that are not supplied are zero
+	unordered_map<string, int> obs_map;
+	for (size_t i = 0; i < obs_names.size(); ++i)
+		obs_map[obs_names[i]] = i;
+	unordered_map<string, int> par_map;
+	for (size_t i = 0; i < model_par_names.size(); ++i)
+		par_map[model_par_names[i]] = i;
+	der_mat.setZero(obs_names.size(), model_par_names.size());
+
+	string ext = get_filename_ext(filename);
+	upper_ip(ext);
+	if (ext == "JCO" || ext == "JCB")
+	{
+		vector<string> row_names;
+		vector<string> col_names;
+		Eigen::SparseMatrix<double> ext_matrix;
+		if (!read_binary(filename, row_names, col_names, ext_matrix))
+			throw PestError("Jacobian_1to1::read_ext_derivatives: error reading derivatives file " + filename);
+		for (int icol = 0; icol < ext_matrix.outerSize(); ++icol)
+		{
+			auto found_par = par_map.find(upper_cp(col_names[icol]));
+			if (found_par == par_map.end())
+				continue;
+			for (Eigen::SparseMatrix<double>::InnerIterator it(ext_matrix, icol); it; ++it)
+			{
+				auto found_obs = obs_map.find(upper_cp(row_names[it.row()]));
+				if (found_obs != obs_map.end())
+					der_mat(found_obs->second, found_par->second) = it.value();
+			}
+		}
+		return;
+	}
+
+	ifstream fin(filename);
+	if (!fin)
+		throw PestError("Jacobian_1to1::read_ext_derivatives: unable to open derivatives file " + filename);
+	string line;
+	vector<string> tokens;
+	while (getline(fin, line))
+	{
+		tokens.clear();
+		tokenize(strip_cp(line), tokens);
+		if (tokens.empty())
+			continue;
+		if (tokens.size() != 3)
+			throw PestError("Jacobian_1to1::read_ext_derivatives: expected 'obs_name par_name derivative' in " + filename + ": " + line);
+		auto found_obs = obs_map.find(upper_cp(tokens[0]));
+		auto found_par = par_map.find(upper_cp(tokens[1]));
+		if (found_obs != obs_map.end() && found_par != par_map.end())
+			der_mat(found_obs->second, found_par->second) = convert_cp<double>(tokens[2]);
+	}
+}
+
+void Jacobian_1to1::calc_ext_derivative_columns(const Eigen::MatrixXd &der_mat, RunManagerAbstract &run_manager,
+	const ParamTransformSeq &par_transform, const JacobianRun &base_run,
+	const vector<const PriorInformationRec*> &row_pi, const ParameterGroupInfo &group_info,
+	const vector<JacobianColumnRuns> &check_col_runs_vec, vector<Eigen::Triplet<double> > &triplet_list)
+{
+	const vector<string> &obs_names = run_manager.get_obs_name_vec();
+	const vector<string> &model_par_names = run_manager.get_par_name_vec();
+	unordered_map<string, int> model_par_map;
+	for (size_t i = 0; i < model_par_names.size(); ++i)
+		model_par_map[model_par_names[i]] = i;
+
+	// chain rule: d(obs)/d(numeric par) = sum over the model parameters of d(obs)/d(model par) * d(model par)/d(numeric par).
+	// The derivatives of the model parameters are taken from a central difference of the parameter transformations alone,
+	// which is exact for the linear (scale, offset and tied) transformations
+	size_t n_obs = obs_names.size();
+	Parameters pi_pars = base_run.ctl_pars;
+	auto calc_pi_residual = [&](const PriorInformationRec *pi_rec, const Parameters &ctl_delta)
+	{
+		for (const auto &ipar : ctl_delta)
+		{
+			pi_pars[ipar.first] = ipar.second;
+		}
+		double resid = pi_rec->calc_residual(pi_pars);
+		for (const auto &ipar : ctl_delta)
+		{
+			auto found = base_run.ctl_pars.find(ipar.first);
+			if (found == base_run.ctl_pars.end())
+				pi_pars.erase(ipar.first);
+			else
+				pi_pars[ipar.first] = found->second;
+		}
+		return resid;
+	};
+	unordered_map<string, int> ext_col_map;
+	vector<Eigen::Triplet<double> > ext_triplets;
+	Eigen::VectorXd col(n_obs);
+	for (const auto &par_name : ext_par_names)
+	{
+		double numeric_value = base_numeric_parameters.get_rec(par_name);
+		double del = (numeric_value == 0.0) ? 1.0e-6 : 1.0e-6 * abs(numeric_value);
+		Parameters ctl_up;
+		ctl_up.insert(par_name, numeric_value + del);
+		par_transform.numeric2active_ctl_ip(ctl_up);
+		Parameters ctl_dn;
+		ctl_dn.insert(par_name, numeric_value - del);
+		par_transform.numeric2active_ctl_ip(ctl_dn);
+		Parameters model_up = par_transform.active_ctl2model_cp(ctl_up);
+		Parameters model_dn = par_transform.active_ctl2model_cp(ctl_dn);
+		col.setZero();
+		for (const auto &ipar : model_up)
+		{
+			auto found = model_par_map.find(ipar.first);
+			if (found == model_par_map.end())
+				continue;
+			double d_model = (ipar.second - model_dn.get_rec(ipar.first)) / (2.0 * del);
+			if (d_model != 0.0)
+				col += der_mat.col(found->second) * d_model;
+		}
+		if (!col.allFinite())
+		{
+			file_manager.rec_ofstream() << " warning: invalid external derivatives for " << par_name << endl;
+			failed_parameter_names.insert(par_name);
+			continue;
+		}
+		int icol = base_numeric_par_names.size();
+		ext_col_map[par_name] = icol;
+		base_numeric_par_names.push_back(par_name);
+		for (size_t irow = 0; irow < n_obs; ++irow)
+		{
+			if (col(irow) != 0.0)
+				ext_triplets.push_back(Eigen::Triplet<double>(irow, icol, col(irow)));
+		}
+		for (size_t irow = n_obs; irow < row_pi.size(); ++irow)
+		{
+			if (row_pi[irow] == nullptr)
+				continue;
+			double der = (calc_pi_residual(row_pi[irow], ctl_up) - calc_pi_residual(row_pi[irow], ctl_dn)) / (2.0 * del);
+			if (der != 0.0)
+				ext_triplets.push_back(Eigen::Triplet<double>(irow, icol, der));
+		}
+	}
+
+	if (!ext_check_pars.empty())
+	{
+		// compare the external columns against the finite difference check columns over the observation rows
+		ofstream &fout_rec = file_manager.rec_ofstream();
+		fout_rec << endl << "  Check of model supplied derivatives against finite differences" << endl;
+		fout_rec << "    " << left << setw(20) << "parameter" << "relative difference" << endl;
+		Eigen::MatrixXd obs_block;
+		for (const auto &check_col : check_col_runs_vec)
+		{
+			auto found = ext_col_map.find(check_col.par_name);
+			if (found == ext_col_map.end())
+				continue;
+			int first_run_id = check_col.run_ids.front();
+			run_manager.get_observations_block(first_run_id, check_col.run_ids.back() - first_run_id + 1, obs_block);
+			JacobianColumnRuns fd_col = check_col;
+			fd_col.icol = 0;
+			vector<Eigen::Triplet<double> > fd_triplets;
+			calc_derivative_column(fd_col, obs_block, first_run_id, base_run.obs_vec, base_run.ctl_pars, pi_pars, row_pi, group_info, false, fd_triplets);
+			Eigen::VectorXd fd_vec = Eigen::VectorXd::Zero(n_obs);
+			for (const auto &t : fd_triplets)
+			{
+				if (t.row() < n_obs)
+					fd_vec(t.row()) = t.value();
+			}
+			Eigen::VectorXd ext_vec = Eigen::VectorXd::Zero(n_obs);
+			for (const auto &t : ext_triplets)
+			{
+				if (t.col() == found->second && t.row() < n_obs)
+					ext_vec(t.row()) = t.value();
+			}
+			double fd_norm = fd_vec.norm();
+			double rel_diff = (fd_norm > 0.0) ? (fd_vec - ext_vec).norm() / fd_norm : (ext_vec.norm() > 0.0 ? 1.0 : 0.0);
+			fout_rec << "    " << left << setw(20) << check_col.par_name << rel_diff << endl;
+			if (rel_diff > 0.1)
+			{
+				fout_rec << "    warning: model supplied derivatives for " << check_col.par_name << " differ from finite differences" << endl;
+				cout << "  warning: model supplied derivatives for " << check_col.par_name << " differ from finite differences by "
+					<< rel_diff * 100.0 << "%" << endl;
+			}
+		}
+		for (const auto &par_name : ext_check_pars)
+		{
+			if (find_if(check_col_runs_vec.begin(), check_col_runs_vec.end(),
+				[&](const JacobianColumnRuns &c) {return c.par_name == par_name; }) == check_col_runs_vec.end())
+				fout_rec << "    " << left << setw(20) << par_name << "no finite difference runs" << endl;
+		}
+		fout_rec << endl;
+		ext_check_pars.clear();
+		ext_checked = true;
+	}
+	triplet_list.insert(triplet_list.end(), ext_triplets.begin(), ext_triplets.end());
+}
+
+void Jacobian_1to1::calc_derivative_column(const JacobianColumnRuns &col_runs, const Eigen::MatrixXd &obs_block, int first_run_id,
+	const vector<double> &base_obs, const Parameters &base_ctl_pars, Parameters &pi_pars,
+	const vector<const PriorInformationRec*> &row_pi, const ParameterGroupInfo &group_info, bool splitswh_flag,
+	vector<Eigen::Triplet<double> > &triplet_list) const
+{
+	// same finite difference rules as Jacobian::calc_derivative, but computed from a block of
+	// observations and the parameter deltas of each run
+	struct DerivativeRun
+	{
+		double numeric_derivative_par;
+		const double *obs;
+		const Parameters *ctl_par_delta;
+	};
+	vector<DerivativeRun> run_vec;
+	run_vec.push_back(DerivativeRun{ col_runs.base_numeric_par_value, base_obs.data(), nullptr });
+	for (size_t i = 0; i < col_runs.run_ids.size(); ++i)
+	{
+		const Parameters *delta_ptr = col_runs.ctl_par_deltas.empty() ? nullptr : &col_runs.ctl_par_deltas[i];
+		run_vec.push_back(DerivativeRun{ col_runs.numeric_par_values[i],
+			obs_block.data() + size_t(col_runs.run_ids[i] - first_run_id) * obs_block.rows(), delta_ptr });
+	}
+	stable_sort(run_vec.begin(), run_vec.end(), [](const DerivativeRun &a, const DerivativeRun &b)
+		{return a.numeric_derivative_par > b.numeric_derivative_par; });
+	const DerivativeRun &run_first = run_vec.front();
+	const DerivativeRun &run_last = run_vec.back();
+	int jcol = col_runs.icol;
+
+	const ParameterGroupRec *g_rec = group_info.get_group_rec_ptr(col_runs.par_name);
+	double splitthresh = g_rec->splitthresh;
+	double splitreldiff = g_rec->splitreldiff;
+	bool split = (run_vec.size() == 3 && splitswh_flag);
+	bool parabolic = (run_vec.size() == 3 && g_rec->dermthd == "PARABOLIC");
+	Eigen::ColPivHouseholderQR<Eigen::MatrixXd> a_qr;
+	if (parabolic)
+	{
+		// Central Difference Parabola:  A is the same for every observation so only factor it once
+		Eigen::MatrixXd a_mat(3, 3);
+		for (int i = 0; i < 3; ++i)
+		{
+			double par_value = run_vec[i].numeric_derivative_par;
+			a_mat(i, 0) = par_value*par_value; a_mat(i, 1) = par_value; a_mat(i, 2) = 1;
+		}
+		a_qr.compute(a_mat);
+	}
+	double del_par = run_last.numeric_derivative_par - run_first.numeric_derivative_par;
+	double der;
+	vector<double> sen_vec;
+	Eigen::VectorXd c(3), y(3);
+	int n_rows = row_pi.size();
+	for (int irow = 0; irow < n_rows; ++irow)
+	{
+		if (row_pi[irow] == nullptr)
+		{
+			//Apply Split threshold on derivative if applicable
+			bool success = false;
+			if (split)
+			{
+				sen_vec.clear();
+				for (int i = 1; i < 3; ++i)
+				{
+					double del_par_i = run_vec[i].numeric_derivative_par - run_vec[i - 1].numeric_derivative_par;
+					double del_obs_i = run_vec[i].obs[irow] - run_vec[i - 1].obs[irow];
+					sen_vec.push_back(del_obs_i / del_par_i);
+				}
+				std::sort(sen_vec.begin(), sen_vec.end(), [](double a, double b) {
+					return std::abs(a) < std::abs(b); });
+				if (abs(sen_vec.back()) >= splitthresh &&
+					abs(sen_vec.back() - sen_vec.front()) / sen_vec.front() > splitreldiff)
+				{
+					success = true;
+					if (sen_vec.front() != 0)
+					{
+						triplet_list.push_back(Eigen::Triplet<double>(irow, jcol, sen_vec.front()));
+					}
+				}
+			}
+			if (parabolic && !success)
+			{
+				//derivative is calculated around the base numeric parameter value
+				for (int i = 0; i < 3; ++i)
+				{
+					y(i) = run_vec[i].obs[irow];
+				}
+				c = a_qr.solve(y);
+				der = 2.0 * c(0) * col_runs.base_numeric_par_value + c(1);
+				if (der != 0)
+				{
+					triplet_list.push_back(Eigen::Triplet<double>(irow, jcol, der));
+				}
+			}
+			else if (!success)
+			{
+				// Forward Difference and Central Difference Outer
+				double del_obs = run_last.obs[irow] - run_first.obs[irow];
+				if (del_obs != 0)
+				{
+					triplet_list.push_back(Eigen::Triplet<double>(irow, jcol, del_obs / del_par));
+				}
+			}
+		}
+		else
+		{
+			// Prior Information allways calculated using outer model runs even for central difference
+			double resid[2];
+			const DerivativeRun *pi_runs[2] = { &run_last, &run_first };
+			for (int i = 0; i < 2; ++i)
+			{
+				const Parameters *delta_ptr = pi_runs[i]->ctl_par_delta;
+				if (delta_ptr == nullptr)
+				{
+					resid[i] = row_pi[irow]->calc_residual(pi_pars);
+					continue;
+				}
+				for (const auto &ipar : *delta_ptr)
+				{
+					pi_pars[ipar.first] = ipar.second;
+				}
+				resid[i] = row_pi[irow]->calc_residual(pi_pars);
+				//reset the changed parameters back to the values associated with the base run
+				for (const auto &ipar : *delta_ptr)
+				{
+					auto found = base_ctl_pars.find(ipar.first);
+					if (found == base_ctl_pars.end())
+						pi_pars.erase(ipar.first);
+					else
+						pi_pars[ipar.first] = found->second;
+				}
+			}
+			double del_prior_info = resid[0] - resid[1];
+			if (del_prior_info != 0) {
+				triplet_list.push_back(Eigen::Triplet<double>(irow, jcol, del_prior_info / del_par));
+			}
+		}
+	}
+}
+
 bool Jacobian_1to1::get_derivative_parameters(const string &par_name, double par_value, const ParamTransformSeq &par_trans, const ParameterGroupInfo &group_info, const ParameterInfo &ctl_par_info,
 		vector<double> &delta_numeric_par_vec, bool phiredswh_flag)
 {
@@ -342,6 +970,25 @@ bool Jacobian_1to1::get_derivative_parameters(const string &par_name, double par
 	return success;
 }
 
+Parameters Jacobian_1to1::get_model_par_delta(const string &par_name, double derivative_par_value, const ParamTransformSeq &par_trans, const Parameters &base_model_pars) const
+{
+	// model parameters changed by perturbing par_name.  Transformations can add model parameters
+	// that keep their base value (ie fixed parameters); these are not part of the delta
+	Parameters new_pars;
+	new_pars.insert(par_name, derivative_par_value);
+	par_trans.active_ctl2model_ip(new_pars);
+	Parameters delta_pars;
+	for (const auto &ipar : new_pars)
+	{
+		auto found = base_model_pars.find(ipar.first);
+		if (ipar.first == par_name || found == base_model_pars.end() || found->second != ipar.second)
+		{
+			delta_pars.insert(ipar.first, ipar.second);
+		}
+	}
+	return delta_pars;
+}
+
 bool Jacobian_1to1::forward_diff(const string &par_name, double base_derivative_val,
 		const ParameterGroupInfo &group_info, const ParameterInfo &ctl_par_info, const ParamTransformSeq &par_trans, double &new_par_val)
 {
@@ -484,3 +1131,63 @@ void Jacobian_1to1::report_errors(std::ostream &fout)
 
 
 }
+
+string JacRefreshTracker::get_full_jac_reason(int iter, int full_iter, bool failed_pars)
+{
+	string reason;
+	if (col_iter.empty())
+		reason = "no previous finite difference jacobian";
+	else if (force_full)
+		reason = "phi reduction stalled or derivative type changed";
+	else if (iter - last_full_iter >= full_iter)
+		reason = "jac_refresh_full_iter iterations since the last full jacobian";
+	else if (failed_pars)
+		reason = "the previous jacobian has failed parameter runs";
+	force_full = false;
+	return reason;
+}
+
+set<string> JacRefreshTracker::get_carry_forward_pars(const vector<string> &numeric_par_names, const vector<string> &jac_par_names,
+	const Eigen::VectorXd &css, double sen_ratio, const Parameters &numeric_pars, const Parameters &numeric_lbnd,
+	const Parameters &numeric_ubnd, double par_change) const
+{
+	set<string> carry_forward_pars;
+	double css_thres = (css.size() > 0) ? sen_ratio * css.maxCoeff() : 0.0;
+	unordered_map<string, int> par2col_map;
+	for (int i = 0; i < jac_par_names.size(); ++i)
+		par2col_map[jac_par_names[i]] = i;
+	for (const auto &par_name : numeric_par_names)
+	{
+		auto icol = par2col_map.find(par_name);
+		if (icol == par2col_map.end() || col_iter.find(par_name) == col_iter.end())
+			continue;
+		if (css[icol->second] >= css_thres)
+			continue;
+		double par_range = abs(numeric_ubnd.get_rec(par_name) - numeric_lbnd.get_rec(par_name));
+		double change = abs(numeric_pars.get_rec(par_name) - col_numeric_pars.get_rec(par_name));
+		if (change > par_change * par_range)
+			continue;
+		carry_forward_pars.insert(par_name);
+	}
+	return carry_forward_pars;
+}
+
+void JacRefreshTracker::record(int iter, const vector<string> &jac_par_names, const Parameters &jac_numeric_pars, const set<string> &carry_forward_pars)
+{
+	if (carry_forward_pars.empty())
+		last_full_iter = iter;
+	for (const auto &par_name : jac_par_names)
+	{
+		if (carry_forward_pars.find(par_name) == carry_forward_pars.end())
+		{
+			col_iter[par_name] = iter;
+			col_numeric_pars[par_name] = jac_numeric_pars.get_rec(par_name);
+		}
+	}
+}
+
+int JacRefreshTracker::get_col_iter(const string &par_name) const
+{
+	auto it = col_iter.find(par_name);
+	return (it == col_iter.end()) ? -1 : it->second;
+}
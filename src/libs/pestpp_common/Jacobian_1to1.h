@@ -1,6 +1,7 @@
 #ifndef JACOBIAN_1TO1H_
 #define JACOBIAN_1TO1H_
 #include<map>
+#include <set>
 #include <unordered_map>
 #include <vector>
 #include <string>
@@ -16,8 +17,20 @@ class RunManagerAbstract;
 class ModelRun;
 class FileManager;
 class PriorInformation;
+class PriorInformationRec;
 class ParameterRec;
 
+class JacobianColumnRuns {
+public:
+	// successful perturbation runs of one numeric parameter
+	std::string par_name;
+	int icol;
+	double base_numeric_par_value;
+	std::vector<int> run_ids;
+	std::vector<double> numeric_par_values;
+	std::vector<Parameters> ctl_par_deltas;
+};
+
 class Jacobian_1to1 : public Jacobian{
 
 public:
@@ -33,8 +46,37 @@ public:
 		const ParameterGroupInfo &group_info,
 		RunManagerAbstract &run_manager, const PriorInformation &prior_info, bool splitswh_flag);
 	virtual void report_errors(std::ostream &fout);
+	void set_num_threads(int _num_threads) { num_threads = _num_threads; }
+	//the columns of these parameters are carried forward from the current matrix by the next build_runs/process_runs
+	//instead of being recomputed from perturbation runs
+	void set_carry_forward_pars(const set<string> &_carry_forward_pars) { carry_forward_pars = _carry_forward_pars; }
+	int get_n_carry_forward_runs() const { return n_carry_forward_runs; }
+	//columns of adjustable parameters with dercom = 0 are read from the file written by the model derivatives
+	//command during the base run.  The first n_check of them are also computed by finite differences on the first jacobian
+	void set_external_derivatives(bool _use_ext_derivatives, int _n_ext_check) { use_ext_derivatives = _use_ext_derivatives; n_ext_check = _n_ext_check; }
+	//used in place of build_runs when the jacobian runs are resumed from a restart file
+	void restart_build(const vector<string> &numeric_par_names, const ParamTransformSeq &par_transform,
+		const ParameterGroupInfo &group_info, const ParameterInfo &ctl_par_info, RunManagerAbstract &run_manager, bool phiredswh_flag = false);
 	virtual ~Jacobian_1to1();
 protected:
+	static const size_t max_obs_block_bytes;
+	int num_threads;
+	set<string> carry_forward_pars;
+	int n_carry_forward_runs;  //perturbation runs skipped by the last build_runs
+	vector<string> build_par_names;  //numeric parameter order requested by the last build_runs
+	bool use_ext_derivatives;
+	int n_ext_check;
+	bool ext_checked;  //the finite difference check of the external derivatives has been made
+	vector<string> ext_par_names;  //parameters whose columns come from the external derivatives file
+	set<string> ext_check_pars;  //external derivative parameters also perturbed for the finite difference check
+	struct ExtFdRun
+	{
+		string par_name;
+		double numeric_par_value;
+		Parameters model_delta;
+	};
+	vector<ExtFdRun> ext_fd_runs;  //perturbation runs of the external columns, only made if the derivatives file is missing
+	int ext_base_run_id;
 	Parameters failed_ctl_parameters;
 	Parameters failed_to_increment_parmaeters;
 	OutputFileWriter* output_file_writer_ptr;
@@ -46,6 +88,49 @@ protected:
 	bool out_of_bounds(const Parameters &model_parameters, const ParameterRec *par_info_ptr) const;
 	bool get_derivative_parameters(const string &par_name, double derivative_par_value, const ParamTransformSeq &par_trans, const ParameterGroupInfo &group_info, const ParameterInfo &ctl_par_info,
 		vector<double> &delta_numeric_par_vec, bool phiredswh_flag);
+	void calc_derivative_column(const JacobianColumnRuns &col_runs, const Eigen::MatrixXd &obs_block, int first_run_id,
+		const std::vector<double> &base_obs, const Parameters &base_ctl_pars, Parameters &pi_pars,
+		const std::vector<const PriorInformationRec*> &row_pi, const ParameterGroupInfo &group_info, bool splitswh_flag,
+		std::vector<Eigen::Triplet<double> > &triplet_list) const;
+	int build_delta_runs(const vector<string> &numeric_par_names, const ParamTransformSeq &par_transform,
+		const ParameterGroupInfo &group_info, const ParameterInfo &ctl_par_info, bool phiredswh_flag,
+		vector<string> &delta_par_names, vector<double> &delta_par_values, vector<Parameters> &delta_model_pars);
+	void set_ext_par_names(const vector<string> &numeric_par_names, const ParameterInfo &ctl_par_info);
+	bool load_ext_derivatives(RunManagerAbstract &run_manager, Eigen::MatrixXd &der_mat);
+	void make_ext_fd_runs(RunManagerAbstract &run_manager);
+	void read_ext_derivatives(const string &filename, const vector<string> &obs_names, const vector<string> &model_par_names,
+		Eigen::MatrixXd &der_mat) const;
+	void calc_ext_derivative_columns(const Eigen::MatrixXd &der_mat, RunManagerAbstract &run_manager,
+		const ParamTransformSeq &par_transform, const JacobianRun &base_run,
+		const vector<const PriorInformationRec*> &row_pi, const ParameterGroupInfo &group_info,
+		const vector<JacobianColumnRuns> &check_col_runs_vec, std::vector<Eigen::Triplet<double> > &triplet_list);
+	Parameters get_model_par_delta(const string &par_name, double derivative_par_value, const ParamTransformSeq &par_trans, const Parameters &base_model_pars) const;
+};
+
+//tracks when and at which parameter values each jacobian column was last computed from
+//perturbation runs, and picks the columns the selective jacobian refresh carries forward
+class JacRefreshTracker
+{
+public:
+	JacRefreshTracker() : force_full(false), last_full_iter(0) {}
+	//a secant update changes every column, so nothing is carried forward until the columns are perturbed again
+	void reset() { col_iter.clear(); col_numeric_pars.clear(); }
+	void set_force_full() { force_full = true; }
+	//reason the next jacobian must be computed in full, or an empty string.  Clears the force flag
+	string get_full_jac_reason(int iter, int full_iter, bool failed_pars);
+	//columns whose composite sensitivity is below sen_ratio times the largest and whose parameter has moved
+	//no more than par_change times its range since the column was computed
+	set<string> get_carry_forward_pars(const vector<string> &numeric_par_names, const vector<string> &jac_par_names,
+		const Eigen::VectorXd &css, double sen_ratio, const Parameters &numeric_pars, const Parameters &numeric_lbnd,
+		const Parameters &numeric_ubnd, double par_change) const;
+	//columns not carried forward were computed at iter from jac_numeric_pars
+	void record(int iter, const vector<string> &jac_par_names, const Parameters &jac_numeric_pars, const set<string> &carry_forward_pars);
+	int get_col_iter(const string &par_name) const;
+private:
+	bool force_full;  //phi stalled or the derivative type changed in the last iteration
+	int last_full_iter;
+	map<string, int> col_iter;
+	Parameters col_numeric_pars;
 };
 
 #endif /* JACOBIAN_1TO1H_ */
@@ -1,5 +1,7 @@
 #include <random>
 #include <iomanip>
+#include <algorithm>
+#include <cmath>
 #include <unordered_set>
 #include <iterator>
 #include "Ensemble.h"
@@ -17,17 +19,20 @@ bool Localizer::initialize(PerformanceLog *performance_log)
 {
 	stringstream ss;
 	how == How::OBSERVATIONS; //set this for the case with no localization
-	string filename = pest_scenario_ptr->get_pestpp_options().get_ies_localizer();
-	if (filename.size() == 0)
+	use_distance = false;
+	const PestppOptions &ppo = pest_scenario_ptr->get_pestpp_options();
+	string filename = ppo.get_ies_localizer();
+	bool has_coords = (ppo.get_ies_loc_par_coords().size() > 0) || (ppo.get_ies_loc_obs_coords().size() > 0);
+	if ((filename.size() == 0) && (!has_coords))
 	{
 		use = false;
 		return false;
 	}
+	if ((filename.size() > 0) && (has_coords))
+		throw runtime_error("Localizer::initialize() error: 'ies_localizer' and 'ies_loc_par_coords'/'ies_loc_obs_coords' can not both be used");
 	use = true;
-	
-	mat.from_file(filename);
-	
-	string how_str = pest_scenario_ptr->get_pestpp_options().get_ies_localize_how();
+
+	string how_str = ppo.get_ies_localize_how();
 	if (how_str[0] == 'P')
 	{
 		how = How::PARAMETERS;
@@ -41,6 +46,14 @@ bool Localizer::initialize(PerformanceLog *performance_log)
 		throw runtime_error("Localizer.initialize(): 'ies_localize_how' must start with 'P' (pars) or 'O' (obs) not " + how_str[0]);
 	}
 
+	if (has_coords)
+	{
+		use_distance = true;
+		return initialize_distance(performance_log);
+	}
+
+	mat.from_file(filename);
+
 	//error checking and building up container of names
 	vector<string> names = pest_scenario_ptr->get_ctl_ordered_adj_par_names();
 	set<string> par_names(names.begin(), names.end());
@@ -81,6 +94,7 @@ bool Localizer::initialize(PerformanceLog *performance_log)
 	for (int i=0;i<mat.nrow();i++)
 	{
 		o = row_names[i];
+		row_name2idx[o] = i;
 		if (obs_names.find(o) != obs_names.end())
 		{
 			obs2row_map[o] = i;
@@ -142,6 +156,7 @@ bool Localizer::initialize(PerformanceLog *performance_log)
 	for (int i=0;i<mat.ncol();++i)
 	{
 		p = col_names[i];
+		col_name2idx[p] = i;
 		if (par_names.find(p) != par_names.end())
 		{
 			par2col_map[p] = i;
@@ -269,46 +284,279 @@ bool Localizer::initialize(PerformanceLog *performance_log)
 	return true;
 }
 
-Eigen::MatrixXd Localizer::get_localizing_obs_hadamard_matrix(int num_reals, string col_name, vector<string> &obs_names)
+bool Localizer::initialize_distance(PerformanceLog *performance_log)
 {
+	stringstream ss;
+	const PestppOptions &ppo = pest_scenario_ptr->get_pestpp_options();
+	if ((ppo.get_ies_loc_par_coords().size() == 0) || (ppo.get_ies_loc_obs_coords().size() == 0))
+		throw runtime_error("Localizer::initialize() error: distance-based localization requires both 'ies_loc_par_coords' and 'ies_loc_obs_coords'");
+	loc_distance = ppo.get_ies_loc_distance();
+	if (loc_distance <= 0.0)
+		throw runtime_error("Localizer::initialize() error: 'ies_loc_distance' must be greater than zero for distance-based localization");
+	string taper_str = ppo.get_ies_loc_taper();
+	if ((taper_str.size() > 0) && (taper_str[0] == 'G'))
+		taper = Taper::GASPARI_COHN;
+	else if ((taper_str.size() > 0) && (taper_str[0] == 'B'))
+		taper = Taper::BOXCAR;
+	else
+		throw runtime_error("Localizer::initialize() error: 'ies_loc_taper' must be 'gaspari_cohn' or 'boxcar', not " + taper_str);
 
-	vector<double> values;
-	vector<string> mat_cols = mat.get_col_names();
-	vector<string>::iterator it = find(mat_cols.begin(), mat_cols.end(), col_name);
-	if (it == mat_cols.end())
-		throw runtime_error("Localizer::get_localizing_obs_hadamard_matrix() error: col_name not found in localizer matrix: " + col_name);
-	int idx = it - mat_cols.begin();
-	Eigen::VectorXd mat_vec = mat.e_ptr()->col(idx);
-	int col_idx;
-	Eigen::MatrixXd loc(obs_names.size(), num_reals);
-	for (int i=0;i<obs_names.size();i++)
+	vector<string> par_names = pest_scenario_ptr->get_ctl_ordered_adj_par_names();
+	vector<string> obs_names = pest_scenario_ptr->get_ctl_ordered_nz_obs_names();
+	performance_log->log_event("reading localization coordinates");
+	read_coords(ppo.get_ies_loc_par_coords(), par_names, par2coord_map, par_coords);
+	read_coords(ppo.get_ies_loc_obs_coords(), obs_names, obs2coord_map, obs_coords);
+
+	//only the neighbour lists are stored, the taper values are calculated when each case is solved
+	performance_log->log_event("building distance-based localization cases");
+	double radius = taper_support(taper, loc_distance);
+	const vector<string> &case_names = (how == How::PARAMETERS) ? par_names : obs_names;
+	const vector<string> &nbr_names = (how == How::PARAMETERS) ? obs_names : par_names;
+	const vector<array<double, 3>> &case_coords = (how == How::PARAMETERS) ? par_coords : obs_coords;
+	const vector<array<double, 3>> &nbr_coords = (how == How::PARAMETERS) ? obs_coords : par_coords;
+	KDTree tree(nbr_coords);
+	vector<int> nbrs;
+	vector<string> vnbr;
+	size_t total_nbrs = 0;
+	for (int i = 0; i < case_names.size(); ++i)
 	{
-		col_idx = obs2row_map[obs_names[i]];
-		loc.row(i).setConstant(mat_vec[col_idx]);
+		tree.radius_search(case_coords[i], radius, nbrs);
+		sort(nbrs.begin(), nbrs.end());
+		vnbr.clear();
+		for (auto j : nbrs)
+		{
+			if (taper_value(taper, distance(case_coords[i], nbr_coords[j]), loc_distance) > 0.0)
+				vnbr.push_back(nbr_names[j]);
+		}
+		if (vnbr.size() == 0)
+			continue;
+		total_nbrs += vnbr.size();
+		if (how == How::PARAMETERS)
+			localizer_map[case_names[i]] = pair<vector<string>, vector<string>>(vnbr, vector<string>{ case_names[i] });
+		else
+			localizer_map[case_names[i]] = pair<vector<string>, vector<string>>(vector<string>{ case_names[i] }, vnbr);
+	}
+	if (localizer_map.size() == 0)
+		throw runtime_error("Localizer::initialize() error: no parameter/observation pairs are within the localization distance");
+	ss << "distance-based localization: " << localizer_map.size() << " of " << case_names.size() << " cases have neighbours, average of ";
+	ss << double(total_nbrs) / double(localizer_map.size()) << " neighbours per case";
+	performance_log->log_event(ss.str());
+	return true;
+}
 
+void Localizer::read_coords(const string &filename, const vector<string> &names, unordered_map<string, int> &name2coord_map,
+	vector<array<double, 3>> &coords)
+{
+	ifstream in(filename);
+	if (!in.good())
+		throw runtime_error("Localizer::read_coords() error: could not open coordinates file " + filename);
+	unordered_map<string, int> name_map;
+	for (int i = 0; i < names.size(); ++i)
+		name_map[names[i]] = i;
+	coords.assign(names.size(), array<double, 3>{ { 0.0, 0.0, 0.0 } });
+	vector<bool> found(names.size(), false);
+	vector<string> tokens, dups;
+	string line;
+	int lcount = 0;
+	while (getline(in, line))
+	{
+		lcount++;
+		pest_utils::strip_ip(line);
+		if ((line.size() == 0) || (line[0] == '#'))
+			continue;
+		tokens.clear();
+		pest_utils::tokenize(line, tokens, ", \t");
+		if ((tokens.size() < 3) || (tokens.size() > 4))
+			throw runtime_error("Localizer::read_coords() error: expecting 'name,x,y[,z]' on line " + to_string(lcount) + " of " + filename);
+		array<double, 3> xyz{ { 0.0, 0.0, 0.0 } };
+		try
+		{
+			for (int j = 1; j < tokens.size(); ++j)
+				pest_utils::convert_ip(tokens[j], xyz[j - 1]);
+		}
+		catch (...)
+		{
+			//a header line is allowed as the first record
+			if (lcount == 1)
+				continue;
+			throw runtime_error("Localizer::read_coords() error: unable to convert coordinates on line " + to_string(lcount) + " of " + filename);
+		}
+		pest_utils::upper_ip(tokens[0]);
+		unordered_map<string, int>::iterator it = name_map.find(tokens[0]);
+		if (it == name_map.end())
+			continue;
+		if (found[it->second])
+			dups.push_back(tokens[0]);
+		found[it->second] = true;
+		coords[it->second] = xyz;
 	}
-	return loc;
+	in.close();
+	stringstream ss;
+	if (dups.size() > 0)
+	{
+		ss << "Localizer::read_coords() error: the following names are listed more than once in " << filename << ": ";
+		for (auto &d : dups)
+			ss << d << ',';
+		throw runtime_error(ss.str());
+	}
+	vector<string> missing;
+	for (int i = 0; i < names.size(); ++i)
+		if (!found[i])
+			missing.push_back(names[i]);
+	if (missing.size() > 0)
+	{
+		ss << "Localizer::read_coords() error: the following names do not have coordinates in " << filename << ": ";
+		for (auto &m : missing)
+			ss << m << ',';
+		throw runtime_error(ss.str());
+	}
+	name2coord_map = name_map;
+}
 
+double Localizer::distance(const array<double, 3> &p1, const array<double, 3> &p2)
+{
+	double dx = p1[0] - p2[0], dy = p1[1] - p2[1], dz = p1[2] - p2[2];
+	return sqrt(dx * dx + dy * dy + dz * dz);
 }
 
+double Localizer::taper_support(Taper taper, double loc_distance)
+{
+	//gaspari-cohn goes to zero at twice the localization distance
+	if (taper == Taper::GASPARI_COHN)
+		return 2.0 * loc_distance;
+	return loc_distance;
+}
+
+double Localizer::taper_value(Taper taper, double dist, double loc_distance)
+{
+	if (taper == Taper::BOXCAR)
+		return (dist <= loc_distance) ? 1.0 : 0.0;
+	//Gaspari and Cohn (1999) eq. 4.10, compactly supported fifth-order piecewise rational function
+	double r = dist / loc_distance;
+	if (r <= 1.0)
+		return (((-0.25 * r + 0.5) * r + 0.625) * r - 5.0 / 3.0) * r * r + 1.0;
+	else if (r < 2.0)
+		return ((((r / 12.0 - 0.5) * r + 0.625) * r + 5.0 / 3.0) * r - 5.0) * r + 4.0 - 2.0 / (3.0 * r);
+	return 0.0;
+}
 
-Eigen::MatrixXd Localizer::get_localizing_par_hadamard_matrix(int num_reals, string row_name, vector<string> &par_names)
+Eigen::VectorXd Localizer::get_localizing_obs_vector(const string &col_name, const vector<string> &obs_names)
 {
+	Eigen::VectorXd loc(obs_names.size());
+	if (use_distance)
+	{
+		unordered_map<string, int>::iterator it = par2coord_map.find(col_name);
+		if (it == par2coord_map.end())
+			throw runtime_error("Localizer::get_localizing_obs_vector() error: par name not found in localization coordinates: " + col_name);
+		const array<double, 3> &par_xyz = par_coords[it->second];
+		for (int i = 0; i < obs_names.size(); i++)
+			loc[i] = taper_value(taper, distance(par_xyz, obs_coords[obs2coord_map.at(obs_names[i])]), loc_distance);
+		return loc;
+	}
+	unordered_map<string, int>::iterator it = col_name2idx.find(col_name);
+	if (it == col_name2idx.end())
+		throw runtime_error("Localizer::get_localizing_obs_vector() error: col_name not found in localizer matrix: " + col_name);
+	Eigen::VectorXd mat_vec = mat.e_ptr()->col(it->second);
+	for (int i=0;i<obs_names.size();i++)
+	{
+		loc[i] = mat_vec[obs2row_map.at(obs_names[i])];
+	}
+	return loc;
+
+}
 
-	vector<double> values;
-	vector<string> mat_rows = mat.get_row_names();
-	vector<string>::iterator it = find(mat_rows.begin(), mat_rows.end(), row_name);
-	if (it == mat_rows.end())
-		throw runtime_error("Localizer::get_localizing_par_hadamard_matrix() error: row_name not found in localizer matrix: " + row_name);
-	int idx = it - mat_rows.begin();
-	Eigen::VectorXd mat_vec = mat.e_ptr()->row(idx);
-	int col_idx;
-	Eigen::MatrixXd loc(par_names.size(), num_reals);
-	for (int i = 0; i<par_names.size(); i++)
+
+Eigen::VectorXd Localizer::get_localizing_par_vector(const string &row_name, const vector<string> &par_names)
+{
+	Eigen::VectorXd loc(par_names.size());
+	if (use_distance)
 	{
-		col_idx = par2col_map[par_names[i]];
-		loc.row(i).setConstant(mat_vec[col_idx]);
+		unordered_map<string, int>::iterator it = obs2coord_map.find(row_name);
+		if (it == obs2coord_map.end())
+			throw runtime_error("Localizer::get_localizing_par_vector() error: obs name not found in localization coordinates: " + row_name);
+		const array<double, 3> &obs_xyz = obs_coords[it->second];
+		for (int i = 0; i < par_names.size(); i++)
+			loc[i] = taper_value(taper, distance(obs_xyz, par_coords[par2coord_map.at(par_names[i])]), loc_distance);
+		return loc;
+	}
+	unordered_map<string, int>::iterator it = row_name2idx.find(row_name);
+	if (it == row_name2idx.end())
+		throw runtime_error("Localizer::get_localizing_par_vector() error: row_name not found in localizer matrix: " + row_name);
+	Eigen::VectorXd mat_vec = mat.e_ptr()->row(it->second);
+	for (int i = 0; i < par_names.size(); i++)
+	{
+		loc[i] = mat_vec[par2col_map.at(par_names[i])];
 	}
 	return loc;
 
-}
\ No newline at end of file
+}
+
+KDTree::KDTree(const vector<array<double, 3>> &_points) : points(_points)
+{
+	idx.resize(points.size());
+	split_dim.assign(points.size(), 0);
+	for (int i = 0; i < idx.size(); ++i)
+		idx[i] = i;
+	build(0, idx.size());
+}
+
+void KDTree::build(int first, int last)
+{
+	//implicit tree: the median of [first,last) is the node, the halves are the subtrees
+	if (last - first <= 1)
+		return;
+	double lo[3] = { 1.0e+300, 1.0e+300, 1.0e+300 };
+	double hi[3] = { -1.0e+300, -1.0e+300, -1.0e+300 };
+	for (int i = first; i < last; ++i)
+	{
+		for (int d = 0; d < 3; ++d)
+		{
+			lo[d] = min(lo[d], points[idx[i]][d]);
+			hi[d] = max(hi[d], points[idx[i]][d]);
+		}
+	}
+	int dim = 0;
+	for (int d = 1; d < 3; ++d)
+		if ((hi[d] - lo[d]) > (hi[dim] - lo[dim]))
+			dim = d;
+	int mid = first + (last - first) / 2;
+	nth_element(idx.begin() + first, idx.begin() + mid, idx.begin() + last,
+		[this, dim](int a, int b) { return points[a][dim] < points[b][dim]; });
+	split_dim[mid] = dim;
+	build(first, mid);
+	build(mid + 1, last);
+}
+
+void KDTree::radius_search(const array<double, 3> &query, double radius, vector<int> &result) const
+{
+	result.clear();
+	search(0, idx.size(), query, radius * radius, result);
+}
+
+void KDTree::search(int first, int last, const array<double, 3> &query, double radius2, vector<int> &result) const
+{
+	if (last <= first)
+		return;
+	int mid = first + (last - first) / 2;
+	const array<double, 3> &p = points[idx[mid]];
+	double dx = p[0] - query[0], dy = p[1] - query[1], dz = p[2] - query[2];
+	if ((dx * dx + dy * dy + dz * dz) <= radius2)
+		result.push_back(idx[mid]);
+	if (last - first == 1)
+		return;
+	int dim = split_dim[mid];
+	double diff = query[dim] - p[dim];
+	//the near side always needs searching, the far side only if the split plane is within the radius
+	if (diff <= 0.0)
+	{
+		search(first, mid, query, radius2, result);
+		if (diff * diff <= radius2)
+			search(mid + 1, last, query, radius2, result);
+	}
+	else
+	{
+		search(mid + 1, last, query, radius2, result);
+		if (diff * diff <= radius2)
+			search(first, mid, query, radius2, result);
+	}
+}
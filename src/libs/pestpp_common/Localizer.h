@@ -2,7 +2,9 @@
 #define LOCALIZER_H_
 
 #include <map>
+#include <array>
 #include <random>
+#include <unordered_map>
 #include <Eigen/Dense>
 #include <Eigen/Sparse>
 #include "FileManager.h"
@@ -16,26 +18,61 @@
 
 
 
+//static k-d tree over 3-d points (2-d points have z = 0) used for neighbour searches
+class KDTree
+{
+public:
+	KDTree() { ; }
+	KDTree(const vector<array<double, 3>> &_points);
+	//indices of all points within radius of the query point
+	void radius_search(const array<double, 3> &query, double radius, vector<int> &result) const;
+	int size() const { return points.size(); }
+private:
+	vector<array<double, 3>> points;
+	vector<int> idx;
+	vector<int> split_dim;
+	void build(int first, int last);
+	void search(int first, int last, const array<double, 3> &query, double radius2, vector<int> &result) const;
+};
+
 class Localizer
 {
 public:
 	enum How { PARAMETERS, OBSERVATIONS};
+	enum Taper { GASPARI_COHN, BOXCAR };
 	Localizer() { ; }
 	Localizer(Pest *_pest_scenario_ptr) { pest_scenario_ptr = _pest_scenario_ptr; }
 	bool initialize(PerformanceLog *performance_log);
-	map<string,pair<vector<string>, vector<string>>> get_localizer_map() { return localizer_map; }
+	const map<string,pair<vector<string>, vector<string>>>& get_localizer_map() const { return localizer_map; }
 	void set_pest_scenario(Pest *_pest_scenario_ptr) { pest_scenario_ptr = _pest_scenario_ptr; }
-	Eigen::MatrixXd get_localizing_obs_hadamard_matrix(int num_reals,string col_name,vector<string> &obs_names);
-	Eigen::MatrixXd get_localizing_par_hadamard_matrix(int num_reals, string row_name, vector<string> &par_names);
+	//localizing factors for each obs in obs_names for the localizer column (parameter) col_name
+	Eigen::VectorXd get_localizing_obs_vector(const string &col_name, const vector<string> &obs_names);
+	//localizing factors for each par in par_names for the localizer row (observation) row_name
+	Eigen::VectorXd get_localizing_par_vector(const string &row_name, const vector<string> &par_names);
 	How get_how() { return how; }
 	bool get_use() { return use; }
+	bool get_use_distance() { return use_distance; }
+	double get_distance() { return loc_distance; }
+	static double taper_value(Taper taper, double dist, double loc_distance);
+	static double taper_support(Taper taper, double loc_distance);
 private:
 	bool use;
+	bool use_distance;
 	How how;
+	Taper taper;
+	double loc_distance;
 	Pest * pest_scenario_ptr;
 	Mat mat;
 	map<string,pair<vector<string>, vector<string>>> localizer_map;
-	map<string, int> obs2row_map, par2col_map;
+	unordered_map<string, int> obs2row_map, par2col_map;
+	unordered_map<string, int> row_name2idx, col_name2idx;
+	unordered_map<string, int> obs2coord_map, par2coord_map;
+	vector<array<double, 3>> obs_coords, par_coords;
+
+	bool initialize_distance(PerformanceLog *performance_log);
+	void read_coords(const string &filename, const vector<string> &names, unordered_map<string, int> &name2coord_map,
+		vector<array<double, 3>> &coords);
+	double distance(const array<double, 3> &p1, const array<double, 3> &p2);
 };
 
 #endif
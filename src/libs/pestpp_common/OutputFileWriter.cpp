@@ -836,8 +836,8 @@ void OutputFileWriter::write_svd_iteration(int iteration_no)
 
 void OutputFileWriter::write_jco(bool isBaseIter, string ext, const Jacobian &jco)
 {
-
-	ofstream &jout = file_manager.open_ofile_ext(ext, ios::out | ios::binary);
+	// only one jacobian file is written at a time
+	wait_for_jco_write();
 
 	vector<string> obs_names;
 	vector<string> par_names;
@@ -869,60 +869,48 @@ void OutputFileWriter::write_jco(bool isBaseIter, string ext, const Jacobian &jc
 		obs_names = jco.get_sim_obs_names();
 	}
 
-	int n_par = par_names.size();
-	int n_obs_and_pi = obs_names.size();
-	int n;
-	int tmp;
-	double data;
-	char par_name[12];
-	char obs_name[20];
-
-	// write header
-	tmp = -n_par;
-	jout.write((char*)&tmp, sizeof(tmp));
-	tmp = -n_obs_and_pi;
-	jout.write((char*)&tmp, sizeof(tmp));
-
-	//write number nonzero elements in jacobian (includes prior information)
-	//n = matrix.nonZeros();
-	n = jco.get_nonzero();
-	jout.write((char*)&n, sizeof(n));
-
-	//write matrix
-	n = 0;
-	map<string, double>::const_iterator found_pi_par;
-	map<string, double>::const_iterator not_found_pi_par;
-
-	//Eigen::SparseMatrix<double> matrix_T(matrix);
 	Eigen::SparseMatrix<double> matrix_T;
 	if (isBaseIter)
 		matrix_T = jco.get_matrix(obs_names,par_names);
 	else
 		matrix_T = jco.get_matrix();
-	matrix_T.transpose();
-	for (int icol = 0; icol<jco.get_outersize(); ++icol)
+
+	string filename = file_manager.build_filename(ext);
+	if (pest_scenario.get_pestpp_options().get_jco_background_write())
 	{
-		for (SparseMatrix<double>::InnerIterator it(matrix_T, icol); it; ++it)
+		// the writer thread owns copies of the names and matrix so the caller is free to
+		// modify the jacobian while the file is being written
+		jco_write_future = std::async(std::launch::async, [](string filename, vector<string> obs_names,
+			vector<string> par_names, Eigen::SparseMatrix<double> matrix)
 		{
-			data = it.value();
-			n = it.row() + 1 + it.col() * matrix_T.rows();
-			jout.write((char*)&(n), sizeof(n));
-			jout.write((char*)&(data), sizeof(data));
-		}
+			write_binary(filename, obs_names, par_names, matrix);
+		}, filename, std::move(obs_names), std::move(par_names), std::move(matrix_T)).share();
 	}
-	//save parameter names
-	for (vector<string>::const_iterator b = par_names.begin(), e = par_names.end();
-		b != e; ++b) {
-		string_to_fortran_char(*b, par_name, 12);
-		jout.write(par_name, 12);
+	else
+	{
+		write_binary(filename, obs_names, par_names, matrix_T);
 	}
+}
 
-	//save observation and Prior information names
-	for (vector<string>::const_iterator b = obs_names.begin(), e = obs_names.end();
-		b != e; ++b) {
-		string_to_fortran_char(*b, obs_name, 20);
-		jout.write(obs_name, 20);
+void OutputFileWriter::wait_for_jco_write()
+{
+	if (jco_write_future.valid())
+	{
+		std::shared_future<void> pending_write = jco_write_future;
+		jco_write_future = std::shared_future<void>();
+		// rethrows any exception raised while writing
+		pending_write.get();
+	}
+}
+
+OutputFileWriter::~OutputFileWriter()
+{
+	try
+	{
+		wait_for_jco_write();
+	}
+	catch (exception &e)
+	{
+		cerr << "error writing jacobian file: " << e.what() << endl;
 	}
-	//save observation names (part 2 prior information)
-	file_manager.close_file(ext);
 }
@@ -22,6 +22,7 @@
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <future>
 #include<Eigen/Dense>
 #include<Eigen/Sparse>
 #include "FileManager.h"
@@ -76,9 +77,13 @@ public:
 	void write_sen_iter(int iter, map<string, double> &ctl_par_sens);
 
 	void write_jco(bool isBaseIter, string ext, const Jacobian &jco);
+	/** @brief Blocks until a jacobian file being written in the background is complete
+	*/
+	void wait_for_jco_write();
 
 	void write_upgrade(int iteration, int is_super, double lambda, double scale_factor, Parameters &pars);
 	void write_jco_run_id(int groupid, std::map<string, vector<int>> &par_run_map);
+	~OutputFileWriter();
 
 private:
 	FileManager &file_manager;
@@ -86,6 +91,7 @@ private:
 	std::string case_name;
 	int eigenwrite;
 	bool save_rei;
+	std::shared_future<void> jco_write_future;
 
 	void prepare_iteration_summary_files(bool restart_flag);
 	void prepare_upgrade_summary_files();
@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <sstream>
 #include <cstring>
+#include <vector>
 #include "PerformanceLog.h"
 #include "config_os.h"
 
@@ -63,6 +64,61 @@ void PerformanceLog::log_summary(const string &message, const std::string &end_t
 	fout.flush();
 }
 
+void PerformanceLog::log_perf_summary(const string &title)
+{
+	if (!perf_trace::enabled())
+		return;
+	map<string, perf_trace::SpanStats> spans;
+	map<string, int64_t> counts;
+	perf_trace::take_interval(spans, counts);
+	write_perf_table(title, spans, counts);
+}
+
+void PerformanceLog::log_perf_totals(const string &title)
+{
+	if (!perf_trace::enabled())
+		return;
+	map<string, perf_trace::SpanStats> spans;
+	map<string, int64_t> counts;
+	perf_trace::get_totals(spans, counts);
+	write_perf_table(title, spans, counts);
+}
+
+void PerformanceLog::write_perf_table(const string &title, const map<string, perf_trace::SpanStats> &spans,
+	const map<string, int64_t> &counts)
+{
+	int ind = indent();
+	fout << endl << string(ind, ' ') << title << endl;
+	fout << string(ind + 2, ' ') << left << setw(48) << "span" << " " << setw(48) << "parent" << right << setw(10) << "calls"
+		<< setw(14) << "total(sec)" << setw(14) << "mean(ms)" << setw(14) << "max(ms)" << setw(16) << "peak rss(MB)" << endl;
+	//longest total first so the expensive spans are at the top
+	vector<pair<string, perf_trace::SpanStats>> sorted_spans(spans.begin(), spans.end());
+	sort(sorted_spans.begin(), sorted_spans.end(),
+		[](const pair<string, perf_trace::SpanStats> &a, const pair<string, perf_trace::SpanStats> &b)
+		{ return a.second.total_sec > b.second.total_sec; });
+	streamsize prec = fout.precision(4);
+	for (auto &s : sorted_spans)
+	{
+		fout << string(ind + 2, ' ') << left << setw(48) << s.first << " " << setw(48) << s.second.parent << right
+			<< setw(10) << s.second.calls << setw(14) << s.second.total_sec
+			<< setw(14) << s.second.total_sec * 1000.0 / max(int64_t(1), s.second.calls)
+			<< setw(14) << s.second.max_sec * 1000.0;
+		if (s.second.peak_rss_kb > 0)
+			fout << setw(16) << double(s.second.peak_rss_kb) / 1024.0;
+		fout << endl;
+	}
+	if (!counts.empty())
+	{
+		fout << string(ind + 2, ' ') << left << setw(48) << "counter" << right << setw(16) << "value" << endl;
+		for (auto &c : counts)
+			fout << string(ind + 2, ' ') << left << setw(48) << c.first << right << setw(16) << c.second << endl;
+	}
+	fout << string(ind + 2, ' ') << "current peak rss(MB): " << double(perf_trace::peak_rss_kb()) / 1024.0 << endl;
+	fout.precision(prec);
+	fout.unsetf(ios_base::adjustfield);
+	fout.flush();
+}
+
 string PerformanceLog::time_to_string(const std::chrono::system_clock::time_point &tmp_time)
 {
 	stringstream time_str;
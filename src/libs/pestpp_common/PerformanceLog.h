@@ -5,6 +5,7 @@
 #include <fstream>
 #include <chrono>
 #include <map>
+#include "perf_trace.h"
 
 class PerformanceLog
 {
@@ -14,6 +15,10 @@ public:
 	void log_summary(const std::string &message, const std::string &end_tag, const std::string &begin_tag, int delta_indent = 0);
 	void log_blank_lines(int n = 1);
 	void add_indent(int n = 1);
+	//write the perf_trace span and counter statistics collected since the previous summary
+	void log_perf_summary(const std::string &title);
+	//write the perf_trace statistics for the whole run
+	void log_perf_totals(const std::string &title);
 	~PerformanceLog();
 private:
 	std::ofstream &fout;
@@ -27,6 +32,8 @@ private:
 	std::string time_to_string(const std::chrono::system_clock::time_point &tmp_time);
 	std::string elapsed_time_to_string(std::chrono::system_clock::time_point &current_time, std::chrono::system_clock::time_point &prev_time);
 	void writetime(std::stringstream &os, time_t tc);
+	void write_perf_table(const std::string &title, const std::map<std::string, perf_trace::SpanStats> &spans,
+		const std::map<std::string, int64_t> &counts);
 };
 
 #endif //PERFORMANCE_LOG_H_
@@ -24,12 +24,14 @@
 #include <map>
 #include <numeric>
 #include "Pest.h"
+#include "PstScenarioCache.h"
 #include "utilities.h"
 #include "pest_error.h"
 #include <sstream>
 #include "pest_data_structs.h"
 #include "Transformation.h"
 #include "FileManager.h"
+#include "FakeModel.h"
 
 
 using namespace::std;
@@ -113,6 +115,7 @@ void Pest::check_inputs(ostream &f_rec)
 	bool unfixed_par = false;
 	int par_ub = 0;
 	int par_lb = 0;
+	int n_model_der = 0;
 	bool forgive_bound = false;
 	if (control_info.noptmax == 0)
 		forgive_bound = true;
@@ -147,8 +150,20 @@ void Pest::check_inputs(ostream &f_rec)
 		{
 			par_warnings.push_back(pname + " has 'dercom' > 1, pestpp suite doesn't support 'dercom' > 1, ignoring");
 		}
+		else if ((prec->dercom == 0) && ((prec->tranform_type == ParameterRec::TRAN_TYPE::LOG) ||
+			(prec->tranform_type == ParameterRec::TRAN_TYPE::NONE)))
+		{
+			n_model_der++;
+		}
 
 	}
+	if (control_info.jacfile != 0)
+	{
+		if (model_exec_info.dercom.empty() || model_exec_info.derfile.empty())
+			par_problems.push_back("'jacfile' is not zero, but the '* derivatives command line' section is missing or incomplete");
+		else if (n_model_der == 0)
+			par_warnings.push_back("'jacfile' is not zero, but no adjustable parameters have 'dercom' = 0, all derivatives will be calculated by finite differences");
+	}
 
 	bool err = false;
 
@@ -274,7 +289,9 @@ void Pest::check_inputs(ostream &f_rec)
 
 void Pest::check_io()
 {
-
+	//the in-process fake model does not use any model interface files
+	if (FakeModel::is_fake_command(model_exec_info.comline_vec))
+		return;
 	if (model_exec_info.tplfile_vec.size() == 0)
 	{
 		cout << "Error: number of template files = 0" << endl;
@@ -361,7 +378,6 @@ int Pest::process_ctl_file(ifstream &fin, string pst_filename)
 	int sec_begin_lnum, sec_lnum;
 	double value;
 	string name;
-	string *trans_type;
 	string prior_info_string;
 	pair<string, string> pi_name_group;
 	int lnum;
@@ -395,17 +411,184 @@ int Pest::process_ctl_file(ifstream &fin, string pst_filename)
 	base_par_transform.push_back_ctl2active_ctl(t_fixed);
 	base_par_transform.push_back_active_ctl2numeric(t_log);
 	base_par_transform.push_back_active_ctl2numeric(t_auto_norm);
+
+	// the whole file is read so it can be hashed and checked against the scenario cache
+	string pst_text;
+	fin.seekg(0, ios::end);
+	streamoff pst_nbytes = fin.tellg();
+	fin.seekg(0, ios::beg);
+	if (pst_nbytes > 0)
+	{
+		pst_text.resize(size_t(pst_nbytes));
+		fin.read(&pst_text[0], pst_nbytes);
+		pst_text.resize(size_t(fin.gcount()));
+	}
+	uint64_t pst_size = pst_text.size();
+	uint64_t pst_hash = fnv1a_hash(pst_text.data(), pst_text.size());
+	string cache_filename = PstScenarioCache::get_filename(pst_filename);
+	PstScenarioCache pst_cache;
+	// the cache is only read when ++pst_cache(true) is set.  The ++ options are not parsed until
+	// the end of the file so they are scanned here; errors are reported by the full parse
+	bool use_pst_cache = false;
+	{
+		PestppOptions cache_options;
+		istringstream pst_lines(pst_text);
+		string line;
+		while (getline(pst_lines, line))
+		{
+			strip_ip(line);
+			if (line.compare(0, 2, "++") != 0)
+				continue;
+			try
+			{
+				cache_options.parce_line(line);
+			}
+			catch (exception &)
+			{
+			}
+		}
+		use_pst_cache = cache_options.get_pst_cache();
+	}
+	bool from_cache = use_pst_cache && pst_cache.read(cache_filename, pst_size, pst_hash);
+	if (from_cache)
+	{
+		cout << "using control file cache " << cache_filename << endl;
+		pst_text.clear();
+	}
 #ifndef _DEBUG
 	try {
 #endif
 	prior_info_string = "";
-	for(lnum=1, sec_begin_lnum=1; getline(fin, line); ++ lnum)
+
+	// add a parameter data record and build its transformations
+	auto add_ctl_par = [&](const string &name, const ParameterRec &pi)
+	{
+		ctl_ordered_par_names.push_back(name);
+		if ((pi.tranform_type == ParameterRec::TRAN_TYPE::LOG) || (pi.tranform_type == ParameterRec::TRAN_TYPE::NONE))
+			n_adj_par++;
+		ctl_parameter_info.insert(name, pi);
+		ctl_parameters.insert(name, pi.init_value);
+		base_group_info.insert_parameter_link(name, pi.group);
+		if (pi.tranform_type == ParameterRec::TRAN_TYPE::FIXED) {
+			t_fixed->insert(name, pi.init_value);}
+		else if (pi.tranform_type == ParameterRec::TRAN_TYPE::LOG) {
+			t_log->insert(name);
+		}
+		if (pi.offset!=0) {
+			t_offset->insert(name, pi.offset);
+		}
+		if (pi.scale !=1) {
+			t_scale->insert(name, pi.scale);
+		}
+	};
+	auto add_ctl_obs = [&](const string &name, double obs_value, const ObservationRec &obs_i)
 	{
+		ctl_ordered_obs_names.push_back(name);
+		observation_info.observations[name] = obs_i;
+		observation_values.insert(name, obs_value);
+	};
+
+	const vector<PstScenarioCache::Entry> &cache_entries = pst_cache.get_entries();
+	size_t text_pos = 0;
+	size_t entry_idx = 0;
+	size_t par_rec_idx = 0;
+	size_t obs_rec_idx = 0;
+	vector<pair<size_t, size_t> > fields;
+	string field_str;
+	for(lnum=0, sec_begin_lnum=1; ; )
+	{
+		if (from_cache)
+		{
+			if (entry_idx == cache_entries.size())
+				break;
+			const PstScenarioCache::Entry &entry = cache_entries[entry_idx++];
+			if (entry.type == PstScenarioCache::EntryType::PAR_BLOCK)
+			{
+				for (int i = 0; i < entry.count; ++i, ++par_rec_idx)
+					add_ctl_par(pst_cache.get_par_names()[par_rec_idx], pst_cache.get_par_recs()[par_rec_idx]);
+				continue;
+			}
+			else if (entry.type == PstScenarioCache::EntryType::OBS_BLOCK)
+			{
+				for (int i = 0; i < entry.count; ++i, ++obs_rec_idx)
+					add_ctl_obs(pst_cache.get_obs_names()[obs_rec_idx], pst_cache.get_obs_values()[obs_rec_idx],
+						pst_cache.get_obs_recs()[obs_rec_idx]);
+				continue;
+			}
+			lnum = entry.lnum;
+			line = entry.line;
+		}
+		else
+		{
+			if (text_pos >= pst_text.size())
+				break;
+			size_t eol = pst_text.find('\n', text_pos);
+			if (eol == string::npos)
+				eol = pst_text.size();
+			line.assign(pst_text, text_pos, eol - text_pos);
+			text_pos = eol + 1;
+			++lnum;
+		}
 		strip_ip(line);
+		sec_lnum = lnum - sec_begin_lnum;
+
+		// parameter and observation data records are split and converted in place
+		// instead of through upper_cp/tokenize/convert_ip
+		if ((!from_cache) && (lnum > 1) && (line.size() > 0) && (line[0] != '#') && (line[0] != '*') &&
+			(line.compare(0, 2, "++") != 0))
+		{
+			if ((section == "PARAMETER DATA") && (sec_lnum <= num_par))
+			{
+				split_fields(line, fields);
+				if ((fields.size() < 9) || ((control_info.numcom > 1) && (fields.size() < 10)))
+					throw PestConversionError(line, ": too few entries for a parameter data record");
+				ParameterRec pi;
+				field_to_upper(line, fields[0], name);
+				field_to_upper(line, fields[1], field_str);
+				field_to_upper(line, fields[2], pi.chglim);
+				pi.init_value = field_to_double(line, fields[3]);
+				pi.lbnd = field_to_double(line, fields[4]);
+				pi.ubnd = field_to_double(line, fields[5]);
+				field_to_upper(line, fields[6], pi.group);
+				pi.scale = field_to_double(line, fields[7]);
+				pi.offset = field_to_double(line, fields[8]);
+				if ((control_info.numcom > 1) || ((control_info.jacfile != 0) && (fields.size() >= 10)))
+					pi.dercom = field_to_int(line, fields[9]);
+				else
+					pi.dercom = 1;
+				if (field_str == "FIXED")
+					pi.tranform_type = ParameterRec::TRAN_TYPE::FIXED;
+				else if (field_str == "LOG")
+					pi.tranform_type = ParameterRec::TRAN_TYPE::LOG;
+				else if (field_str == "TIED")
+					pi.tranform_type = ParameterRec::TRAN_TYPE::TIED;
+				else
+					pi.tranform_type = ParameterRec::TRAN_TYPE::NONE;
+				add_ctl_par(name, pi);
+				pst_cache.add_par_block();
+				continue;
+			}
+			else if (section == "OBSERVATION DATA")
+			{
+				split_fields(line, fields);
+				if (fields.size() < 4)
+					throw PestConversionError(line, ": too few entries for an observation data record");
+				ObservationRec obs_i;
+				field_to_upper(line, fields[0], name);
+				value = field_to_double(line, fields[1]);
+				obs_i.weight = field_to_double(line, fields[2]);
+				field_to_upper(line, fields[3], obs_i.group);
+				add_ctl_obs(name, value, obs_i);
+				pst_cache.add_obs_block();
+				continue;
+			}
+		}
+		if ((!from_cache) && (line.size() > 0) && (line[0] != '#'))
+			pst_cache.add_line(lnum, line);
+
 		line_upper = upper_cp(line);
 		tokens.clear();
 		tokenize(line_upper, tokens);
-		sec_lnum = lnum - sec_begin_lnum;
 		
 		if (lnum == 1)
 		{
@@ -453,6 +636,14 @@ int Pest::process_ctl_file(ifstream &fin, string pst_filename)
 			else if (sec_lnum == 2)
 			{
 				convert_ip(tokens[0], num_par);
+				ctl_ordered_par_names.reserve(num_par);
+				if (tokens.size() > 1)
+				{
+					//only used to size the name vector, so a bad value is not an error here.
+					//the hashed containers are not reserved since that changes their iteration order
+					long num_obs = max(strtol(tokens[1].c_str(), nullptr, 10), 0L);
+					ctl_ordered_obs_names.reserve(num_obs);
+				}
 			}
 			else if (sec_lnum == 3)
 			{
@@ -543,66 +734,7 @@ int Pest::process_ctl_file(ifstream &fin, string pst_filename)
 		else if (section == "PARAMETER DATA")
 		{
 			if (sec_lnum <= num_par) {
-				double scale;
-				double offset;
-				ParameterRec pi;
-				name = tokens[0];
-				trans_type = &tokens[1];
-				convert_ip(tokens[2], pi.chglim);
-				convert_ip(tokens[3], pi.init_value);
-				convert_ip(tokens[4], pi.lbnd);
-				convert_ip(tokens[5], pi.ubnd);
-				convert_ip(tokens[6], pi.group);
-				convert_ip(tokens[7], scale);
-				convert_ip(tokens[8], offset);
-				if (control_info.numcom > 1)
-					convert_ip(tokens[9], pi.dercom);
-				else
-					pi.dercom = 1;
-				pi.scale = scale;
-				pi.offset = offset;
-				// add parameters to model parameter and paramter_info datasets
-				ctl_ordered_par_names.push_back(name);
-				if (*trans_type == "FIXED")
-				{
-					pi.tranform_type = ParameterRec::TRAN_TYPE::FIXED;
-				}
-				else if (*trans_type == "LOG")
-				{
-					pi.tranform_type = ParameterRec::TRAN_TYPE::LOG;
-					n_adj_par++;
-				}
-				else if (*trans_type == "TIED")
-				{
-					pi.tranform_type = ParameterRec::TRAN_TYPE::TIED;
-				}
-				else if (*trans_type == "NONE")
-				{
-					pi.tranform_type = ParameterRec::TRAN_TYPE::NONE;
-					n_adj_par++;
-				}
-				else
-				{
-					pi.tranform_type = ParameterRec::TRAN_TYPE::NONE;
-					assert(true);
-					n_adj_par++;
-				}
-				ctl_parameter_info.insert(name, pi);
-				ctl_parameters.insert(name, pi.init_value);
-				base_group_info.insert_parameter_link(name, pi.group);
-
-				// build appropriate transformations
-				if (*trans_type == "FIXED") {
-					t_fixed->insert(name, pi.init_value);}
-				else if (*trans_type == "LOG") {
-					t_log->insert(name);
-				}
-				if (offset!=0) {
-					t_offset->insert(name, offset);
-				}
-				if (scale !=1) {
-					t_scale->insert(name, scale);
-				}
+				//parameter data records are processed above
 			}
 			// Get rest of information for tied paramters
 			else {
@@ -630,18 +762,6 @@ int Pest::process_ctl_file(ifstream &fin, string pst_filename)
 				ctl_ordered_obs_group_names.push_back(name);
 			}
 		}
-		else if (section == "OBSERVATION DATA")
-		{
-			ObservationRec obs_i;
-			name = tokens[0];
-			convert_ip(tokens[1], value);
-			convert_ip(tokens[2], obs_i.weight);
-			obs_i.group = tokens[3];
-			ctl_ordered_obs_names.push_back(name);
-			observation_info.observations[name] = obs_i;
-			observation_values.insert(name, value);
-		}
-
 		else if (section == "PRIOR INFORMATION")
 		{
 			//This section processes the prior information.  It does not write out the
@@ -685,6 +805,13 @@ int Pest::process_ctl_file(ifstream &fin, string pst_filename)
 		{
 			model_exec_info.comline_vec.push_back(line);
 		}
+		else if (section == "DERIVATIVES COMMAND LINE")
+		{
+			if (sec_lnum == 1)
+				model_exec_info.dercom = line;
+			else if (sec_lnum == 2)
+				model_exec_info.derfile = line;
+		}
 		else if (section == "MODEL INPUT/OUTPUT" )
 		{
 			vector<string> tokens_case_sen;
@@ -803,21 +930,40 @@ int Pest::process_ctl_file(ifstream &fin, string pst_filename)
 	pestpp_options.set_parcov_scale_fac(-999.0);
 	pestpp_options.set_jac_scale(true);
 	pestpp_options.set_upgrade_augment(true);
+	pestpp_options.set_jtqj_num_threads(0);
+	pestpp_options.set_jac_num_threads(0);
 	pestpp_options.set_opt_obj_func("");
 	pestpp_options.set_opt_coin_log(true);
 	pestpp_options.set_opt_skip_final(false);
+	pestpp_options.set_opt_lp_warm_start(true);
 	pestpp_options.set_opt_std_weights(false);
 	pestpp_options.set_opt_dec_var_groups(vector<string>());
 	pestpp_options.set_opt_ext_var_groups(vector<string>());
 	pestpp_options.set_opt_constraint_groups(vector<string>());
 	pestpp_options.set_opt_risk(0.5);
+	pestpp_options.set_opt_risk_sweep(vector<double>());
+	pestpp_options.set_opt_obj_sweep_file(string());
 	pestpp_options.set_opt_direction(1.0);
 	pestpp_options.set_opt_iter_tol(0.001);
 	pestpp_options.set_opt_recalc_fosm_every(1);
 	pestpp_options.set_opt_iter_derinc_fac(1.0);
 	pestpp_options.set_opt_include_bnd_pi(true);
 	pestpp_options.set_hotstart_resfile(string());
+	pestpp_options.set_de_async(false);
+	pestpp_options.set_jco_background_write(false);
+	pestpp_options.set_reg_weight_spectral(false);
+	pestpp_options.set_pst_cache(false);
+	pestpp_options.set_perf_trace(false);
+	pestpp_options.set_panther_metrics_interval(0.0);
+	pestpp_options.set_panther_metrics_port(0);
 	pestpp_options.set_upgrade_bounds("ROBUST");
+	pestpp_options.set_jac_update("NONE");
+	pestpp_options.set_jac_update_phi_ratio(0.5);
+	pestpp_options.set_jac_update_max_iter(3);
+	pestpp_options.set_jac_refresh_sen_ratio(0.0);
+	pestpp_options.set_jac_refresh_par_change(0.05);
+	pestpp_options.set_jac_refresh_full_iter(4);
+	pestpp_options.set_der_check_npar(2);
 	pestpp_options.set_ies_par_csv("");
 	pestpp_options.set_ies_obs_csv("");
 	pestpp_options.set_ies_obs_restart_csv("");
@@ -837,6 +983,7 @@ int Pest::process_ctl_file(ifstream &fin, string pst_filename)
 	pestpp_options.set_ies_enforce_bounds(true);
 	pestpp_options.set_par_sigma_range(4.0);
 	pestpp_options.set_ies_save_binary(false);
+	pestpp_options.set_ies_checkpoint(false);
 	pestpp_options.set_ies_localizer("");
 	pestpp_options.set_ies_accept_phi_fac(1.05);
 	pestpp_options.set_ies_lambda_inc_fac(10.0);
@@ -845,6 +992,10 @@ int Pest::process_ctl_file(ifstream &fin, string pst_filename)
 	pestpp_options.set_ies_weight_csv("");
 	pestpp_options.set_ies_subset_how("RANDOM");
 	pestpp_options.set_ies_localize_how("PARAMETERS");
+	pestpp_options.set_ies_loc_par_coords("");
+	pestpp_options.set_ies_loc_obs_coords("");
+	pestpp_options.set_ies_loc_distance(0.0);
+	pestpp_options.set_ies_loc_taper("GASPARI_COHN");
 	pestpp_options.set_ies_num_threads(-1);
 	pestpp_options.set_ies_debug_fail_subset(false);
 	pestpp_options.set_ies_debug_fail_remainder(false);
@@ -899,6 +1050,26 @@ int Pest::process_ctl_file(ifstream &fin, string pst_filename)
 
 	}
 	regul_scheme_ptr->set_max_reg_iter(pestpp_options.get_max_reg_iter());
+
+	// the cache is only written when every parameter and observation name is unique so
+	// the records can be recovered from the scenario in control file order
+	if ((!from_cache) && (pestpp_options.get_pst_cache()) &&
+		(ctl_ordered_par_names.size() == ctl_parameters.size()) &&
+		(ctl_ordered_obs_names.size() == observation_values.size()))
+	{
+		for (auto &n : ctl_ordered_par_names)
+			pst_cache.add_par(n, *ctl_parameter_info.get_parameter_rec_ptr(n));
+		for (auto &n : ctl_ordered_obs_names)
+			pst_cache.add_obs(n, observation_values.get_rec(n), observation_info.observations.at(n));
+		try
+		{
+			pst_cache.write(cache_filename, pst_size, pst_hash);
+		}
+		catch (exception &e)
+		{
+			cout << "WARNING: unable to write control file cache: " << e.what() << endl;
+		}
+	}
 //	//Make sure we use Q1/2J is PROPACK is chosen
 //	if (pestpp_options.get_svd_pack() == PestppOptions::SVD_PACK::PROPACK)
 //	{
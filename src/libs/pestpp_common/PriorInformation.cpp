@@ -21,6 +21,7 @@
 #include <vector>
 #include <iostream>
 #include <cmath>
+#include <atomic>
 #include "utilities.h"
 #include "Transformable.h"
 
@@ -137,6 +138,22 @@ ostream& operator<< (ostream& out, const PriorInformationRec &rhs)
 	return out;
 }
 
+size_t PriorInformation::new_generation()
+{
+	static atomic<size_t> next_generation(0);
+	return ++next_generation;
+}
+
+PriorInformation& PriorInformation::operator=(const PriorInformation &rhs)
+{
+	if (this != &rhs)
+	{
+		prior_info_map = rhs.prior_info_map;
+		generation = new_generation();
+	}
+	return *this;
+}
+
 void PriorInformation::AddRecord(const string &name, const PriorInformationRec* pi_rec_ptr)
 {
 	PriorInformationRec pi_rec(pi_rec_ptr->get_obs_value(), pi_rec_ptr->get_weight(), pi_rec_ptr->get_group(), pi_rec_ptr->get_atoms());
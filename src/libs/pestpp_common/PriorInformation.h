@@ -67,7 +67,9 @@ class PriorInformation
 public:
 	typedef std::map<std::string, PriorInformationRec>::iterator iterator;
 	typedef std::map<std::string, PriorInformationRec>::const_iterator const_iterator;
-	PriorInformation() {}
+	PriorInformation() : generation(new_generation()) {}
+	PriorInformation(const PriorInformation &rhs) : prior_info_map(rhs.prior_info_map), generation(new_generation()) {}
+	PriorInformation& operator=(const PriorInformation &rhs);
 	~PriorInformation() {}
 	std::pair<std::string, std::string> AddRecord(const std::string &pi_line);
 	void AddRecord(const std::string &name, const PriorInformationRec* pi_rec_ptr);
@@ -81,8 +83,12 @@ public:
 	size_t size() const {return prior_info_map.size();}
 	int get_nnz_pi() const;
 	std::vector<std::string> get_keys() const;
+	//changes whenever the prior information records may have been replaced, so pointers to them can be cached against it
+	size_t get_generation() const { return generation; }
 private:
 	std::map<std::string, PriorInformationRec> prior_info_map;
+	size_t generation;
+	static size_t new_generation();
 };
 
 
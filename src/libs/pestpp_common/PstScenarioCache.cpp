@@ -0,0 +1,240 @@
+#include <fstream>
+#include <cstring>
+#include "PstScenarioCache.h"
+
+using namespace std;
+
+namespace cache_utils
+{
+	const char cache_magic[8] = { 'P', 'S', 'T', 'C', 'A', 'C', 'H', 'E' };
+
+	template<typename T>
+	void put(vector<char> &buf, const T &value)
+	{
+		const char *p = reinterpret_cast<const char*>(&value);
+		buf.insert(buf.end(), p, p + sizeof(T));
+	}
+
+	void put_string(vector<char> &buf, const string &s)
+	{
+		put(buf, uint32_t(s.size()));
+		buf.insert(buf.end(), s.begin(), s.end());
+	}
+
+	class CacheReader
+	{
+	public:
+		CacheReader(const vector<char> &_buf) : buf(_buf), pos(0) {}
+		template<typename T>
+		bool get(T &value)
+		{
+			if (pos + sizeof(T) > buf.size())
+				return false;
+			memcpy(&value, &buf[pos], sizeof(T));
+			pos += sizeof(T);
+			return true;
+		}
+		bool get_string(string &s)
+		{
+			uint32_t n;
+			if ((!get(n)) || (pos + n > buf.size()))
+				return false;
+			s.assign(buf.data() + pos, n);
+			pos += n;
+			return true;
+		}
+		bool at_end() const { return pos == buf.size(); }
+	private:
+		const vector<char> &buf;
+		size_t pos;
+	};
+}
+
+using namespace cache_utils;
+
+const int32_t PstScenarioCache::version;
+
+void PstScenarioCache::add_line(int lnum, const string &line)
+{
+	Entry e;
+	e.type = EntryType::LINE;
+	e.lnum = lnum;
+	e.count = 0;
+	e.line = line;
+	entries.push_back(e);
+}
+
+void PstScenarioCache::add_par_block()
+{
+	if ((entries.size() > 0) && (entries.back().type == EntryType::PAR_BLOCK))
+	{
+		entries.back().count++;
+		return;
+	}
+	Entry e;
+	e.type = EntryType::PAR_BLOCK;
+	e.lnum = 0;
+	e.count = 1;
+	entries.push_back(e);
+}
+
+void PstScenarioCache::add_obs_block()
+{
+	if ((entries.size() > 0) && (entries.back().type == EntryType::OBS_BLOCK))
+	{
+		entries.back().count++;
+		return;
+	}
+	Entry e;
+	e.type = EntryType::OBS_BLOCK;
+	e.lnum = 0;
+	e.count = 1;
+	entries.push_back(e);
+}
+
+void PstScenarioCache::add_par(const string &name, const ParameterRec &rec)
+{
+	par_names.push_back(name);
+	par_recs.push_back(rec);
+}
+
+void PstScenarioCache::add_obs(const string &name, double value, const ObservationRec &rec)
+{
+	obs_names.push_back(name);
+	obs_values.push_back(value);
+	obs_recs.push_back(rec);
+}
+
+void PstScenarioCache::write(const string &filename, uint64_t pst_size, uint64_t pst_hash) const
+{
+	vector<char> buf;
+	buf.insert(buf.end(), cache_magic, cache_magic + 8);
+	put(buf, version);
+	put(buf, pst_size);
+	put(buf, pst_hash);
+	put(buf, uint64_t(entries.size()));
+	for (auto &e : entries)
+	{
+		put(buf, int8_t(e.type));
+		put(buf, int32_t(e.lnum));
+		put(buf, int32_t(e.count));
+		put_string(buf, e.line);
+	}
+	put(buf, uint64_t(par_names.size()));
+	for (size_t i = 0; i < par_names.size(); ++i)
+	{
+		const ParameterRec &r = par_recs[i];
+		put_string(buf, par_names[i]);
+		put_string(buf, r.chglim);
+		put(buf, r.lbnd);
+		put(buf, r.ubnd);
+		put(buf, r.init_value);
+		put(buf, r.scale);
+		put(buf, r.offset);
+		put_string(buf, r.group);
+		put(buf, int32_t(r.dercom));
+		put(buf, int8_t(r.tranform_type));
+	}
+	put(buf, uint64_t(obs_names.size()));
+	for (size_t i = 0; i < obs_names.size(); ++i)
+	{
+		put_string(buf, obs_names[i]);
+		put(buf, obs_values[i]);
+		put(buf, obs_recs[i].weight);
+		put_string(buf, obs_recs[i].group);
+	}
+	ofstream out(filename, ios::binary);
+	if (!out.good())
+		throw PestError("PstScenarioCache::write() error: unable to open " + filename + " for writing");
+	out.write(buf.data(), buf.size());
+	if (!out.good())
+		throw PestError("PstScenarioCache::write() error: unable to write " + filename);
+}
+
+bool PstScenarioCache::read(const string &filename, uint64_t pst_size, uint64_t pst_hash)
+{
+	entries.clear();
+	par_names.clear();
+	par_recs.clear();
+	obs_names.clear();
+	obs_values.clear();
+	obs_recs.clear();
+	ifstream in(filename, ios::binary | ios::ate);
+	if (!in.good())
+		return false;
+	streamoff fsize = in.tellg();
+	in.seekg(0, ios::beg);
+	vector<char> buf(size_t(max(fsize, streamoff(0))));
+	if ((buf.size() < 8) || (!in.read(buf.data(), buf.size())) || (memcmp(buf.data(), cache_magic, 8) != 0))
+		return false;
+	in.close();
+
+	//any mismatch or truncation means the cache is stale or damaged and the text is parsed instead
+	CacheReader r(buf);
+	char magic[8];
+	int32_t file_version;
+	uint64_t file_pst_size, file_pst_hash, n;
+	for (int i = 0; i < 8; ++i)
+		r.get(magic[i]);
+	if ((!r.get(file_version)) || (file_version != version))
+		return false;
+	if ((!r.get(file_pst_size)) || (!r.get(file_pst_hash)) || (file_pst_size != pst_size) || (file_pst_hash != pst_hash))
+		return false;
+	//every record takes at least one byte, which bounds the counts of a damaged file
+	bool ok = r.get(n) && (n <= buf.size());
+	entries.resize(ok ? n : 0);
+	for (size_t i = 0; ok && (i < entries.size()); ++i)
+	{
+		int8_t type;
+		int32_t lnum, count;
+		ok = r.get(type) && r.get(lnum) && r.get(count) && r.get_string(entries[i].line);
+		entries[i].type = EntryType(type);
+		entries[i].lnum = lnum;
+		entries[i].count = count;
+	}
+	ok = ok && r.get(n) && (n <= buf.size());
+	par_names.resize(ok ? n : 0);
+	par_recs.resize(ok ? n : 0);
+	for (size_t i = 0; ok && (i < par_names.size()); ++i)
+	{
+		ParameterRec &p = par_recs[i];
+		int32_t dercom;
+		int8_t tran;
+		ok = r.get_string(par_names[i]) && r.get_string(p.chglim) && r.get(p.lbnd) && r.get(p.ubnd) &&
+			r.get(p.init_value) && r.get(p.scale) && r.get(p.offset) && r.get_string(p.group) &&
+			r.get(dercom) && r.get(tran);
+		p.dercom = dercom;
+		p.tranform_type = ParameterRec::TRAN_TYPE(tran);
+	}
+	ok = ok && r.get(n) && (n <= buf.size());
+	obs_names.resize(ok ? n : 0);
+	obs_values.resize(ok ? n : 0);
+	obs_recs.resize(ok ? n : 0);
+	for (size_t i = 0; ok && (i < obs_names.size()); ++i)
+	{
+		ok = r.get_string(obs_names[i]) && r.get(obs_values[i]) && r.get(obs_recs[i].weight) &&
+			r.get_string(obs_recs[i].group);
+	}
+	ok = ok && r.at_end();
+
+	//the block counts must account for exactly the records that were read
+	size_t n_par = 0, n_obs = 0;
+	for (auto &e : entries)
+	{
+		if (e.type == EntryType::PAR_BLOCK)
+			n_par += e.count;
+		else if (e.type == EntryType::OBS_BLOCK)
+			n_obs += e.count;
+	}
+	if ((!ok) || (n_par != par_names.size()) || (n_obs != obs_names.size()))
+	{
+		entries.clear();
+		par_names.clear();
+		par_recs.clear();
+		obs_names.clear();
+		obs_values.clear();
+		obs_recs.clear();
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,58 @@
+#ifndef PST_SCENARIO_CACHE_H_
+#define PST_SCENARIO_CACHE_H_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "pest_data_structs.h"
+
+using namespace std;
+
+/* @brief Binary snapshot of a parsed control file
+
+ The snapshot holds the control file lines that are processed as text (control data,
+ groups, prior information, model I/O, ++ options, etc.) together with the parsed
+ records of the parameter data and observation data sections, in control file order.
+ Pest::process_ctl_file() replays the snapshot through the same code used for a text
+ parse so the resulting scenario is identical.  The snapshot is keyed by the size and
+ FNV-1a hash of the control file text and is ignored if either does not match.
+*/
+class PstScenarioCache
+{
+public:
+	enum class EntryType : int8_t { LINE, PAR_BLOCK, OBS_BLOCK };
+	class Entry
+	{
+	public:
+		EntryType type;
+		int lnum;   // control file line number for LINE entries
+		int count;  // number of records for PAR_BLOCK and OBS_BLOCK entries
+		string line;
+	};
+	PstScenarioCache() { ; }
+	void add_line(int lnum, const string &line);
+	//count one more record in the current parameter/observation data block
+	void add_par_block();
+	void add_obs_block();
+	void add_par(const string &name, const ParameterRec &rec);
+	void add_obs(const string &name, double value, const ObservationRec &rec);
+	bool read(const string &filename, uint64_t pst_size, uint64_t pst_hash);
+	void write(const string &filename, uint64_t pst_size, uint64_t pst_hash) const;
+	const vector<Entry>& get_entries() const { return entries; }
+	const vector<string>& get_par_names() const { return par_names; }
+	const vector<ParameterRec>& get_par_recs() const { return par_recs; }
+	const vector<string>& get_obs_names() const { return obs_names; }
+	const vector<double>& get_obs_values() const { return obs_values; }
+	const vector<ObservationRec>& get_obs_recs() const { return obs_recs; }
+	static string get_filename(const string &pst_filename) { return pst_filename + ".cache"; }
+private:
+	static const int32_t version = 1;
+	vector<Entry> entries;
+	vector<string> par_names;
+	vector<ParameterRec> par_recs;
+	vector<string> obs_names;
+	vector<double> obs_values;
+	vector<ObservationRec> obs_recs;
+};
+
+#endif /* PST_SCENARIO_CACHE_H_ */
@@ -35,17 +35,69 @@ QSqrtMatrix::QSqrtMatrix(const ObservationInfo *_obs_info_ptr, const PriorInform
 {
 }
 
-Eigen::SparseMatrix<double> QSqrtMatrix::get_sparse_matrix(const vector<string> &obs_names, const DynamicRegularization &regul, bool get_sqaure) const
+QSqrtMatrix::QSqrtMatrix(const QSqrtMatrix &rhs)
+: obs_info_ptr(rhs.obs_info_ptr), prior_info_ptr(rhs.prior_info_ptr)
+{
+}
+
+QSqrtMatrix& QSqrtMatrix::operator=(const QSqrtMatrix &rhs)
 {
+	if (this != &rhs)
+	{
+		lock_guard<mutex> guard(lookup_lock);
+		obs_info_ptr = rhs.obs_info_ptr;
+		prior_info_ptr = rhs.prior_info_ptr;
+		last_lookup.reset();
+	}
+	return *this;
+}
+
+shared_ptr<const QSqrtMatrix::RecordLookup> QSqrtMatrix::get_record_lookup(const vector<string> &obs_names) const
+{
+	lock_guard<mutex> guard(lookup_lock);
+	if (last_lookup && last_lookup->obs_info_generation == obs_info_ptr->get_generation()
+		&& last_lookup->prior_info_generation == prior_info_ptr->get_generation()
+		&& last_lookup->n_obs_info == obs_info_ptr->observations.size()
+		&& last_lookup->n_prior_info == prior_info_ptr->size() && last_lookup->names == obs_names)
+	{
+		return last_lookup;
+	}
 
-	Eigen::SparseMatrix<double> weights(obs_names.size(), obs_names.size());
+	shared_ptr<RecordLookup> lookup = make_shared<RecordLookup>();
+	lookup->names = obs_names;
+	lookup->obs_info_generation = obs_info_ptr->get_generation();
+	lookup->prior_info_generation = prior_info_ptr->get_generation();
+	lookup->n_obs_info = obs_info_ptr->observations.size();
+	lookup->n_prior_info = prior_info_ptr->size();
+	lookup->obs_recs.assign(obs_names.size(), nullptr);
+	lookup->pi_recs.assign(obs_names.size(), nullptr);
 	unordered_map<string, ObservationRec>::const_iterator found_obsinfo_iter;
 	unordered_map<string, ObservationRec>::const_iterator non_found_obsinfo_iter = obs_info_ptr->observations.end();
 	PriorInformation::const_iterator found_prior_info;
 	PriorInformation::const_iterator not_found_prior_info = prior_info_ptr->end();
-	vector<string>::const_iterator b;
-	vector<string>::const_iterator e;
-	int i = 0;
+	for (int i = 0; i < obs_names.size(); ++i)
+	{
+		found_obsinfo_iter = obs_info_ptr->observations.find(obs_names[i]);
+		if (found_obsinfo_iter != non_found_obsinfo_iter)
+		{
+			lookup->obs_recs[i] = &(found_obsinfo_iter->second);
+			continue;
+		}
+		found_prior_info = prior_info_ptr->find(obs_names[i]);
+		if (found_prior_info != not_found_prior_info)
+			lookup->pi_recs[i] = &(found_prior_info->second);
+	}
+	last_lookup = lookup;
+	return last_lookup;
+}
+
+Eigen::SparseMatrix<double> QSqrtMatrix::get_sparse_matrix(const vector<string> &obs_names, const DynamicRegularization &regul, bool get_sqaure) const
+{
+	// names are resolved to observation/prior information records once per ordering;
+	// repeated calls with the same names only read the current weights
+	shared_ptr<const RecordLookup> lookup = get_record_lookup(obs_names);
+	int n = obs_names.size();
+	Eigen::SparseMatrix<double> weights(n, n);
 	double weight = 0;
 	double tikhonov_weight = 1.0;
 	const string *group = nullptr;
@@ -53,16 +105,17 @@ Eigen::SparseMatrix<double> QSqrtMatrix::get_sparse_matrix(const vector<string>
 	// of this
 	bool use_regul = regul.get_use_dynamic_reg();
 	if (use_regul) tikhonov_weight = sqrt(regul.get_weight());
-	std::vector<Eigen::Triplet<double> > triplet_list;
-	for (i = 0, b = obs_names.begin(), e = obs_names.end(); b != e; ++b, ++i)
+	weights.reserve(n);
+	for (int i = 0; i < n; ++i)
 	{
-		found_obsinfo_iter = obs_info_ptr->observations.find(*b);
-		found_prior_info = prior_info_ptr->find(*b);
+		weights.startVec(i);
+		const ObservationRec *obs_rec = lookup->obs_recs[i];
+		const PriorInformationRec *pi_rec = lookup->pi_recs[i];
 		// This section handles Observations
-		if (found_obsinfo_iter != non_found_obsinfo_iter)
+		if (obs_rec)
 		{
-			group = &((*found_obsinfo_iter).second.group);
-			weight = (*found_obsinfo_iter).second.weight;
+			group = &(obs_rec->group);
+			weight = obs_rec->weight;
 			bool is_reg_grp = ObservationGroupRec::is_regularization(*group);
 			if (use_regul && is_reg_grp)
 			{
@@ -74,14 +127,14 @@ Eigen::SparseMatrix<double> QSqrtMatrix::get_sparse_matrix(const vector<string>
 				weight *= tikhonov_weight;
 			}
 			if (get_sqaure) weight = weight * weight;
-			triplet_list.push_back(Eigen::Triplet<double>(i, i, weight));
+			weights.insertBack(i, i) = weight;
 		}
 		// This section handles Prior Information
-		else if (found_prior_info != not_found_prior_info)
+		else if (pi_rec)
 		{
-			group = &((*found_prior_info).second.get_group());
-			weight = (*found_prior_info).second.get_weight();
-			bool is_reg_grp = (*found_prior_info).second.is_regularization();
+			group = &(pi_rec->get_group());
+			weight = pi_rec->get_weight();
+			bool is_reg_grp = pi_rec->is_regularization();
 			if (use_regul && is_reg_grp)
 			{
 				if (regul.get_adj_grp_weights())
@@ -92,15 +145,13 @@ Eigen::SparseMatrix<double> QSqrtMatrix::get_sparse_matrix(const vector<string>
 				weight *= sqrt(regul.get_weight());
 			}
 			if (get_sqaure) weight = weight * weight;
-			triplet_list.push_back(Eigen::Triplet<double>(i, i, weight));
+			weights.insertBack(i, i) = weight;
 		}
 		else {
 			assert(true);  //observation not in standard observations or prior information
 		}
 	}
-	weights.resize(obs_names.size(), obs_names.size());
-	weights.setZero();
-	weights.setFromTriplets(triplet_list.begin(), triplet_list.end());
+	weights.finalize();
 	return weights;
 }
 
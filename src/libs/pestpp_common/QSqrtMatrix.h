@@ -20,10 +20,15 @@
 #define QSQRT_MATRIX_H_
 
 #include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
 #include <Eigen/Dense>
 #include<Eigen/Sparse>
 
 class ObservationInfo;
+class ObservationRec;
+class PriorInformationRec;
 class Observations;
 class PriorInformation;
 class Parameters;
@@ -36,11 +41,31 @@ class QSqrtMatrix
 public:
 	QSqrtMatrix(){};
 	QSqrtMatrix(const ObservationInfo *obs_info_ptr, const PriorInformation *prior_info_ptr);
+	QSqrtMatrix(const QSqrtMatrix &rhs);
+	QSqrtMatrix& operator=(const QSqrtMatrix &rhs);
 	Eigen::SparseMatrix<double> get_sparse_matrix(const vector<string> &obs_names, const DynamicRegularization &regul, bool get_square = false) const;
 	~QSqrtMatrix(void);
 private:
+	// observation and prior information records resolved for one ordering of names.
+	// Weights are read through the record pointers on every call so weight changes
+	// are picked up without rebuilding the lookup.  The pointers are only used while the
+	// generations of the observation and prior information containers are unchanged
+	class RecordLookup
+	{
+	public:
+		vector<string> names;
+		vector<const ObservationRec*> obs_recs;
+		vector<const PriorInformationRec*> pi_recs;
+		size_t obs_info_generation;
+		size_t prior_info_generation;
+		size_t n_obs_info;
+		size_t n_prior_info;
+	};
 	const ObservationInfo *obs_info_ptr;
 	const PriorInformation *prior_info_ptr;
+	mutable shared_ptr<const RecordLookup> last_lookup;
+	mutable mutex lookup_lock;
+	shared_ptr<const RecordLookup> get_record_lookup(const vector<string> &obs_names) const;
 };
 
 #endif /* QSQRT_MATRIX_H_ */
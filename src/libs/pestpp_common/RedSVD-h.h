@@ -136,58 +136,66 @@ namespace RedSVD
 		void compute(const MatrixType& A, const Index rank)
 		{
 			if(A.cols() == 0 || A.rows() == 0)
+			{
+				m_matrixU.resize(0, 0);
+				m_vectorS.resize(0);
+				m_matrixV.resize(0, 0);
 				return;
+			}
 
 			Index r = (rank < A.cols()) ? rank : A.cols();
 
 			r = (r < A.rows()) ? r : A.rows();
 
+			//the sample and range matrices are members so that repeated calls with
+			//the same shapes (e.g. the localized ies upgrade) reuse their storage
+
 			// Gaussian Random Matrix for A^T
-			DenseMatrix O(A.rows(), r);
-			sample_gaussian(O);
+			m_O.resize(A.rows(), r);
+			sample_gaussian(m_O);
 
 			// Compute Sample Matrix of A^T
-			DenseMatrix Y = A.transpose() * O;
+			m_Y.noalias() = A.transpose() * m_O;
 
 			// Orthonormalize Y
-			gram_schmidt(Y);
+			gram_schmidt(m_Y);
 
 			// Range(B) = Range(A^T)
-			DenseMatrix B = A * Y;
+			m_B.noalias() = A * m_Y;
 
 			// Gaussian Random Matrix
-			DenseMatrix P(B.cols(), r);
-			sample_gaussian(P);
+			m_P.resize(m_B.cols(), r);
+			sample_gaussian(m_P);
 
 			// Compute Sample Matrix of B
-			DenseMatrix Z = B * P;
+			m_Z.noalias() = m_B * m_P;
 
 			// Orthonormalize Z
-			gram_schmidt(Z);
+			gram_schmidt(m_Z);
 
 			// Range(C) = Range(B)
-			DenseMatrix C = Z.transpose() * B;
+			m_C.noalias() = m_Z.transpose() * m_B;
 
-			Eigen::JacobiSVD<DenseMatrix> svdOfC(C, Eigen::ComputeThinU | Eigen::ComputeThinV);
+			m_svdOfC.compute(m_C, Eigen::ComputeThinU | Eigen::ComputeThinV);
 
 			// C = USV^T
 			// A = Z * U * S * V^T * Y^T()
-			m_matrixU = Z * svdOfC.matrixU();
-			m_vectorS = svdOfC.singularValues();
-			m_matrixV = Y * svdOfC.matrixV();
+			m_matrixU.noalias() = m_Z * m_svdOfC.matrixU();
+			m_vectorS = m_svdOfC.singularValues();
+			m_matrixV.noalias() = m_Y * m_svdOfC.matrixV();
 		}
 
-		DenseMatrix matrixU() const
+		const DenseMatrix& matrixU() const
 		{
 			return m_matrixU;
 		}
 
-		ScalarVector singularValues() const
+		const ScalarVector& singularValues() const
 		{
 			return m_vectorS;
 		}
 
-		DenseMatrix matrixV() const
+		const DenseMatrix& matrixV() const
 		{
 			return m_matrixV;
 		}
@@ -196,6 +204,8 @@ namespace RedSVD
 		DenseMatrix m_matrixU;
 		ScalarVector m_vectorS;
 		DenseMatrix m_matrixV;
+		DenseMatrix m_O, m_Y, m_B, m_P, m_Z, m_C;
+		Eigen::JacobiSVD<DenseMatrix> m_svdOfC;
 	};
 
 	template<typename _MatrixType>
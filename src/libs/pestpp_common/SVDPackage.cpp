@@ -22,6 +22,9 @@
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
+#include <random>
+#include <sstream>
+#include <cmath>
 #include "RedSVD-h.h"
 
 
@@ -68,11 +71,8 @@ void SVD_REDSVD::solve_ip(Eigen::MatrixXd& A, Eigen::MatrixXd &Sigma, Eigen::Mat
 	if (performance_log)
 		performance_log->log_event("starting REDSVD");
 
-	RedSVD::RedSVD<MatrixXd> red_svd(A);
-	
-	U = red_svd.matrixU();
-	V = red_svd.matrixV();
-	VectorXd Sigma_full = red_svd.singularValues();
+	red_svd.compute(A, (A.rows() < A.cols()) ? A.rows() : A.cols());
+	const VectorXd &Sigma_full = red_svd.singularValues();
 
 	int kmax = (Sigma_full.size() < n_max_sing) ? Sigma_full.size() : n_max_sing;
 	int num_sing_used = 0;
@@ -93,30 +93,10 @@ void SVD_REDSVD::solve_ip(Eigen::MatrixXd& A, Eigen::MatrixXd &Sigma, Eigen::Mat
 	ss << "triming REDSVD components to " << num_sing_used << "elements";
 	if (performance_log)
 		performance_log->log_event(ss.str());
-	//std::cout << Sigma_full << std::endl;
 	Sigma = Sigma_full.head(num_sing_used);
-	//std::cout << Sigma << std::endl;
-	//Sigma_trunc = Sigma_full.tail(Sigma_full.size() - num_sing_used);
-	if (num_sing_used == 1)
-	{
-		Eigen::VectorXd temp = V.col(0);
-		V.resize(V.rows(),1);
-		V.col(0) = temp;
-		temp = U.col(0);
-		U.resize(U.rows(),1);
-		U.col(0) = temp;
-	}
-	else
-	{
-		//std::cout << U.col(0);
-		Eigen::MatrixXd temp = V.leftCols(num_sing_used);
-		V = temp;
-		temp = U.leftCols(num_sing_used);
-		U = temp;
-		//std::cout << U.col(0);
-
-
-	}
+	//copy only the retained components out of the workspace
+	U = red_svd.matrixU().leftCols(num_sing_used);
+	V = red_svd.matrixV().leftCols(num_sing_used);
 	if (performance_log)
 		performance_log->log_event("done REDSVD");
 	return;
@@ -128,7 +108,7 @@ void SVD_REDSVD::solve_ip(Eigen::MatrixXd& A, Eigen::MatrixXd &Sigma, Eigen::Mat
 	if (performance_log)
 		performance_log->log_event("starting REDSVD");
 
-	RedSVD::RedSVD<MatrixXd> red_svd(A);
+	red_svd.compute(A, (A.rows() < A.cols()) ? A.rows() : A.cols());
 	if (performance_log)
 		performance_log->log_event("retrieving REDSVD components");
 	U = red_svd.matrixU();
@@ -146,13 +126,13 @@ void SVD_REDSVD::solve_ip(Eigen::SparseMatrix<double>& A, Eigen::VectorXd &Sigma
 	if (performance_log)
 		performance_log->log_event("starting REDSVD");
 
-	
-	RedSVD::RedSVD<MatrixXd> red_svd(A,n_max_sing);
+	A_dense = A;
+	red_svd.compute(A_dense, n_max_sing);
 	if (performance_log)
 		performance_log->log_event("retrieving REDSVD components");
 	U = red_svd.matrixU().sparseView();
 	VT = red_svd.matrixV().transpose().sparseView();
-	VectorXd Sigma_full = red_svd.singularValues();
+	const VectorXd &Sigma_full = red_svd.singularValues();
 
 	int kmax = (Sigma_full.size() < n_max_sing) ? Sigma_full.size() : n_max_sing;
 	int num_sing_used = 0;
@@ -286,3 +266,155 @@ void SVD_EIGEN::solve_ip(Eigen::SparseMatrix<double>& A, Eigen::VectorXd &Sigma,
 	Vt = Eigen::SparseMatrix<double>(Vt.topRows(num_sing_used));
 	U = Eigen::SparseMatrix<double>(U.leftCols(num_sing_used));
 }
+
+
+void SVD_RANDOMIZED::solve_ip(Eigen::SparseMatrix<double>& A, Eigen::VectorXd &Sigma, Eigen::SparseMatrix<double>& U,
+	Eigen::SparseMatrix<double>& VT, Eigen::VectorXd &Sigma_trunc)
+{
+	solve_ip(A, Sigma, U, VT, Sigma_trunc, eign_thres);
+}
+
+namespace
+{
+	//orthonormal basis for the columns of Y
+	MatrixXd orthonormal_basis(const MatrixXd &Y)
+	{
+		HouseholderQR<MatrixXd> qr(Y);
+		return qr.householderQ() * MatrixXd::Identity(Y.rows(), Y.cols());
+	}
+
+	//thin svd of a tall matrix, Bt = W * S * Z^T.  The eigenvectors of the small gram matrix rotate Bt to nearly
+	//orthogonal columns, so the jacobi svd of the triangular factor needs few sweeps and keeps the
+	//accuracy of the small singular values
+	void tall_thin_svd(const MatrixXd &Bt, VectorXd &s, MatrixXd &W, MatrixXd &Z)
+	{
+		int n = Bt.rows();
+		int b = Bt.cols();
+		SelfAdjointEigenSolver<MatrixXd> eig_fac(Bt.transpose() * Bt);
+		MatrixXd Z0 = eig_fac.eigenvectors().rowwise().reverse();
+		HouseholderQR<MatrixXd> qr(Bt * Z0);
+		MatrixXd R = qr.matrixQR().topRows(b).triangularView<Upper>();
+		JacobiSVD<MatrixXd> svd_fac(R, ComputeFullU | ComputeFullV);
+		s = svd_fac.singularValues();
+		MatrixXd Ur = MatrixXd::Zero(n, b);
+		Ur.topRows(b) = svd_fac.matrixU();
+		W = qr.householderQ() * Ur;
+		Z = Z0 * svd_fac.matrixV();
+	}
+
+	int num_above_thres(const VectorXd &s, double eigen_thres, int max_sing)
+	{
+		int kmax = (s.size() < max_sing) ? s.size() : max_sing;
+		int num_sing_used = 0;
+		for (int i_sing = 0; i_sing < kmax; ++i_sing)
+		{
+			if ((s[0] > 0.0) && (s[i_sing] / s[0] > eigen_thres))
+				++num_sing_used;
+			else
+				break;
+		}
+		return num_sing_used;
+	}
+}
+
+void SVD_RANDOMIZED::solve_ip(Eigen::SparseMatrix<double>& A, Eigen::VectorXd &Sigma, Eigen::SparseMatrix<double>& U,
+	Eigen::SparseMatrix<double>& VT, Eigen::VectorXd &Sigma_trunc, double _eigen_thres)
+{
+	if (performance_log)
+		performance_log->log_event("starting randomized SVD");
+	int n_row = A.rows();
+	int n_col = A.cols();
+	int max_rank = std::min(n_row, n_col);
+	int n_sing = std::min(n_max_sing, max_rank);
+	if (n_sing < 1)
+	{
+		Sigma.resize(0);
+		Sigma_trunc = VectorXd::Zero(max_rank);
+		U.resize(n_row, 0);
+		VT.resize(0, n_col);
+		return;
+	}
+
+	//the block starts at the size of the previous solution and grows until the threshold is reached
+	int n_start = (V_start.rows() == n_col) ? V_start.cols() : 0;
+	int block_max = std::min(max_rank, n_sing + n_oversample);
+	int block = (n_start > 0) ? std::min(n_start, n_sing) : std::min(n_sing, 5 * n_oversample);
+	block = std::min(block_max, block + n_oversample);
+
+	//fixed seed so repeated solves of the same matrix give the same result
+	std::mt19937 rand_gen(1);
+	std::normal_distribution<double> norm_dist(0.0, 1.0);
+	MatrixXd V_seed(n_col, 0);
+	if (n_start > 0)
+		V_seed = V_start.leftCols(std::min(n_start, block));
+	MatrixXd Q, Bt, W, Z;
+	VectorXd s, s_last;
+	int n_pass = 0;
+	int n_keep = 0;
+	while (true)
+	{
+		MatrixXd Omega(n_col, block);
+		if (V_seed.cols() > 0)
+			Omega.leftCols(V_seed.cols()) = V_seed;
+		for (int j = V_seed.cols(); j < block; ++j)
+			for (int i = 0; i < n_col; ++i)
+				Omega(i, j) = norm_dist(rand_gen);
+
+		//range of A, refined by power iterations until the kept singular values settle
+		Q = orthonormal_basis(A * Omega);
+		s_last.resize(0);
+		for (int i_iter = 0; ; ++i_iter)
+		{
+			//A ~= Q * Bt^T.  The singular values of Bt come from its small gram matrix here,
+			//the vectors are only needed once the iterations are done
+			Bt = A.transpose() * Q;
+			++n_pass;
+			SelfAdjointEigenSolver<MatrixXd> eig_fac(Bt.transpose() * Bt, EigenvaluesOnly);
+			s.resize(block);
+			for (int i = 0; i < block; ++i)
+				s[i] = std::sqrt(std::max(eig_fac.eigenvalues()[block - 1 - i], 0.0));
+			n_keep = num_above_thres(s, _eigen_thres, n_sing);
+			//a block that can not hold the values above the threshold is grown before it is refined
+			if ((block < block_max) && (n_keep + n_oversample > block))
+				break;
+			if (s_last.size() == s.size())
+			{
+				double max_change = 0.0;
+				for (int i = 0; i < std::max(n_keep, 1); ++i)
+					max_change = std::max(max_change, std::abs(s[i] - s_last[i]));
+				if (max_change <= power_iter_tol * s[0])
+					break;
+			}
+			if (i_iter >= max_power_iter)
+				break;
+			s_last = s;
+			Q = orthonormal_basis(A * orthonormal_basis(Bt));
+		}
+		//done when the block carries all the values above the threshold plus the oversampling vectors
+		if ((block >= block_max) || (n_keep + n_oversample <= block))
+			break;
+		V_seed = orthonormal_basis(Bt);
+		block = std::min(block_max, 2 * block);
+	}
+
+	//Bt = W * S * Z^T, so A ~= (Q * Z) * S * W^T
+	tall_thin_svd(Bt, s, W, Z);
+	n_keep = num_above_thres(s, _eigen_thres, n_sing);
+
+	std::stringstream ss;
+	ss << "randomized SVD: " << n_keep << " singular values above threshold from a block of " << block
+		<< " vectors after " << n_pass << " passes";
+	if (performance_log)
+		performance_log->log_event(ss.str());
+
+	Sigma = s.head(n_keep);
+	//Sigma_trunc has the length of the full truncated spectrum.  The values computed in the block come
+	//first and the rest, which are not computed, are zero as in SVD_PROPACK
+	Sigma_trunc = VectorXd::Zero(max_rank - n_keep);
+	Sigma_trunc.head(s.size() - n_keep) = s.tail(s.size() - n_keep);
+	U = MatrixXd(Q * Z.leftCols(n_keep)).sparseView();
+	VT = MatrixXd(W.leftCols(n_keep).transpose()).sparseView();
+	V_start = W.leftCols(n_keep);
+	if (performance_log)
+		performance_log->log_event("done randomized SVD");
+}
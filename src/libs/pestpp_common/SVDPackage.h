@@ -23,6 +23,7 @@
 #include<Eigen/Dense>
 #include<Eigen/Sparse>
 #include "PerformanceLog.h"
+#include "RedSVD-h.h"
 
 class SVDPackage
 {
@@ -36,6 +37,8 @@ public:
 	virtual void set_eign_thres(double _eign_thres);
 	virtual double get_eign_thres();
 	virtual void set_performance_log(PerformanceLog *_performance_log);
+	//starting estimate of the right singular vectors (one per column) for the next solve.  Ignored by the direct packages
+	virtual void set_start_subspace(const Eigen::MatrixXd &V) {}
 	virtual ~SVDPackage(void){};
 	const std::string description;
 	virtual SVDPackage *clone() const {return 0;}
@@ -63,7 +66,8 @@ class SVD_REDSVD : public SVDPackage
 {
 public:
 	SVD_REDSVD(int _n_max_sing = 1000, double _eign_thres = 1.0e-7) : SVDPackage("RedSVD", _n_max_sing, _eign_thres) {}
-	SVD_REDSVD(const SVD_REDSVD &rhs) : SVDPackage(rhs) {}
+	//the workspace is not copied; a copy starts empty so each thread can own a clone
+	SVD_REDSVD(const SVD_REDSVD &rhs) : SVDPackage(rhs), red_svd(), A_dense() {}
 	virtual void solve_ip(Eigen::SparseMatrix<double>& A, Eigen::VectorXd &Sigma, Eigen::SparseMatrix<double>& U,
 		Eigen::SparseMatrix<double>& VT, Eigen::VectorXd &Sigma_trunc);
 	virtual void solve_ip(Eigen::SparseMatrix<double>& A, Eigen::VectorXd &Sigma, Eigen::SparseMatrix<double>& U,
@@ -74,6 +78,36 @@ public:
 	virtual void solve_ip(Eigen::MatrixXd& A, Eigen::MatrixXd &Sigma, Eigen::MatrixXd& U,
 		Eigen::MatrixXd& V);
 	virtual ~SVD_REDSVD(void) {}
+private:
+	//workspace reused across solves of this instance
+	RedSVD::RedSVD<Eigen::MatrixXd> red_svd;
+	Eigen::MatrixXd A_dense;
+};
+
+//truncated SVD by a randomized range finder with power iterations.  Only products with the sparse
+//matrix and its transpose are formed.  The range finder is seeded with the right singular vectors of
+//the previous solve (or those passed to set_start_subspace()) and the block of vectors is grown until
+//the ratio of the smallest to the largest singular value falls below the eigenvalue threshold.  Sigma_trunc
+//holds min(rows, cols) - Sigma.size() values: the truncated values of the block, then zeros for those not computed
+class SVD_RANDOMIZED : public SVDPackage
+{
+public:
+	SVD_RANDOMIZED(int _n_max_sing = 1000, double _eign_thres = 1.0e-7) : SVDPackage("randomized SVD", _n_max_sing, _eign_thres) {}
+	SVD_RANDOMIZED(const SVD_RANDOMIZED &rhs) : SVDPackage(rhs), V_start(rhs.V_start) {}
+	virtual void solve_ip(Eigen::SparseMatrix<double>& A, Eigen::VectorXd &Sigma, Eigen::SparseMatrix<double>& U,
+		Eigen::SparseMatrix<double>& VT, Eigen::VectorXd &Sigma_trunc);
+	virtual void solve_ip(Eigen::SparseMatrix<double>& A, Eigen::VectorXd &Sigma, Eigen::SparseMatrix<double>& U,
+		Eigen::SparseMatrix<double>& VT, Eigen::VectorXd &Sigma_trunc, double _eigen_thres);
+	virtual void set_start_subspace(const Eigen::MatrixXd &V) { V_start = V; }
+	virtual SVD_RANDOMIZED *clone() const { return new SVD_RANDOMIZED(*this); }
+	virtual ~SVD_RANDOMIZED(void) {}
+private:
+	//extra vectors carried in the block beyond the singular values that are kept
+	static const int n_oversample = 10;
+	static const int max_power_iter = 4;
+	//change of the kept singular values between power iterations, relative to the largest, that ends the iterations
+	static constexpr double power_iter_tol = 1.0e-6;
+	Eigen::MatrixXd V_start;
 };
 
 #endif //SVDPACKAGE_H_
@@ -35,6 +35,7 @@
 #include "PriorInformation.h"
 #include "Regularization.h"
 #include "SVD_PROPACK.h"
+#include "Jacobian_1to1.h"
 #include "OutputFileWriter.h"
 #include "debug.h"
 #include "covariance.h"
@@ -86,6 +87,80 @@ bool MuPoint::operator< (const MuPoint &rhs) const
 	return abs(f()) < abs(rhs.f());
 }
 
+bool TikhonovSpectrum::factor(const Eigen::SparseMatrix<double> &jac, const Eigen::VectorXd &q_meas, const Eigen::VectorXd &q_reg,
+	const Eigen::VectorXd &solve_residuals, const Eigen::VectorXd &phi_residuals)
+{
+	valid = false;
+	// measurement and unit weight regularization normal matrices
+	Eigen::SparseMatrix<double> jac_t = jac.transpose();
+	Eigen::SparseMatrix<double> q_jac = q_meas.asDiagonal() * jac;
+	MatrixXd A = MatrixXd(Eigen::SparseMatrix<double>(jac_t * q_jac));
+	q_jac = q_reg.asDiagonal() * jac;
+	MatrixXd B = MatrixXd(Eigen::SparseMatrix<double>(jac_t * q_jac));
+
+	// solve A v = theta (A + B) v.  The eigenvectors satisfy Vt (A + B) V = I, so Vt A V = theta
+	// and Vt B V = 1 - theta, which diagonalizes A + mu B for every weight factor mu
+	// A + B is factored here because the generalized solver does not check its Cholesky factorization.
+	// A + B is singular when some parameters are informed by neither the measurements nor the
+	// regularization; the caller then falls back to the normal weight factor search
+	MatrixXd M = A + B;
+	LLT<MatrixXd> llt(M);
+	if (llt.info() != Eigen::Success)
+	{
+		return false;
+	}
+	VectorXd pivots = llt.matrixLLT().diagonal();
+	double min_pivot = pivots.minCoeff();
+	double max_pivot = pivots.maxCoeff();
+	if (!(min_pivot > 0.0) || min_pivot * min_pivot <= numeric_limits<double>::epsilon() * pivots.size() * max_pivot * max_pivot)
+	{
+		return false;
+	}
+	// reduce to the standard problem (L^-1 A L^-T) w = theta w, with v = L^-T w
+	MatrixXd C = llt.matrixL().solve(A);
+	C = llt.matrixL().solve(MatrixXd(C.transpose()));
+	SelfAdjointEigenSolver<MatrixXd> es(C);
+	if (es.info() != Eigen::Success || !es.eigenvalues().allFinite() || !es.eigenvectors().allFinite())
+	{
+		return false;
+	}
+	theta = es.eigenvalues();
+	MatrixXd V = llt.matrixU().solve(es.eigenvectors());
+	// right hand sides used to compute the upgrade and to project the residuals
+	s_meas = V.transpose() * (jac_t * q_meas.cwiseProduct(solve_residuals));
+	s_reg = V.transpose() * (jac_t * q_reg.cwiseProduct(solve_residuals));
+	p_meas = V.transpose() * (jac_t * q_meas.cwiseProduct(phi_residuals));
+	p_reg = V.transpose() * (jac_t * q_reg.cwiseProduct(phi_residuals));
+	phi0_meas = phi_residuals.cwiseProduct(q_meas).dot(phi_residuals);
+	phi0_reg = phi_residuals.cwiseProduct(q_reg).dot(phi_residuals);
+	valid = true;
+	return valid;
+}
+
+PhiComponets TikhonovSpectrum::phi(double mu) const
+{
+	// with the upgrade x = V c, phi = r'Qr - 2 c'V'J'Qr + c'V'J'QJVc where V'J'QJV is diagonal
+	double phi_meas = phi0_meas;
+	double phi_reg = phi0_reg;
+	for (int i = 0; i < theta.size(); ++i)
+	{
+		double th = theta(i);
+		double den = th + mu * (1.0 - th);
+		if (den <= 0.0)
+		{
+			continue;
+		}
+		double c = (s_meas(i) + mu * s_reg(i)) / den;
+		phi_meas += c * (th * c - 2.0 * p_meas(i));
+		phi_reg += c * ((1.0 - th) * c - 2.0 * p_reg(i));
+	}
+	PhiComponets phi_comp;
+	phi_comp.meas = max(0.0, phi_meas);
+	phi_comp.regul = mu * max(0.0, phi_reg);
+	return phi_comp;
+}
+
+
 
 
 SVDSolver::SVDSolver(Pest &_pest_scenario, FileManager &_file_manager, ObjectiveFunc *_obj_func,
@@ -99,7 +174,9 @@ SVDSolver::SVDSolver(Pest &_pest_scenario, FileManager &_file_manager, Objective
 	regul_scheme_ptr(_pest_scenario.get_regul_scheme_ptr()), output_file_writer(_output_file_writer), mat_inv(_mat_inv), description(_description), best_lambda(20.0),
 	performance_log(_performance_log), base_lambda_vec(_pest_scenario.get_pestpp_options().get_base_lambda_vec()), lambda_scale_vec(_pest_scenario.get_pestpp_options().get_lambda_scale_vec()),
 	terminate_local_iteration(false), reg_frac(_pest_scenario.get_pestpp_options().get_reg_frac()),
-		parcov(_parcov),parcov_scale_fac(_pest_scenario.get_pestpp_options().get_parcov_scale_fac()),upgrade_augment(_pest_scenario.get_pestpp_options().get_upgrade_augment())
+	reg_weight_spectral(_pest_scenario.get_pestpp_options().get_reg_weight_spectral()),
+		parcov(_parcov),parcov_scale_fac(_pest_scenario.get_pestpp_options().get_parcov_scale_fac()),upgrade_augment(_pest_scenario.get_pestpp_options().get_upgrade_augment()),
+		jtqj_num_threads(_pest_scenario.get_pestpp_options().get_jtqj_num_threads())
 {
 	if (_pest_scenario.get_pestpp_options().get_jac_scale())
 	{
@@ -111,6 +188,22 @@ SVDSolver::SVDSolver(Pest &_pest_scenario, FileManager &_file_manager, Objective
 		upgrade_bounds = UpgradeBounds::ROBUST;
 	else
 		upgrade_bounds = UpgradeBounds::CHEAP;
+	string jac_update_str = _pest_scenario.get_pestpp_options().get_jac_update();
+	if (jac_update_str == "BROYDEN")
+		jac_update = JacUpdate::BROYDEN;
+	else if (jac_update_str == "SCHUBERT")
+		jac_update = JacUpdate::SCHUBERT;
+	else
+		jac_update = JacUpdate::NONE;
+	jac_update_phi_ratio = _pest_scenario.get_pestpp_options().get_jac_update_phi_ratio();
+	jac_update_max_iter = _pest_scenario.get_pestpp_options().get_jac_update_max_iter();
+	jacobian_updated = false;
+	n_jac_update_iter = 0;
+	last_jac_runs = 0;
+	jac_runs_saved = 0;
+	jac_refresh_sen_ratio = _pest_scenario.get_pestpp_options().get_jac_refresh_sen_ratio();
+	jac_refresh_par_change = _pest_scenario.get_pestpp_options().get_jac_refresh_par_change();
+	jac_refresh_full_iter = _pest_scenario.get_pestpp_options().get_jac_refresh_full_iter();
 	svd_package = new SVD_EIGEN();
 }
 
@@ -130,6 +223,11 @@ void SVDSolver::set_svd_package(PestppOptions::SVD_PACK _svd_pack)
 		svd_package = new SVD_REDSVD;
 
 	}
+	else if (_svd_pack == PestppOptions::RANDSVD)
+	{
+		delete svd_package;
+		svd_package = new SVD_RANDOMIZED;
+	}
 
 	svd_package->set_max_sing(svd_info.maxsing);
 	svd_package->set_eign_thres(svd_info.eigthresh);
@@ -206,11 +304,21 @@ ModelRun SVDSolver::solve(RunManagerAbstract &run_manager, TerminationController
 			{
 				calc_jacobian = true;
 			}
+			else if (jacobian_updated)
+			{
+				os << "  using the jacobian updated from the upgrade runs of the previous iteration" << endl;
+				cout << "  using updated jacobian" << endl;
+				jacobian_updated = false;
+				jac_refresh.reset();
+			}
 			else
 			{
 				bool restart_runs = (restart_controller.get_restart_option() == RestartController::RestartOption::RESUME_JACOBIAN_RUNS);
+				int nruns_start_jac = run_manager.get_total_runs();
 				iteration_jac(run_manager, termination_ctl, best_upgrade_run, false, restart_runs);
 				if (restart_runs) restart_controller.get_restart_option() = RestartController::RestartOption::NONE;
+				last_jac_runs = run_manager.get_total_runs() - nruns_start_jac;
+				n_jac_update_iter = 0;
 			}
 
 			// Update Regularization weights if REG_FRAC is used
@@ -267,11 +375,13 @@ ModelRun SVDSolver::solve(RunManagerAbstract &run_manager, TerminationController
 		cout << "    starting phi = " << prev_phi << ";  ending phi = " << best_new_phi <<
 			"  (" << phi_ratio * 100 << "% of starting phi)" << endl;
 
+		bool derivative_switch = false;
 		if (prev_phi != 0 && par_group_info_ptr->have_switch_derivative() && !phiredswh_flag &&
 			termination_ctl.get_iteration_number() + 1 > ctl_info->noptswitch &&
 			(prev_phi - best_new_phi) / prev_phi < ctl_info->phiredswh)
 		{
 			phiredswh_flag = true;
+			derivative_switch = true;
 			os << endl << "      Switching to central derivatives:" << endl;
 			cout << endl << "    Switching to central derivatives:" << endl;
 		}
@@ -280,10 +390,31 @@ ModelRun SVDSolver::solve(RunManagerAbstract &run_manager, TerminationController
 			ctl_info->splitswh > 0 && phi_ratio >= ctl_info->splitswh)
 		{
 			splitswh_flag = true;
+			derivative_switch = true;
 			os << endl << "    Switching to split threshold derivatives" << endl << endl;
 			cout << endl << "  Switching to split threshold derivatives" << endl << endl;
 		}
 
+		if (jac_refresh_sen_ratio > 0.0 && (derivative_switch ||
+			(prev_phi != 0 && (prev_phi - best_new_phi) / prev_phi < ctl_info->phiredswh)))
+		{
+			jac_refresh.set_force_full();
+		}
+
+		//replace the next full jacobian with a secant update from this iteration's upgrade runs
+		if (jac_update != JacUpdate::NONE)
+		{
+			if (derivative_switch)
+			{
+				os << "  full jacobian will be computed next iteration: switching derivative type" << endl;
+				jacobian_updated = false;
+			}
+			else
+				jacobian_updated = update_jacobian(prev_run, best_upgrade_run, os);
+			secant_numeric_pars.clear();
+			secant_obs.clear();
+		}
+
 		restart_controller.get_restart_option() = RestartController::RestartOption::NONE;
 
 		int nruns_end_iter = run_manager.get_total_runs();
@@ -302,6 +433,10 @@ ModelRun SVDSolver::solve(RunManagerAbstract &run_manager, TerminationController
 		tmp_str.clear();
 		tmp_str << "time to complete iteration " << global_iter_num;
 		performance_log->log_summary(tmp_str.str(), "end_iter", "start_iter");
+		tmp_str.str("");
+		tmp_str.clear();
+		tmp_str << "performance summary for iteration " << global_iter_num;
+		performance_log->log_perf_summary(tmp_str.str());
 		// write files that get wrtten at the end of each iteration
 		stringstream filename;
 		string complete_filename;
@@ -424,7 +559,7 @@ void SVDSolver::calc_lambda_upgrade_vec_JtQJ(const Jacobian &jacobian, const QSq
 	ident.resize(jac.cols(), jac.cols());
 	ident.setIdentity();
 	performance_log->log_event("forming JtQJ matrix");
-	Eigen::SparseMatrix<double> JtQJ = jac.transpose() * q_mat * jac;
+	Eigen::SparseMatrix<double> JtQJ = calc_weighted_normal_matrix(jac, q_mat, jtqj_num_threads);
 
 	if (parcov.nrow() > 0)
 	//if (parcov_scale_fac > 0.0)
@@ -445,7 +580,10 @@ void SVDSolver::calc_lambda_upgrade_vec_JtQJ(const Jacobian &jacobian, const QSq
 		{
 			//Compute Scaling Matrix Sii
 			performance_log->log_event("commencing to scale JtQJ matrix");
-			svd_package->solve_ip(JtQJ, Sigma, U, Vt, Sigma_trunc, 0.0);
+			{
+				perf_trace::ScopedSpan svd_span("SVDPackage::solve_ip");
+				svd_package->solve_ip(JtQJ, Sigma, U, Vt, Sigma_trunc, 0.0);
+			}
 			VectorXd Sigma_inv_sqrt = Sigma.array().inverse().sqrt();
 			S = Vt.transpose() * Sigma_inv_sqrt.asDiagonal() * U.transpose();
 			VectorXd S_diag = S.diagonal();
@@ -457,7 +595,7 @@ void SVDSolver::calc_lambda_upgrade_vec_JtQJ(const Jacobian &jacobian, const QSq
 			performance_log->log_event("JS");
 			JS = jac * S;
 			performance_log->log_event("JS.transpose() * q_mat * JS + lambda * S.transpose() * S");
-			JtQJ = JS.transpose() * q_mat * JS + lambda * S.transpose() * S;
+			JtQJ = calc_weighted_normal_matrix(JS, q_mat, jtqj_num_threads) + lambda * S.transpose() * S;
 			info_str.str("");
 			info_str << "S info: " << "rows = " << S.rows() << ": cols = " << S.cols() << ": size = " << S.size() << ": nonzeros = " << S.nonZeros();
 			performance_log->log_event(info_str.str());
@@ -468,7 +606,10 @@ void SVDSolver::calc_lambda_upgrade_vec_JtQJ(const Jacobian &jacobian, const QSq
 
 		// Returns truncated Sigma, U and Vt arrays with small singular parameters trimed off
 		performance_log->log_event("commencing SVD factorization");
-		svd_package->solve_ip(JtQJ, Sigma, U, Vt, Sigma_trunc);
+		{
+			perf_trace::ScopedSpan svd_span("SVDPackage::solve_ip");
+			svd_package->solve_ip(JtQJ, Sigma, U, Vt, Sigma_trunc);
+		}
 		performance_log->log_event("SVD factorization complete");
 
 		if (!recalc_js)
@@ -498,7 +639,10 @@ void SVDSolver::calc_lambda_upgrade_vec_JtQJ(const Jacobian &jacobian, const QSq
 	else
 	{
 		performance_log->log_event("commencing SVD factorization");
-		svd_package->solve_ip(JtQJ, Sigma, U, Vt, Sigma_trunc);
+		{
+			perf_trace::ScopedSpan svd_span("SVDPackage::solve_ip");
+			svd_package->solve_ip(JtQJ, Sigma, U, Vt, Sigma_trunc);
+		}
 		performance_log->log_event("SVD factorization complete");
 		//Only add lambda to singular values above the threshhold
 		Sigma = Sigma.array() + (Sigma.cwiseProduct(Sigma).array() * lambda).sqrt();
@@ -603,7 +747,10 @@ void SVDSolver::calc_lambda_upgrade_vecQ12J(const Jacobian &jacobian, const QSqr
 	Eigen::SparseMatrix<double> SqrtQ_J = q_sqrt * jac;
 	// Returns truncated Sigma, U and Vt arrays with small singular parameters trimed off
 	performance_log->log_event("commencing SVD factorization");
-	svd_package->solve_ip(SqrtQ_J, Sigma, U, Vt, Sigma_trunc);
+	{
+		perf_trace::ScopedSpan svd_span("SVDPackage::solve_ip");
+		svd_package->solve_ip(SqrtQ_J, Sigma, U, Vt, Sigma_trunc);
+	}
 	performance_log->log_event("SVD factorization complete");
 	//Only add lambda to singular values above the threshhold
 	if (marquardt_type == MarquardtMatrix::IDENT)
@@ -882,6 +1029,8 @@ ModelRun SVDSolver::iteration_reuse_jac(RunManagerAbstract &run_manager, Termina
 	if (jco_filename.empty()) jac_filename = file_manager.build_filename("jcb");
 	cout << "  reading previously computed jacobian:  " << jac_filename << endl;
 	file_manager.get_ofstream("rec") << "  reading previously computed jacobian:  " << jac_filename << endl;
+	// the file may still be being written in the background
+	output_file_writer.wait_for_jco_write();
 	jacobian.read(jac_filename);
 	//todo: make sure the jco has the right pars and obs
 
@@ -957,15 +1106,25 @@ ModelRun SVDSolver::iteration_reuse_jac(RunManagerAbstract &run_manager, Termina
 
 void SVDSolver::iteration_jac(RunManagerAbstract &run_manager, TerminationController &termination_ctl, ModelRun &base_run, bool calc_init_obs, bool restart_runs)
 {
+	perf_trace::ScopedSpan span("SVDSolver::iteration_jac", true);
 	ostream &os = file_manager.rec_ofstream();
 	ostream &fout_restart = file_manager.get_ofstream("rst");
 
 	set<string> out_ofbound_pars;
 
 	vector<string> numeric_parname_vec = par_transform.ctl2numeric_cp(base_run.get_ctl_pars()).get_keys();
+	int iter = termination_ctl.get_iteration_number() + 1;
+	Jacobian_1to1 *jacobian_1to1 = dynamic_cast<Jacobian_1to1*>(&jacobian);
+	bool selective_refresh = (jac_refresh_sen_ratio > 0.0 && jacobian_1to1 != nullptr);
+	set<string> carry_forward_pars;
 
 	if (!restart_runs)
 	{
+		if (selective_refresh)
+		{
+			carry_forward_pars = get_jac_carry_forward_pars(base_run, numeric_parname_vec, iter, os);
+			jacobian_1to1->set_carry_forward_pars(carry_forward_pars);
+		}
 
 		// Calculate Jacobian
 		if (!base_run.obs_valid() || calc_init_obs == true) {
@@ -973,24 +1132,55 @@ void SVDSolver::iteration_jac(RunManagerAbstract &run_manager, TerminationContro
 		}
 		cout << "  calculating jacobian... ";
 		performance_log->log_event("commencing to build jacobian parameter sets");
+		perf_trace::ScopedSpan build_span("Jacobian::build_runs");
 		jacobian.build_runs(base_run, numeric_parname_vec, par_transform,
 			*par_group_info_ptr, *ctl_par_info_ptr, run_manager, out_ofbound_pars,
 			phiredswh_flag, calc_init_obs);
 
 		RestartController::write_jac_runs_built(fout_restart);
 	}
+	else if (jacobian_1to1 != nullptr)
+	{
+		jacobian_1to1->restart_build(numeric_parname_vec, par_transform, *par_group_info_ptr, *ctl_par_info_ptr,
+			run_manager, phiredswh_flag);
+	}
 
 	performance_log->log_event("jacobian parameter sets built, commencing model runs");
-	jacobian.make_runs(run_manager);
+	{
+		perf_trace::ScopedSpan run_span("Jacobian::make_runs");
+		jacobian.make_runs(run_manager);
+	}
 	performance_log->log_event("jacobian runs complete, processing runs");
 	jacobian.process_runs(par_transform,
 		*par_group_info_ptr, run_manager, *prior_info_ptr, splitswh_flag);
 	performance_log->log_event("processing jacobian runs complete");
 
+	if (selective_refresh)
+	{
+		os << "  Selective jacobian refresh: " << numeric_parname_vec.size() - carry_forward_pars.size() << " of "
+			<< numeric_parname_vec.size() << " parameters perturbed, " << jacobian_1to1->get_n_carry_forward_runs()
+			<< " model runs skipped" << endl;
+		if (!carry_forward_pars.empty())
+		{
+			os << "    carried forward columns (parameter, iteration last computed, iterations stale):" << endl;
+			for (const auto &par_name : carry_forward_pars)
+			{
+				int col_iter = jac_refresh.get_col_iter(par_name);
+				os << "      " << left << setw(20) << par_name << right << setw(6) << col_iter
+					<< setw(6) << iter - col_iter << endl;
+			}
+			cout << "  selective jacobian refresh: " << jacobian_1to1->get_n_carry_forward_runs() << " model runs skipped" << endl;
+		}
+		jac_refresh.record(iter, jacobian.parameter_list(), jacobian.get_base_numeric_parameters(), carry_forward_pars);
+	}
+
 	performance_log->log_event("saving jacobian and sen files");
 	// save jacobian
 	//jacobian.save("jcb");
-	output_file_writer.write_jco(true,"jcb", jacobian);
+	{
+		perf_trace::ScopedSpan write_span("OutputFileWriter::write_jco");
+		output_file_writer.write_jco(true, "jcb", jacobian);
+	}
 
 	//Update parameters and observations for base run
 	{
@@ -1007,6 +1197,7 @@ void SVDSolver::iteration_jac(RunManagerAbstract &run_manager, TerminationContro
 
 ModelRun SVDSolver::iteration_upgrd(RunManagerAbstract &run_manager, TerminationController &termination_ctl, ModelRun &base_run, bool restart_runs)
 {
+	perf_trace::ScopedSpan span("SVDSolver::iteration_upgrd", true);
 	ostream &os = file_manager.rec_ofstream();
 	ostream &fout_restart = file_manager.get_ofstream("rst");
 
@@ -1094,6 +1285,7 @@ ModelRun SVDSolver::iteration_upgrd(RunManagerAbstract &run_manager, Termination
 		ofstream &fout_rec = file_manager.rec_ofstream();
 		for (double i_lambda : lambda_vec)
 		{
+			perf_trace::ScopedSpan lambda_span("SVDSolver::lambda_upgrade");
 			prf_message.str("");
 			prf_message << "beginning upgrade vector calculations, lambda = " << i_lambda;
 			performance_log->log_event(prf_message.str());
@@ -1110,6 +1302,7 @@ ModelRun SVDSolver::iteration_upgrd(RunManagerAbstract &run_manager, Termination
 			Parameters frozen_active_ctl_pars = failed_jac_pars;
 			try
 			{
+				perf_trace::ScopedSpan upgrade_span("SVDSolver::calc_upgrade_vec");
 				calc_upgrade_vec(i_lambda, frozen_active_ctl_pars, Q_sqrt, *regul_scheme_ptr, residuals_vec,
 					obs_names_vec, base_run_active_ctl_par, new_pars, mar_mat, limit_type, false);
 			}
@@ -1173,7 +1366,10 @@ ModelRun SVDSolver::iteration_upgrd(RunManagerAbstract &run_manager, Termination
 	cout << endl;
 	performance_log->add_indent(-1);
 	cout << "  performing upgrade vector model runs... ";
-	run_manager.run();
+	{
+		perf_trace::ScopedSpan run_span("SVDSolver::upgrade_runs");
+		run_manager.run();
+	}
 
 	// process model runs
 	cout << "  testing upgrade vectors... ";
@@ -1188,6 +1384,9 @@ ModelRun SVDSolver::iteration_upgrd(RunManagerAbstract &run_manager, Termination
 
 	int n_runs = run_manager.get_nruns();
 	bool one_success = false;
+	secant_numeric_pars.clear();
+	secant_obs.clear();
+	perf_trace::ScopedSpan test_span("SVDSolver::test_upgrades");
 	for (int i = 1; i < n_runs; ++i) {
 		ModelRun upgrade_run(base_run);
 		Parameters tmp_pars;
@@ -1201,6 +1400,11 @@ ModelRun SVDSolver::iteration_upgrd(RunManagerAbstract &run_manager, Termination
 			one_success = true;
 			par_transform.model2ctl_ip(tmp_pars);
 			upgrade_run.update_ctl(tmp_pars, tmp_obs);
+			if (jac_update != JacUpdate::NONE)
+			{
+				secant_numeric_pars.push_back(par_transform.ctl2numeric_cp(tmp_pars));
+				secant_obs.push_back(tmp_obs);
+			}
 
 			Parameters frozen_pars = read_frozen_pars(fin_frz, i);
 			upgrade_run.set_frozen_ctl_parameters(frozen_pars);
@@ -1271,6 +1475,97 @@ ModelRun SVDSolver::iteration_upgrd(RunManagerAbstract &run_manager, Termination
 	return best_upgrade_run;
 }
 
+set<string> SVDSolver::get_jac_carry_forward_pars(ModelRun &base_run, const vector<string> &numeric_par_names, int iter, ostream &os)
+{
+	string reason = jac_refresh.get_full_jac_reason(iter, jac_refresh_full_iter, !jacobian.get_failed_parameter_names().empty());
+	if (!reason.empty())
+	{
+		os << "  Selective jacobian refresh: computing full jacobian, " << reason << endl;
+		return set<string>();
+	}
+
+	//composite sensitivity of each column of the current jacobian
+	const vector<string> &obs_names = jacobian.observation_list();
+	const vector<string> &jac_par_names = jacobian.parameter_list();
+	QSqrtMatrix Q_sqrt(obs_info_ptr, prior_info_ptr);
+	Eigen::SparseMatrix<double> q_sqrt = Q_sqrt.get_sparse_matrix(obs_names, *regul_scheme_ptr);
+	Eigen::SparseMatrix<double> weighted_jac = q_sqrt * jacobian.get_matrix(obs_names, jac_par_names);
+	VectorXd css(jac_par_names.size());
+	for (int i = 0; i < weighted_jac.outerSize(); ++i)
+	{
+		css[i] = weighted_jac.col(i).norm();
+	}
+	//parameter changes are measured relative to the numeric parameter range
+	Parameters ctl_lbnd = base_run.get_ctl_pars();
+	Parameters ctl_ubnd = ctl_lbnd;
+	for (auto &ipar : ctl_lbnd)
+		ipar.second = ctl_par_info_ptr->get_parameter_rec_ptr(ipar.first)->lbnd;
+	for (auto &ipar : ctl_ubnd)
+		ipar.second = ctl_par_info_ptr->get_parameter_rec_ptr(ipar.first)->ubnd;
+	Parameters numeric_lbnd = par_transform.ctl2numeric_cp(ctl_lbnd);
+	Parameters numeric_ubnd = par_transform.ctl2numeric_cp(ctl_ubnd);
+	Parameters numeric_pars = par_transform.ctl2numeric_cp(base_run.get_ctl_pars());
+	return jac_refresh.get_carry_forward_pars(numeric_par_names, jac_par_names, css, jac_refresh_sen_ratio,
+		numeric_pars, numeric_lbnd, numeric_ubnd, jac_refresh_par_change);
+}
+
+bool SVDSolver::update_jacobian(ModelRun &base_run, ModelRun &upgrade_run, ostream &os)
+{
+	//compare the phi reduction of the best upgrade with the reduction predicted by the jacobian it was computed from
+	Parameters base_numeric_pars = par_transform.ctl2numeric_cp(base_run.get_ctl_pars());
+	Parameters upgrade_numeric_pars = par_transform.ctl2numeric_cp(upgrade_run.get_ctl_pars());
+	const vector<string> &numeric_par_names = jacobian.parameter_list();
+	vector<string> obs_names_vec = base_run.get_obs_template().get_keys();
+	VectorXd delta_par_vec(numeric_par_names.size());
+	for (int i = 0; i < numeric_par_names.size(); ++i)
+		delta_par_vec[i] = upgrade_numeric_pars.get_rec(numeric_par_names[i]) - base_numeric_pars.get_rec(numeric_par_names[i]);
+	VectorXd delta_obs_vec = jacobian.get_matrix(obs_names_vec, numeric_par_names) * delta_par_vec;
+	Observations projected_obs = base_run.get_obs();
+	Observations full_delta_obs(projected_obs);
+	full_delta_obs.update_without_clear(obs_names_vec, delta_obs_vec);
+	projected_obs += full_delta_obs;
+	double base_phi = base_run.get_phi(*regul_scheme_ptr);
+	double new_phi = upgrade_run.get_phi(*regul_scheme_ptr);
+	double proj_phi = base_run.get_obj_func_ptr()->get_phi(projected_obs, upgrade_run.get_ctl_pars(), *regul_scheme_ptr);
+	double reduction_ratio = (base_phi > proj_phi) ? (base_phi - new_phi) / (base_phi - proj_phi) : 0.0;
+	os << endl << "  Jacobian update: actual phi reduction / linearly predicted phi reduction = " << reduction_ratio << endl;
+
+	string reason;
+	if (secant_numeric_pars.empty())
+		reason = "no successful upgrade runs";
+	else if (new_phi >= base_phi)
+		reason = "phi did not decrease";
+	else if (reduction_ratio < jac_update_phi_ratio)
+		reason = "phi reduction ratio is less than jac_update_phi_ratio";
+	else if (n_jac_update_iter >= jac_update_max_iter)
+		reason = "jac_update_max_iter consecutive updated jacobians have been used";
+	else if (!jacobian.get_failed_parameter_names().empty())
+		reason = "the jacobian has failed parameter runs";
+	int n_secant = 0;
+	if (reason.empty())
+	{
+		n_secant = jacobian.secant_update(base_numeric_pars, base_run.get_obs(), secant_numeric_pars, secant_obs,
+			jac_update == JacUpdate::SCHUBERT);
+		if (n_secant == 0)
+			reason = "the upgrade runs did not change the parameters";
+	}
+	if (!reason.empty())
+	{
+		os << "    full jacobian will be computed next iteration: " << reason << endl;
+		return false;
+	}
+	jacobian.set_base_numeric_pars(upgrade_numeric_pars);
+	jacobian.set_base_sim_obs(upgrade_run.get_obs());
+	++n_jac_update_iter;
+	//a jacobian read from file has no run count, so count a forward difference run per parameter
+	int runs_saved = (last_jac_runs > 0) ? last_jac_runs : numeric_par_names.size();
+	jac_runs_saved += runs_saved;
+	os << "    jacobian updated (" << ((jac_update == JacUpdate::SCHUBERT) ? "Schubert" : "Broyden") << ") from "
+		<< n_secant << " upgrade runs, " << runs_saved << " model runs saved (" << jac_runs_saved << " in total)" << endl;
+	cout << "  jacobian updated from " << n_secant << " upgrade runs, " << runs_saved << " model runs saved" << endl;
+	return true;
+}
+
 void SVDSolver::check_limits(const Parameters &init_active_ctl_pars, const Parameters &upgrade_active_ctl_pars,
 	map<string, LimitType> &limit_type_map, Parameters &active_ctl_parameters_at_limit)
 {
@@ -1776,6 +2071,60 @@ void SVDSolver::dynamic_weight_adj_percent(const ModelRun &base_run, double reg_
 }
 
 
+bool SVDSolver::factor_tikhonov_spectrum(const Jacobian &jacobian, const QSqrtMatrix &Q_sqrt, const DynamicRegularization &regul,
+	const Eigen::VectorXd &Residuals, const vector<string> &obs_name_vec,
+	const Parameters &base_active_ctl_pars, const Parameters &freeze_active_ctl_pars, TikhonovSpectrum &spectrum)
+{
+	// the prior parameter covariance term can not be diagonalized together with the other two
+	if (parcov.nrow() > 0)
+	{
+		return false;
+	}
+	Parameters pars_nf = base_active_ctl_pars;
+	pars_nf.erase(freeze_active_ctl_pars);
+	par_transform.active_ctl2numeric_ip(pars_nf);
+	vector<string> numeric_par_names = pars_nf.get_keys();
+
+	//Compute effect of frozen parameters on the residuals vector the same way as phi_estimate()
+	Parameters delta_freeze_pars = freeze_active_ctl_pars;
+	Parameters base_freeze_pars(base_active_ctl_pars, delta_freeze_pars.get_keys());
+	par_transform.ctl2numeric_ip(delta_freeze_pars);
+	par_transform.ctl2numeric_ip(base_freeze_pars);
+	delta_freeze_pars -= base_freeze_pars;
+	VectorXd del_residuals = calc_residual_corrections(jacobian, delta_freeze_pars, obs_name_vec);
+
+	// split the squared weights into measurement and unit weight regularization parts
+	DynamicRegularization unit_regul = regul;
+	unit_regul.set_weight(1.0);
+	VectorXd q_diag = Q_sqrt.get_sparse_matrix(obs_name_vec, unit_regul, true).diagonal();
+	VectorXd q_meas = VectorXd::Zero(q_diag.size());
+	VectorXd q_reg = VectorXd::Zero(q_diag.size());
+	for (size_t i = 0; i < obs_name_vec.size(); ++i)
+	{
+		bool is_reg = false;
+		auto found_obs = obs_info_ptr->observations.find(obs_name_vec[i]);
+		if (found_obs != obs_info_ptr->observations.end())
+		{
+			is_reg = ObservationGroupRec::is_regularization(found_obs->second.group);
+		}
+		else
+		{
+			auto found_pi = prior_info_ptr->find(obs_name_vec[i]);
+			is_reg = (found_pi != prior_info_ptr->end()) && found_pi->second.is_regularization();
+		}
+		if (is_reg)
+			q_reg(i) = q_diag(i);
+		else
+			q_meas(i) = q_diag(i);
+	}
+
+	performance_log->log_event("factoring measurement and regularization normal matrices");
+	Eigen::SparseMatrix<double> jac = jacobian.get_matrix(obs_name_vec, numeric_par_names);
+	bool success = spectrum.factor(jac, q_meas, q_reg, Residuals + del_residuals, Residuals - del_residuals);
+	performance_log->log_event("factorization complete");
+	return success;
+}
+
 void SVDSolver::dynamic_weight_adj(const ModelRun &base_run, const Jacobian &jacobian, QSqrtMatrix &Q_sqrt,
 	const Eigen::VectorXd &residuals_vec, const vector<string> &obs_names_vec,
 	const Parameters &base_run_active_ctl_par, const Parameters &freeze_active_ctl_pars)
@@ -1839,8 +2188,30 @@ void SVDSolver::dynamic_weight_adj(const ModelRun &base_run, const Jacobian &jac
 	{
 		i_mu.target_phi_meas = target_phi_meas;
 	}
-	PhiComponets proj_phi_cur = phi_estimate(base_run, jacobian, Q_sqrt, *regul_scheme_ptr, residuals_vec, obs_names_vec,
-		base_run_active_ctl_par, freeze_active_ctl_pars, *regul_scheme_ptr);
+
+	// when requested, factor the measurement and regularization normal matrices once so each trial
+	// weight factor is evaluated from the cached spectrum instead of a new upgrade calculation
+	TikhonovSpectrum spectrum;
+	if (reg_weight_spectral)
+	{
+		if (!factor_tikhonov_spectrum(jacobian, Q_sqrt, *regul_scheme_ptr, residuals_vec, obs_names_vec,
+			base_run_active_ctl_par, freeze_active_ctl_pars, spectrum))
+		{
+			os << "    note: unable to factor normal matrices for the spectral weight factor search," << endl;
+			os << "          using upgrade vector estimates instead" << endl;
+		}
+	}
+	auto estimate_phi = [&](double mu) -> PhiComponets
+	{
+		if (spectrum.is_valid())
+		{
+			return spectrum.phi(mu);
+		}
+		tmp_regul_scheme.set_weight(mu);
+		return phi_estimate(base_run, jacobian, Q_sqrt, tmp_regul_scheme, residuals_vec, obs_names_vec,
+			base_run_active_ctl_par, freeze_active_ctl_pars, tmp_regul_scheme);
+	};
+	PhiComponets proj_phi_cur = estimate_phi(mu_cur);
 	double f_cur = proj_phi_cur.meas - target_phi_meas;
 
 	if (f_cur < 0)
@@ -1849,9 +2220,7 @@ void SVDSolver::dynamic_weight_adj(const ModelRun &base_run, const Jacobian &jac
 		double mu_new = mu_vec[0].mu * wffac;
 		mu_new = max(wfmin, mu_new);
 		mu_new = min(mu_new, wfmax);
-		tmp_regul_scheme.set_weight(mu_new);
-		PhiComponets phi_proj_new = phi_estimate(base_run, jacobian, Q_sqrt, tmp_regul_scheme, residuals_vec, obs_names_vec,
-			base_run_active_ctl_par, freeze_active_ctl_pars, tmp_regul_scheme);
+		PhiComponets phi_proj_new = estimate_phi(mu_new);
 		mu_vec[3].set(mu_new, phi_proj_new);
 	}
 	else
@@ -1860,9 +2229,7 @@ void SVDSolver::dynamic_weight_adj(const ModelRun &base_run, const Jacobian &jac
 		double mu_new = mu_vec[3].mu * wffac;
 		mu_new = max(wfmin, mu_new);
 		mu_new = min(mu_new, wfmax);
-		tmp_regul_scheme.set_weight(mu_new);
-		PhiComponets phi_proj_new = phi_estimate(base_run, jacobian, Q_sqrt, tmp_regul_scheme, residuals_vec, obs_names_vec,
-			base_run_active_ctl_par, freeze_active_ctl_pars, tmp_regul_scheme);
+		PhiComponets phi_proj_new = estimate_phi(mu_new);
 		mu_vec[0].set(mu_new, phi_proj_new);
 	}
 
@@ -1879,9 +2246,7 @@ void SVDSolver::dynamic_weight_adj(const ModelRun &base_run, const Jacobian &jac
 		{
 			mu_vec[3] = mu_vec[0];
 			mu_vec[0].mu = max(mu_vec[0].mu / wffac, wfmin);
-			tmp_regul_scheme.set_weight(mu_vec[0].mu);
-			mu_vec[0].phi_comp = phi_estimate(base_run, jacobian, Q_sqrt, tmp_regul_scheme, residuals_vec, obs_names_vec,
-				base_run_active_ctl_par, freeze_active_ctl_pars, tmp_regul_scheme);
+			mu_vec[0].phi_comp = estimate_phi(mu_vec[0].mu);
 			mu_vec[0].print(os);
 			os << endl;
 			cout << "    ...solving for optimal weight factor : " << setw(6) << mu_vec[0].mu << endl << flush;
@@ -1901,9 +2266,7 @@ void SVDSolver::dynamic_weight_adj(const ModelRun &base_run, const Jacobian &jac
 		{
 			mu_vec[0] = mu_vec[3];
 			mu_vec[3].mu = min(mu_vec[3].mu * wffac, wfmax);
-			tmp_regul_scheme.set_weight(mu_vec[3].mu);
-			mu_vec[3].phi_comp = phi_estimate(base_run, jacobian, Q_sqrt, tmp_regul_scheme, residuals_vec, obs_names_vec,
-				base_run_active_ctl_par, freeze_active_ctl_pars, tmp_regul_scheme);
+			mu_vec[3].phi_comp = estimate_phi(mu_vec[3].mu);
 			mu_vec[3].print(os);
 			os << endl;
 			//mu_vec[0].print(cout);
@@ -1916,14 +2279,10 @@ void SVDSolver::dynamic_weight_adj(const ModelRun &base_run, const Jacobian &jac
 	double tau = (sqrt(5.0) - 1.0) / 2.0;
 	double lw = mu_vec[3].mu - mu_vec[0].mu;
 	mu_vec[1].mu = mu_vec[0].mu + (1.0 - tau) * lw;
-	tmp_regul_scheme.set_weight(mu_vec[1].mu);
-	mu_vec[1].phi_comp = phi_estimate(base_run, jacobian, Q_sqrt, tmp_regul_scheme, residuals_vec, obs_names_vec,
-		base_run_active_ctl_par, freeze_active_ctl_pars, tmp_regul_scheme);
+	mu_vec[1].phi_comp = estimate_phi(mu_vec[1].mu);
 
 	mu_vec[2].mu = mu_vec[3].mu - (1.0 - tau) * lw;
-	tmp_regul_scheme.set_weight(mu_vec[2].mu);
-	mu_vec[2].phi_comp = phi_estimate(base_run, jacobian, Q_sqrt, tmp_regul_scheme, residuals_vec, obs_names_vec,
-		base_run_active_ctl_par, freeze_active_ctl_pars, tmp_regul_scheme);
+	mu_vec[2].phi_comp = estimate_phi(mu_vec[2].mu);
 
 	if (mu_vec[0].f() > 0)
 	{
@@ -1960,9 +2319,7 @@ void SVDSolver::dynamic_weight_adj(const ModelRun &base_run, const Jacobian &jac
 				mu_vec[1] = mu_vec[2];
 				lw = mu_vec[3].mu - mu_vec[0].mu;
 				mu_vec[2].mu = mu_vec[3].mu - (1.0 - tau) * lw;
-				tmp_regul_scheme.set_weight(mu_vec[2].mu);
-				mu_vec[2].phi_comp = phi_estimate(base_run, jacobian, Q_sqrt, tmp_regul_scheme, residuals_vec, obs_names_vec,
-					base_run_active_ctl_par, freeze_active_ctl_pars, tmp_regul_scheme);
+				mu_vec[2].phi_comp = estimate_phi(mu_vec[2].mu);
 			}
 			else
 			{
@@ -1970,9 +2327,7 @@ void SVDSolver::dynamic_weight_adj(const ModelRun &base_run, const Jacobian &jac
 				mu_vec[2] = mu_vec[1];
 				lw = mu_vec[3].mu - mu_vec[0].mu;
 				mu_vec[1].mu = mu_vec[0].mu + (1.0 - tau) * lw;
-				tmp_regul_scheme.set_weight(mu_vec[1].mu);
-				mu_vec[1].phi_comp = phi_estimate(base_run, jacobian, Q_sqrt, tmp_regul_scheme, residuals_vec, obs_names_vec,
-					base_run_active_ctl_par, freeze_active_ctl_pars, tmp_regul_scheme);
+				mu_vec[1].phi_comp = estimate_phi(mu_vec[1].mu);
 			}
 
 			auto min_mu = std::min_element(mu_vec.begin(), mu_vec.end());
@@ -26,6 +26,7 @@
 #include "Transformable.h"
 #include "ParamTransformSeq.h"
 #include "Jacobian.h"
+#include "Jacobian_1to1.h"
 #include "pest_data_structs.h"
 #include "ModelRunPP.h"
 #include "TerminationController.h"
@@ -58,6 +59,31 @@ public:
 	bool operator< (const MuPoint &rhs) const;
 };
 
+/** @brief Generalized eigen decomposition of the measurement and regularization normal matrices
+
+Jt*Qm*J and Jt*Qr*J are diagonalized together once so that the linearized measurement and
+regularization objective functions of the Tikhonov solution can be evaluated in O(n) for any
+regularization weight factor.
+*/
+class TikhonovSpectrum
+{
+public:
+	TikhonovSpectrum() : valid(false), phi0_meas(0.0), phi0_reg(0.0) {}
+	bool factor(const Eigen::SparseMatrix<double> &jac, const Eigen::VectorXd &q_meas, const Eigen::VectorXd &q_reg,
+		const Eigen::VectorXd &solve_residuals, const Eigen::VectorXd &phi_residuals);
+	bool is_valid() const { return valid; }
+	PhiComponets phi(double mu) const;
+private:
+	bool valid;
+	double phi0_meas;
+	double phi0_reg;
+	Eigen::VectorXd theta;
+	Eigen::VectorXd s_meas;
+	Eigen::VectorXd s_reg;
+	Eigen::VectorXd p_meas;
+	Eigen::VectorXd p_reg;
+};
+
 
 class SVDSolver
 {
@@ -67,6 +93,7 @@ protected:
 	enum class LimitType {NONE, LBND, UBND, REL, FACT};
 	enum class MarquardtMatrix {IDENT, JTQJ};
 	enum class UpgradeBounds {ROBUST, CHEAP};
+	enum class JacUpdate {NONE, BROYDEN, SCHUBERT};
 public:
 	SVDSolver(Pest &_pest_scenario, FileManager &_file_manager, ObjectiveFunc *_obj_func,
 		const ParamTransformSeq &_par_transform, Jacobian &_jacobian,
@@ -127,10 +154,25 @@ protected:
 	bool terminate_local_iteration;
 	bool der_forgive;
 	bool upgrade_augment;
+	int jtqj_num_threads;
 	double reg_frac;
+	bool reg_weight_spectral;
 	Covariance parcov;
 	double parcov_scale_fac;
 	Eigen::SparseMatrix<double> JS;
+	JacUpdate jac_update;
+	double jac_update_phi_ratio;
+	int jac_update_max_iter;
+	bool jacobian_updated;  //jacobian was updated from the upgrade runs of the last iteration
+	int n_jac_update_iter;  //consecutive iterations using an updated jacobian
+	int last_jac_runs;  //model runs used by the last full jacobian
+	int jac_runs_saved;
+	vector<Parameters> secant_numeric_pars;  //successful upgrade runs of the current iteration
+	vector<Observations> secant_obs;
+	double jac_refresh_sen_ratio;
+	double jac_refresh_par_change;
+	int jac_refresh_full_iter;
+	JacRefreshTracker jac_refresh;
 	virtual void limit_parameters_ip(const Parameters &init_active_ctl_pars, Parameters &upgrade_active_ctl_pars,
 		LimitType &limit_type, const Parameters &frozen_ative_ctl_pars);
 	virtual Parameters limit_parameters_freeze_all_ip(const Parameters &init_active_ctl_pars,
@@ -163,6 +205,9 @@ protected:
 		const Eigen::VectorXd &Residuals, const vector<string> &obs_name_vec,
 		const Parameters &base_active_ctl_pars, const Parameters &freeze_active_ctl_pars);
 	void dynamic_weight_adj_percent(const ModelRun &base_run, double reg_frac);
+	bool factor_tikhonov_spectrum(const Jacobian &jacobian, const QSqrtMatrix &Q_sqrt, const DynamicRegularization &regul,
+		const Eigen::VectorXd &Residuals, const vector<string> &obs_name_vec,
+		const Parameters &base_active_ctl_pars, const Parameters &freeze_active_ctl_pars, TikhonovSpectrum &spectrum);
 	bool par_heading_out_bnd(double org_par, double new_par, double lower_bnd, double upper_bnd);
 	double sidi_method(const vector<double> &x, const vector<double> &y);
 	double secant_method(double x0, double y0, double x1, double y1);
@@ -172,6 +217,8 @@ protected:
 		const Eigen::VectorXd &residuals_vec, const vector<string> &obs_names_vec,
 		const Parameters &base_run_active_ctl_par, const Parameters &freeze_active_ctl_pars,
 		DynamicRegularization &tmp_regul_scheme, bool scale_upgrade = false);
+	bool update_jacobian(ModelRun &base_run, ModelRun &upgrade_run, ostream &os);
+	set<string> get_jac_carry_forward_pars(ModelRun &base_run, const vector<string> &numeric_par_names, int iter, ostream &os);
 	int check_bnd_par(Parameters &new_freeze_active_ctl_pars, const Parameters &current_active_ctl_pars, const Parameters &new_upgrade_active_ctl_pars, const Parameters &new_grad_active_ctl_pars = Parameters());
 };
 
@@ -46,95 +46,82 @@ void SVD_PROPACK::solve_ip(Eigen::SparseMatrix<double>& A, VectorXd &Sigma, Eige
 	solve_ip(A, Sigma, U, Vt, Sigma_trunc, eign_thres);
 }
 
-void SVD_PROPACK::solve_ip(Eigen::SparseMatrix<double>& A, VectorXd &Sigma, Eigen::SparseMatrix<double> &U, Eigen::SparseMatrix<double>& Vt, VectorXd &Sigma_trunc, double _eigen_thres)
+void SVD_PROPACK::set_operator_size(int n_nonzero)
 {
-	class local_utils {
-		public:
-		static void init_array(double data[], int len, double value = 0.0)
-		{
-			for(int i=0; i<len; ++i)
-			{
-				data[i] = value;
-			}
-		}
-	};
-	int m_rows = A.rows();
-	int n_cols = A.cols();
-	int n_nonzero;
-	int k = min(m_rows, n_cols);
-	k = min(n_max_sing, k);
-        int kmax = k;
-	int ioption[] = {0, 1};
+	//the operator arrays are completely overwritten by the callers, so only grow them
+	if (dparm.size() < n_nonzero)
+		dparm.resize(n_nonzero);
+	if (iparm.size() < 2 * n_nonzero + 1)
+		iparm.resize(2 * n_nonzero + 1);
+	iparm[0] = n_nonzero;
+}
+
+int SVD_PROPACK::dlansvd_ip(int m_rows, int n_cols, int kmax)
+{
+	int k = kmax;
+	int ioption[] = { 0, 1 };
 	char eps_char = 'e';
 	double eps = DEF_DLAMCH(&eps_char);
-	double doption[] = {0.0, sqrt(eps), pow(eps, 3.0/4.0), 0.0};
-	int ierr = 0;
-
-	//count number of nonzero entries
-	n_nonzero = A.nonZeros();
-
-	// Allocate and initialize arrays
-	double *dparm = new double[n_nonzero];
-	int *iparm = new int[2*n_nonzero+1];
-	double *tmp_u = new double[m_rows*(kmax+1)];
-	double *tmp_sigma = new double[k];
-	double *tmp_bnd = new double[k];
-	double *tmp_v = new double[n_cols*kmax];
+	double doption[] = { 0.0, sqrt(eps), pow(eps, 3.0 / 4.0), 0.0 };
 	int nb = 1;
-	int lwork =  m_rows + n_cols + 9*kmax + 5*kmax*kmax + 4 + max(3*kmax*kmax+4*kmax+4, nb*max(m_rows,n_cols));
+	int lwork = m_rows + n_cols + 9 * kmax + 5 * kmax*kmax + 4 + max(3 * kmax*kmax + 4 * kmax + 4, nb*max(m_rows, n_cols));
+	int liwork = 8 * kmax;
 	if (performance_log)
 	{
 		stringstream info_str;
-		info_str << "allocating lwork; size = " << lwork << endl;
+		info_str << "sizing DLANSVD workspace; lwork = " << lwork << ", liwork = " << liwork << endl;
 		performance_log->log_event(info_str.str());
 	}
-	double *tmp_work = new double[lwork];
-	//cerr << "lwork allocated" << endl;
-	int liwork = 8*kmax;
+	//assign() keeps the existing capacity, so repeated solves of the same size do not allocate
+	tmp_u.assign(m_rows*(kmax + 1), 0.0);
+	tmp_sigma.assign(k, 0.0);
+	tmp_bnd.assign(k, 0.0);
+	tmp_v.assign(n_cols*kmax, 0.0);
+	tmp_work.assign(lwork, 0.0);
+	tmp_iwork.assign(liwork, 0);
+	char jobu = 'Y';
+	char jobv = 'Y';
+	long jobu_len = 1;
+	long jobv_len = 1;
+	int ld_tmpu = m_rows;
+	int ld_tmpv = n_cols;
+
+	// Compute singluar values and vectors
+	int info = 0;
+	double tolin = 1.0E-4;
 	if (performance_log)
 	{
-		stringstream info_str;
-		info_str << "allocating tmp_iwork; size = " << liwork << endl;
-		performance_log->log_event(info_str.str());
+		performance_log->log_event("calling DEF_DLANSVD");
 	}
-	int *tmp_iwork = new int[liwork];
-	iparm[0] = n_nonzero;
+	DEF_DLANSVD(&jobu, &jobv, &m_rows, &n_cols, &k, &kmax, tmp_u.data(), &ld_tmpu, tmp_sigma.data(), tmp_bnd.data(),
+		tmp_v.data(), &ld_tmpv, &tolin, tmp_work.data(), &lwork, tmp_iwork.data(), &liwork, doption, ioption, &info,
+		dparm.data(), iparm.data(), &jobu_len, &jobv_len);
+	return info;
+}
+
+void SVD_PROPACK::solve_ip(Eigen::SparseMatrix<double>& A, VectorXd &Sigma, Eigen::SparseMatrix<double> &U, Eigen::SparseMatrix<double>& Vt, VectorXd &Sigma_trunc, double _eigen_thres)
+{
+	int m_rows = A.rows();
+	int n_cols = A.cols();
+	int k = min(m_rows, n_cols);
+	k = min(n_max_sing, k);
+	int kmax = k;
+
+	//count number of nonzero entries
+	int n_nonzero = A.nonZeros();
+	set_operator_size(n_nonzero);
 	int n=0;
-	double data;
 	for (int icol=0; icol<A.outerSize(); ++icol)
 	{
 		for (SparseMatrix<double>::InnerIterator it(A, icol); it; ++it)
 		{
-			data = it.value();
-			dparm[n] = data;
+			dparm[n] = it.value();
 			++n;
 			iparm[n] = it.row()+1;
 			iparm[n_nonzero+n] = it.col()+1;
 		}
 	}
-	local_utils::init_array(tmp_u, m_rows*(kmax+1), 0.0);
-	local_utils::init_array(tmp_sigma, k, 0.0);
-	local_utils::init_array(tmp_bnd, k, 0.0);;
-	local_utils::init_array(tmp_v, n_cols*kmax, 0.0);
-	local_utils::init_array(tmp_work,lwork, 0.0);
-	char jobu = 'Y';
-    char jobv = 'Y';
-	long jobu_len = 1;
-	long jobv_len = 1;
-	int ld_tmpu = m_rows;
-	int ld_tmpv = n_cols;
-	int ld_tmpb = kmax;
-
-	// Compute singluar values and vectors
-	int info=0;
-	double tolin = 1.0E-4 ;
-	if (performance_log)
-	{
-		performance_log->log_event("calling DEF_DLANSVD");
-	}
-	DEF_DLANSVD(&jobu, &jobv, &m_rows, &n_cols, &k, &kmax, tmp_u, &ld_tmpu, tmp_sigma, tmp_bnd,
-		   tmp_v, &ld_tmpv, &tolin, tmp_work, &lwork, tmp_iwork, &liwork, doption, ioption, &info,
-		   dparm,iparm, &jobu_len, &jobv_len);
+	int info = dlansvd_ip(m_rows, n_cols, kmax);
 
 	if (performance_log)
 	{
@@ -173,7 +160,7 @@ void SVD_PROPACK::solve_ip(Eigen::SparseMatrix<double>& A, VectorXd &Sigma, Eige
 	}
 
 	std::vector<Eigen::Triplet<double> > triplet_list;
-	triplet_list.reserve(n_sing_used);
+	triplet_list.reserve(n_sing_used * max(m_rows, n_cols));
 	// Update U
 	for (int i_sing = 0; i_sing<n_sing_used; ++i_sing)
 	{
@@ -204,79 +191,23 @@ void SVD_PROPACK::solve_ip(Eigen::SparseMatrix<double>& A, VectorXd &Sigma, Eige
 	Vt.resize(n_sing_used, n_cols);
 	Vt.setZero();
 	Vt.setFromTriplets(triplet_list.begin(), triplet_list.end());
-
-	delete [] dparm;
-	delete [] iparm;
-	delete [] tmp_u;
-	delete [] tmp_sigma;
-	delete [] tmp_bnd;
-	delete [] tmp_v;
-	delete [] tmp_work;
-	delete [] tmp_iwork;
-
 }
 
 
 void SVD_PROPACK::solve_ip(Eigen::MatrixXd& A, Eigen::MatrixXd &Sigma, Eigen::MatrixXd& U, Eigen::MatrixXd& V, double _eigen_thres, int _max_sing)
 {
-	class local_utils {
-	public:
-		static void init_array(double data[], int len, double value = 0.0)
-		{
-			for (int i = 0; i<len; ++i)
-			{
-				data[i] = value;
-			}
-		}
-	};
 	int m_rows = A.rows();
 	int n_cols = A.cols();
-	int n_nonzero;
 	int k = min(m_rows, n_cols);
 	k = min(n_max_sing, k);
 	int kmax = k;
-	int ioption[] = { 0, 1 };
-	char eps_char = 'e';
-	double eps = DEF_DLAMCH(&eps_char);
-	double doption[] = { 0.0, sqrt(eps), pow(eps, 3.0 / 4.0), 0.0 };
-	int ierr = 0;
-
-	//count number of nonzero entries
-	//n_nonzero = A.nonZeros();
-	n_nonzero = m_rows * n_cols;
 
-	// Allocate and initialize arrays
-	double *dparm = new double[n_nonzero];
-	int *iparm = new int[2 * n_nonzero + 1];
-	double *tmp_u = new double[m_rows*(kmax + 1)];
-	double *tmp_sigma = new double[k];
-	double *tmp_bnd = new double[k];
-	double *tmp_v = new double[n_cols*kmax];
-	int nb = 1;
-	int lwork = m_rows + n_cols + 9 * kmax + 5 * kmax*kmax + 4 + max(3 * kmax*kmax + 4 * kmax + 4, nb*max(m_rows, n_cols));
-	if (performance_log)
-	{
-		stringstream info_str;
-		info_str << "allocating lwork; size = " << lwork << endl;
-		performance_log->log_event(info_str.str());
-	}
-	double *tmp_work = new double[lwork];
-	//cerr << "lwork allocated" << endl;
-	int liwork = 8 * kmax;
-	if (performance_log)
-	{
-		stringstream info_str;
-		info_str << "allocating tmp_iwork; size = " << liwork << endl;
-		performance_log->log_event(info_str.str());
-	}
-	int *tmp_iwork = new int[liwork];
-	iparm[0] = n_nonzero;
+	//the dense matrix is passed to aprod as a full coordinate list
+	int n_nonzero = m_rows * n_cols;
+	set_operator_size(n_nonzero);
 	int n = 0;
-	double data;
-	//for (int icol = 0; icol<A.outerSize(); ++icol)
 	for (int icol = 0; icol < n_cols; ++icol)
 	{
-		//for (SparseMatrix<double>::InnerIterator it(A, icol); it; ++it)
 		for (int jrow=0;jrow< m_rows;++jrow)
 		{
 			dparm[n] = A(jrow,icol);
@@ -285,29 +216,7 @@ void SVD_PROPACK::solve_ip(Eigen::MatrixXd& A, Eigen::MatrixXd &Sigma, Eigen::Ma
 			iparm[n_nonzero + n] = icol + 1;
 		}
 	}
-	local_utils::init_array(tmp_u, m_rows*(kmax + 1), 0.0);
-	local_utils::init_array(tmp_sigma, k, 0.0);
-	local_utils::init_array(tmp_bnd, k, 0.0);;
-	local_utils::init_array(tmp_v, n_cols*kmax, 0.0);
-	local_utils::init_array(tmp_work, lwork, 0.0);
-	char jobu = 'Y';
-	char jobv = 'Y';
-	long jobu_len = 1;
-	long jobv_len = 1;
-	int ld_tmpu = m_rows;
-	int ld_tmpv = n_cols;
-	int ld_tmpb = kmax;
-
-	// Compute singluar values and vectors
-	int info = 0;
-	double tolin = 1.0E-4;
-	if (performance_log)
-	{
-		performance_log->log_event("calling DEF_DLANSVD");
-	}
-	DEF_DLANSVD(&jobu, &jobv, &m_rows, &n_cols, &k, &kmax, tmp_u, &ld_tmpu, tmp_sigma, tmp_bnd,
-		tmp_v, &ld_tmpv, &tolin, tmp_work, &lwork, tmp_iwork, &liwork, doption, ioption, &info,
-		dparm, iparm, &jobu_len, &jobv_len);
+	int info = dlansvd_ip(m_rows, n_cols, kmax);
 
 	if (performance_log)
 	{
@@ -330,52 +239,12 @@ void SVD_PROPACK::solve_ip(Eigen::MatrixXd& A, Eigen::MatrixXd &Sigma, Eigen::Ma
 			break;
 		}
 	}
-	// Update Sigma
-	Sigma.resize(n_sing_used, n_sing_used);
-	Sigma.setConstant(0.0);
-	for (int i_sing = 0; i_sing<n_sing_used; ++i_sing)
-	{
-		Sigma(i_sing,i_sing) = tmp_sigma[i_sing];
-	}
-
-	/*Sigma_trunc.resize(kmax - n_sing_used);
-	Sigma_trunc.setConstant(0.0);
-	for (int i_sing = n_sing_used; i_sing<kmax; ++i_sing)
-	{
-		Sigma_trunc(i_sing - n_sing_used) = tmp_sigma[i_sing];
-	}*/
-	
-	// Update U
-	U.resize(m_rows, n_sing_used);
-	U.setZero();
-	for (int i_sing = 0; i_sing<n_sing_used; ++i_sing)
-	{
-		for (int irow = 0; irow<m_rows; ++irow)
-		{
-			U(irow, i_sing) = tmp_u[i_sing*m_rows + irow];
-		}
-	}
-	
-	// Update Vt
-	V.resize(n_sing_used, n_cols);
-	V.setZero();
-	for (int i_sing = 0; i_sing<n_sing_used; ++i_sing)
-	{
-		for (int icol = 0; icol<n_cols; ++icol)
-		{
-			V(i_sing, icol) = tmp_v[i_sing*n_cols + icol];
-		}
-	}
-	V.transposeInPlace();
+	// Update Sigma - a column of singular values, the same shape the other packages return
+	Sigma = Eigen::Map<Eigen::VectorXd>(tmp_sigma.data(), n_sing_used);
 
-	delete[] dparm;
-	delete[] iparm;
-	delete[] tmp_u;
-	delete[] tmp_sigma;
-	delete[] tmp_bnd;
-	delete[] tmp_v;
-	delete[] tmp_work;
-	delete[] tmp_iwork;
+	// Update U and V straight from the column-major workspace
+	U = Eigen::Map<Eigen::MatrixXd>(tmp_u.data(), m_rows, n_sing_used);
+	V = Eigen::Map<Eigen::MatrixXd>(tmp_v.data(), n_cols, n_sing_used);
 }
 
 
@@ -20,6 +20,7 @@
 #define SVD_PROPACK_H_
 
 #include "SVDPackage.h"
+#include <vector>
 #include<Eigen/Dense>
 #include<Eigen/Sparse>
 
@@ -27,12 +28,20 @@ class SVD_PROPACK  : public SVDPackage
 {
 public:
 	SVD_PROPACK(int _n_max_sing = 1000, double _eign_thres = 1.0e-7);
+	SVD_PROPACK(const SVD_PROPACK &rhs) : SVDPackage(rhs) {}
+	virtual SVD_PROPACK *clone() const { return new SVD_PROPACK(*this); }
 	void solve_ip(Eigen::SparseMatrix<double>& A, Eigen::VectorXd &Sigma, Eigen::SparseMatrix<double>& U, Eigen::SparseMatrix<double>& Vt, Eigen::VectorXd &Sigma_trunc);
 	void solve_ip(Eigen::SparseMatrix<double>& A, Eigen::VectorXd &Sigma, Eigen::SparseMatrix<double> &U, Eigen::SparseMatrix<double>& Vt, Eigen::VectorXd &Sigma_trunc, double _eigen_thres);
 	void solve_ip(Eigen::MatrixXd& A, Eigen::MatrixXd &Sigma, Eigen::MatrixXd& U, Eigen::MatrixXd& V, double _eigen_thres, int _max_sing);
 	void test();
 	~SVD_PROPACK(void);
 private:
+	//DLANSVD operands and workspace, grown on demand and reused by later solves.  Copies start
+	//with an empty workspace so concurrent callers each use their own clone
+	std::vector<double> dparm, tmp_u, tmp_sigma, tmp_bnd, tmp_v, tmp_work;
+	std::vector<int> iparm, tmp_iwork;
+	void set_operator_size(int n_nonzero);
+	int dlansvd_ip(int m_rows, int n_cols, int kmax);
 };
 
 #endif /*SVD_PROPACK_H_*/
@@ -585,6 +585,33 @@ void TranSVD::set_SVD_pack_propack()
 	tran_svd_pack = new SVD_PROPACK(max_sing, eigthresh);
 }
 
+void TranSVD::set_SVD_pack_randomized()
+{
+	int max_sing = tran_svd_pack->get_max_sing();
+	double eigthresh = tran_svd_pack->get_eign_thres();
+	delete tran_svd_pack;
+	tran_svd_pack = new SVD_RANDOMIZED(max_sing, eigthresh);
+}
+
+void TranSVD::seed_svd_pack(const vector<string> &prev_par_names)
+{
+	//start the next solve from the current right singular vectors, matched by parameter name
+	if ((Vt.rows() == 0) || (Vt.cols() != prev_par_names.size()))
+		return;
+	map<string, int> prev_idx;
+	for (int i = 0; i < prev_par_names.size(); ++i)
+		prev_idx[prev_par_names[i]] = i;
+	MatrixXd Vt_prev = Vt;
+	MatrixXd V = MatrixXd::Zero(base_parameter_names.size(), Vt_prev.rows());
+	for (int i = 0; i < base_parameter_names.size(); ++i)
+	{
+		auto iter = prev_idx.find(base_parameter_names[i]);
+		if (iter != prev_idx.end())
+			V.row(i) = Vt_prev.col(iter->second).transpose();
+	}
+	tran_svd_pack->set_start_subspace(V);
+}
+
 void TranSVD::set_performance_log(PerformanceLog *performance_log)
 {
 	tran_svd_pack->set_performance_log(performance_log);
@@ -629,6 +656,7 @@ void TranSVD::update_reset_frozen_pars(const Jacobian &jacobian, const QSqrtMatr
 	debug_print(_frozen_derivative_pars);
 	stringstream sup_name;
 	super_parameter_names.clear();
+	vector<string> prev_par_names = base_parameter_names;
 
 	tran_svd_pack->set_max_sing(maxsing);
 	tran_svd_pack->set_eign_thres(_eigthresh);
@@ -650,6 +678,7 @@ void TranSVD::update_reset_frozen_pars(const Jacobian &jacobian, const QSqrtMatr
 
 	SqrtQ_J = Q_sqrt.get_sparse_matrix(obs_names, DynamicRegularization::get_unit_reg_instance()) * jacobian.get_matrix(obs_names, base_parameter_names);
 
+	seed_svd_pack(prev_par_names);
 	calc_svd();
 	debug_print(this->base_parameter_names);
 	debug_print(this->frozen_derivative_parameters);
@@ -687,10 +716,12 @@ void TranSVD::update_add_frozen_pars(const Parameters &frozen_pars)
 		throw PestError("TranSVD::update_add_frozen_pars - All parameters are frozen in SVD transformation");
 	}
 	//remove frozen parameters from base_parameter_names
+	vector<string> prev_par_names = base_parameter_names;
 	auto end_iter = std::remove_if(base_parameter_names.begin(), base_parameter_names.end(),
 		[&new_frozen_pars](string &str)->bool{return new_frozen_pars.find(str)!=new_frozen_pars.end();});
 	base_parameter_names.resize(std::distance(base_parameter_names.begin(), end_iter));
 	matrix_del_cols(SqrtQ_J, del_col_ids);
+	seed_svd_pack(prev_par_names);
 	calc_svd();
 	debug_print(this->base_parameter_names);
 	debug_print(this->frozen_derivative_parameters);
@@ -291,6 +291,7 @@ public:
 	TranSVD(int _max_sing, double _eign_thresh, const string &_name = "unnamed TranSVD");
 	TranSVD(const TranSVD &rhs);
 	void set_SVD_pack_propack();
+	void set_SVD_pack_randomized();
 	void update_reset_frozen_pars(const Jacobian &jacobian, const QSqrtMatrix &Q_sqrt, const Parameters &base_numeric_pars,
 		int maxsing, double eigthresh, const vector<string> &par_names, const vector<string> &obs_names,
 		const Parameters &_frozen_derivative_pars=Parameters());
@@ -328,6 +329,7 @@ protected:
 	Parameters init_base_numeric_parameters;
 	Parameters frozen_derivative_parameters;
 	void calc_svd();
+	void seed_svd_pack(const vector<string> &prev_par_names);
 };
 
 class TranNormalize: public Transformation {
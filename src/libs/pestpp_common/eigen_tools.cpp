@@ -26,6 +26,11 @@
 #include <string>
 #include <cstdio>
 #include <cstdint>
+#include <cassert>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <exception>
 
 
 using namespace Eigen;
@@ -272,3 +277,190 @@ Eigen::SparseMatrix<double> eigenvec_2_diagsparse(Eigen::VectorXd vec)
 
 
 }
+
+Eigen::SparseMatrix<double> calc_weighted_normal_matrix(const Eigen::SparseMatrix<double> &jac, const Eigen::SparseMatrix<double> &q,
+	int num_threads, double dense_fill)
+{
+	const int n_obs = jac.rows();
+	const int n_par = jac.cols();
+	assert(q.rows() == n_obs && q.cols() == n_obs);
+	// extract the diagonal of Q, or fall back to the general product if Q has off diagonal entries
+	VectorXd q_diag = VectorXd::Zero(n_obs);
+	bool q_nonneg = true;
+	for (int k = 0; k < q.outerSize(); ++k)
+	{
+		for (SparseMatrix<double>::InnerIterator it(q, k); it; ++it)
+		{
+			if (it.row() != it.col())
+			{
+				if (it.value() != 0.0)
+					return SparseMatrix<double>(jac.transpose() * q * jac);
+				continue;
+			}
+			q_diag(it.row()) = it.value();
+			if (it.value() < 0.0)
+				q_nonneg = false;
+		}
+	}
+
+	int n_threads = num_threads;
+	if (n_threads < 1)
+	{
+		n_threads = max(1, int(thread::hardware_concurrency()));
+	}
+	n_threads = max(1, min(n_threads, n_par));
+	const int col_block = 32;
+	atomic<int> next_block(0);
+	vector<vector<Triplet<double> > > thread_triplets(n_threads);
+	vector<exception_ptr> exception_ptrs(n_threads);
+	auto run_threads = [&](const function<void(int)> &work)
+	{
+		if (n_threads < 2)
+		{
+			work(0);
+			return;
+		}
+		vector<thread> threads;
+		for (int i = 0; i < n_threads; ++i)
+		{
+			threads.push_back(thread([&, i]()
+			{
+				try
+				{
+					work(i);
+				}
+				catch (...)
+				{
+					exception_ptrs[i] = current_exception();
+				}
+			}));
+		}
+		for (auto &t : threads)
+		{
+			t.join();
+		}
+		for (auto &eptr : exception_ptrs)
+		{
+			if (eptr)
+			{
+				rethrow_exception(eptr);
+			}
+		}
+	};
+
+	SparseMatrix<double, RowMajor> jac_rows(jac);
+	jac_rows.makeCompressed();
+	const int *row_ptr = jac_rows.outerIndexPtr();
+	const int *col_idx = jac_rows.innerIndexPtr();
+	const double *row_val = jac_rows.valuePtr();
+	double fill = (n_obs > 0 && n_par > 0) ? double(jac.nonZeros()) / (double(n_obs) * double(n_par)) : 0.0;
+	if (fill > dense_fill && q_nonneg)
+	{
+		// dense path: W = sqrt(Q) J is filled one panel of rows at a time into a reused buffer (about 32 MB) and
+		// W^T W is accumulated into the lower triangle one block of columns at a time
+		const int row_panel = max(1, min(n_obs, max(64, (1 << 22) / max(1, n_par))));
+		MatrixXd w(row_panel, n_par);
+		MatrixXd normal = MatrixXd::Zero(n_par, n_par);
+		for (int r0 = 0; r0 < n_obs; r0 += row_panel)
+		{
+			int n_rows = min(row_panel, n_obs - r0);
+			w.topRows(n_rows).setZero();
+			for (int r = 0; r < n_rows; ++r)
+			{
+				double q_sqrt = sqrt(q_diag(r0 + r));
+				for (int p = row_ptr[r0 + r]; p < row_ptr[r0 + r + 1]; ++p)
+					w(r, col_idx[p]) = q_sqrt * row_val[p];
+			}
+			next_block = 0;
+			run_threads([&](int thread_id)
+			{
+				int j0;
+				while ((j0 = (next_block++) * col_block) < n_par)
+				{
+					int n_cols = min(col_block, n_par - j0);
+					normal.block(j0, j0, n_par - j0, n_cols).noalias() +=
+						w.block(0, j0, n_rows, n_par - j0).transpose() * w.block(0, j0, n_rows, n_cols);
+				}
+			});
+		}
+		// mirror the lower triangle
+		vector<Triplet<double> > triplet_list;
+		for (int j = 0; j < n_par; ++j)
+		{
+			for (int i = j; i < n_par; ++i)
+			{
+				double val = normal(i, j);
+				if (val == 0.0)
+					continue;
+				triplet_list.push_back(Triplet<double>(i, j, val));
+				if (i != j)
+					triplet_list.push_back(Triplet<double>(j, i, val));
+			}
+		}
+		SparseMatrix<double> result(n_par, n_par);
+		result.setFromTriplets(triplet_list.begin(), triplet_list.end());
+		return result;
+	}
+
+	// sparse path: column j of the lower triangle is sum_k q_k J(k,j) J(k,i>=j), accumulated from the rows of J
+	run_threads([&](int thread_id)
+	{
+		vector<double> acc(n_par, 0.0);
+		vector<char> touched(n_par, 0);
+		vector<int> touched_idx;
+		vector<Triplet<double> > &t_list = thread_triplets[thread_id];
+		int j_beg;
+		while ((j_beg = (next_block++) * col_block) < n_par)
+		{
+			int j_end = min(n_par, j_beg + col_block);
+			for (int j = j_beg; j < j_end; ++j)
+			{
+				for (SparseMatrix<double>::InnerIterator it(jac, j); it; ++it)
+				{
+					int k = it.row();
+					double wv = q_diag(k) * it.value();
+					if (wv == 0.0)
+						continue;
+					const int *beg = lower_bound(col_idx + row_ptr[k], col_idx + row_ptr[k + 1], j);
+					for (const int *p = beg; p != col_idx + row_ptr[k + 1]; ++p)
+					{
+						int i = *p;
+						acc[i] += wv * row_val[p - col_idx];
+						if (!touched[i])
+						{
+							touched[i] = 1;
+							touched_idx.push_back(i);
+						}
+					}
+				}
+				for (int i : touched_idx)
+				{
+					if (acc[i] != 0.0)
+					{
+						t_list.push_back(Triplet<double>(i, j, acc[i]));
+						if (i != j)
+							t_list.push_back(Triplet<double>(j, i, acc[i]));
+					}
+					acc[i] = 0.0;
+					touched[i] = 0;
+				}
+				touched_idx.clear();
+			}
+		}
+	});
+	vector<Triplet<double> > triplet_list;
+	size_t n_triplets = 0;
+	for (const auto &t_list : thread_triplets)
+	{
+		n_triplets += t_list.size();
+	}
+	triplet_list.reserve(n_triplets);
+	for (auto &t_list : thread_triplets)
+	{
+		triplet_list.insert(triplet_list.end(), t_list.begin(), t_list.end());
+		vector<Triplet<double> >().swap(t_list);
+	}
+	SparseMatrix<double> result(n_par, n_par);
+	result.setFromTriplets(triplet_list.begin(), triplet_list.end());
+	return result;
+}
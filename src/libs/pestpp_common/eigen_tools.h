@@ -48,4 +48,12 @@ bool load_vector_bin(Eigen::VectorXd &vec, std::istream &fin);
 
 Eigen::SparseMatrix<double> eigenvec_2_diagsparse(Eigen::VectorXd vec);
 
+//weighted normal matrix J^T Q J for a symmetric weight matrix Q.  A diagonal Q is applied as a row scaling of J and only
+//one triangle of the product is computed, in blocks of columns on num_threads threads (0 = one per core), before it is
+//mirrored.  When the fill of J exceeds dense_fill the product is accumulated from dense panels of rows of sqrt(Q) J
+//(a blocked SYRK), so only one panel of J is ever held densely.
+//A non-diagonal Q falls back to the general sparse product
+Eigen::SparseMatrix<double> calc_weighted_normal_matrix(const Eigen::SparseMatrix<double> &jac, const Eigen::SparseMatrix<double> &q,
+	int num_threads = 0, double dense_fill = 0.25);
+
 #endif /* EIGEN_TOOLS_H_ */
@@ -25,6 +25,7 @@
 #include <sstream>
 #include <list>
 #include <regex>
+#include <atomic>
 #include "pest_data_structs.h"
 #include "utilities.h"
 #include "pest_error.h"
@@ -297,6 +298,20 @@ ostream& operator<< (ostream &os, const PestppOptions& val)
 		os << " no" << endl;
 	if (val.get_reg_frac() > 0.0)
 		os << "    regularization fraction of total phi = " << left << setw(10) << val.get_reg_frac() << endl;
+	os << "    spectral regularization weight factor search = " << left << setw(10) << val.get_reg_weight_spectral() << endl;
+	if (val.get_jac_update() != "NONE")
+	{
+		os << "    jacobian update between full jacobians = " << left << setw(10) << val.get_jac_update() << endl;
+		os << "    jacobian update minimum phi reduction ratio = " << left << setw(10) << val.get_jac_update_phi_ratio() << endl;
+		os << "    jacobian update maximum consecutive iterations = " << left << setw(10) << val.get_jac_update_max_iter() << endl;
+	}
+	if (val.get_jac_refresh_sen_ratio() > 0.0)
+	{
+		os << "    selective jacobian refresh sensitivity ratio = " << left << setw(10) << val.get_jac_refresh_sen_ratio() << endl;
+		os << "    selective jacobian refresh parameter change = " << left << setw(10) << val.get_jac_refresh_par_change() << endl;
+		os << "    selective jacobian refresh full jacobian interval = " << left << setw(10) << val.get_jac_refresh_full_iter() << endl;
+	}
+	os << "    model supplied derivative check parameters = " << left << setw(10) << val.get_der_check_npar() << endl;
 	os << "    lambdas = " << endl;
 	for (auto &lam : val.get_base_lambda_vec())
 	{
@@ -331,7 +346,10 @@ ostream& operator<< (ostream &os, const PestppOptions& val)
 	os << "    run overdue reschedule factor = " << left << setw(20) << val.get_overdue_reched_fac() << endl;
 	os << "    run overdue giveup factor = " << left << setw(20) << val.get_overdue_giveup_fac() << endl;
 	os << "    base parameter jacobian filename = " << left << setw(20) << val.get_basejac_filename() << endl;
+	os << "    write jacobian files in background = " << left << setw(20) << val.get_jco_background_write() << endl;
 	os << "    prior parameter covariance upgrade scaling factor = " << left << setw(10) << val.get_parcov_scale_fac() << endl;
+	os << "    JtQJ threads = " << left << setw(10) << val.get_jtqj_num_threads() << endl;
+	os << "    jacobian threads = " << left << setw(10) << val.get_jac_num_threads() << endl;
 	if (val.get_global_opt() == PestppOptions::GLOBAL_OPT::OPT_DE)
 	{
 		os << "    global optimizer = differential evolution (DE)" << endl;
@@ -340,6 +358,7 @@ ostream& operator<< (ostream &os, const PestppOptions& val)
 		os << "    DE population size = " << setw(10) << val.get_de_npopulation() << endl;
 		os << "    DE max generations = " << setw(10) << val.get_de_max_gen() << endl;
 		os << "    DE F dither = " << left << setw(10) << val.get_de_dither_f() << endl;
+		os << "    DE asynchronous = " << left << setw(10) << val.get_de_async() << endl;
 	}
 	os << endl;
 	return os;
@@ -355,7 +374,8 @@ PestppOptions::PestppOptions(int _n_iter_base, int _n_iter_super, int _max_n_sup
 	lambda_scale_vec({1.0}),
 	iter_summary_flag(_iter_summary_flag), der_forgive(_der_forgive), overdue_reched_fac(_overdue_reched_fac),
 	overdue_giveup_fac(_overdue_giveup_fac), reg_frac(_reg_frac), global_opt(_global_opt),
-	de_f(_de_f), de_cr(_de_cr), de_npopulation(_de_npopulation), de_max_gen(_de_max_gen), de_dither_f(_de_dither_f)
+	de_f(_de_f), de_cr(_de_cr), de_npopulation(_de_npopulation), de_max_gen(_de_max_gen), de_dither_f(_de_dither_f),
+	de_async(false), jco_background_write(false), reg_weight_spectral(false), pst_cache(false)
 {
 }
 
@@ -411,6 +431,8 @@ void PestppOptions::parce_line(const string &line)
 				svd_pack = PROPACK;
 			else if (value == "REDSVD")
 				svd_pack = REDSVD;
+			else if ((value == "RANDSVD") || (value == "RANDOMIZED"))
+				svd_pack = RANDSVD;
 			else if ((value == "EIGEN") || (value == "JACOBI"))
 				svd_pack = EIGEN;
 			else
@@ -597,6 +619,14 @@ void PestppOptions::parce_line(const string &line)
 			is >> boolalpha >> upgrade_augment;
 
 		}
+		else if (key == "JTQJ_NUM_THREADS")
+		{
+			convert_ip(value, jtqj_num_threads);
+		}
+		else if (key == "JAC_NUM_THREADS")
+		{
+			convert_ip(value, jac_num_threads);
+		}
 
 		else if (key == "UPGRADE_BOUNDS")
 		{
@@ -606,7 +636,37 @@ void PestppOptions::parce_line(const string &line)
 				convert_ip(value, upgrade_bounds);
 			else
 				throw runtime_error("unrecognozed 'upgrade_bounds' option: should 'robust' or 'cheap'");
-
+		}
+		else if (key == "JAC_UPDATE")
+		{
+			if ((value == "NONE") || (value == "BROYDEN") || (value == "SCHUBERT"))
+				convert_ip(value, jac_update);
+			else
+				throw runtime_error("unrecognized 'jac_update' option: should be 'none', 'broyden' or 'schubert'");
+		}
+		else if (key == "JAC_UPDATE_PHI_RATIO")
+		{
+			convert_ip(value, jac_update_phi_ratio);
+		}
+		else if (key == "JAC_UPDATE_MAX_ITER")
+		{
+			convert_ip(value, jac_update_max_iter);
+		}
+		else if (key == "JAC_REFRESH_SEN_RATIO")
+		{
+			convert_ip(value, jac_refresh_sen_ratio);
+		}
+		else if (key == "JAC_REFRESH_PAR_CHANGE")
+		{
+			convert_ip(value, jac_refresh_par_change);
+		}
+		else if (key == "JAC_REFRESH_FULL_ITER")
+		{
+			convert_ip(value, jac_refresh_full_iter);
+		}
+		else if (key == "DER_CHECK_NPAR")
+		{
+			convert_ip(value, der_check_npar);
 		}
 
 		else if (key == "GLOBAL_OPT")
@@ -635,6 +695,44 @@ void PestppOptions::parce_line(const string &line)
 			istringstream is(value);
 			is >> boolalpha >> de_dither_f;
 		}
+		else if (key == "REG_WEIGHT_SPECTRAL")
+		{
+			transform(value.begin(), value.end(), value.begin(), ::tolower);
+			istringstream is(value);
+			is >> boolalpha >> reg_weight_spectral;
+		}
+		else if (key == "PST_CACHE")
+		{
+			transform(value.begin(), value.end(), value.begin(), ::tolower);
+			istringstream is(value);
+			is >> boolalpha >> pst_cache;
+		}
+		else if (key == "JCO_BACKGROUND_WRITE")
+		{
+			transform(value.begin(), value.end(), value.begin(), ::tolower);
+			istringstream is(value);
+			is >> boolalpha >> jco_background_write;
+		}
+		else if (key == "PERF_TRACE")
+		{
+			transform(value.begin(), value.end(), value.begin(), ::tolower);
+			istringstream is(value);
+			is >> boolalpha >> perf_trace_flag;
+		}
+		else if (key == "PANTHER_METRICS_INTERVAL")
+		{
+			convert_ip(value, panther_metrics_interval);
+		}
+		else if (key == "PANTHER_METRICS_PORT")
+		{
+			convert_ip(value, panther_metrics_port);
+		}
+		else if (key == "DE_ASYNC")
+		{
+			transform(value.begin(), value.end(), value.begin(), ::tolower);
+			istringstream is(value);
+			is >> boolalpha >> de_async;
+		}
 		else if ((key == "OPT_OBJ_FUNC") || (key == "OPT_OBJECTIVE_FUNCTION"))
 		{
 			passed_args.insert("OPT_OBJ_FUNC");
@@ -647,6 +745,12 @@ void PestppOptions::parce_line(const string &line)
 			istringstream is(value);
 			is >> boolalpha >> opt_coin_log;
 		}
+		else if (key == "OPT_LP_WARM_START")
+		{
+			transform(value.begin(), value.end(), value.begin(), ::tolower);
+			istringstream is(value);
+			is >> boolalpha >> opt_lp_warm_start;
+		}
 		else if (key == "OPT_SKIP_FINAL")
 		{
 			transform(value.begin(), value.end(), value.begin(), ::tolower);
@@ -703,6 +807,22 @@ void PestppOptions::parce_line(const string &line)
 			convert_ip(value, opt_risk);
 		}
 
+		else if (key == "OPT_RISK_SWEEP")
+		{
+			opt_risk_sweep.clear();
+			vector<string> risk_tok;
+			tokenize(value, risk_tok, ",");
+			for (const auto &irisk : risk_tok)
+			{
+				opt_risk_sweep.push_back(convert_cp<double>(irisk));
+			}
+		}
+
+		else if (key == "OPT_OBJ_SWEEP_FILE")
+		{
+			opt_obj_sweep_file = org_value;
+		}
+
 		else if (key == "OPT_ITER_DERINC_FAC")
 		{
 			convert_ip(value, opt_iter_derinc_fac);
@@ -849,6 +969,12 @@ void PestppOptions::parce_line(const string &line)
 			istringstream is(value);
 			is >> boolalpha >> ies_save_binary;
 		}
+		else if (key == "IES_CHECKPOINT")
+		{
+			transform(value.begin(), value.end(), value.begin(), ::tolower);
+			istringstream is(value);
+			is >> boolalpha >> ies_checkpoint;
+		}
 		else if (key == "PAR_SIGMA_RANGE")
 		{
 			convert_ip(value, par_sigma_range);
@@ -895,6 +1021,22 @@ void PestppOptions::parce_line(const string &line)
 		{
 			convert_ip(value, ies_localize_how);
 		}
+		else if (key == "IES_LOC_PAR_COORDS")
+		{
+			ies_loc_par_coords = org_value;
+		}
+		else if (key == "IES_LOC_OBS_COORDS")
+		{
+			ies_loc_obs_coords = org_value;
+		}
+		else if (key == "IES_LOC_DISTANCE")
+		{
+			convert_ip(value, ies_loc_distance);
+		}
+		else if (key == "IES_LOC_TAPER")
+		{
+			convert_ip(value, ies_loc_taper);
+		}
 		else if (key == "IES_NUM_THREADS")
 		{
 			convert_ip(value, ies_num_threads);
@@ -962,6 +1104,23 @@ bool ObservationGroupRec::is_regularization(const string &grp_name)
 
 }
 
+size_t ObservationInfo::new_generation()
+{
+	static atomic<size_t> next_generation(0);
+	return ++next_generation;
+}
+
+ObservationInfo& ObservationInfo::operator=(const ObservationInfo &rhs)
+{
+	if (this != &rhs)
+	{
+		groups = rhs.groups;
+		observations = rhs.observations;
+		generation = new_generation();
+	}
+	return *this;
+}
+
 void ObservationInfo::reset_group_weights(string &group, double val)
 {
 	for (auto &o : observations)
@@ -173,8 +173,11 @@ ostream& operator<< (ostream &os, const ObservationRec& val);
 
 class ObservationInfo {
 public:
-	ObservationInfo() {}
-	ObservationInfo(const ObservationInfo & rhs) : groups(rhs.groups), observations(rhs.observations){}
+	ObservationInfo() : generation(new_generation()) {}
+	ObservationInfo(const ObservationInfo & rhs) : groups(rhs.groups), observations(rhs.observations), generation(new_generation()) {}
+	ObservationInfo& operator=(const ObservationInfo &rhs);
+	//changes whenever the observation records may have been replaced, so pointers to them can be cached against it
+	size_t get_generation() const { return generation; }
 	bool is_regularization(const string &obs_name) const;
 	unordered_map<string, ObservationGroupRec> groups;
 	unordered_map<string, ObservationRec> observations;
@@ -189,7 +192,9 @@ public:
 	vector<string> get_groups();
 	void reset_group_weights(string &group, double val);
 	void scale_group_weights(string &group, double scale_val);
-
+private:
+	size_t generation;
+	static size_t new_generation();
 };
 
 class ModelExecInfo {
@@ -199,6 +204,8 @@ public:
 	std::vector<std::string> inpfile_vec;
 	std::vector<std::string> insfile_vec;
 	std::vector<std::string> outfile_vec;
+	std::string dercom;  //derivatives command line, used when jacfile = 1
+	std::string derfile;  //external derivatives file written by dercom
 };
 
 class ParetoInfo {
@@ -212,7 +219,7 @@ public:
 
 class PestppOptions {
 public:
-	enum SVD_PACK { EIGEN, PROPACK, REDSVD };
+	enum SVD_PACK { EIGEN, PROPACK, REDSVD, RANDSVD };
 	enum MAT_INV { Q12J, JTQJ };
 	enum GLOBAL_OPT { NONE, OPT_DE };
 	PestppOptions(int _n_iter_base = 50, int _n_iter_super = 0, int _max_n_super = 50,
@@ -246,6 +253,8 @@ public:
 	int get_de_npopulation() const { return de_npopulation; }
 	int get_de_max_gen() const { return de_max_gen; }
 	bool get_de_dither_f() const { return de_dither_f; }
+	bool get_de_async() const { return de_async; }
+	void set_de_async(bool _de_async) { de_async = _de_async; }
 	void set_global_opt(const GLOBAL_OPT _global_opt) { global_opt = _global_opt; }
 	void set_max_n_super(int _max_n_super) { max_n_super = _max_n_super; }
 	void set_super_eigthres(double _super_eigthres) { super_eigthres = _super_eigthres; }
@@ -295,12 +304,42 @@ public:
 
 	bool get_upgrade_augment()const { return upgrade_augment; }
 	void set_upgrade_augment(bool _upgrade_augment) { upgrade_augment = _upgrade_augment; }
+	int get_jtqj_num_threads() const { return jtqj_num_threads; }
+	void set_jtqj_num_threads(int _threads) { jtqj_num_threads = _threads; }
+	int get_jac_num_threads() const { return jac_num_threads; }
+	void set_jac_num_threads(int _threads) { jac_num_threads = _threads; }
 
 	void set_hotstart_resfile(string _res_file) { hotstart_resfile = _res_file; }
 	string get_hotstart_resfile() const { return hotstart_resfile; }
+	bool get_jco_background_write() const { return jco_background_write; }
+	bool get_reg_weight_spectral() const { return reg_weight_spectral; }
+	void set_reg_weight_spectral(bool _reg_weight_spectral) { reg_weight_spectral = _reg_weight_spectral; }
+	bool get_pst_cache() const { return pst_cache; }
+	void set_pst_cache(bool _pst_cache) { pst_cache = _pst_cache; }
+	void set_jco_background_write(bool _jco_background_write) { jco_background_write = _jco_background_write; }
+	bool get_perf_trace() const { return perf_trace_flag; }
+	void set_perf_trace(bool _perf_trace) { perf_trace_flag = _perf_trace; }
+	double get_panther_metrics_interval() const { return panther_metrics_interval; }
+	void set_panther_metrics_interval(double _interval) { panther_metrics_interval = _interval; }
+	int get_panther_metrics_port() const { return panther_metrics_port; }
+	void set_panther_metrics_port(int _port) { panther_metrics_port = _port; }
 
 	void set_upgrade_bounds(string _upgrade_bounds) { upgrade_bounds = _upgrade_bounds; }
 	string get_upgrade_bounds() const { return upgrade_bounds; }
+	void set_jac_update(string _jac_update) { jac_update = _jac_update; }
+	string get_jac_update() const { return jac_update; }
+	void set_jac_update_phi_ratio(double _ratio) { jac_update_phi_ratio = _ratio; }
+	double get_jac_update_phi_ratio() const { return jac_update_phi_ratio; }
+	void set_jac_update_max_iter(int _max_iter) { jac_update_max_iter = _max_iter; }
+	int get_jac_update_max_iter() const { return jac_update_max_iter; }
+	void set_jac_refresh_sen_ratio(double _ratio) { jac_refresh_sen_ratio = _ratio; }
+	double get_jac_refresh_sen_ratio() const { return jac_refresh_sen_ratio; }
+	void set_jac_refresh_par_change(double _change) { jac_refresh_par_change = _change; }
+	double get_jac_refresh_par_change() const { return jac_refresh_par_change; }
+	void set_jac_refresh_full_iter(int _full_iter) { jac_refresh_full_iter = _full_iter; }
+	int get_jac_refresh_full_iter() const { return jac_refresh_full_iter; }
+	void set_der_check_npar(int _der_check_npar) { der_check_npar = _der_check_npar; }
+	int get_der_check_npar() const { return der_check_npar; }
 
 
 	string get_opt_obj_func()const { return opt_obj_func; }
@@ -309,6 +348,8 @@ public:
 	void set_opt_coin_log(bool _log) { opt_coin_log = _log; }
 	bool get_opt_skip_final()const { return opt_skip_final; }
 	void set_opt_skip_final(bool _skip_final) { opt_skip_final = _skip_final; }
+	bool get_opt_lp_warm_start()const { return opt_lp_warm_start; }
+	void set_opt_lp_warm_start(bool _warm_start) { opt_lp_warm_start = _warm_start; }
 
 	vector<string> get_opt_dec_var_groups()const { return opt_dec_var_groups; }
 	void set_opt_dec_var_groups(vector<string> _grps) { opt_dec_var_groups = _grps; }
@@ -318,6 +359,10 @@ public:
 	void set_opt_constraint_groups(vector<string> _grps) { opt_constraint_groups = _grps; }
 	double get_opt_risk()const { return opt_risk; }
 	void set_opt_risk(double _risk) { opt_risk = _risk; }
+	vector<double> get_opt_risk_sweep()const { return opt_risk_sweep; }
+	void set_opt_risk_sweep(vector<double> _risk_sweep) { opt_risk_sweep = _risk_sweep; }
+	string get_opt_obj_sweep_file()const { return opt_obj_sweep_file; }
+	void set_opt_obj_sweep_file(string _obj_sweep_file) { opt_obj_sweep_file = _obj_sweep_file; }
 	double get_opt_direction()const { return opt_direction; }
 	void set_opt_direction(double _direction) { opt_direction = _direction; }
 	double get_opt_iter_tol()const { return opt_iter_tol; }
@@ -372,6 +417,8 @@ public:
 	void set_par_sigma_range(double _par_sigma_range) { par_sigma_range = _par_sigma_range; }
 	bool get_ies_save_binary() const { return ies_save_binary; }
 	void set_ies_save_binary(bool _ies_save_binary) { ies_save_binary = _ies_save_binary; }
+	bool get_ies_checkpoint() const { return ies_checkpoint; }
+	void set_ies_checkpoint(bool _ies_checkpoint) { ies_checkpoint = _ies_checkpoint; }
 	string get_ies_localizer() const { return ies_localizer; }
 	void set_ies_localizer(string _ies_localizer) { ies_localizer = _ies_localizer; }
 	double get_ies_accept_phi_fac() const { return ies_accept_phi_fac; }
@@ -388,6 +435,14 @@ public:
 	void set_ies_subset_how(string _ies_subset_how) { ies_subset_how = _ies_subset_how; }
 	void set_ies_localize_how(string _how) { ies_localize_how = _how; }
 	string get_ies_localize_how() const { return ies_localize_how; }
+	string get_ies_loc_par_coords() const { return ies_loc_par_coords; }
+	void set_ies_loc_par_coords(string _coords) { ies_loc_par_coords = _coords; }
+	string get_ies_loc_obs_coords() const { return ies_loc_obs_coords; }
+	void set_ies_loc_obs_coords(string _coords) { ies_loc_obs_coords = _coords; }
+	double get_ies_loc_distance() const { return ies_loc_distance; }
+	void set_ies_loc_distance(double _distance) { ies_loc_distance = _distance; }
+	string get_ies_loc_taper() const { return ies_loc_taper; }
+	void set_ies_loc_taper(string _taper) { ies_loc_taper = _taper; }
 
 	double get_overdue_giveup_minutes() const { return overdue_giveup_minutes; }
 	void set_overdue_giveup_minutes(double overdue_minutes) { overdue_giveup_minutes = overdue_minutes; }
@@ -443,8 +498,23 @@ private:
 	double parcov_scale_fac;
 	bool jac_scale;
 	bool upgrade_augment;
+	int jtqj_num_threads;
+	int jac_num_threads;
 	string upgrade_bounds;
+	string jac_update;
+	double jac_update_phi_ratio;
+	int jac_update_max_iter;
+	double jac_refresh_sen_ratio;
+	double jac_refresh_par_change;
+	int jac_refresh_full_iter;
+	int der_check_npar;
 	string hotstart_resfile;
+	bool jco_background_write;
+	bool reg_weight_spectral;
+	bool pst_cache;
+	bool perf_trace_flag;
+	double panther_metrics_interval;
+	int panther_metrics_port;
 
 	GLOBAL_OPT global_opt;
 	double de_f;
@@ -452,14 +522,18 @@ private:
 	int de_npopulation;
 	int de_max_gen;
 	bool de_dither_f;
+	bool de_async;
 
 	string opt_obj_func;
 	bool opt_coin_log;
 	bool opt_skip_final;
+	bool opt_lp_warm_start;
 	vector<string> opt_dec_var_groups;
 	vector<string> opt_external_var_groups;
 	vector<string> opt_constraint_groups;
 	double opt_risk;
+	vector<double> opt_risk_sweep;
+	string opt_obj_sweep_file;
 	double opt_direction;
 	double opt_iter_tol;
 	int opt_recalc_fosm_every;
@@ -486,6 +560,7 @@ private:
 	bool ies_enforce_bounds;
 	double par_sigma_range;
 	bool ies_save_binary;
+	bool ies_checkpoint;
 	string ies_localizer;
 	double ies_accept_phi_fac;
 	double ies_lambda_inc_fac;
@@ -495,6 +570,10 @@ private:
 	string ies_weight_csv;
 	string ies_subset_how;
 	string ies_localize_how;
+	string ies_loc_par_coords;
+	string ies_loc_obs_coords;
+	double ies_loc_distance;
+	string ies_loc_taper;
 	int ies_num_threads;
 	bool ies_debug_fail_subset;
 	bool ies_debug_fail_remainder;
@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <thread>
+#include "system_variables.h"
+#include "FakeModel.h"
+
+using namespace std;
+
+const string FakeModel::command_name = "pestpp_fake_model";
+
+bool FakeModel::is_fake_command(const vector<string> &comline_vec)
+{
+	if (comline_vec.size() != 1)
+		return false;
+	vector<string> tokens;
+	pest_utils::tokenize(comline_vec[0], tokens);
+	return (tokens.size() > 0) && (pest_utils::lower_cp(tokens[0]) == command_name);
+}
+
+FakeModel::FakeModel() : function(Function::LINEAR), band(5), noise(0.0), seed(1), sleep_sec(0.0), work(0),
+	fail_frac(0.0)
+{
+}
+
+void FakeModel::initialize(const string &comline, const vector<string> &_par_name_vec, const vector<string> &_obs_name_vec)
+{
+	vector<string> tokens;
+	pest_utils::tokenize(comline, tokens);
+	for (size_t i = 1; i < tokens.size(); ++i)
+	{
+		string tok = pest_utils::lower_cp(tokens[i]);
+		size_t eq = tok.find('=');
+		if (eq == string::npos)
+			throw runtime_error("FakeModel error: expected key=value, found '" + tokens[i] + "'");
+		string key = tok.substr(0, eq);
+		string value = tok.substr(eq + 1);
+		if (key == "function")
+		{
+			if (value == "linear")
+				function = Function::LINEAR;
+			else if (value == "quadratic")
+				function = Function::QUADRATIC;
+			else
+				throw runtime_error("FakeModel error: unrecognized function '" + value + "', expected linear or quadratic");
+		}
+		else if (key == "band")
+			pest_utils::convert_ip(value, band);
+		else if (key == "noise")
+			pest_utils::convert_ip(value, noise);
+		else if (key == "seed")
+			pest_utils::convert_ip(value, seed);
+		else if (key == "sleep")
+			pest_utils::convert_ip(value, sleep_sec);
+		else if (key == "work")
+			pest_utils::convert_ip(value, work);
+		else if (key == "fail")
+			pest_utils::convert_ip(value, fail_frac);
+		else
+			throw runtime_error("FakeModel error: unrecognized option '" + key + "'");
+	}
+	if ((band < 0) || (noise < 0.0) || (sleep_sec < 0.0) || (work < 0) || (fail_frac < 0.0) || (fail_frac > 1.0))
+		throw runtime_error("FakeModel error: invalid option value in '" + comline + "'");
+
+	par_order = sorted_order(_par_name_vec);
+	obs_order = sorted_order(_obs_name_vec);
+}
+
+vector<int> FakeModel::sorted_order(const vector<string> &names)
+{
+	vector<int> sorted_idx(names.size());
+	iota(sorted_idx.begin(), sorted_idx.end(), 0);
+	sort(sorted_idx.begin(), sorted_idx.end(), [&names](int a, int b) { return names[a] < names[b]; });
+	vector<int> order(sorted_idx.size());
+	for (int i = 0; i < sorted_idx.size(); ++i)
+		order[sorted_idx[i]] = i;
+	return order;
+}
+
+double FakeModel::coef(long iobs, long ipar) const
+{
+	return 1.0 + 0.5 * sin(double(iobs + 3 * ipar));
+}
+
+void FakeModel::run(pest_utils::thread_flag* terminate, const vector<double> &par_vals, vector<double> &obs_vals)
+{
+	int n_par = par_order.size();
+	int n_obs = obs_order.size();
+	if (par_vals.size() != n_par)
+		throw runtime_error("FakeModel error: number of parameter values does not match the number of parameters");
+	vector<double> p(n_par);
+	for (int i = 0; i < n_par; ++i)
+		p[par_order[i]] = par_vals[i];
+
+	//the generator for noise and failures depends only on the seed and the parameter values
+	uint64_t hash = pest_utils::fnv1a_hash(reinterpret_cast<const char*>(p.data()), p.size() * sizeof(double));
+	mt19937_64 gen(hash ^ seed);
+	if ((fail_frac > 0.0) && (uniform_real_distribution<double>(0.0, 1.0)(gen) < fail_frac))
+		throw runtime_error("FakeModel: simulated model run failure");
+
+	vector<double> y_sorted(n_obs, 0.0);
+	for (long j = 0; j < n_obs; ++j)
+	{
+		long k_mid = (n_obs > 0) ? long(double(j) * n_par / n_obs) : 0;
+		long k_beg = max(0L, k_mid - band);
+		long k_end = min(long(n_par), k_mid + band + 1);
+		double y = 0.0;
+		for (long k = k_beg; k < k_end; ++k)
+		{
+			double x = p[k];
+			if (function == Function::QUADRATIC)
+				x += 0.1 * x * x;
+			y += coef(j, k) * x;
+		}
+		y_sorted[j] = y;
+	}
+	if (noise > 0.0)
+	{
+		normal_distribution<double> dist(0.0, noise);
+		for (auto &y : y_sorted)
+			y += dist(gen);
+	}
+	obs_vals.resize(n_obs);
+	for (int i = 0; i < n_obs; ++i)
+		obs_vals[i] = y_sorted[obs_order[i]];
+
+	if (work > 0)
+	{
+		//the result is folded back in as zero so the loop cannot be removed
+		volatile double acc = 1.0;
+		for (int64_t i = 0; i < work; ++i)
+			acc = acc * 1.0000001 + 1.0e-9;
+		if (n_obs > 0)
+			obs_vals[0] += 0.0 * acc;
+	}
+
+	if (sleep_sec > 0.0)
+	{
+		auto end = chrono::steady_clock::now() + chrono::duration<double>(sleep_sec);
+		while (chrono::steady_clock::now() < end)
+		{
+			if ((terminate) && (terminate->get()))
+				break;
+			auto remaining = chrono::duration<double>(end - chrono::steady_clock::now());
+			this_thread::sleep_for(min(remaining, chrono::duration<double>(OperSys::thread_sleep_milli_secs / 1000.0)));
+		}
+	}
+}
+
+string FakeModel::get_description() const
+{
+	stringstream ss;
+	ss << command_name << ": function=" << (function == Function::LINEAR ? "linear" : "quadratic")
+		<< " band=" << band << " noise=" << noise << " seed=" << seed << " sleep=" << sleep_sec
+		<< " work=" << work << " fail=" << fail_frac;
+	return ss.str();
+}
@@ -0,0 +1,50 @@
+#ifndef FAKE_MODEL_H_
+#define FAKE_MODEL_H_
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "utilities.h"
+
+// In-process synthetic model used in place of an external executable.  It is
+// selected by a model command line of the form
+//
+//     pestpp_fake_model [function=linear|quadratic] [band=5] [noise=0.0] [seed=1]
+//                       [sleep=0.0] [work=0] [fail=0.0]
+//
+// Observation j is a banded function of the parameters whose scaled index lies
+// within "band" of j.  Parameters and observations are matched in sorted name
+// order, so results do not depend on the order the caller uses.  noise adds gaussian noise with the
+// given standard deviation, sleep waits the given number of seconds, work adds
+// that many floating point operations per run and fail is the fraction of runs
+// that throw.  The noise and failures are drawn from a generator seeded with the
+// parameter values, so the same parameters always give the same result.  No
+// template, instruction or model files are read or written.
+
+class FakeModel
+{
+public:
+	enum class Function { LINEAR, QUADRATIC };
+	static const std::string command_name;
+	static bool is_fake_command(const std::vector<std::string> &comline_vec);
+	FakeModel();
+	void initialize(const std::string &comline, const std::vector<std::string> &_par_name_vec,
+		const std::vector<std::string> &_obs_name_vec);
+	void run(pest_utils::thread_flag* terminate, const std::vector<double> &par_vals, std::vector<double> &obs_vals);
+	std::string get_description() const;
+private:
+	Function function;
+	int band;
+	double noise;
+	unsigned int seed;
+	double sleep_sec;
+	int64_t work;
+	double fail_frac;
+	//index of each caller parameter and observation in sorted name order
+	std::vector<int> par_order;
+	std::vector<int> obs_order;
+	double coef(long iobs, long ipar) const;
+	static std::vector<int> sorted_order(const std::vector<std::string> &names);
+};
+
+#endif /* FAKE_MODEL_H_ */
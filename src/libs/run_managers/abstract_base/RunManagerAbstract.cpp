@@ -27,13 +27,16 @@
 #include "Transformable.h"
 #include "utilities.h"
 
+const string RunManagerAbstract::derivatives_info_txt = "derivatives";
+
 RunManagerAbstract::RunManagerAbstract(const vector<string> _comline_vec,
 	const vector<string> _tplfile_vec, const vector<string> _inpfile_vec,
 	const vector<string> _insfile_vec, const vector<string> _outfile_vec,
 	const string &stor_filename, int _max_n_failure)
   : total_runs(0), max_n_failure(_max_n_failure), file_stor(stor_filename),
     comline_vec(_comline_vec), tplfile_vec(_tplfile_vec),
-    inpfile_vec(_inpfile_vec), insfile_vec(_insfile_vec), outfile_vec(_outfile_vec)
+    inpfile_vec(_inpfile_vec), insfile_vec(_insfile_vec), outfile_vec(_outfile_vec),
+    first_unreported_run(0)
 {
 	cout << endl;
 	cout << "             Generalized Run Manager Interface" << endl;
@@ -46,25 +49,126 @@ RunManagerAbstract::RunManagerAbstract(const vector<string> _comline_vec,
 
 void RunManagerAbstract::initialize(const Parameters &model_pars, const Observations &obs, const string &_filename)
 {
+	clear_run_tracking();
 	file_stor.reset(model_pars.get_keys(), obs.get_keys(), _filename);
 }
 
 void RunManagerAbstract::initialize(const std::vector<std::string> &par_names, std::vector<std::string> &obs_names, const string &_filename)
 {
+	clear_run_tracking();
 	file_stor.reset(par_names, obs_names, _filename);
 }
 
 void RunManagerAbstract::reinitialize(const string &_filename)
 {
+	clear_run_tracking();
 	vector<string> par_names = get_par_name_vec();
 	vector<string> obs_names = get_obs_name_vec();
 	file_stor.reset(par_names, obs_names, _filename);
 }
 
+void RunManagerAbstract::reinitialize_delta(const Parameters &base_model_pars, int max_n_delta, const string &_filename)
+{
+	clear_run_tracking();
+	vector<string> par_names = get_par_name_vec();
+	vector<string> obs_names = get_obs_name_vec();
+	file_stor.reset_delta(par_names, obs_names, base_model_pars.get_data_vec(par_names), max_n_delta, _filename);
+}
+
 void RunManagerAbstract::initialize_restart(const std::string &_filename)
 {
+	clear_run_tracking();
 
 	file_stor.init_restart(_filename);
+	restore_derivative_tracking();
+}
+
+void RunManagerAbstract::set_derivatives_command(const string &_dercom, const string &_derfile)
+{
+	dercom = _dercom;
+	derfile = _derfile;
+}
+
+void RunManagerAbstract::request_derivatives(int run_id)
+{
+	if (!supports_derivatives() || dercom.empty())
+		throw PestError("run manager does not support model supplied derivatives");
+	derivative_run_ids.insert(run_id);
+}
+
+string RunManagerAbstract::get_derivatives_file(int run_id) const
+{
+	auto found = derivative_file_map.find(run_id);
+	if (found == derivative_file_map.end())
+		return string();
+	return found->second;
+}
+
+int RunManagerAbstract::get_next_completed_run(int &run_status)
+{
+	run_status = 0;
+	// replaced runs are below first_unreported_run
+	for (auto it = requeued_run_ids.begin(); it != requeued_run_ids.end(); ++it)
+	{
+		int status = file_stor.get_run_status(*it);
+		if (status == 0 || run_pending(*it))
+			continue;
+		int run_id = *it;
+		requeued_run_ids.erase(it);
+		run_status = status;
+		return run_id;
+	}
+	int nruns = get_nruns();
+	while (first_unreported_run < nruns && reported_run_ids.erase(first_unreported_run) > 0)
+	{
+		++first_unreported_run;
+	}
+	for (int run_id = first_unreported_run; run_id < nruns; ++run_id)
+	{
+		if (reported_run_ids.find(run_id) != reported_run_ids.end())
+			continue;
+		int status = file_stor.get_run_status(run_id);
+		// failed runs may still be waiting to be retried
+		if (status == 0 || run_pending(run_id))
+			continue;
+		reported_run_ids.insert(run_id);
+		run_status = status;
+		return run_id;
+	}
+	return -1;
+}
+
+void RunManagerAbstract::restore_derivative_tracking()
+{
+	// the derivatives requests are not kept in the run storage file so they are recovered from the run info text.
+	// The derivatives file of a run that finished before the restart is reused if it is still on disk
+	if (dercom.empty())
+		return;
+	int nruns = file_stor.get_nruns();
+	int run_status;
+	string info_txt;
+	double info_value;
+	for (int run_id = 0; run_id < nruns; ++run_id)
+	{
+		file_stor.get_info(run_id, run_status, info_txt, info_value);
+		if (info_txt != derivatives_info_txt)
+			continue;
+		derivative_run_ids.insert(run_id);
+		string filename = get_local_derivatives_filename();
+		if (run_status > 0 && pest_utils::check_exist_in(filename))
+		{
+			derivative_file_map[run_id] = filename;
+		}
+	}
+}
+
+void RunManagerAbstract::clear_run_tracking()
+{
+	derivative_run_ids.clear();
+	derivative_file_map.clear();
+	reported_run_ids.clear();
+	requeued_run_ids.clear();
+	first_unreported_run = 0;
 }
 
 int RunManagerAbstract::add_run(const vector<double> &model_pars, const string &info_txt, double info_value)
@@ -85,6 +189,31 @@ int RunManagerAbstract::add_run(const Eigen::VectorXd &model_pars, const string
 	return run_id;
 }
 
+int RunManagerAbstract::add_run_delta(const Parameters &delta_model_pars, const string &info_txt, double info_value)
+{
+	int run_id = file_stor.add_run_delta(delta_model_pars, info_txt, info_value);
+	return run_id;
+}
+
+int RunManagerAbstract::replace_run(int run_id, const Parameters &model_pars, const string &info_txt, double info_value)
+{
+	if (run_pending(run_id))
+	{
+		stringstream ss;
+		ss << "RunManagerAbstract::replace_run: run " << run_id << " has not finished";
+		throw PestError(ss.str());
+	}
+	file_stor.replace_run(run_id, model_pars, info_txt, info_value);
+	derivative_run_ids.erase(run_id);
+	derivative_file_map.erase(run_id);
+	reported_run_ids.erase(run_id);
+	if (run_id < first_unreported_run)
+	{
+		requeued_run_ids.insert(run_id);
+	}
+	return run_id;
+}
+
 void RunManagerAbstract::update_run(int run_id, const Parameters &pars, const Observations &obs)
 {
 
@@ -227,6 +356,28 @@ bool RunManagerAbstract::get_model_parameters(int run_id, Parameters &pars)
         return success;
  }
 
+bool RunManagerAbstract::get_model_parameter_delta(int run_id, Parameters &delta_pars)
+{
+	bool success = false;
+	vector<int> par_idx;
+	vector<double> par_vals;
+	int status = file_stor.get_par_delta(run_id, par_idx, par_vals);
+	const vector<string> &par_names = file_stor.get_par_name_vec();
+	delta_pars.clear();
+	for (int i = 0; i < par_idx.size(); ++i)
+	{
+		delta_pars.insert(par_names[par_idx[i]], par_vals[i]);
+	}
+	if (status > 0) success = true;
+	return success;
+}
+
+void RunManagerAbstract::get_observations_block(int first_run_id, int n_runs, Eigen::MatrixXd &obs_mat)
+{
+	obs_mat.resize(file_stor.get_obs_name_vec().size(), n_runs);
+	file_stor.get_observations_block(first_run_id, n_runs, obs_mat.data());
+}
+
 bool RunManagerAbstract::get_observations_vec(int run_id, vector<double> &data_vec)
 {
 	bool success = false;
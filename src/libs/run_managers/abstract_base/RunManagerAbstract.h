@@ -22,6 +22,7 @@
 #include <string>
 #include <vector>
 #include <set>
+#include <map>
 #include "RunStorage.h"
 #include <Eigen/Dense>
 #include <chrono>
@@ -35,7 +36,8 @@ class Observations;
 class RunManagerAbstract
 {
 public:
-	enum class RUN_UNTIL_COND { NORMAL, NO_OPS, TIME, NO_OPS_OR_TIME };
+	//RUN_RETURNED returns once at least one run of the set has completed, failed or timed out
+	enum class RUN_UNTIL_COND { NORMAL, NO_OPS, TIME, NO_OPS_OR_TIME, RUN_RETURNED };
 	RunManagerAbstract(const std::vector<std::string> _comline_vec,
 		const std::vector<std::string> _tplfile_vec, const std::vector<std::string> _inpfile_vec,
 		const std::vector<std::string> _insfile_vec, const std::vector<std::string> _outfile_vec,
@@ -44,10 +46,16 @@ public:
 	virtual void initialize(const Parameters &model_pars, const Observations &obs, const std::string &_filename = std::string(""));
 	virtual void initialize_restart(const std::string &_filename);
 	virtual void reinitialize(const std::string &_filename = std::string(""));
+	virtual void reinitialize_delta(const Parameters &base_model_pars, int max_n_delta, const std::string &_filename = std::string(""));
 	virtual void free_memory();
 	virtual int add_run(const Parameters &model_pars, const std::string &info_txt="", double info_value=RunStorage::no_data);
 	virtual int add_run(const std::vector<double> &model_pars, const std::string &info_txt="", double info_valuee=RunStorage::no_data);
 	virtual int add_run(const Eigen::VectorXd &model_pars, const std::string &info_txt="", double info_valuee=RunStorage::no_data);
+	virtual int add_run_delta(const Parameters &delta_model_pars, const std::string &info_txt = "", double info_value = RunStorage::no_data);
+	//replaces the parameters of a finished run and queues it to be made again, so that steady-state algorithms
+	//can hold a bounded number of runs in storage.  Returns the id of the queued run, which is a new run if the
+	//run manager cannot reuse run_id
+	virtual int replace_run(int run_id, const Parameters &model_pars, const std::string &info_txt = "", double info_value = RunStorage::no_data);
 	virtual void update_run(int run_id, const Parameters &pars, const Observations &obs);
 	virtual void run() = 0;
 	virtual RunManagerAbstract::RUN_UNTIL_COND run_until(RUN_UNTIL_COND condition, int n_nops = 0, double sec = 0.0);
@@ -63,7 +71,9 @@ public:
 	virtual bool get_run(int run_id, std::vector<double> &pars_vec, std::vector<double> &obs_vec);
 	virtual const std::set<int> get_failed_run_ids();
 	virtual bool get_model_parameters(int run_num, Parameters &pars);
+	virtual bool get_model_parameter_delta(int run_id, Parameters &delta_pars);
 	virtual bool get_observations_vec(int run_id, std::vector<double> &data_vec);
+	virtual void get_observations_block(int first_run_id, int n_runs, Eigen::MatrixXd &obs_mat);
 	virtual Observations get_obs_template(double value = -9999.0) const;
 	virtual int get_total_runs(void) const {return total_runs;}
 	virtual int get_num_good_runs(void);
@@ -78,6 +88,18 @@ public:
 	virtual void print_run_summary(std::ostream &fout) { file_stor.print_run_summary(fout); }
 	//virtual Observations get_init_run_obs() { return init_run_obs; }
 	virtual std::vector<double> get_init_sim() { return init_sim;  }
+	//the derivatives command is run after the model commands for runs flagged by request_derivatives() and the
+	//external derivatives file it writes is made available on the master through get_derivatives_file().
+	//Runs added with derivatives_info_txt as their info text are flagged again by initialize_restart()
+	static const std::string derivatives_info_txt;
+	virtual void set_derivatives_command(const std::string &_dercom, const std::string &_derfile);
+	virtual bool supports_derivatives() const { return false; }
+	virtual void request_derivatives(int run_id);
+	virtual std::string get_derivatives_file(int run_id) const;
+	//non-blocking: the id of a run that has finished (successfully or with no retries left) and has not been returned
+	//before, or -1 if there is none.  run_status is set as in get_info().  Used with run_until() so that runs can be
+	//processed and new runs added while others are still in progress
+	virtual int get_next_completed_run(int &run_status);
 protected:
 	int total_runs;
 	int max_n_failure; // maximium number of times to retry a failed model run
@@ -91,7 +113,18 @@ protected:
 	bool run_requried(int run_id);
 	//Observations init_run_obs;
 	std::vector<double> init_sim;
+	std::string dercom;
+	std::string derfile;
+	std::set<int> derivative_run_ids;
+	std::map<int, std::string> derivative_file_map;  //run id to local copy of the external derivatives file
+	int first_unreported_run;  //runs below this id have been returned by get_next_completed_run()
+	std::set<int> reported_run_ids;
+	std::set<int> requeued_run_ids;  //replaced runs below first_unreported_run that have not been returned
 	virtual void update_run_failed(int run_id);
+	virtual bool run_pending(int run_id) { return false; }  //run is queued or still being made
+	virtual std::string get_local_derivatives_filename() const { return derfile; }
+	void clear_run_tracking();
+	void restore_derivative_tracking();
 };
 
 #endif /*  RUNMANAGERABSTRACT_H */
@@ -24,18 +24,21 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <cstring>
 #include "RunStorage.h"
 #include "Serialization.h"
 #include "Transformable.h"
+#include "perf_trace.h"
 #include <limits>
 
 using std::numeric_limits;
 
 using namespace std;
 
+
 const double RunStorage::no_data = -9999.0;
 
-RunStorage::RunStorage(const string &_filename) :filename(_filename), run_byte_size(0)
+RunStorage::RunStorage(const string &_filename) :filename(_filename), run_byte_size(0), delta_mode(false), max_n_delta(0)
 {
 }
 
@@ -43,6 +46,35 @@ void RunStorage::reset(const vector<string> &_par_names, const vector<string> &_
 {
 	par_names = _par_names;
 	obs_names = _obs_names;
+	delta_mode = false;
+	max_n_delta = 0;
+	base_pars.clear();
+	par_name_index.clear();
+	reset_file(_filename);
+}
+
+void RunStorage::reset_delta(const vector<string> &_par_names, const vector<string> &_obs_names, const vector<double> &base_par_vec,
+	int _max_n_delta, const string &_filename)
+{
+	if (base_par_vec.size() != _par_names.size())
+	{
+		throw PestError("RunStorage::reset_delta: size of base parameter vector is different from the number of parameters");
+	}
+	par_names = _par_names;
+	obs_names = _obs_names;
+	delta_mode = true;
+	max_n_delta = max(_max_n_delta, 0);
+	base_pars = base_par_vec;
+	par_name_index.clear();
+	for (int i = 0; i < par_names.size(); ++i)
+	{
+		par_name_index[par_names[i]] = i;
+	}
+	reset_file(_filename);
+}
+
+void RunStorage::reset_file(const string &_filename)
+{
 	// a file needs to exist before it can be opened it with read and write
 	// permission.   So open it with write permission to crteate it, close
 	// and then reopen it with read and write permisssion.
@@ -69,13 +101,25 @@ void RunStorage::reset(const vector<string> &_par_names, const vector<string> &_
 	vector<int8_t> serial_onames(Serialization::serialize(obs_names));
 	std::int64_t o_name_size_64 = serial_onames.size() * sizeof(char);
 	// calculate the number of bytes required to store a model run
-	run_par_byte_size = par_names.size() * sizeof(double);
+	if (delta_mode)
+	{
+		run_par_byte_size = (1 + max_n_delta) * sizeof(std::int32_t) + max_n_delta * sizeof(double);
+	}
+	else
+	{
+		run_par_byte_size = par_names.size() * sizeof(double);
+	}
 	run_data_byte_size = run_par_byte_size + obs_names.size() * sizeof(double);
 	//compute the amount of memeory required to store a single model run
 	// run_byte_size = size of run_status + size of info_txt + size of info_value + size of parameter oand observation data
 	run_byte_size =  sizeof(std::int8_t) + 41*sizeof(char) * sizeof(double) + run_data_byte_size;
-	std::int64_t  run_size_64 = run_byte_size;
+	// a negative run size flags delta storage
+	std::int64_t  run_size_64 = delta_mode ? -run_byte_size : run_byte_size;
 	beg_run0 = 4 * sizeof(std::int64_t) + serial_pnames.size() + serial_onames.size();
+	if (delta_mode)
+	{
+		beg_run0 += sizeof(std::int64_t) + base_pars.size() * sizeof(double);
+	}
 	std::int64_t n_runs_64=0;
 	// write header to file
 	buf_stream.seekp(0, ios_base::beg);
@@ -85,6 +129,11 @@ void RunStorage::reset(const vector<string> &_par_names, const vector<string> &_
 	buf_stream.write((char*) &o_name_size_64, sizeof(o_name_size_64));
 	buf_stream.write((char*)serial_pnames.data(), serial_pnames.size());
 	buf_stream.write((char*)serial_onames.data(), serial_onames.size());
+	if (delta_mode)
+	{
+		buf_stream.write((char*) &max_n_delta, sizeof(max_n_delta));
+		buf_stream.write((char*) base_pars.data(), base_pars.size() * sizeof(double));
+	}
 	//add flag for double buffering
 	std::int8_t buf_status = 0;
 	int end_of_runs = get_nruns();
@@ -99,6 +148,8 @@ void RunStorage::init_restart(const std::string &_filename)
 	filename = _filename;
 	par_names.clear();
 	obs_names.clear();
+	base_pars.clear();
+	par_name_index.clear();
 
 	if (buf_stream.is_open())
 	{
@@ -119,7 +170,8 @@ void RunStorage::init_restart(const std::string &_filename)
 
 	std::int64_t  run_size_64;
 	buf_stream.read((char*) &run_size_64, sizeof(run_size_64));
-	run_byte_size = run_size_64;
+	delta_mode = (run_size_64 < 0);
+	run_byte_size = delta_mode ? -run_size_64 : run_size_64;
 
 	std::int64_t p_name_size_64;
 	buf_stream.read((char*) &p_name_size_64, sizeof(p_name_size_64));
@@ -138,7 +190,23 @@ void RunStorage::init_restart(const std::string &_filename)
 	Serialization::unserialize(serial_onames, obs_names);
 
 	beg_run0 = 4 * sizeof(std::int64_t) + serial_pnames.size() + serial_onames.size();
-	run_par_byte_size = par_names.size() * sizeof(double);
+	if (delta_mode)
+	{
+		buf_stream.read((char*) &max_n_delta, sizeof(max_n_delta));
+		base_pars.resize(par_names.size());
+		buf_stream.read((char*) base_pars.data(), base_pars.size() * sizeof(double));
+		for (int i = 0; i < par_names.size(); ++i)
+		{
+			par_name_index[par_names[i]] = i;
+		}
+		beg_run0 += sizeof(std::int64_t) + base_pars.size() * sizeof(double);
+		run_par_byte_size = (1 + max_n_delta) * sizeof(std::int32_t) + max_n_delta * sizeof(double);
+	}
+	else
+	{
+		max_n_delta = 0;
+		run_par_byte_size = par_names.size() * sizeof(double);
+	}
 	run_data_byte_size = run_par_byte_size + obs_names.size() * sizeof(double);
 
 	//check buffer to see if a write was improperly terminated
@@ -154,12 +222,11 @@ void RunStorage::init_restart(const std::string &_filename)
 		buf_stream.read(reinterpret_cast<char*>(&buf_run_id), sizeof(buf_run_id));
 		buf_stream.read(reinterpret_cast<char*>(&r_status), sizeof(r_status));
 		check_rec_id(buf_run_id);
-		size_t n_par = par_names.size();
 		size_t n_obs = obs_names.size();
-		vector<double> pars_vec(n_par, Parameters::no_data);
+		vector<char> par_block(run_par_byte_size);
 		vector<double> obs_vec(n_obs, Observations::no_data);
 
-		buf_stream.read(reinterpret_cast<char*>(pars_vec.data()), n_par * sizeof(double));
+		buf_stream.read(par_block.data(), par_block.size());
 		buf_stream.read(reinterpret_cast<char*>(obs_vec.data()), n_obs * sizeof(double));
 
 		//write data
@@ -167,7 +234,7 @@ void RunStorage::init_restart(const std::string &_filename)
 		buf_stream.write(reinterpret_cast<char*>(&r_status), sizeof(r_status));
 		//skip over info_txt and info_value fields
 		buf_stream.seekp(sizeof(char)*info_txt_length + sizeof(double), ios_base::cur);
-		buf_stream.write(reinterpret_cast<char*>(pars_vec.data()), pars_vec.size() * sizeof(double));
+		buf_stream.write(par_block.data(), par_block.size());
 		buf_stream.write(reinterpret_cast<char*>(obs_vec.data()), obs_vec.size() * sizeof(double));
 		buf_stream.flush();
 		//reset flag for buffer at end of file to 0 to signal it is no longer relavent
@@ -231,8 +298,121 @@ streamoff RunStorage::get_stream_pos(int run_id)
 	return pos;
 }
 
- int RunStorage::add_run(const vector<double> &model_pars, const string &info_txt, double info_value)
- {
+vector<char> RunStorage::pack_delta_block(const vector<int> &par_idx, const vector<double> &par_vals) const
+{
+	if (par_idx.size() > max_n_delta)
+	{
+		ostringstream msg;
+		msg << "Error in RunStorage routine: number of changed parameters (" << par_idx.size()
+			<< ") exceeds the maximum number of parameter deltas (" << max_n_delta << ")";
+		throw PestError(msg.str());
+	}
+	vector<char> par_block(run_par_byte_size, 0);
+	std::int32_t n_delta = par_idx.size();
+	vector<std::int32_t> idx_data(par_idx.begin(), par_idx.end());
+	char *buf = par_block.data();
+	memcpy(buf, &n_delta, sizeof(n_delta));
+	if (n_delta > 0)
+	{
+		memcpy(buf + sizeof(std::int32_t), idx_data.data(), n_delta * sizeof(std::int32_t));
+		memcpy(buf + (1 + max_n_delta) * sizeof(std::int32_t), par_vals.data(), n_delta * sizeof(double));
+	}
+	return par_block;
+}
+
+void RunStorage::unpack_delta_block(const vector<char> &par_block, vector<int> &par_idx, vector<double> &par_vals) const
+{
+	std::int32_t n_delta;
+	const char *buf = par_block.data();
+	memcpy(&n_delta, buf, sizeof(n_delta));
+	vector<std::int32_t> idx_data(n_delta);
+	par_vals.resize(n_delta);
+	if (n_delta > 0)
+	{
+		memcpy(idx_data.data(), buf + sizeof(std::int32_t), n_delta * sizeof(std::int32_t));
+		memcpy(par_vals.data(), buf + (1 + max_n_delta) * sizeof(std::int32_t), n_delta * sizeof(double));
+	}
+	par_idx.assign(idx_data.begin(), idx_data.end());
+}
+
+vector<char> RunStorage::delta_block_from_vec(const vector<double> &par_data) const
+{
+	// record every parameter that differs from the base vector
+	vector<int> par_idx;
+	vector<double> par_vals;
+	for (int i = 0; i < par_data.size(); ++i)
+	{
+		if (par_data[i] != base_pars[i])
+		{
+			par_idx.push_back(i);
+			par_vals.push_back(par_data[i]);
+		}
+	}
+	return pack_delta_block(par_idx, par_vals);
+}
+
+vector<char> RunStorage::delta_block_from_vec(int run_id, const vector<double> &par_data)
+{
+	// keep the parameters already recorded for this run.  Values returned from a model run
+	// can differ from the base vector due to roundoff in the template files.  The base values
+	// are written through the same templates by every run, so the rounded values replace the base
+	vector<int> par_idx;
+	vector<double> par_vals;
+	get_par_delta(run_id, par_idx, par_vals);
+	vector<bool> is_delta(par_data.size(), false);
+	for (int i = 0; i < par_idx.size(); ++i)
+	{
+		par_vals[i] = par_data[par_idx[i]];
+		is_delta[par_idx[i]] = true;
+	}
+	bool base_changed = false;
+	for (int i = 0; i < par_data.size(); ++i)
+	{
+		if (!is_delta[i] && par_data[i] != base_pars[i])
+		{
+			base_pars[i] = par_data[i];
+			base_changed = true;
+		}
+	}
+	if (base_changed)
+	{
+		write_base_pars();
+	}
+	return pack_delta_block(par_idx, par_vals);
+}
+
+void RunStorage::write_base_pars()
+{
+	// the base parameter values are the last section of the header
+	streamoff base_pos = beg_run0 - base_pars.size() * sizeof(double);
+	buf_stream.seekp(base_pos, ios_base::beg);
+	buf_stream.write(reinterpret_cast<const char*>(base_pars.data()), base_pars.size() * sizeof(double));
+	buf_stream.flush();
+}
+
+void RunStorage::read_par_block(double *pars)
+{
+	// read the parameter section of a run record at the current stream position
+	if (!delta_mode)
+	{
+		buf_stream.read(reinterpret_cast<char*>(pars), par_names.size() * sizeof(double));
+		return;
+	}
+	vector<char> par_block(run_par_byte_size);
+	buf_stream.read(par_block.data(), par_block.size());
+	vector<int> par_idx;
+	vector<double> par_vals;
+	unpack_delta_block(par_block, par_idx, par_vals);
+	std::copy(base_pars.begin(), base_pars.end(), pars);
+	for (int i = 0; i < par_idx.size(); ++i)
+	{
+		pars[par_idx[i]] = par_vals[i];
+	}
+}
+
+int RunStorage::add_run_native(const char *par_block, const string &info_txt, double info_value)
+{
+	perf_trace::ScopedSpan span("RunStorage::add_run");
 	std::int8_t r_status = 0;
 	int run_id = increment_nruns() - 1;
 	vector<char> info_txt_buf;
@@ -242,7 +422,7 @@ streamoff RunStorage::get_stream_pos(int run_id)
 	buf_stream.write(reinterpret_cast<char*>(&r_status), sizeof(r_status));
 	buf_stream.write(reinterpret_cast<char*>(info_txt_buf.data()), sizeof(char)*info_txt_buf.size());
 	buf_stream.write(reinterpret_cast<char*>(&info_value), sizeof(double));
-	buf_stream.write(reinterpret_cast<const char*>(&model_pars[0]), model_pars.size()*sizeof(double));
+	buf_stream.write(par_block, run_par_byte_size);
 	//add flag for double buffering
 	std::int8_t buf_status = 0;
 	int end_of_runs = get_nruns();
@@ -250,12 +430,24 @@ streamoff RunStorage::get_stream_pos(int run_id)
 	buf_stream.write(reinterpret_cast<char*>(&buf_status), sizeof(buf_status));
 	buf_stream.flush();
 	return run_id;
- }
+}
 
- int RunStorage::add_run(const Eigen::VectorXd &model_pars, const string &info_txt, double info_value)
- {
+void RunStorage::replace_run(int run_id, const vector<double> &model_pars, const string &info_txt, double info_value)
+{
+	// overwrite the record of an existing run with new parameters and mark it as not yet run
+	check_rec_id(run_id);
+	if (model_pars.size() != par_names.size())
+	{
+		throw PestError("Error in RunStorage routine.  Size of parameter data is different from what is expected");
+	}
+	vector<char> par_block;
+	const char *par_data = reinterpret_cast<const char*>(model_pars.data());
+	if (delta_mode)
+	{
+		par_block = delta_block_from_vec(model_pars);
+		par_data = par_block.data();
+	}
 	std::int8_t r_status = 0;
-	int run_id = increment_nruns() - 1;
 	vector<char> info_txt_buf;
 	info_txt_buf.resize(info_txt_length, '\0');
 	copy_n(info_txt.begin(), min(info_txt.size(), size_t(info_txt_length)-1) , info_txt_buf.begin());
@@ -263,14 +455,34 @@ streamoff RunStorage::get_stream_pos(int run_id)
 	buf_stream.write(reinterpret_cast<char*>(&r_status), sizeof(r_status));
 	buf_stream.write(reinterpret_cast<char*>(info_txt_buf.data()), sizeof(char)*info_txt_buf.size());
 	buf_stream.write(reinterpret_cast<char*>(&info_value), sizeof(double));
-	buf_stream.write(reinterpret_cast<const char*>(&model_pars(0)), model_pars.size()*sizeof(model_pars(0)));
-	//add flag for double buffering
-	std::int8_t buf_status = 0;
-	int end_of_runs = get_nruns();
-	buf_stream.seekp(get_stream_pos(end_of_runs), ios_base::beg);
-	buf_stream.write(reinterpret_cast<char*>(&buf_status), sizeof(buf_status));
+	buf_stream.write(par_data, run_par_byte_size);
 	buf_stream.flush();
-	return run_id;
+}
+
+void RunStorage::replace_run(int run_id, const Parameters &pars, const string &info_txt, double info_value)
+{
+	replace_run(run_id, pars.get_data_vec(par_names), info_txt, info_value);
+}
+
+ int RunStorage::add_run(const vector<double> &model_pars, const string &info_txt, double info_value)
+ {
+	if (delta_mode)
+	{
+		vector<char> par_block = delta_block_from_vec(model_pars);
+		return add_run_native(par_block.data(), info_txt, info_value);
+	}
+	return add_run_native(reinterpret_cast<const char*>(&model_pars[0]), info_txt, info_value);
+ }
+
+ int RunStorage::add_run(const Eigen::VectorXd &model_pars, const string &info_txt, double info_value)
+ {
+	if (delta_mode)
+	{
+		vector<double> par_data(model_pars.data(), model_pars.data() + model_pars.size());
+		vector<char> par_block = delta_block_from_vec(par_data);
+		return add_run_native(par_block.data(), info_txt, info_value);
+	}
+	return add_run_native(reinterpret_cast<const char*>(&model_pars(0)), info_txt, info_value);
  }
 
 
@@ -281,6 +493,34 @@ int RunStorage::add_run(const Parameters &pars, const string &info_txt, double i
 	return run_id;
 }
 
+int RunStorage::add_run_delta(const Parameters &delta_pars, const string &info_txt, double info_value)
+{
+	if (!delta_mode)
+	{
+		throw PestError("RunStorage::add_run_delta: run storage was not initialized for parameter deltas");
+	}
+	vector<pair<int, double> > delta_vec;
+	for (const auto &ipar : delta_pars)
+	{
+		auto found = par_name_index.find(ipar.first);
+		if (found == par_name_index.end())
+		{
+			throw PestError("RunStorage::add_run_delta: unknown parameter: " + ipar.first);
+		}
+		delta_vec.push_back(make_pair(found->second, ipar.second));
+	}
+	sort(delta_vec.begin(), delta_vec.end());
+	vector<int> par_idx;
+	vector<double> par_vals;
+	for (const auto &idelta : delta_vec)
+	{
+		par_idx.push_back(idelta.first);
+		par_vals.push_back(idelta.second);
+	}
+	vector<char> par_block = pack_delta_block(par_idx, par_vals);
+	return add_run_native(par_block.data(), info_txt, info_value);
+}
+
 void RunStorage::copy(const RunStorage &rhs_rs)
 {
 	if (buf_stream.is_open())
@@ -308,18 +548,18 @@ void RunStorage::copy(const RunStorage &rhs_rs)
 	beg_run0 = rhs_rs.beg_run0;
 	run_byte_size = rhs_rs.run_byte_size;
 	run_par_byte_size = rhs_rs.run_par_byte_size;
-	run_data_byte_size = rhs_rs.run_par_byte_size;
+	run_data_byte_size = rhs_rs.run_data_byte_size;
 	par_names = rhs_rs.par_names;
 	obs_names = rhs_rs.obs_names;
+	delta_mode = rhs_rs.delta_mode;
+	max_n_delta = rhs_rs.max_n_delta;
+	base_pars = rhs_rs.base_pars;
+	par_name_index = rhs_rs.par_name_index;
 }
 
-void RunStorage::update_run(int run_id, const Parameters &pars, const Observations &obs)
+void RunStorage::write_run_data(int run_id, std::int8_t r_status, const char *par_block, const vector<double> &obs_data)
 {
-	//set run status flage to complete
-	std::int8_t r_status = 1;
-	check_rec_id(run_id);
-	vector<double> par_data(pars.get_data_vec(par_names));
-	vector<double> obs_data(obs.get_data_vec(obs_names));
+	perf_trace::ScopedSpan span("RunStorage::update_run");
 	//write data to buffer at end of file and set buffer flag to 1
 	std::int8_t buf_status = 0;
 	std::int32_t buf_run_id = run_id;
@@ -328,8 +568,8 @@ void RunStorage::update_run(int run_id, const Parameters &pars, const Observatio
 	buf_stream.write(reinterpret_cast<char*>(&buf_status), sizeof(buf_status));
 	buf_stream.write(reinterpret_cast<char*>(&buf_run_id), sizeof(buf_run_id));
 	buf_stream.write(reinterpret_cast<char*>(&r_status), sizeof(r_status));
-	buf_stream.write(reinterpret_cast<char*>(par_data.data()), par_data.size() * sizeof(double));
-	buf_stream.write(reinterpret_cast<char*>(obs_data.data()), obs_data.size() * sizeof(double));
+	buf_stream.write(par_block, run_par_byte_size);
+	buf_stream.write(reinterpret_cast<const char*>(obs_data.data()), obs_data.size() * sizeof(double));
 	buf_status = 1;
 	buf_stream.seekp(get_stream_pos(end_of_runs), ios_base::beg);
 	buf_stream.write(reinterpret_cast<char*>(&buf_status), sizeof(buf_status));
@@ -339,8 +579,8 @@ void RunStorage::update_run(int run_id, const Parameters &pars, const Observatio
 	buf_stream.write(reinterpret_cast<char*>(&r_status), sizeof(r_status));
 	//skip over info_txt and info_value fields
 	buf_stream.seekp(sizeof(char)*info_txt_length+sizeof(double), ios_base::cur);
-	buf_stream.write(reinterpret_cast<char*>(par_data.data()), par_data.size() * sizeof(double));
-	buf_stream.write(reinterpret_cast<char*>(obs_data.data()), obs_data.size() * sizeof(double));
+	buf_stream.write(par_block, run_par_byte_size);
+	buf_stream.write(reinterpret_cast<const char*>(obs_data.data()), obs_data.size() * sizeof(double));
 	buf_stream.flush();
 	//reset flag for buffer at end of file to 0 to signal it is no longer relavent
 	buf_status = 0;
@@ -349,14 +589,76 @@ void RunStorage::update_run(int run_id, const Parameters &pars, const Observatio
 	buf_stream.flush();
 }
 
+void RunStorage::update_run(int run_id, const Parameters &pars, const Observations &obs)
+{
+	//set run status flage to complete
+	std::int8_t r_status = 1;
+	check_rec_id(run_id);
+	vector<double> par_data(pars.get_data_vec(par_names));
+	vector<double> obs_data(obs.get_data_vec(obs_names));
+	if (delta_mode)
+	{
+		vector<char> par_block = delta_block_from_vec(run_id, par_data);
+		write_run_data(run_id, r_status, par_block.data(), obs_data);
+	}
+	else
+	{
+		write_run_data(run_id, r_status, reinterpret_cast<char*>(par_data.data()), obs_data);
+	}
+}
+
+void RunStorage::update_run(int run_id, const vector<double> &par_data, const vector<double> &obs_data)
+{
+	//set run status flage to complete
+	std::int8_t r_status = 1;
+	check_rec_id(run_id);
+	if ((par_data.size() != par_names.size()) || (obs_data.size() != obs_names.size()))
+	{
+		throw PestError("Error in RunStorage routine.  Size of run data is different from what is expected");
+	}
+	if (delta_mode)
+	{
+		vector<char> par_block = delta_block_from_vec(run_id, par_data);
+		write_run_data(run_id, r_status, par_block.data(), obs_data);
+	}
+	else
+	{
+		write_run_data(run_id, r_status, reinterpret_cast<const char*>(par_data.data()), obs_data);
+	}
+}
+
+void RunStorage::update_run_delta(int run_id, const vector<double> &delta_par_vals, const vector<double> &obs_vec)
+{
+	//set run status flage to complete
+	std::int8_t r_status = 1;
+	check_rec_id(run_id);
+	if (!delta_mode)
+	{
+		throw PestError("RunStorage::update_run_delta: run storage was not initialized for parameter deltas");
+	}
+	if (obs_vec.size() != obs_names.size())
+	{
+		throw PestError("Error in RunStorage routine.  Size of observation data is different from what is expected");
+	}
+	vector<int> par_idx;
+	vector<double> par_vals;
+	get_par_delta(run_id, par_idx, par_vals);
+	if (delta_par_vals.size() != par_idx.size())
+	{
+		throw PestError("Error in RunStorage routine.  Size of parameter delta is different from what is expected");
+	}
+	vector<char> par_block = pack_delta_block(par_idx, delta_par_vals);
+	write_run_data(run_id, r_status, par_block.data(), obs_vec);
+}
+
 
 void RunStorage::update_run(int run_id, const Observations &obs)
 {
+	perf_trace::ScopedSpan span("RunStorage::update_run");
 	//set run status flage to complete
 	std::int8_t r_status = 1;
 	check_rec_id(run_id);
 	vector<double> obs_data(obs.get_data_vec(obs_names));
-	size_t n_pars = par_names.size();
 
 	//write data to buffer at end of file and set buffer flag to 1
 	std::int8_t buf_status = 0;
@@ -367,7 +669,7 @@ void RunStorage::update_run(int run_id, const Observations &obs)
 	buf_stream.write(reinterpret_cast<char*>(&buf_run_id), sizeof(buf_run_id));
 	buf_stream.write(reinterpret_cast<char*>(&r_status), sizeof(r_status));
 	//skip over parameter section
-	buf_stream.seekp(n_pars * sizeof(double), ios_base::cur);
+	buf_stream.seekp(run_par_byte_size, ios_base::cur);
 	buf_stream.write(reinterpret_cast<char*>(obs_data.data()), obs_data.size() * sizeof(double));
 	buf_status = 1;
 	buf_stream.seekp(get_stream_pos(end_of_runs), ios_base::beg);
@@ -380,7 +682,7 @@ void RunStorage::update_run(int run_id, const Observations &obs)
 	//skip over info_txt and info_value fields
 	buf_stream.seekp(sizeof(char)*info_txt_length + sizeof(double), ios_base::cur);
 	//skip over parameter section
-	buf_stream.seekp(n_pars * sizeof(double), ios_base::cur);
+	buf_stream.seekp(run_par_byte_size, ios_base::cur);
 	buf_stream.write(reinterpret_cast<char*>(obs_data.data()), obs_data.size() * sizeof(double));
 	buf_stream.flush();
 	//reset flag for buffer at end of file to 0 to signal it is no longer relavent
@@ -392,6 +694,23 @@ void RunStorage::update_run(int run_id, const Observations &obs)
 
 void RunStorage::update_run(int run_id, const vector<char> serial_data)
 {
+	perf_trace::ScopedSpan span("RunStorage::update_run");
+	if (delta_mode)
+	{
+		// serial_data holds the full parameter and observation vectors, which are stored as a delta block
+		size_t npar = par_names.size();
+		size_t nobs = obs_names.size();
+		if (serial_data.size() != (npar + nobs) * sizeof(double))
+		{
+			throw PestError("Error in RunStorage routine.  Size of serial data is different from what is expected");
+		}
+		vector<double> par_data(npar);
+		vector<double> obs_data(nobs);
+		memcpy(par_data.data(), serial_data.data(), npar * sizeof(double));
+		memcpy(obs_data.data(), serial_data.data() + npar * sizeof(double), nobs * sizeof(double));
+		update_run(run_id, par_data, obs_data);
+		return;
+	}
 	//set run status flage to complete
 	std::int8_t r_status = 1;
 	check_rec_size(serial_data);
@@ -506,6 +825,7 @@ int RunStorage::get_run(int run_id, Parameters &pars, Observations &obs, bool cl
 
 int RunStorage::get_run(int run_id, double *pars, size_t npars, double *obs, size_t nobs, string &info_txt, double &info_value)
 {
+	perf_trace::ScopedSpan span("RunStorage::get_run");
 	std::int8_t r_status;
 	vector<char> info_txt_buf;
 	info_txt_buf.resize(info_txt_length, '\0');
@@ -531,7 +851,14 @@ int RunStorage::get_run(int run_id, double *pars, size_t npars, double *obs, siz
 	buf_stream.read(reinterpret_cast<char*>(&r_status), sizeof(r_status));
 	buf_stream.read(reinterpret_cast<char*>(&info_txt_buf[0]), sizeof(char)*info_txt_length);
 	buf_stream.read(reinterpret_cast<char*>(&info_value), sizeof(double));
-	buf_stream.read(reinterpret_cast<char*>(pars), p_size * sizeof(double));
+	if (delta_mode)
+	{
+		read_par_block(pars);
+	}
+	else
+	{
+		buf_stream.read(reinterpret_cast<char*>(pars), p_size * sizeof(double));
+	}
 	buf_stream.read(reinterpret_cast<char*>(obs), o_size * sizeof(double));
 	int status = r_status;
 	info_txt = info_txt_buf.data();
@@ -540,6 +867,7 @@ int RunStorage::get_run(int run_id, double *pars, size_t npars, double *obs, siz
 
 int RunStorage::get_run(int run_id, vector<double> &pars_vec, vector<double> &obs_vec, string &info_txt, double &info_value)
 {
+	perf_trace::ScopedSpan span("RunStorage::get_run");
 	std::int8_t  r_status;
 	vector<char> info_txt_buf;
 	info_txt_buf.resize(info_txt_length, '\0');
@@ -556,7 +884,7 @@ int RunStorage::get_run(int run_id, vector<double> &pars_vec, vector<double> &ob
 	buf_stream.read(reinterpret_cast<char*>(&r_status), sizeof(r_status));
 	buf_stream.read(reinterpret_cast<char*>(&info_txt_buf[0]), sizeof(char)*info_txt_length);
 	buf_stream.read(reinterpret_cast<char*>(&info_value), sizeof(double));
-	buf_stream.read(reinterpret_cast<char*>(&pars_vec[0]), n_par * sizeof(double));
+	read_par_block(pars_vec.data());
 	buf_stream.read(reinterpret_cast<char*>(&obs_vec[0]), n_obs * sizeof(double));
 	int status = r_status;
 	info_txt = info_txt_buf.data();
@@ -583,13 +911,61 @@ vector<char> RunStorage::get_serial_pars(int run_id)
 	std::int8_t r_status;
 
 	vector<char> serial_data;
-	serial_data.resize(run_par_byte_size);
+	serial_data.resize(par_names.size() * sizeof(double));
 	buf_stream.seekg(get_stream_pos(run_id), ios_base::beg);
 	buf_stream.seekg(sizeof(r_status)+sizeof(char)*info_txt_length+sizeof(double), ios_base::cur);
-	buf_stream.read(serial_data.data(), serial_data.size());
+	if (delta_mode)
+	{
+		vector<double> par_data(par_names.size());
+		read_par_block(par_data.data());
+		memcpy(serial_data.data(), par_data.data(), serial_data.size());
+	}
+	else
+	{
+		buf_stream.read(serial_data.data(), serial_data.size());
+	}
 	return serial_data;
 }
 
+vector<char> RunStorage::get_serial_par_delta(int run_id)
+{
+	vector<int> par_idx;
+	vector<double> par_vals;
+	get_par_delta(run_id, par_idx, par_vals);
+	vector<int8_t> serial_data = Serialization::serialize(par_idx, par_vals);
+	return vector<char>(serial_data.begin(), serial_data.end());
+}
+
+int RunStorage::get_par_delta(int run_id, vector<int> &par_idx, vector<double> &par_vals)
+{
+	std::int8_t r_status;
+	check_rec_id(run_id);
+	par_idx.clear();
+	par_vals.clear();
+	buf_stream.seekg(get_stream_pos(run_id), ios_base::beg);
+	buf_stream.read(reinterpret_cast<char*>(&r_status), sizeof(r_status));
+	buf_stream.seekg(sizeof(char)*info_txt_length + sizeof(double), ios_base::cur);
+	if (delta_mode)
+	{
+		vector<char> par_block(run_par_byte_size);
+		buf_stream.read(par_block.data(), par_block.size());
+		unpack_delta_block(par_block, par_idx, par_vals);
+	}
+	else
+	{
+		// full storage has no base vector, so every parameter is part of the delta
+		par_vals.resize(par_names.size());
+		buf_stream.read(reinterpret_cast<char*>(par_vals.data()), par_vals.size() * sizeof(double));
+		par_idx.resize(par_names.size());
+		for (int i = 0; i < par_idx.size(); ++i)
+		{
+			par_idx[i] = i;
+		}
+	}
+	int status = r_status;
+	return status;
+}
+
 int  RunStorage::get_parameters(int run_id, Parameters &pars)
 {
 	std::int8_t r_status;
@@ -607,7 +983,7 @@ int  RunStorage::get_parameters(int run_id, Parameters &pars)
 	buf_stream.read(reinterpret_cast<char*>(&info_txt_buf[0]), sizeof(char)*info_txt_length);
 	buf_stream.read(reinterpret_cast<char*>(&info_value), sizeof(double));
 
-	buf_stream.read(reinterpret_cast<char*>(par_data.data()), n_par*sizeof(double));
+	read_par_block(par_data.data());
 	pars.update(par_names, par_data);
 	int status = r_status;
 	return status;
@@ -623,7 +999,6 @@ int  RunStorage::get_observations(int run_id, Observations &obs)
 
 	check_rec_id(run_id);
 
-	size_t n_par = par_names.size();
 	size_t n_obs = obs_names.size();
 	vector<double> obs_data;
 	obs_data.resize(n_obs);
@@ -631,7 +1006,7 @@ int  RunStorage::get_observations(int run_id, Observations &obs)
 	buf_stream.read(reinterpret_cast<char*>(&r_status), sizeof(r_status));
 	buf_stream.read(reinterpret_cast<char*>(&info_txt_buf[0]), sizeof(char)*info_txt_length);
 	buf_stream.read(reinterpret_cast<char*>(&info_value), sizeof(double));
-	buf_stream.seekg(n_par*sizeof(double), ios_base::cur);
+	buf_stream.seekg(run_par_byte_size, ios_base::cur);
 	buf_stream.read(reinterpret_cast<char*>(obs_data.data()), n_obs*sizeof(double));
 	int status = r_status;
 	obs.update(obs_names, obs_data);
@@ -641,6 +1016,7 @@ int  RunStorage::get_observations(int run_id, Observations &obs)
 
 int  RunStorage::get_observations_vec(int run_id, vector<double> &obs_data)
 {
+	perf_trace::ScopedSpan span("RunStorage::get_observations");
 	std::int8_t r_status;
 	vector<char> info_txt_buf;
 	info_txt_buf.resize(info_txt_length, '\0');
@@ -648,19 +1024,35 @@ int  RunStorage::get_observations_vec(int run_id, vector<double> &obs_data)
 
 	check_rec_id(run_id);
 
-	size_t n_par = par_names.size();
 	size_t n_obs = obs_names.size();
 	obs_data.resize(n_obs);
 	buf_stream.seekg(get_stream_pos(run_id), ios_base::beg);
 	buf_stream.read(reinterpret_cast<char*>(&r_status), sizeof(r_status));
 	buf_stream.read(reinterpret_cast<char*>(&info_txt_buf[0]), sizeof(char)*info_txt_length);
 	buf_stream.read(reinterpret_cast<char*>(&info_value), sizeof(double));
-	buf_stream.seekg(n_par*sizeof(double), ios_base::cur);
+	buf_stream.seekg(run_par_byte_size, ios_base::cur);
 	buf_stream.read(reinterpret_cast<char*>(obs_data.data()), n_obs*sizeof(double));
 	int status = r_status;
 	return status;
 }
 
+void RunStorage::get_observations_block(int first_run_id, int n_runs, double *obs_data)
+{
+	perf_trace::ScopedSpan span("RunStorage::get_observations");
+	// read the observations of n_runs consecutive runs in a single pass through the file.
+	// obs_data is filled run by run (ie one column of observations per run)
+	if (n_runs < 1) return;
+	check_rec_id(first_run_id + n_runs - 1);
+	size_t n_obs = obs_names.size();
+	streamoff obs_offset = sizeof(std::int8_t) + sizeof(char)*info_txt_length + sizeof(double) + run_par_byte_size;
+	buf_stream.seekg(get_stream_pos(first_run_id) + obs_offset, ios_base::beg);
+	for (int i = 0; i < n_runs; ++i)
+	{
+		buf_stream.read(reinterpret_cast<char*>(obs_data + i * n_obs), n_obs * sizeof(double));
+		buf_stream.seekg(run_byte_size - n_obs * sizeof(double), ios_base::cur);
+	}
+}
+
 void RunStorage::free_memory()
 {
 	if (buf_stream.is_open()) {
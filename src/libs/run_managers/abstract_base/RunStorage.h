@@ -25,6 +25,7 @@
 #include <ostream>
 #include <vector>
 #include <cstdint>
+#include <unordered_map>
 #include <Eigen/Dense>
 
 class Parameters;
@@ -49,19 +50,35 @@ class RunStorage {
 	//                   depends on the type of model run being stored  )
 	//       parameter_values  (parameters values for model runs)                     double*number of parameters
 	//       observationn_values( observations results produced by the model run)     double*number of observations
+	//
+	// Delta storage (see reset_delta()) is flagged by a negative run_size in the header.  The header is then followed by
+	//     max_n_delta (maximum number of parameters that differ from the base vector)  int_64_t
+	//     base_parameter_values (parameter values shared by all model runs)            double*number of parameters
+	//       (updated with the template roundoff of the values returned by completed runs)
+	//   and the parameter_values of each run are replaced by
+	//       n_delta (number of parameters that differ from the base vector)             int_32_t
+	//       delta_index (index of each parameter that differs from the base vector)    int_32_t*max_n_delta
+	//       delta_value (value of each parameter that differs from the base vector)    double*max_n_delta
 
 public:
 	static const double no_data;
 	RunStorage(const std::string &_filename);
 	void reset(const std::vector<std::string> &par_names, const std::vector<std::string> &obs_names, const std::string &_filename = std::string(""));
+	void reset_delta(const std::vector<std::string> &par_names, const std::vector<std::string> &obs_names, const std::vector<double> &base_par_vec,
+		int _max_n_delta, const std::string &_filename = std::string(""));
 	void init_restart(const std::string &_filename);
 	virtual int add_run(const std::vector<double> &model_pars, const std::string &info_txt="", double info_value=no_data);
 	virtual int add_run(const Parameters &pars, const std::string &info_txt="", double info_value=no_data);
 	virtual int add_run(const Eigen::VectorXd &model_pars, const std::string &info_txt="", double info_value=no_data);
+	int add_run_delta(const Parameters &delta_pars, const std::string &info_txt = "", double info_value = no_data);
+	void replace_run(int run_id, const std::vector<double> &model_pars, const std::string &info_txt = "", double info_value = no_data);
+	void replace_run(int run_id, const Parameters &pars, const std::string &info_txt = "", double info_value = no_data);
 	void copy(const RunStorage &rhs_rs);
 	void update_run(int run_id, const Parameters &pars, const Observations &obs);
+	void update_run(int run_id, const std::vector<double> &par_data, const std::vector<double> &obs_data);
 	void update_run(int run_id, const Observations &obs);
 	void update_run(int run_id, const std::vector<char> serial_data);
+	void update_run_delta(int run_id, const std::vector<double> &delta_par_vals, const std::vector<double> &obs_vec);
 	void update_run_failed(int run_id);
 	void set_run_nfailed(int run_id, int nfail);
 	int get_nruns();
@@ -80,11 +97,16 @@ public:
 	int get_run(int run_id, std::vector<double> &pars_vec, std::vector<double> &obs_vec);
 	int get_parameters(int run_id, Parameters &pars);
 	std::vector<char> get_serial_pars(int run_id);
+	std::vector<char> get_serial_par_delta(int run_id);
+	int get_par_delta(int run_id, std::vector<int> &par_idx, std::vector<double> &par_vals);
+	bool is_delta() const { return delta_mode; }
+	const std::vector<double>& get_base_par_vec() const { return base_pars; }
 	int get_observations_vec(int run_id, std::vector<double> &data_vec);
 	int get_observations(int run_id, Observations &obs);
+	void get_observations_block(int first_run_id, int n_runs, double *obs_data);
 	static void export_diff_to_text_file(const std::string &in1_filename, const std::string &in2_filename, const std::string &out_filename);
 	void free_memory();
-	std::string get_filename() { return filename; }
+	std::string get_filename() const { return filename; }
 	void print_run_summary(std::ostream &fout);
 	~RunStorage();
 private:
@@ -97,6 +119,19 @@ private:
 	std::streamoff run_data_byte_size;
 	std::vector<std::string> par_names;
 	std::vector<std::string> obs_names;
+	bool delta_mode;
+	std::int64_t max_n_delta;
+	std::vector<double> base_pars;
+	std::unordered_map<std::string, int> par_name_index;
+	void reset_file(const std::string &_filename);
+	int add_run_native(const char *par_block, const std::string &info_txt, double info_value);
+	std::vector<char> pack_delta_block(const std::vector<int> &par_idx, const std::vector<double> &par_vals) const;
+	void unpack_delta_block(const std::vector<char> &par_block, std::vector<int> &par_idx, std::vector<double> &par_vals) const;
+	std::vector<char> delta_block_from_vec(const std::vector<double> &par_data) const;
+	std::vector<char> delta_block_from_vec(int run_id, const std::vector<double> &par_data);
+	void write_base_pars();
+	void read_par_block(double *pars);
+	void write_run_data(int run_id, std::int8_t r_status, const char *par_block, const std::vector<double> &obs_data);
 	void check_rec_size(const std::vector<char> &serial_data) const;
 	void check_rec_id(int run_id);
 	std::int8_t get_run_status_native(int run_id);
@@ -39,6 +39,7 @@ public:
 	static std::vector<int8_t> serialize(const Parameters &pars, const std::vector<std::string> &par_names_vec, const Observations &obs, const std::vector<std::string> &obs_names_vec, double run_time);
 	static std::vector<int8_t> serialize(const std::vector<std::string> &string_vec);
 	static std::vector<int8_t> serialize(const std::vector<std::vector<std::string> const*> &string_vec_vec);
+	static std::vector<int8_t> serialize(const std::vector<int> &par_idx, const std::vector<double> &par_vals);
 	static unsigned long unserialize(const std::vector<int8_t> &ser_data, int64_t &data, unsigned long start_loc = 0);
 	static unsigned long unserialize(const std::vector<int8_t> &ser_data, Transformable &tr_data, unsigned long start_loc = 0);
 	static unsigned long unserialize(const std::vector<int8_t> &ser_data, std::vector<Transformable*> &tr_vec, unsigned long start_loc = 0);
@@ -46,6 +47,7 @@ public:
 	static unsigned long unserialize(const std::vector<int8_t> &ser_data, std::vector<std::string> &string_vec, unsigned long start_loc = 0, unsigned long max_read_bytes = ULONG_MAX);
 	static unsigned long unserialize(const std::vector<int8_t> &ser_data, Transformable &items, const std::vector<std::string> &names_vec, unsigned long start_loc = 0);
 	static unsigned long unserialize(const std::vector<int8_t> &ser_data, Parameters &pars, const std::vector<std::string> &par_names, Observations &obs, const std::vector<std::string> &obs_names, double &run_time);
+	static unsigned long unserialize(const std::vector<int8_t> &ser_data, std::vector<int> &par_idx, std::vector<double> &par_vals, unsigned long start_loc = 0);
 private:
 };
 
@@ -159,6 +159,28 @@ vector<int8_t> Serialization::serialize(const vector<string> &string_vec)
 	return serial_data;
 }
 
+vector<int8_t> Serialization::serialize(const vector<int> &par_idx, const vector<double> &par_vals)
+{
+	// sparse parameter delta:  n_delta (int32_t), par_idx (int32_t*n_delta), par_vals (double*n_delta)
+	// n_delta has the same width as in the RunStorage delta blocks
+	assert(par_idx.size() == par_vals.size());
+	int32_t n_delta = par_idx.size();
+	vector<int32_t> idx_data(par_idx.begin(), par_idx.end());
+	size_t n_sz = sizeof(int32_t);
+	size_t idx_buf_sz = n_delta * sizeof(int32_t);
+	size_t val_buf_sz = n_delta * sizeof(double);
+	vector<int8_t> serial_data;
+	serial_data.resize(n_sz + idx_buf_sz + val_buf_sz);
+	int8_t *buf = &serial_data[0];
+	w_memcpy_s(buf, n_sz, &n_delta, sizeof(int32_t));
+	if (n_delta > 0)
+	{
+		w_memcpy_s(buf + n_sz, idx_buf_sz, &idx_data[0], idx_buf_sz);
+		w_memcpy_s(buf + n_sz + idx_buf_sz, val_buf_sz, &par_vals[0], val_buf_sz);
+	}
+	return serial_data;
+}
+
 vector<int8_t> Serialization::serialize(const vector<vector<string>const*> &string_vec_vec)
 {
 	vector<int8_t> serial_data;
@@ -278,3 +300,24 @@ unsigned long Serialization::unserialize(const vector<int8_t> &ser_data, Paramet
 	w_memcpy_s(&run_time, sizeof(double), ser_data.data() + bytes_read, sizeof(double));
 	return bytes_read;
 }
+
+unsigned long Serialization::unserialize(const vector<int8_t> &ser_data, vector<int> &par_idx, vector<double> &par_vals, unsigned long start_loc)
+{
+	int32_t n_delta;
+	size_t n_sz = sizeof(int32_t);
+	assert(ser_data.size() >= start_loc + n_sz);
+	w_memcpy_s(&n_delta, sizeof(int32_t), ser_data.data() + start_loc, n_sz);
+	assert(n_delta >= 0);
+	size_t idx_buf_sz = n_delta * sizeof(int32_t);
+	size_t val_buf_sz = n_delta * sizeof(double);
+	assert(ser_data.size() >= start_loc + n_sz + idx_buf_sz + val_buf_sz);
+	vector<int32_t> idx_data(n_delta);
+	par_vals.resize(n_delta);
+	if (n_delta > 0)
+	{
+		w_memcpy_s(&idx_data[0], idx_buf_sz, ser_data.data() + start_loc + n_sz, idx_buf_sz);
+		w_memcpy_s(&par_vals[0], val_buf_sz, ser_data.data() + start_loc + n_sz + idx_buf_sz, val_buf_sz);
+	}
+	par_idx.assign(idx_data.begin(), idx_data.end());
+	return n_sz + idx_buf_sz + val_buf_sz;
+}
@@ -101,6 +101,8 @@ void ModelInterface::set_files()
 ModelInterface::ModelInterface()
 {
 	initialized = false;
+	use_fake_model = false;
+	run_derivatives = false;
 }
 
 ModelInterface::ModelInterface(vector<string> _tplfile_vec, vector<string> _inpfile_vec,
@@ -113,6 +115,8 @@ ModelInterface::ModelInterface(vector<string> _tplfile_vec, vector<string> _inpf
 	comline_vec = _comline_vec;
 
 	initialized = false;
+	use_fake_model = false;
+	run_derivatives = false;
 }
 
 void ModelInterface::initialize(vector<string> _tplfile_vec, vector<string> _inpfile_vec,
@@ -133,6 +137,16 @@ void ModelInterface::initialize(vector<string> &_par_name_vec, vector<string> &_
 {
 	par_name_vec = _par_name_vec;
 	obs_name_vec = _obs_name_vec;
+
+	//the fake model needs no template or instruction files
+	use_fake_model = FakeModel::is_fake_command(comline_vec);
+	if (use_fake_model)
+	{
+		fake_model.initialize(comline_vec[0], par_name_vec, obs_name_vec);
+		initialized = true;
+		return;
+	}
+
 	int npar = par_name_vec.size();
 	int nobs = obs_name_vec.size();
 	int ntpl = tplfile_vec.size();
@@ -162,6 +176,11 @@ void ModelInterface::initialize(vector<string> &_par_name_vec, vector<string> &_
 
 void ModelInterface::finalize()
 {
+	if (use_fake_model)
+	{
+		initialized = false;
+		return;
+	}
 	mio_finalise_w_(&ifail);
 	if (ifail != 0) ModelInterface::throw_mio_error("error finalizing model interface");
 	initialized = false;
@@ -209,6 +228,16 @@ void ModelInterface::run(pest_utils::thread_flag* terminate, pest_utils::thread_
 
 	try
 	{
+		if (use_fake_model)
+		{
+			fake_model.run(terminate, par_vals, obs_vals);
+			if (terminate->get())
+				return;
+			obs->update(obs_name_vec, obs_vals);
+			finished->set(true);
+			return;
+		}
+
 		//first delete any existing input and output files
 		// This outer loop is a work around for a bug in windows.  Window can fail to release a file
 		// handle quick enough when the external run executes very quickly
@@ -281,6 +310,12 @@ void ModelInterface::run(pest_utils::thread_flag* terminate, pest_utils::thread_
 		// 	throw PestError(ss.str());
 		// }
 
+		vector<string> run_comline_vec(comline_vec);
+		if (run_derivatives && !dercom.empty())
+		{
+			run_comline_vec.push_back(dercom);
+		}
+
 		int npar = par_vals.size();
 		try
 		{
@@ -308,7 +343,7 @@ void ModelInterface::run(pest_utils::thread_flag* terminate, pest_utils::thread_
 		{
 			throw PestError("could not assign job limit flag to job object");
 		}
-		for (auto &cmd_string : comline_vec)
+		for (auto &cmd_string : run_comline_vec)
 		{
 			//start the command
 			PROCESS_INFORMATION pi;
@@ -366,7 +401,7 @@ void ModelInterface::run(pest_utils::thread_flag* terminate, pest_utils::thread_
 #ifdef OS_LINUX
 		//a flag to track if the run was terminated
 		bool term_break = false;
-		for (auto &cmd_string : comline_vec)
+		for (auto &cmd_string : run_comline_vec)
 		{
 			//start the command
 			int command_pid = start(cmd_string);
@@ -5,6 +5,7 @@
 #include <string>
 #include "Transformable.h"
 #include "utilities.h"
+#include "FakeModel.h"
 
 using namespace std;
 
@@ -30,12 +31,19 @@ public:
 	void finalize();
 	~ModelInterface();
 	bool get_initialized(){ return initialized; }
+	bool get_use_fake_model() { return use_fake_model; }
+	//the derivatives command is run after the model commands while run_derivatives is set
+	void set_derivatives_command(const string &_dercom) { dercom = _dercom; }
+	void set_run_derivatives(bool _run_derivatives) { run_derivatives = _run_derivatives; }
 private:
 
 	void set_files();
 	void check();
 
 	bool initialized;
+	//true when the command line selects the in-process FakeModel
+	bool use_fake_model;
+	FakeModel fake_model;
 	int ifail;
 	vector<string> par_name_vec;
 	vector<string> obs_name_vec;
@@ -44,6 +52,8 @@ private:
 	vector<string> outfile_vec;
 	vector<string> insfile_vec;
 	vector<string> comline_vec;
+	string dercom;
+	bool run_derivatives;
 
 	vector<double> par_vals;
 	vector<double> obs_vals;
@@ -71,9 +71,22 @@ void RunManagerSerial::run()
 				obs_vec.resize(obs_name_vec.size(), RunStorage::no_data);
 				obs.clear();
 				obs.insert(obs_name_vec, obs_vec);
+				bool der_run = (derivative_run_ids.find(i_run) != derivative_run_ids.end());
+				if (der_run)
+				{
+					remove(derfile.c_str());
+				}
+				mi.set_run_derivatives(der_run);
 				mi.run(&pars, &obs);
 				
 				OperSys::chdir(run_dir.c_str());
+				if (der_run)
+				{
+					if (check_exist_in(derfile))
+						derivative_file_map[i_run] = derfile;
+					else
+						cerr << endl << "  derivatives command did not write " << derfile << endl;
+				}
 				success_runs += 1;
 				std::cout << string(message.str().size(), '\b');
 				message.str("");
@@ -121,6 +134,12 @@ void RunManagerSerial::run()
 }
 
 
+void RunManagerSerial::set_derivatives_command(const string &_dercom, const string &_derfile)
+{
+	RunManagerAbstract::set_derivatives_command(_dercom, _derfile);
+	mi.set_derivatives_command(_dercom);
+}
+
 RunManagerSerial::~RunManagerSerial(void)
 {
 }
@@ -31,6 +31,8 @@ public:
 		const std::vector<std::string> _insfile_vec, const std::vector<std::string> _outfile_vec,
 		const std::string &stor_filename, const std::string &run_dir, int _max_run_fail=1);
 	virtual void run();
+	virtual void set_derivatives_command(const std::string &_dercom, const std::string &_derfile);
+	virtual bool supports_derivatives() const { return true; }
 	void throw_mio_error(std::string base_message);
 	~RunManagerSerial(void);
 private:
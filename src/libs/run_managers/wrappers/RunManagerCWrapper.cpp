@@ -166,6 +166,21 @@ int rmic_get_run(RunManager *run_manager_ptr, int run_id, double *parameter_data
 	return err;
 }
 
+int rmic_get_next_completed_run(RunManager *run_manager_ptr, int *run_id, int *run_status)
+{
+	int err = 0;
+	*run_id = -1;
+	try
+	{
+		*run_id = run_manager_ptr->get_next_completed_run(*run_status);
+	}
+	catch (...)
+	{
+		err = 1;
+	}
+	return err;
+}
+
 int rmic_get_num_failed_runs(RunManager *run_manager_ptr, int *nfail)
 {
 	int err = 0;
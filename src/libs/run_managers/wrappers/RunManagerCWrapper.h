@@ -73,6 +73,12 @@ extern __declspec(dllexport)
 #endif
 int rmic_get_run(RunManager *run_manager_ptr, int run_id, double *parameter_data, int npar, double *obs_data, int nobs);
 
+//non-blocking: run_id is set to a run that has finished since the last call, or -1 if there is none
+#ifdef OS_WIN
+extern __declspec(dllexport)
+#endif
+int rmic_get_next_completed_run(RunManager *run_manager_ptr, int *run_id, int *run_status);
+
 
 #ifdef OS_WIN
 extern __declspec(dllexport)
@@ -111,6 +111,22 @@ int rmif_add_run_(double *parameter_data, int *npar, int *id)
 	return err;
 }
 
+int rmif_replace_run_(double *parameter_data, int *npar, int *id)
+{
+	//id is the run to replace on entry and the id the new run was given on return
+	int err = 0;
+	try {
+		Parameters pars;
+		pars.insert(_run_manager_ptr_->get_par_name_vec(), vector<double>(parameter_data, parameter_data + *npar));
+		*id = _run_manager_ptr_->replace_run(*id, pars);
+	}
+	catch (...)
+	{
+		err = 1;
+	}
+	return err;
+}
+
 int rmif_add_run_with_info_(double *parameter_data, int *npar, int *id,
 	char *f_info_txt, int  *info_txt_len, double *info_value)
 {
@@ -218,6 +234,20 @@ int rmif_get_run_(int *run_id, double *parameter_data, int *npar, double *obs_da
 }
 
 
+int rmif_get_next_completed_run_(int *run_id, int *run_status)
+{
+	int err = 0;
+	*run_id = -1;
+	try {
+		*run_id = _run_manager_ptr_->get_next_completed_run(*run_status);
+	}
+	catch (...)
+	{
+		err = 1;
+	}
+	return err;
+}
+
 int rmif_get_run_with_info_(int *run_id, double *parameter_data, int *npar, double *obs_data, int *nobs,
 	char *f_info_txt, int  *info_txt_len, double *info_value)
 {
@@ -34,6 +34,8 @@ int RMIF_CREATE_GENIE(char *f_comline, int  *comline_str_len, int *comline_array
 
 int RMIF_ADD_RUN(double *parameter_data, int *npar, int *id);
 
+int RMIF_REPLACE_RUN(double *parameter_data, int *npar, int *id);
+
 int RMIF_ADD_RUN_WITH_INFO(double *parameter_data, int *npar, int *id,
 	char *f_info_txt, int  *info_txt_len, double *info_value);
 
@@ -50,6 +52,8 @@ int RMIF_RUN_UNTIL(int *condition, int *no_ops, double *time_sec, int *return_co
 
 int RMIF_GET_RUN(int *run_id, double *parameter_data, int *npar, double *obs_data, int *nobs);
 
+int RMIF_GET_NEXT_COMPLETED_RUN(int *run_id, int *run_status);
+
 int RMIF_GET_RUN_WITH_INFO(int *run_id, double *parameter_data, int *npar, double *obs_data, int *nobs,
 	char *f_info_txt, int  *info_txt_len, double *info_value);
 
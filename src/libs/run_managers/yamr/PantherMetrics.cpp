@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+#include "network_package.h"
+#include "pest_error.h"
+#include "PantherMetrics.h"
+
+using namespace std;
+
+const vector<double> PantherMetrics::Histogram::bucket_bounds = { 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0, 30.0, 60.0,
+	120.0, 300.0, 600.0, 1800.0, 3600.0, 7200.0, 14400.0 };
+
+PantherMetrics::Histogram::Histogram() : bucket_counts(bucket_bounds.size() + 1, 0), count(0), sum(0.0),
+	min_value(0.0), max_value(0.0)
+{
+}
+
+void PantherMetrics::Histogram::add(double value)
+{
+	size_t i = lower_bound(bucket_bounds.begin(), bucket_bounds.end(), value) - bucket_bounds.begin();
+	bucket_counts[i]++;
+	if (count == 0)
+	{
+		min_value = value;
+		max_value = value;
+	}
+	else
+	{
+		min_value = min(min_value, value);
+		max_value = max(max_value, value);
+	}
+	count++;
+	sum += value;
+}
+
+double PantherMetrics::Histogram::quantile(double q) const
+{
+	if (count == 0)
+		return 0.0;
+	double target = q * count;
+	double cum = 0.0;
+	for (size_t i = 0; i < bucket_counts.size(); ++i)
+	{
+		if (bucket_counts[i] == 0)
+			continue;
+		if (cum + bucket_counts[i] >= target)
+		{
+			//interpolate within the bucket, clipped to the observed range
+			double lower = (i == 0) ? min_value : max(min_value, bucket_bounds[i - 1]);
+			double upper = (i < bucket_bounds.size()) ? min(max_value, bucket_bounds[i]) : max_value;
+			double frac = (target - cum) / bucket_counts[i];
+			return lower + frac * (upper - lower);
+		}
+		cum += bucket_counts[i];
+	}
+	return max_value;
+}
+
+void PantherMetrics::Histogram::write_json(ostream &fout) const
+{
+	fout << "{\"count\": " << count << ", \"mean\": " << get_mean() << ", \"min\": " << get_min()
+		<< ", \"max\": " << get_max() << ", \"p50\": " << quantile(0.5) << ", \"p90\": " << quantile(0.9)
+		<< ", \"p99\": " << quantile(0.99) << ", \"buckets\": [";
+	for (size_t i = 0; i < bucket_counts.size(); ++i)
+	{
+		fout << (i > 0 ? ", " : "") << "{\"le\": ";
+		if (i < bucket_bounds.size())
+			fout << bucket_bounds[i];
+		else
+			fout << "\"inf\"";
+		fout << ", \"count\": " << bucket_counts[i] << "}";
+	}
+	fout << "]}";
+}
+
+PantherMetrics::PantherMetrics() : enabled(false), interval_sec(0.0), n_closed_workers(0)
+{
+	start_time = chrono::system_clock::now();
+	last_snapshot_time = start_time;
+	closed_workers = WorkerSnapshot{ "closed", "", "closed", -1, 0.0, 0.0, 0.0, 0.0, 0, 0, 0 };
+}
+
+void PantherMetrics::initialize(const string &_csv_filename, const string &_json_filename, double _interval_sec)
+{
+	csv_filename = _csv_filename;
+	json_filename = _json_filename;
+	interval_sec = _interval_sec;
+	enabled = true;
+	f_csv.open(csv_filename);
+	if (!f_csv.good())
+		throw PestError("PantherMetrics::initialize: unable to open " + csv_filename + " for writing");
+	f_csv << "time_sec,runs_waiting,runs_active,runs_completed,runs_failed,runs_timed_out,unique_failures,"
+		<< "workers_running,workers_waiting,workers_unavailable,worker_utilization,bytes_sent,bytes_received,"
+		<< "run_time_mean,run_time_p50,run_time_p90,run_time_max,queue_wait_p50,queue_wait_p90" << endl;
+}
+
+double PantherMetrics::get_elapsed_sec() const
+{
+	return chrono::duration<double>(chrono::system_clock::now() - start_time).count();
+}
+
+bool PantherMetrics::snapshot_due() const
+{
+	if (!enabled)
+		return false;
+	return chrono::duration<double>(chrono::system_clock::now() - last_snapshot_time).count() >= interval_sec;
+}
+
+void PantherMetrics::count(const string &name, int64_t n)
+{
+	counters[name] += n;
+}
+
+void PantherMetrics::add_closed_worker(const WorkerSnapshot &worker)
+{
+	n_closed_workers++;
+	closed_workers.busy_sec += worker.busy_sec;
+	closed_workers.idle_sec += worker.idle_sec;
+	closed_workers.runs_completed += worker.runs_completed;
+	closed_workers.runs_failed += worker.runs_failed;
+	closed_workers.runs_killed += worker.runs_killed;
+}
+
+string PantherMetrics::to_json(const MasterSnapshot &master, const vector<WorkerSnapshot> &workers) const
+{
+	stringstream ss;
+	ss << setprecision(6);
+	int n_done = master.runs_completed + master.runs_failed;
+	double busy = closed_workers.busy_sec;
+	double idle = closed_workers.idle_sec;
+	for (auto &w : workers)
+	{
+		busy += w.busy_sec;
+		idle += w.idle_sec;
+	}
+	ss << "{" << endl;
+	ss << "  \"time_sec\": " << get_elapsed_sec() << "," << endl;
+	ss << "  \"queue\": {\"runs_waiting\": " << master.runs_waiting << ", \"runs_active\": " << master.runs_active
+		<< ", \"runs_completed\": " << master.runs_completed << ", \"runs_failed\": " << master.runs_failed
+		<< ", \"runs_timed_out\": " << master.runs_timed_out << ", \"unique_failures\": " << master.unique_failures
+		<< ", \"failure_rate\": " << ((n_done > 0) ? double(master.runs_failed) / n_done : 0.0)
+		<< ", \"timeout_rate\": " << ((n_done > 0) ? double(master.runs_timed_out) / n_done : 0.0) << "}," << endl;
+	ss << "  \"workers\": {\"running\": " << master.workers_running << ", \"waiting\": " << master.workers_waiting
+		<< ", \"unavailable\": " << master.workers_unavailable << ", \"closed\": " << n_closed_workers
+		<< ", \"busy_sec\": " << busy << ", \"idle_sec\": " << idle
+		<< ", \"utilization\": " << ((busy + idle > 0.0) ? busy / (busy + idle) : 0.0) << "}," << endl;
+	ss << "  \"overdue\": {\"avg_run_sec\": " << master.avg_run_sec << ", \"overdue_reched_fac\": " << master.overdue_reched_fac
+		<< ", \"overdue_giveup_fac\": " << master.overdue_giveup_fac << ", \"overdue_giveup_minutes\": " << master.overdue_giveup_minutes
+		<< "}," << endl;
+	ss << "  \"network\": {\"bytes_sent\": " << NetPackage::get_total_bytes_sent() << ", \"bytes_received\": "
+		<< NetPackage::get_total_bytes_received() << "}," << endl;
+	ss << "  \"counters\": {";
+	bool first = true;
+	for (auto &c : counters)
+	{
+		ss << (first ? "" : ", ") << "\"" << c.first << "\": " << c.second;
+		first = false;
+	}
+	ss << "}," << endl;
+	ss << "  \"run_time_sec\": ";
+	run_time.write_json(ss);
+	ss << "," << endl << "  \"queue_wait_sec\": ";
+	queue_wait.write_json(ss);
+	ss << "," << endl << "  \"worker_detail\": [" << endl;
+	for (size_t i = 0; i < workers.size(); ++i)
+	{
+		const WorkerSnapshot &w = workers[i];
+		string work_dir = w.work_dir;
+		replace(work_dir.begin(), work_dir.end(), '\\', '/');
+		replace(work_dir.begin(), work_dir.end(), '"', '\'');
+		ss << "    {\"name\": \"" << w.name << "\", \"work_dir\": \"" << work_dir << "\", \"state\": \"" << w.state
+			<< "\", \"run_id\": " << w.run_id << ", \"busy_sec\": " << w.busy_sec << ", \"idle_sec\": " << w.idle_sec
+			<< ", \"current_run_sec\": " << w.current_run_sec << ", \"avg_run_sec\": " << w.avg_run_sec
+			<< ", \"runs_completed\": " << w.runs_completed << ", \"runs_failed\": " << w.runs_failed
+			<< ", \"runs_killed\": " << w.runs_killed << "}" << (i + 1 < workers.size() ? "," : "") << endl;
+	}
+	ss << "  ]" << endl << "}" << endl;
+	return ss.str();
+}
+
+void PantherMetrics::write_snapshot(const MasterSnapshot &master, const vector<WorkerSnapshot> &workers)
+{
+	if (!enabled)
+		return;
+	last_snapshot_time = chrono::system_clock::now();
+	double busy = closed_workers.busy_sec;
+	double idle = closed_workers.idle_sec;
+	for (auto &w : workers)
+	{
+		busy += w.busy_sec;
+		idle += w.idle_sec;
+	}
+	f_csv << get_elapsed_sec() << "," << master.runs_waiting << "," << master.runs_active << ","
+		<< master.runs_completed << "," << master.runs_failed << "," << master.runs_timed_out << ","
+		<< master.unique_failures << "," << master.workers_running << "," << master.workers_waiting << ","
+		<< master.workers_unavailable << "," << ((busy + idle > 0.0) ? busy / (busy + idle) : 0.0) << ","
+		<< NetPackage::get_total_bytes_sent() << "," << NetPackage::get_total_bytes_received() << ","
+		<< run_time.get_mean() << "," << run_time.quantile(0.5) << "," << run_time.quantile(0.9) << ","
+		<< run_time.get_max() << "," << queue_wait.quantile(0.5) << "," << queue_wait.quantile(0.9) << endl;
+
+	//write to a temporary file and rename so readers never see a partial document
+	string tmp_filename = json_filename + ".tmp";
+	{
+		ofstream f_json(tmp_filename);
+		if (!f_json.good())
+			return;
+		f_json << to_json(master, workers);
+	}
+	remove(json_filename.c_str());
+	rename(tmp_filename.c_str(), json_filename.c_str());
+}
@@ -0,0 +1,102 @@
+#ifndef PANTHER_METRICS_H_
+#define PANTHER_METRICS_H_
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+// Counters, histograms and per-worker utilization for the PANTHER master.
+// RunManagerPanther feeds the events and periodically hands over the current
+// queue and worker state; snapshots are appended to a csv file (one row per
+// interval) and written in full to a json file that is replaced each interval.
+// The same json document is served by the optional local http endpoint.
+
+class PantherMetrics
+{
+public:
+	class Histogram
+	{
+	public:
+		Histogram();
+		void add(double value);
+		int64_t get_count() const { return count; }
+		double get_mean() const { return (count > 0) ? sum / count : 0.0; }
+		double get_min() const { return (count > 0) ? min_value : 0.0; }
+		double get_max() const { return (count > 0) ? max_value : 0.0; }
+		//estimated from the buckets by linear interpolation
+		double quantile(double q) const;
+		void write_json(std::ostream &fout) const;
+		//upper bounds of the buckets, in seconds; the last bucket is open ended
+		static const std::vector<double> bucket_bounds;
+	private:
+		std::vector<int64_t> bucket_counts;
+		int64_t count;
+		double sum;
+		double min_value;
+		double max_value;
+	};
+
+	struct WorkerSnapshot
+	{
+		std::string name;
+		std::string work_dir;
+		std::string state;
+		int run_id;
+		double busy_sec;
+		double idle_sec;
+		//how long the current run has been going, 0 when not running
+		double current_run_sec;
+		double avg_run_sec;
+		int runs_completed;
+		int runs_failed;
+		int runs_killed;
+	};
+
+	struct MasterSnapshot
+	{
+		int runs_waiting;
+		int runs_active;
+		int runs_completed;
+		int runs_failed;
+		int runs_timed_out;
+		int unique_failures;
+		int workers_running;
+		int workers_waiting;
+		int workers_unavailable;
+		double avg_run_sec;
+		double overdue_reched_fac;
+		double overdue_giveup_fac;
+		double overdue_giveup_minutes;
+	};
+
+	PantherMetrics();
+	void initialize(const std::string &_csv_filename, const std::string &_json_filename, double _interval_sec);
+	bool get_enabled() const { return enabled; }
+	bool snapshot_due() const;
+	void count(const std::string &name, int64_t n = 1);
+	void add_run_time(double sec) { run_time.add(sec); }
+	void add_queue_wait(double sec) { queue_wait.add(sec); }
+	//keep the totals of workers that have disconnected
+	void add_closed_worker(const WorkerSnapshot &worker);
+	void write_snapshot(const MasterSnapshot &master, const std::vector<WorkerSnapshot> &workers);
+	std::string to_json(const MasterSnapshot &master, const std::vector<WorkerSnapshot> &workers) const;
+private:
+	bool enabled;
+	double interval_sec;
+	std::string csv_filename;
+	std::string json_filename;
+	std::ofstream f_csv;
+	std::chrono::system_clock::time_point start_time;
+	std::chrono::system_clock::time_point last_snapshot_time;
+	std::map<std::string, int64_t> counters;
+	Histogram run_time;
+	Histogram queue_wait;
+	WorkerSnapshot closed_workers;
+	int n_closed_workers;
+	double get_elapsed_sec() const;
+};
+
+#endif /* PANTHER_METRICS_H_ */
@@ -1,6 +1,7 @@
 #include "PantherSlave.h"
 #include "utilities.h"
 #include "Serialization.h"
+#include "PayloadCodec.h"
 #include "system_variables.h"
 #include <cassert>
 #include <cstring>
@@ -14,7 +15,7 @@ using namespace pest_utils;
 
 int  linpack_wrap(void);
 
-PANTHERSlave::PANTHERSlave() :mi()
+PANTHERSlave::PANTHERSlave() :mi(), base_par_group_id(-1), use_payload_codec(false), base_obs_group_id(-1)
 {
 
 }
@@ -56,6 +57,7 @@ void PANTHERSlave::init_network(const string &host, const string &port)
 	cout << "connection to master succeeded on socket: " << w_get_addrinfo_string(connect_addr) << endl << endl;
 	freeaddrinfo(servinfo);
 
+	w_set_nodelay(sockfd);
 	fdmax = sockfd;
 	FD_ZERO(&master);
 	FD_SET(sockfd, &master);
@@ -89,6 +91,8 @@ void PANTHERSlave::process_ctl_file(const string &ctl_filename)
 	inpfile_vec.clear();
 	insfile_vec.clear();
 	outfile_vec.clear();
+	dercom.clear();
+	derfile.clear();
 	std::vector<std::string> pestpp_lines;
 	fin.open(ctl_filename);
 	if (!fin)
@@ -99,6 +103,12 @@ void PANTHERSlave::process_ctl_file(const string &ctl_filename)
 		for (lnum = 1, sec_begin_lnum = 1; getline(fin, line); ++lnum)
 		{
 			strip_ip(line);
+			//only the control data and model interface sections are needed by the worker,
+			//so lines in the (possibly very large) data sections are not tokenized
+			if ((section != "CONTROL DATA") && (section != "MODEL COMMAND LINE") && (section != "MODEL INPUT/OUTPUT") &&
+				(section != "DERIVATIVES COMMAND LINE") &&
+				(line.compare(0, 1, "*") != 0) && (line.compare(0, 2, "++") != 0))
+				continue;
 			line_upper = upper_cp(line);
 			tokens.clear();
 			tokenize(line_upper, tokens);
@@ -132,6 +142,13 @@ void PANTHERSlave::process_ctl_file(const string &ctl_filename)
 			{
 				comline_vec.push_back(line);
 			}
+			else if (section == "DERIVATIVES COMMAND LINE")
+			{
+				if (sec_lnum == 1)
+					dercom = line;
+				else if (sec_lnum == 2)
+					derfile = line;
+			}
 			else if (section == "MODEL INPUT/OUTPUT")
 			{
 				vector<string> tokens_case_sen;
@@ -210,6 +227,8 @@ void PANTHERSlave::process_panther_ctl_file(const string &ctl_filename)
 	inpfile_vec.clear();
 	insfile_vec.clear();
 	outfile_vec.clear();
+	dercom.clear();
+	derfile.clear();
 	std::vector<std::string> pestpp_lines;
 	fin.open(ctl_filename);
 	try {
@@ -238,6 +257,13 @@ void PANTHERSlave::process_panther_ctl_file(const string &ctl_filename)
 			{
 				comline_vec.push_back(line);
 			}
+			else if (section == "DERIVATIVES COMMAND LINE")
+			{
+				if (sec_lnum == 1)
+					dercom = line;
+				else if (sec_lnum == 2)
+					derfile = line;
+			}
 			else if (section == "MODEL INPUT")
 			{
 				vector<string> tokens_case_sen;
@@ -432,6 +458,7 @@ NetPackage::PackType PANTHERSlave::run_model(Parameters &pars, Observations &obs
 		//initialize the model interface
 		mi.initialize(tplfile_vec, inpfile_vec, insfile_vec,
 			outfile_vec, comline_vec, par_name_vec, obs_name_vec);
+		mi.set_derivatives_command(dercom);
 	}
 
 	thread_flag f_terminate(false);
@@ -542,7 +569,8 @@ NetPackage::PackType PANTHERSlave::run_model(Parameters &pars, Observations &obs
 	}
 
 	//sleep here just to give the os a chance to cleanup any remaining file handles
-	w_sleep(poll_interval_seconds * 1000);
+	if (!mi.get_use_fake_model())
+		w_sleep(poll_interval_seconds * 1000);
 	return final_run_status;
 }
 
@@ -556,6 +584,8 @@ void PANTHERSlave::run_async(pest_utils::thread_flag* terminate, pest_utils::thr
 
 void PANTHERSlave::check_io()
 {
+	if (FakeModel::is_fake_command(comline_vec))
+		return;
 	vector<string> inaccessible_files;
 	for (auto &file : insfile_vec)
 	if (!check_exist_in(file)) inaccessible_files.push_back(file);
@@ -639,7 +669,15 @@ void PANTHERSlave::start(const string &host, const string &port)
 		else if(net_pack.get_type() == NetPackage::PackType::REQ_LINPACK)
 		{
 			linpack_wrap();
-			net_pack.reset(NetPackage::PackType::LINPACK, 0, 0,"");
+			// return the offered capabilities that this slave supports
+			string offered = net_pack.get_desc();
+			use_payload_codec = NetPackage::has_capability(offered, PayloadCodec::handshake);
+			string supported;
+			if (use_payload_codec)
+				supported = PayloadCodec::handshake + " ";
+			if (NetPackage::has_capability(offered, NetPackage::run_delta_capability))
+				supported += NetPackage::run_delta_capability;
+			net_pack.reset(NetPackage::PackType::LINPACK, 0, 0, supported);
 			char data;
 			err = send_message(net_pack, &data, 0);
 			if (err != 1)
@@ -647,12 +685,83 @@ void PANTHERSlave::start(const string &host, const string &port)
 				exit(-1);
 			}
 		}
-		else if(net_pack.get_type() == NetPackage::PackType::START_RUN)
+		else if (net_pack.get_type() == NetPackage::PackType::BASE_PARS)
 		{
-			Serialization::unserialize(net_pack.get_data(), pars, par_name_vec);
+			// base parameter values shared by the START_RUN_DELTA runs of this group
+			size_t npar = par_name_vec.size();
+			if (net_pack.get_data().size() != npar * sizeof(double))
+			{
+				cerr << "received corrupt base parameter packet from master" << endl;
+				cerr << "terminating execution ..." << endl << endl;
+				net_pack.reset(NetPackage::PackType::CORRUPT_MESG, 0, 0, "");
+				char data;
+				int np_err = send_message(net_pack, &data, 0);
+				exit(-1);
+			}
+			base_par_vec.resize(npar);
+			w_memcpy_s(base_par_vec.data(), npar * sizeof(double), net_pack.get_data().data(), npar * sizeof(double));
+			base_par_group_id = net_pack.get_group_id();
+		}
+		else if (net_pack.get_type() == NetPackage::PackType::BASE_OBS)
+		{
+			// reference observations for the RUN_FINISHED_PACKED results of this group
+			try
+			{
+				PayloadCodec::decode(net_pack.get_data(), 0, net_pack.get_data().size(), obs_name_vec.size(), base_obs_vec);
+			}
+			catch (exception &e)
+			{
+				cerr << "received corrupt base observation packet from master: " << e.what() << endl;
+				cerr << "terminating execution ..." << endl << endl;
+				net_pack.reset(NetPackage::PackType::CORRUPT_MESG, 0, 0, "");
+				char data;
+				int np_err = send_message(net_pack, &data, 0);
+				exit(-1);
+			}
+			base_obs_group_id = net_pack.get_group_id();
+		}
+		else if(net_pack.get_type() == NetPackage::PackType::START_RUN
+			|| net_pack.get_type() == NetPackage::PackType::START_RUN_DELTA)
+		{
+			bool delta_run = (net_pack.get_type() == NetPackage::PackType::START_RUN_DELTA);
+			vector<int> par_idx;
+			vector<double> par_vals;
+			vector<double> sent_par_vec;
+			if (delta_run)
+			{
+				if (base_par_group_id != net_pack.get_group_id())
+				{
+					cerr << "received parameter delta without base parameters from master" << endl;
+					cerr << "terminating execution ..." << endl << endl;
+					net_pack.reset(NetPackage::PackType::CORRUPT_MESG, 0, 0, "");
+					char data;
+					int np_err = send_message(net_pack, &data, 0);
+					exit(-1);
+				}
+				Serialization::unserialize(net_pack.get_data(), par_idx, par_vals);
+				vector<double> par_data(base_par_vec);
+				for (size_t i = 0; i < par_idx.size(); ++i)
+				{
+					par_data[par_idx[i]] = par_vals[i];
+				}
+				pars.update(par_name_vec, par_data);
+				sent_par_vec.swap(par_data);
+			}
+			else
+			{
+				Serialization::unserialize(net_pack.get_data(), pars, par_name_vec);
+				if (use_payload_codec)
+					sent_par_vec = pars.get_data_vec(par_name_vec);
+			}
 			// run model
 			int group_id = net_pack.get_group_id();
 			int run_id = net_pack.get_run_id();
+			bool der_run = (net_pack.get_desc() == NetPackage::derivatives_desc) && !dercom.empty();
+			if (der_run)
+			{
+				remove(derfile.c_str());
+			}
+			mi.set_run_derivatives(der_run);
 			
 			cout << "received parameters (group id = " << group_id << ", run id = " << run_id << ")" << endl;
 			cout << "starting model run..." << endl;
@@ -666,8 +775,59 @@ void PANTHERSlave::start(const string &host, const string &port)
 				cout << "run complete" << endl;
 				cout << "sending results to master (group id = " << group_id << ", run id = " << run_id << ")..." << endl;
 				cout << "results sent" << endl << endl;
-				serialized_data = Serialization::serialize(pars, par_name_vec, obs, obs_name_vec, run_time);
-				net_pack.reset(NetPackage::PackType::RUN_FINISHED, group_id, run_id, "");
+				if (der_run)
+				{
+					// the derivatives file goes ahead of the results so the master has it when the run completes
+					ifstream fin(derfile, ios::binary);
+					if (fin)
+					{
+						vector<int8_t> der_data((istreambuf_iterator<char>(fin)), istreambuf_iterator<char>());
+						NetPackage der_pack(NetPackage::PackType::DERIVATIVES, group_id, run_id, "");
+						err = send_message(der_pack, der_data.data(), der_data.size());
+						if (err != 1)
+						{
+							exit(-1);
+						}
+					}
+					else
+					{
+						cerr << "derivatives command did not write " << derfile << endl;
+					}
+				}
+				if (use_payload_codec)
+				{
+					// only the parameters changed by the model interface are returned
+					const vector<double> *base_obs = (base_obs_group_id == group_id) ? &base_obs_vec : nullptr;
+					serialized_data = PayloadCodec::pack_results(sent_par_vec, pars.get_data_vec(par_name_vec),
+						obs.get_data_vec(obs_name_vec), run_time, base_obs);
+					net_pack.reset(NetPackage::PackType::RUN_FINISHED_PACKED, group_id, run_id, "");
+				}
+				else if (delta_run)
+				{
+					// only return the parameters changed by the model interface (template roundoff) along with the observations
+					vector<double> run_par_vec = pars.get_data_vec(par_name_vec);
+					par_idx.clear();
+					par_vals.clear();
+					for (size_t i = 0; i < run_par_vec.size(); ++i)
+					{
+						if (run_par_vec[i] != sent_par_vec[i])
+						{
+							par_idx.push_back(i);
+							par_vals.push_back(run_par_vec[i]);
+						}
+					}
+					serialized_data = Serialization::serialize(par_idx, par_vals);
+					vector<double> obs_data = obs.get_data_vec(obs_name_vec);
+					obs_data.push_back(run_time);
+					const int8_t *obs_buf = reinterpret_cast<const int8_t*>(obs_data.data());
+					serialized_data.insert(serialized_data.end(), obs_buf, obs_buf + obs_data.size() * sizeof(double));
+					net_pack.reset(NetPackage::PackType::RUN_FINISHED_DELTA, group_id, run_id, "");
+				}
+				else
+				{
+					serialized_data = Serialization::serialize(pars, par_name_vec, obs, obs_name_vec, run_time);
+					net_pack.reset(NetPackage::PackType::RUN_FINISHED, group_id, run_id, "");
+				}
 				err = send_message(net_pack, serialized_data.data(), serialized_data.size());
 				if (err != 1)
 				{
@@ -71,8 +71,16 @@ private:
 	std::vector<std::string> inpfile_vec;
 	std::vector<std::string> insfile_vec;
 	std::vector<std::string> outfile_vec;
+	std::string dercom;
+	std::string derfile;
 	std::vector<std::string> obs_name_vec;
 	std::vector<std::string> par_name_vec;
+	std::vector<double> base_par_vec;
+	int base_par_group_id;
+	//set when the master offers the compressed result format during the handshake
+	bool use_payload_codec;
+	std::vector<double> base_obs_vec;
+	int base_obs_group_id;
 
 	ModelInterface mi;
 	void run_async(pest_utils::thread_flag* terminate, pest_utils::thread_flag* finished,
@@ -0,0 +1,208 @@
+#include <cstring>
+#include "pest_error.h"
+#include "network_wrapper.h"
+#include "Serialization.h"
+#include "PayloadCodec.h"
+
+using namespace std;
+
+const string PayloadCodec::handshake = "payload_codec_1";
+
+void PayloadCodec::put_varint(vector<int8_t> &out, uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		out.push_back(int8_t((value & 0x7f) | 0x80));
+		value >>= 7;
+	}
+	out.push_back(int8_t(value));
+}
+
+uint64_t PayloadCodec::get_varint(const vector<int8_t> &data, size_t &loc, size_t end_loc)
+{
+	uint64_t value = 0;
+	for (int shift = 0; shift < 64; shift += 7)
+	{
+		if (loc >= end_loc)
+			throw PestError("PayloadCodec: corrupt data, truncated length");
+		uint8_t b = uint8_t(data[loc++]);
+		value |= uint64_t(b & 0x7f) << shift;
+		if ((b & 0x80) == 0)
+			return value;
+	}
+	throw PestError("PayloadCodec: corrupt data, invalid length");
+}
+
+vector<int8_t> PayloadCodec::encode(const vector<double> &vals, const vector<double> *ref)
+{
+	size_t n = vals.size();
+	bool use_ref = (ref) && (ref->size() == n);
+	size_t total = n * sizeof(double);
+	//shuffle so that byte b of every value is stored in lane b
+	vector<uint8_t> shuffled(total);
+	for (size_t i = 0; i < n; ++i)
+	{
+		uint64_t w;
+		memcpy(&w, &vals[i], sizeof(w));
+		if (use_ref)
+		{
+			uint64_t r;
+			memcpy(&r, &(*ref)[i], sizeof(r));
+			w ^= r;
+		}
+		for (size_t b = 0; b < sizeof(w); ++b)
+			shuffled[b * n + i] = uint8_t(w >> (8 * b));
+	}
+
+	vector<int8_t> out;
+	out.reserve(total / 4 + 16);
+	out.push_back(int8_t((use_ref ? XOR_REF : 0) | RLE));
+	//tokens: literal length, literal bytes, run length, run byte (if run length > 0)
+	size_t i = 0;
+	size_t lit_start = 0;
+	bool compressible = true;
+	while (i < total)
+	{
+		size_t j = i + 1;
+		while (j < total && shuffled[j] == shuffled[i])
+			++j;
+		if (j - i >= min_run)
+		{
+			put_varint(out, i - lit_start);
+			out.insert(out.end(), shuffled.begin() + lit_start, shuffled.begin() + i);
+			put_varint(out, j - i);
+			out.push_back(int8_t(shuffled[i]));
+			lit_start = j;
+			if (out.size() > total)
+			{
+				compressible = false;
+				break;
+			}
+		}
+		i = j;
+	}
+	if (compressible)
+	{
+		put_varint(out, total - lit_start);
+		out.insert(out.end(), shuffled.begin() + lit_start, shuffled.end());
+		put_varint(out, 0);
+	}
+	if ((!compressible) || (out.size() > total + 1))
+	{
+		//incompressible, store the shuffled bytes as they are
+		out.assign(1, int8_t(use_ref ? XOR_REF : 0));
+		out.insert(out.end(), shuffled.begin(), shuffled.end());
+	}
+	return out;
+}
+
+void PayloadCodec::decode(const vector<int8_t> &data, size_t start_loc, size_t data_len, size_t n_vals,
+	vector<double> &vals, const vector<double> *ref)
+{
+	size_t end_loc = start_loc + data_len;
+	if (data_len < 1 || end_loc > data.size())
+		throw PestError("PayloadCodec::decode: corrupt data, block exceeds package size");
+	int8_t flags = data[start_loc];
+	size_t loc = start_loc + 1;
+	size_t total = n_vals * sizeof(double);
+	vector<uint8_t> shuffled(total);
+	if (flags & RLE)
+	{
+		size_t i_out = 0;
+		while (i_out < total)
+		{
+			uint64_t lit_len = get_varint(data, loc, end_loc);
+			if (lit_len > total - i_out || lit_len > end_loc - loc)
+				throw PestError("PayloadCodec::decode: corrupt data, literal exceeds block size");
+			memcpy(shuffled.data() + i_out, data.data() + loc, lit_len);
+			loc += lit_len;
+			i_out += lit_len;
+			uint64_t run_len = get_varint(data, loc, end_loc);
+			if (run_len == 0)
+				continue;
+			if (run_len > total - i_out || loc >= end_loc)
+				throw PestError("PayloadCodec::decode: corrupt data, run exceeds block size");
+			memset(shuffled.data() + i_out, uint8_t(data[loc++]), run_len);
+			i_out += run_len;
+		}
+	}
+	else
+	{
+		if (end_loc - loc != total)
+			throw PestError("PayloadCodec::decode: corrupt data, unexpected block size");
+		memcpy(shuffled.data(), data.data() + loc, total);
+	}
+	if ((flags & XOR_REF) && ((!ref) || (ref->size() != n_vals)))
+		throw PestError("PayloadCodec::decode: data was coded against reference values that are not available");
+
+	vals.resize(n_vals);
+	for (size_t i = 0; i < n_vals; ++i)
+	{
+		uint64_t w = 0;
+		for (size_t b = 0; b < sizeof(w); ++b)
+			w |= uint64_t(shuffled[b * n_vals + i]) << (8 * b);
+		if (flags & XOR_REF)
+		{
+			uint64_t r;
+			memcpy(&r, &(*ref)[i], sizeof(r));
+			w ^= r;
+		}
+		memcpy(&vals[i], &w, sizeof(w));
+	}
+}
+
+vector<int8_t> PayloadCodec::pack_results(const vector<double> &sent_pars, const vector<double> &run_pars,
+	const vector<double> &obs_vals, double run_time, const vector<double> *base_obs)
+{
+	if (sent_pars.size() != run_pars.size())
+		throw PestError("PayloadCodec::pack_results: number of parameter values does not match");
+	vector<int> par_idx;
+	vector<double> par_vals;
+	for (size_t i = 0; i < run_pars.size(); ++i)
+	{
+		if (memcmp(&sent_pars[i], &run_pars[i], sizeof(double)) != 0)
+		{
+			par_idx.push_back(i);
+			par_vals.push_back(run_pars[i]);
+		}
+	}
+	bool use_ref = (base_obs) && (base_obs->size() == obs_vals.size());
+	vector<int8_t> obs_block = encode(obs_vals, use_ref ? base_obs : nullptr);
+	vector<int8_t> par_block = Serialization::serialize(par_idx, par_vals);
+
+	vector<int8_t> out;
+	out.reserve(1 + sizeof(run_time) + par_block.size() + sizeof(int64_t) + obs_block.size());
+	out.push_back(int8_t(use_ref ? XOR_REF : 0));
+	const int8_t *rt = reinterpret_cast<const int8_t*>(&run_time);
+	out.insert(out.end(), rt, rt + sizeof(run_time));
+	out.insert(out.end(), par_block.begin(), par_block.end());
+	int64_t obs_block_len = obs_block.size();
+	const int8_t *len = reinterpret_cast<const int8_t*>(&obs_block_len);
+	out.insert(out.end(), len, len + sizeof(obs_block_len));
+	out.insert(out.end(), obs_block.begin(), obs_block.end());
+	return out;
+}
+
+void PayloadCodec::unpack_results(const vector<int8_t> &data, size_t n_obs, vector<int> &par_idx,
+	vector<double> &par_vals, vector<double> &obs_vals, double &run_time, const vector<double> *base_obs)
+{
+	size_t loc = 1;
+	if (data.size() < loc + sizeof(run_time))
+		throw PestError("PayloadCodec::unpack_results: corrupt data, package too small");
+	w_memcpy_s(&run_time, sizeof(run_time), data.data() + loc, sizeof(run_time));
+	loc += sizeof(run_time);
+	loc += Serialization::unserialize(data, par_idx, par_vals, loc);
+	int64_t obs_block_len;
+	if (data.size() < loc + sizeof(obs_block_len))
+		throw PestError("PayloadCodec::unpack_results: corrupt data, package too small");
+	w_memcpy_s(&obs_block_len, sizeof(obs_block_len), data.data() + loc, sizeof(obs_block_len));
+	loc += sizeof(obs_block_len);
+	if (obs_block_len < 0 || loc + obs_block_len != data.size())
+		throw PestError("PayloadCodec::unpack_results: corrupt data, unexpected observation block size");
+	decode(data, loc, obs_block_len, n_obs, obs_vals, base_obs);
+}
+
+bool PayloadCodec::uses_base_obs(const vector<int8_t> &data)
+{
+	return (data.size() > 0) && (data[0] & XOR_REF);
+}
@@ -0,0 +1,44 @@
+#ifndef PAYLOAD_CODEC_H_
+#define PAYLOAD_CODEC_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Lossless packing of the model run results exchanged between the PANTHER
+// master and slaves.  Observation values can be xor'ed against a reference
+// vector that both ends hold (the base observations of the run group), then
+// their bytes are shuffled so the sign/exponent bytes of all values are
+// adjacent and finally run-length coded.  Only the parameters that the model
+// interface changed (roundoff in the template files) are returned; the master
+// already has the values it sent.  The codec is negotiated during the slave
+// handshake, so either end can be an older version.
+
+class PayloadCodec
+{
+public:
+	//description string exchanged with REQ_LINPACK/LINPACK to negotiate the codec
+	static const std::string handshake;
+
+	//byte-shuffled run-length coding of vals, xor'ed against ref when ref is not null
+	static std::vector<int8_t> encode(const std::vector<double> &vals, const std::vector<double> *ref = nullptr);
+	static void decode(const std::vector<int8_t> &data, size_t start_loc, size_t data_len, size_t n_vals,
+		std::vector<double> &vals, const std::vector<double> *ref = nullptr);
+
+	//results of a run.  sent_pars are the values received from the master, run_pars the values used by the model
+	static std::vector<int8_t> pack_results(const std::vector<double> &sent_pars, const std::vector<double> &run_pars,
+		const std::vector<double> &obs_vals, double run_time, const std::vector<double> *base_obs = nullptr);
+	//par_idx and par_vals are the parameters that differ from those sent with the run
+	static void unpack_results(const std::vector<int8_t> &data, size_t n_obs, std::vector<int> &par_idx,
+		std::vector<double> &par_vals, std::vector<double> &obs_vals, double &run_time, const std::vector<double> *base_obs = nullptr);
+	//true when the packed results were coded against the base observations
+	static bool uses_base_obs(const std::vector<int8_t> &data);
+private:
+	enum Flags : int8_t { XOR_REF = 1, RLE = 2 };
+	//runs shorter than this are cheaper to store as literals
+	static const size_t min_run = 4;
+	static void put_varint(std::vector<int8_t> &out, uint64_t value);
+	static uint64_t get_varint(const std::vector<int8_t> &data, size_t &loc, size_t end_loc);
+};
+
+#endif /* PAYLOAD_CODEC_H_ */
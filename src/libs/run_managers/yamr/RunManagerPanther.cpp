@@ -39,6 +39,7 @@
 #include "Transformable.h"
 #include "utilities.h"
 #include "Serialization.h"
+#include "PayloadCodec.h"
 
 
 using namespace std;
@@ -57,12 +58,22 @@ SlaveInfoRec::SlaveInfoRec(int _socket_fd)
 	name_info_vec = w_getnameinfo_vec(_socket_fd);
 	run_id = UNKNOWN_ID;
 	group_id = UNKNOWN_ID;
+	base_par_group_id = UNKNOWN_ID;
+	base_obs_group_id = UNKNOWN_ID;
+	payload_codec = false;
+	run_delta = false;
 	state = SlaveInfoRec::State::NEW;
 	work_dir = "";
 	linpack_time = std::chrono::hours(-500);
 	run_time = std::chrono::hours(-500);
 	start_time = std::chrono::system_clock::now();
 	last_ping_time = std::chrono::system_clock::now();
+	state_time = start_time;
+	busy_time = std::chrono::system_clock::duration::zero();
+	idle_time = std::chrono::system_clock::duration::zero();
+	n_runs_completed = 0;
+	n_runs_failed = 0;
+	n_runs_killed = 0;
 	ping = false;
 	failed_pings = 0;
 }
@@ -138,11 +149,13 @@ void SlaveInfoRec::set_state(const State &_state)
 	{
 		throw PestError("SlaveInfo::set_state: run_id and group_id must be supplied when state it set to active");
 	}
+	accumulate_state_time();
 	state = _state;
 }
 
 void SlaveInfoRec::set_state(const State &_state, int _run_id, int _group_id)
 {
+	accumulate_state_time();
 	state = _state;
 	run_id = _run_id;
 	group_id = _group_id;
@@ -256,13 +269,69 @@ int SlaveInfoRec::seconds_since_last_ping_time() const
 		(chrono::system_clock::now() - last_ping_time).count();
 }
 
+bool SlaveInfoRec::is_busy_state(const State &_state)
+{
+	return (_state == State::ACTIVE || _state == State::KILLED || _state == State::KILLED_FAILED);
+}
+
+bool SlaveInfoRec::is_idle_state(const State &_state)
+{
+	return (_state == State::WAITING || _state == State::COMPLETE);
+}
+
+void SlaveInfoRec::accumulate_state_time()
+{
+	chrono::system_clock::time_point now = chrono::system_clock::now();
+	if (is_busy_state(state))
+		busy_time += now - state_time;
+	else if (is_idle_state(state))
+		idle_time += now - state_time;
+	state_time = now;
+}
+
+double SlaveInfoRec::get_busy_sec() const
+{
+	chrono::system_clock::duration dt = busy_time;
+	if (is_busy_state(state))
+		dt += chrono::system_clock::now() - state_time;
+	return chrono::duration<double>(dt).count();
+}
+
+double SlaveInfoRec::get_idle_sec() const
+{
+	chrono::system_clock::duration dt = idle_time;
+	if (is_idle_state(state))
+		dt += chrono::system_clock::now() - state_time;
+	return chrono::duration<double>(dt).count();
+}
+
+string SlaveInfoRec::get_state_name(const State &_state)
+{
+	switch (_state)
+	{
+	case State::NEW: return "new";
+	case State::CWD_REQ: return "cwd_req";
+	case State::CWD_RCV: return "cwd_rcv";
+	case State::NAMES_SENT: return "names_sent";
+	case State::LINPACK_REQ: return "linpack_req";
+	case State::LINPACK_RCV: return "linpack_rcv";
+	case State::WAITING: return "waiting";
+	case State::ACTIVE: return "active";
+	case State::KILLED: return "killed";
+	case State::KILLED_FAILED: return "killed_failed";
+	case State::COMPLETE: return "complete";
+	}
+	return "unknown";
+}
+
 
 RunManagerPanther::RunManagerPanther(const string &stor_filename, const string &_port, ofstream &_f_rmr, int _max_n_failure,
 	double _overdue_reched_fac, double _overdue_giveup_fac, double _overdue_giveup_minutes)
 	: RunManagerAbstract(vector<string>(), vector<string>(), vector<string>(),
 	vector<string>(), vector<string>(), stor_filename, _max_n_failure),
 	overdue_reched_fac(_overdue_reched_fac), overdue_giveup_fac(_overdue_giveup_fac),
-	port(_port), f_rmr(_f_rmr), n_no_ops(0), overdue_giveup_minutes(_overdue_giveup_minutes)
+	port(_port), f_rmr(_f_rmr), n_no_ops(0), overdue_giveup_minutes(_overdue_giveup_minutes),
+	run_until_pending(false), metrics_listener(-1), base_obs_group_id(-1)
 {
 	max_concurrent_runs = max(MAX_CONCURRENT_RUNS_LOWER_LIMIT, _max_n_failure);
 	w_init();
@@ -332,6 +401,12 @@ list<SlaveInfoRec>::iterator RunManagerPanther::get_active_run_iter(int socket)
 }
 
 
+void RunManagerPanther::initialize(const std::vector<std::string> &model_par_names, std::vector<std::string> &obs_names, const string &_filename)
+{
+	RunManagerAbstract::initialize(model_par_names, obs_names, _filename);
+	cur_group_id = NetPackage::get_new_group_id();
+}
+
 void RunManagerPanther::initialize(const Parameters &model_pars, const Observations &obs, const string &_filename)
 {
 	RunManagerAbstract::initialize(model_pars, obs, _filename);
@@ -342,6 +417,7 @@ void RunManagerPanther::initialize_restart(const std::string &_filename)
 {
 	file_stor.init_restart(_filename);
 	free_memory();
+	restore_derivative_tracking();
 	vector<int> waiting_run_id_vec = get_outstanding_run_ids();
 	for (int &id : waiting_run_id_vec)
 	{
@@ -349,6 +425,12 @@ void RunManagerPanther::initialize_restart(const std::string &_filename)
 	}
 }
 
+string RunManagerPanther::get_local_derivatives_filename() const
+{
+	// the derivatives files sent by the workers are written next to the run storage file
+	return file_stor.get_filename() + "." + pest_utils::get_filename(derfile);
+}
+
 void RunManagerPanther::reinitialize(const std::string &_filename)
 {
 	free_memory();
@@ -356,32 +438,82 @@ void RunManagerPanther::reinitialize(const std::string &_filename)
 	cur_group_id = NetPackage::get_new_group_id();
 }
 
+void RunManagerPanther::reinitialize_delta(const Parameters &base_model_pars, int max_n_delta, const std::string &_filename)
+{
+	free_memory();
+	RunManagerAbstract::reinitialize_delta(base_model_pars, max_n_delta, _filename);
+	cur_group_id = NetPackage::get_new_group_id();
+}
+
+void RunManagerPanther::end_pending_runs()
+{
+	// runs made by run_until() calls that returned early are counted and any runs still
+	// active are killed before the run set is discarded
+	if (run_until_pending)
+	{
+		total_runs += model_runs_done;
+		kill_all_active_runs();
+		write_metrics(true);
+		run_until_pending = false;
+	}
+}
+
 void  RunManagerPanther::free_memory()
 {
+	end_pending_runs();
 	waiting_runs.clear();
 	model_runs_done = 0;
 	failure_map.clear();
 	active_runid_to_iterset_map.clear();
+	run_enqueue_time_map.clear();
+	run_until_pending = false;
+}
+
+void RunManagerPanther::add_waiting_run(int run_id)
+{
+	waiting_runs.push_back(run_id);
+	if (metrics.get_enabled())
+		run_enqueue_time_map[run_id] = chrono::system_clock::now();
 }
 
 int RunManagerPanther::add_run(const Parameters &model_pars, const string &info_txt, double info_value)
 {
 	int run_id = file_stor.add_run(model_pars, info_txt, info_value);
-	waiting_runs.push_back(run_id);
+	add_waiting_run(run_id);
 	return run_id;
 }
 
 int RunManagerPanther::add_run(const std::vector<double> &model_pars, const string &info_txt, double info_value)
 {
 	int run_id = file_stor.add_run(model_pars, info_txt, info_value);
-	waiting_runs.push_back(run_id);
+	add_waiting_run(run_id);
 	return run_id;
 }
 
 int RunManagerPanther::add_run(const Eigen::VectorXd &model_pars, const string &info_txt, double info_value)
 {
 	int run_id = file_stor.add_run(model_pars, info_txt, info_value);
-	waiting_runs.push_back(run_id);
+	add_waiting_run(run_id);
+	return run_id;
+}
+
+int RunManagerPanther::add_run_delta(const Parameters &delta_model_pars, const string &info_txt, double info_value)
+{
+	int run_id = file_stor.add_run_delta(delta_model_pars, info_txt, info_value);
+	add_waiting_run(run_id);
+	return run_id;
+}
+
+int RunManagerPanther::replace_run(int run_id, const Parameters &model_pars, const string &info_txt, double info_value)
+{
+	// a concurrent instance of the old run that is being killed can still return results for run_id
+	if (active_runid_to_iterset_map.count(run_id) > 0)
+	{
+		return add_run(model_pars, info_txt, info_value);
+	}
+	RunManagerAbstract::replace_run(run_id, model_pars, info_txt, info_value);
+	failure_map.erase(run_id);
+	add_waiting_run(run_id);
 	return run_id;
 }
 
@@ -416,34 +548,40 @@ RunManagerAbstract::RUN_UNTIL_COND RunManagerPanther::run_until(RUN_UNTIL_COND c
 	stringstream message;
 	NetPackage net_pack;
 
-	model_runs_done = 0;
-	model_runs_failed = 0;
-	model_runs_timed_out = 0;
-	failure_map.clear();
-	active_runid_to_iterset_map.clear();
-	int num_runs = waiting_runs.size();
-	cout << "    running model " << num_runs << " times" << endl;
-	f_rmr << "running model " << num_runs << " times" << endl;
-	if (slave_info_set.size() == 0) // first entry is the listener, slave apears after this
-	{
-		cout << endl << "      waiting for slaves to appear..." << endl << endl;
-		f_rmr << endl << "    waiting for slaves to appear..." << endl << endl;
-	}
-	else
+	// when polling incrementally (NO_OPS or TIME), runs are still in flight from the
+	// previous call so the run counters, failure history and active runs are kept
+	if (!run_until_pending)
 	{
-		for (auto &si : slave_info_set)
-			si.reset_runtime();
-	}
-	cout << endl;
-	f_rmr << endl;
+		model_runs_done = 0;
+		model_runs_failed = 0;
+		model_runs_timed_out = 0;
+		failure_map.clear();
+		active_runid_to_iterset_map.clear();
+		int num_runs = waiting_runs.size();
+		cout << "    running model " << num_runs << " times" << endl;
+		f_rmr << "running model " << num_runs << " times" << endl;
+		if (slave_info_set.size() == 0) // first entry is the listener, slave apears after this
+		{
+			cout << endl << "      waiting for slaves to appear..." << endl << endl;
+			f_rmr << endl << "    waiting for slaves to appear..." << endl << endl;
+		}
+		else
+		{
+			for (auto &si : slave_info_set)
+				si.reset_runtime();
+		}
+		cout << endl;
+		f_rmr << endl;
 
-	cout << "PANTHER progress" << endl;
-	cout << "   runs(C = completed | F = failed | T = timed out)" << endl;
-	cout << "   slaves(R = running | W = waiting | U = unavailable)" << endl;
-	cout << "------------------------------------------------------------------------------" << endl;
+		cout << "PANTHER progress" << endl;
+		cout << "   runs(C = completed | F = failed | T = timed out)" << endl;
+		cout << "   slaves(R = running | W = waiting | U = unavailable)" << endl;
+		cout << "------------------------------------------------------------------------------" << endl;
+	}
 
 	std::chrono::system_clock::time_point start_time = std::chrono::system_clock::now();
 	double run_time_sec = 0.0;
+	int n_runs_returned = model_runs_done + model_runs_failed + model_runs_timed_out;
 	while (!all_runs_complete() && terminate_reason == RUN_UNTIL_COND::NORMAL)
 	{
 		echo();
@@ -464,6 +602,7 @@ RunManagerAbstract::RUN_UNTIL_COND RunManagerPanther::run_until(RUN_UNTIL_COND c
 		{
 			n_no_ops = 0;
 		}
+		write_metrics(false);
 
 		if ((condition == RUN_UNTIL_COND::NO_OPS || condition == RUN_UNTIL_COND::NO_OPS_OR_TIME) && n_no_ops >= max_no_ops)
 		{
@@ -475,7 +614,13 @@ RunManagerAbstract::RUN_UNTIL_COND RunManagerPanther::run_until(RUN_UNTIL_COND c
 			terminate_reason = RUN_UNTIL_COND::TIME;
 		}
 
+		if (condition == RUN_UNTIL_COND::RUN_RETURNED && model_runs_done + model_runs_failed + model_runs_timed_out > n_runs_returned)
+		{
+			terminate_reason = RUN_UNTIL_COND::RUN_RETURNED;
+		}
+
 	}
+	run_until_pending = (terminate_reason != RUN_UNTIL_COND::NORMAL);
 	if (terminate_reason == RUN_UNTIL_COND::NORMAL)
 	{
 		echo();
@@ -483,6 +628,7 @@ RunManagerAbstract::RUN_UNTIL_COND RunManagerPanther::run_until(RUN_UNTIL_COND c
 		//kill any remaining active runs
 		kill_all_active_runs();
 		echo();
+		write_metrics(true);
 		cout << endl << endl;
 		message.str("");
 		message << "   " << model_runs_done << " runs complete :  " << get_num_failed_runs() << " runs failed";
@@ -602,7 +748,11 @@ bool RunManagerPanther::listen()
 	for(int i = 0; i <= fdmax; i++) {
 		if (FD_ISSET(i, &read_fds)) { // we got one!!
 			got_message = true;
-			if (i == listener)  // handle new connections
+			if (i == metrics_listener)
+			{
+				serve_metrics();
+			}
+			else if (i == listener)  // handle new connections
 			{
 				int newfd;
 				addr_len = sizeof remote_addr;
@@ -659,6 +809,11 @@ void RunManagerPanther::close_slave(list<SlaveInfoRec>::iterator slave_info_iter
 	SlaveInfoRec::State state = slave_info_iter->get_state();
 
 	string socket_name = slave_info_iter->get_socket_name();
+	if (metrics.get_enabled())
+	{
+		metrics.count("slaves_closed");
+		metrics.add_closed_worker(get_worker_snapshot(*slave_info_iter));
+	}
 	w_close(i_sock); // bye!
 	FD_CLR(i_sock, &master); // remove from master set
 	// remove run from active_runid_to_iterset_map
@@ -861,10 +1016,46 @@ int RunManagerPanther::schedule_run(int run_id, std::list<list<SlaveInfoRec>::it
 	if (it_slave != free_slave_list.end())
 	{
 		int socket_fd = (*it_slave)->get_socket_fd();
-		vector<char> data = file_stor.get_serial_pars(run_id);
 		string host_name = (*it_slave)->get_hostname();
-		NetPackage net_pack(NetPackage::PackType::START_RUN, cur_group_id, run_id, "");
-		int err = net_pack.send(socket_fd, &data[0], data.size());
+		int err = 1;
+		vector<char> data;
+		string run_desc = (derivative_run_ids.find(run_id) != derivative_run_ids.end()) ? NetPackage::derivatives_desc : "";
+		NetPackage net_pack(NetPackage::PackType::START_RUN, cur_group_id, run_id, run_desc);
+		if (file_stor.is_delta() && (*it_slave)->get_run_delta())
+		{
+			// send the base parameters once per group, then only the parameters that differ from them
+			if ((*it_slave)->get_base_par_group_id() != cur_group_id)
+			{
+				const vector<double> &base_pars = file_stor.get_base_par_vec();
+				NetPackage base_pack(NetPackage::PackType::BASE_PARS, cur_group_id, 0, "");
+				err = base_pack.send(socket_fd, base_pars.data(), base_pars.size() * sizeof(double));
+				if (err > 0)
+				{
+					(*it_slave)->set_base_par_group_id(cur_group_id);
+				}
+			}
+			data = file_stor.get_serial_par_delta(run_id);
+			net_pack.reset(NetPackage::PackType::START_RUN_DELTA, cur_group_id, run_id, run_desc);
+		}
+		else
+		{
+			// slaves without the run delta capability receive the full parameter vector
+			data = file_stor.get_serial_pars(run_id);
+		}
+		if ((err > 0) && (*it_slave)->get_payload_codec() && (base_obs_group_id == cur_group_id)
+			&& ((*it_slave)->get_base_obs_group_id() != cur_group_id))
+		{
+			NetPackage base_pack(NetPackage::PackType::BASE_OBS, cur_group_id, 0, "");
+			err = base_pack.send(socket_fd, base_obs_packed.data(), base_obs_packed.size());
+			if (err > 0)
+			{
+				(*it_slave)->set_base_obs_group_id(cur_group_id);
+			}
+		}
+		if (err > 0)
+		{
+			err = net_pack.send(socket_fd, &data[0], data.size());
+		}
 		if (err > 0)
 		{
 			(*it_slave)->set_state(SlaveInfoRec::State::ACTIVE, run_id, cur_group_id);
@@ -873,6 +1064,16 @@ int RunManagerPanther::schedule_run(int run_id, std::list<list<SlaveInfoRec>::it
 			//reset the last ping time so we don't ping immediately after run is started
 			(*it_slave)->reset_last_ping_time();
 			active_runid_to_iterset_map.insert(make_pair(run_id, *it_slave));
+			if (metrics.get_enabled())
+			{
+				metrics.count((n_concurrent > 0) ? "runs_rescheduled" : "runs_dispatched");
+				auto it_enqueue = run_enqueue_time_map.find(run_id);
+				if (it_enqueue != run_enqueue_time_map.end())
+				{
+					metrics.add_queue_wait(get_duration_sec(it_enqueue->second));
+					run_enqueue_time_map.erase(it_enqueue);
+				}
+			}
 			stringstream ss;
 			ss << "Sending run " << run_id << " to: " << host_name << "$" << (*it_slave)->get_work_dir() <<
 				"  (group id:" << cur_group_id << ", run id:" << run_id << ", concurrent runs:" << get_n_concurrent(run_id) << ")";
@@ -981,6 +1182,8 @@ void RunManagerPanther::process_message(int i_sock)
 	else if (net_pack.get_type() == NetPackage::PackType::LINPACK)
 	{
 		slave_info_iter->end_linpack();
+		slave_info_iter->set_payload_codec(NetPackage::has_capability(net_pack.get_desc(), PayloadCodec::handshake));
+		slave_info_iter->set_run_delta(NetPackage::has_capability(net_pack.get_desc(), NetPackage::run_delta_capability));
 		slave_info_iter->set_state(SlaveInfoRec::State::LINPACK_RCV);
 		stringstream ss;
 		ss << "new slave ready: " << socket_name;
@@ -993,6 +1196,8 @@ void RunManagerPanther::process_message(int i_sock)
 	}
 
 	else if ( (net_pack.get_type() == NetPackage::PackType::RUN_FINISHED
+		|| net_pack.get_type() == NetPackage::PackType::RUN_FINISHED_DELTA
+		|| net_pack.get_type() == NetPackage::PackType::RUN_FINISHED_PACKED
 		|| net_pack.get_type() == NetPackage::PackType::RUN_FAILED
 		|| net_pack.get_type() == NetPackage::PackType::RUN_KILLED)
 			&& net_pack.get_group_id() != cur_group_id)
@@ -1005,7 +1210,9 @@ void RunManagerPanther::process_message(int i_sock)
 		//ss << "run " << run_id << " received from unexpected group id: " << group_id << ", should be group: " << cur_group_id;
 		//throw PestError(ss.str());
 	}
-	else if (net_pack.get_type() == NetPackage::PackType::RUN_FINISHED)
+	else if (net_pack.get_type() == NetPackage::PackType::RUN_FINISHED
+		|| net_pack.get_type() == NetPackage::PackType::RUN_FINISHED_DELTA
+		|| net_pack.get_type() == NetPackage::PackType::RUN_FINISHED_PACKED)
 	{
 		int run_id = net_pack.get_run_id();
 		int group_id = net_pack.get_group_id();
@@ -1022,6 +1229,8 @@ void RunManagerPanther::process_message(int i_sock)
 		else
 		{
 			// keep track of model run time
+			if (metrics.get_enabled())
+				metrics.add_run_time(slave_info_iter->get_duration_sec());
 			slave_info_iter->end_run();
 			stringstream ss;
 			ss << "run " << run_id << " received from: " << host_name << "$" << slave_info_iter->get_work_dir() <<
@@ -1046,6 +1255,9 @@ void RunManagerPanther::process_message(int i_sock)
 			ss << "Run " << run_id << " failed on slave:" << host_name << "$" << slave_info_iter->get_work_dir() << "  (group id: " << group_id << ", run id: " << run_id << ", concurrent: " << n_concur << ") ";
 			report(ss.str(), false);
 			model_runs_failed++;
+			slave_info_iter->add_run_failed();
+			if (metrics.get_enabled())
+				metrics.count("runs_failed");
 			update_run_failed(run_id, i_sock);
 			auto it = get_active_run_iter(i_sock);
 			unschedule_run(it);
@@ -1074,6 +1286,23 @@ void RunManagerPanther::process_message(int i_sock)
 		report("ping received from slave" + host_name + "$" + slave_info_iter->get_work_dir(), false);
 #endif
 	}
+	else if (net_pack.get_type() == NetPackage::PackType::DERIVATIVES)
+	{
+		// external derivatives file written by the derivatives command, sent ahead of the run results
+		int run_id = net_pack.get_run_id();
+		if (net_pack.get_group_id() == cur_group_id)
+		{
+			string filename = get_local_derivatives_filename();
+			ofstream fout(filename, ios::binary);
+			const vector<int8_t> &der_data = net_pack.get_data();
+			fout.write(reinterpret_cast<const char*>(der_data.data()), der_data.size());
+			fout.close();
+			derivative_file_map[run_id] = filename;
+			stringstream ss;
+			ss << "derivatives for run " << run_id << " received from: " << host_name << "$" << slave_info_iter->get_work_dir();
+			report(ss.str(), false);
+		}
+	}
 	else if (net_pack.get_type() == NetPackage::PackType::IO_ERROR)
 	{
 		//string err(net_pack.get_data().begin(),net_pack.get_data().end());
@@ -1097,12 +1326,68 @@ bool RunManagerPanther::process_model_run(int sock_id, NetPackage &net_pack)
 	//check if another instance of this model run has already completed
 	if (!run_finished(run_id))
 	{
-		Parameters pars;
-		Observations obs;
-		double run_time = 0;
-		Serialization::unserialize(net_pack.get_data(), pars, get_par_name_vec(), obs, get_obs_name_vec(), run_time);
-		file_stor.update_run(run_id, pars, obs);
+		if (net_pack.get_type() == NetPackage::PackType::RUN_FINISHED_DELTA)
+		{
+			// parameters changed by the model interface followed by the observation values and the run time
+			vector<int> par_idx;
+			vector<double> par_vals;
+			const vector<int8_t> &data = net_pack.get_data();
+			unsigned long bytes_read = Serialization::unserialize(data, par_idx, par_vals);
+			size_t nobs = get_obs_name_vec().size();
+			vector<double> obs_vec(nobs);
+			if (data.size() < bytes_read + (nobs + 1) * sizeof(double))
+			{
+				throw PestError("RunManagerPanther::process_model_run: size of run results is different from what is expected");
+			}
+			w_memcpy_s(obs_vec.data(), nobs * sizeof(double), data.data() + bytes_read, nobs * sizeof(double));
+			size_t npar = get_par_name_vec().size();
+			vector<double> par_vec(npar);
+			vector<char> par_data = file_stor.get_serial_pars(run_id);
+			w_memcpy_s(par_vec.data(), npar * sizeof(double), par_data.data(), par_data.size());
+			for (size_t i = 0; i < par_idx.size(); ++i)
+			{
+				if ((par_idx[i] < 0) || (par_idx[i] >= npar))
+					throw PestError("RunManagerPanther::process_model_run: parameter index in run results is out of range");
+				par_vec[par_idx[i]] = par_vals[i];
+			}
+			// template roundoff of the base parameters is absorbed into the stored base vector
+			file_stor.update_run(run_id, par_vec, obs_vec);
+			set_base_obs(obs_vec);
+		}
+		else if (net_pack.get_type() == NetPackage::PackType::RUN_FINISHED_PACKED)
+		{
+			// parameters changed by the model interface and the coded observation values
+			vector<int> par_idx;
+			vector<double> par_vals;
+			vector<double> obs_vec;
+			double run_time = 0;
+			const vector<double> *base_obs = (base_obs_group_id == cur_group_id) ? &base_obs_vec : nullptr;
+			PayloadCodec::unpack_results(net_pack.get_data(), get_obs_name_vec().size(), par_idx, par_vals, obs_vec, run_time, base_obs);
+			size_t npar = get_par_name_vec().size();
+			vector<double> par_vec(npar);
+			vector<char> par_data = file_stor.get_serial_pars(run_id);
+			w_memcpy_s(par_vec.data(), npar * sizeof(double), par_data.data(), par_data.size());
+			for (size_t i = 0; i < par_idx.size(); ++i)
+			{
+				if ((par_idx[i] < 0) || (par_idx[i] >= npar))
+					throw PestError("RunManagerPanther::process_model_run: parameter index in run results is out of range");
+				par_vec[par_idx[i]] = par_vals[i];
+			}
+			file_stor.update_run(run_id, par_vec, obs_vec);
+			set_base_obs(obs_vec);
+		}
+		else
+		{
+			Parameters pars;
+			Observations obs;
+			double run_time = 0;
+			Serialization::unserialize(net_pack.get_data(), pars, get_par_name_vec(), obs, get_obs_name_vec(), run_time);
+			file_stor.update_run(run_id, pars, obs);
+			if (base_obs_group_id != cur_group_id)
+				set_base_obs(obs.get_data_vec(get_obs_name_vec()));
+		}
 		slave_info_iter->set_state(SlaveInfoRec::State::COMPLETE);
+		slave_info_iter->add_run_completed();
 		//slave_info_iter->set_state(SlaveInfoRec::State::WAITING);
 		use_run = true;
 		model_runs_done++;
@@ -1124,6 +1409,9 @@ void RunManagerPanther::kill_run(list<SlaveInfoRec>::iterator slave_info_iter, c
 	{
 		int run_id = slave_info_iter->get_run_id();
 		slave_info_iter->set_state(SlaveInfoRec::State::KILLED);
+		slave_info_iter->add_run_killed();
+		if (metrics.get_enabled())
+			metrics.count("kill_requests");
 		//schedule run to be killed
 		string host_name = slave_info_iter->get_hostname();
 		stringstream ss;
@@ -1229,7 +1517,9 @@ void RunManagerPanther::kill_all_active_runs()
 		}
 		else if (cur_state == SlaveInfoRec::State::NAMES_SENT)
 		{
-			NetPackage net_pack(NetPackage::PackType::REQ_LINPACK, 0, 0, "");
+			// offer the optional message formats; the slave returns the ones it supports with LINPACK
+			string capabilities = PayloadCodec::handshake + " " + NetPackage::run_delta_capability;
+			NetPackage net_pack(NetPackage::PackType::REQ_LINPACK, 0, 0, capabilities);
 			char data = '\0';
 			int err = net_pack.send(i_sock, &data, sizeof(data));
 			if (err  > 0)
@@ -1268,6 +1558,23 @@ void RunManagerPanther::kill_all_active_runs()
 	 return sock_id_vec;
  }
 
+ bool RunManagerPanther::run_pending(int run_id)
+ {
+	 if (find(waiting_runs.begin(), waiting_runs.end(), run_id) != waiting_runs.end())
+	 {
+		 return true;
+	 }
+	 auto range_pair = active_runid_to_iterset_map.equal_range(run_id);
+	 for (auto it_active = range_pair.first; it_active != range_pair.second; ++it_active)
+	 {
+		 if (it_active->second->get_state() == SlaveInfoRec::State::ACTIVE)
+		 {
+			 return true;
+		 }
+	 }
+	 return false;
+ }
+
  bool RunManagerPanther::all_runs_complete()
  {
 	 // check for run in the waitng queue
@@ -1292,6 +1599,7 @@ void RunManagerPanther::kill_all_active_runs()
 	 stringstream ss;
 	 ss << "new connection from: " << w_getnameinfo_string(sock_id);
 	 report(ss.str(), false);
+	 w_set_nodelay(sock_id);
 	 FD_SET(sock_id, &master); // add to master set
 	 if (sock_id > fdmax) { // keep track of the max
 		 fdmax = sock_id;
@@ -1323,6 +1631,16 @@ void RunManagerPanther::kill_all_active_runs()
 	 return global_runtime / (double)count;
  }
 
+ void RunManagerPanther::set_base_obs(const vector<double> &obs_vec)
+ {
+	 // the first run completed in a group becomes the reference for the rest of the group
+	 if (base_obs_group_id == cur_group_id)
+		 return;
+	 base_obs_vec = obs_vec;
+	 base_obs_packed = PayloadCodec::encode(base_obs_vec);
+	 base_obs_group_id = cur_group_id;
+ }
+
  void RunManagerPanther::unschedule_run(list<SlaveInfoRec>::iterator slave_info_iter)
  {
 	 int run_id = slave_info_iter->get_run_id();
@@ -1422,10 +1740,137 @@ void RunManagerPanther::kill_all_active_runs()
 	 throw(PestError("Error: Unsuppoerted function call  RunManagerPANTHER::update_run_failed(int run_id)"  ));
  }
 
+void RunManagerPanther::set_metrics(const string &csv_filename, const string &json_filename, double interval_sec, int http_port)
+{
+	metrics.initialize(csv_filename, json_filename, interval_sec);
+	for (int run_id : waiting_runs)
+		run_enqueue_time_map[run_id] = chrono::system_clock::now();
+	if (http_port <= 0)
+		return;
+	struct addrinfo hints;
+	struct addrinfo *servinfo;
+	memset(&hints, 0, sizeof hints);
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+	string port_str = to_string(http_port);
+	//only bind the loopback interface, the endpoint is not meant to be reachable from other hosts
+	if (w_getaddrinfo("127.0.0.1", port_str.c_str(), &hints, &servinfo) != 0)
+		throw PestError("RunManagerPanther::set_metrics: unable to resolve 127.0.0.1:" + port_str);
+	addrinfo *connect_addr = w_bind_first_avl(servinfo, metrics_listener);
+	if (connect_addr == nullptr)
+	{
+		freeaddrinfo(servinfo);
+		throw PestError("RunManagerPanther::set_metrics: metrics port " + port_str + " is busy.  Can not bind port");
+	}
+	w_listen(metrics_listener, BACKLOG);
+	freeaddrinfo(servinfo);
+	FD_SET(metrics_listener, &master);
+	if (metrics_listener > fdmax)
+		fdmax = metrics_listener;
+	cout << "PANTHER master serving metrics on http://127.0.0.1:" << port_str << endl;
+	f_rmr << "PANTHER master serving metrics on http://127.0.0.1:" << port_str << endl;
+}
+
+void RunManagerPanther::write_metrics(bool force)
+{
+	if (!metrics.get_enabled())
+		return;
+	if ((!force) && (!metrics.snapshot_due()))
+		return;
+	metrics.write_snapshot(get_master_snapshot(), get_worker_snapshots());
+}
+
+void RunManagerPanther::serve_metrics()
+{
+	struct sockaddr_storage remote_addr;
+	socklen_t addr_len = sizeof remote_addr;
+	int sock = w_accept(metrics_listener, (struct sockaddr *)&remote_addr, &addr_len);
+	if (sock == -1)
+		return;
+	//the request itself is not interpreted, every request gets the current snapshot.
+	//wait briefly for it so the client does not see a reset connection
+	fd_set read_fds;
+	FD_ZERO(&read_fds);
+	FD_SET(sock, &read_fds);
+	timeval tv;
+	tv.tv_sec = 0;
+	tv.tv_usec = 200000;
+	if (w_select(sock + 1, &read_fds, NULL, NULL, &tv) > 0)
+	{
+		int8_t buf[4096];
+		w_recv(sock, buf, sizeof(buf), 0);
+	}
+	string body = metrics.to_json(get_master_snapshot(), get_worker_snapshots());
+	stringstream ss;
+	ss << "HTTP/1.0 200 OK\r\nContent-Type: application/json\r\nContent-Length: " << body.size()
+		<< "\r\nConnection: close\r\n\r\n" << body;
+	string response = ss.str();
+	int64_t len = response.size();
+	w_sendall(sock, (int8_t*)response.data(), &len);
+	w_close(sock);
+	metrics.count("http_requests");
+}
+
+PantherMetrics::MasterSnapshot RunManagerPanther::get_master_snapshot()
+{
+	PantherMetrics::MasterSnapshot snap;
+	map<string, int> stats_map = get_slave_stats();
+	snap.runs_waiting = waiting_runs.size();
+	snap.runs_active = 0;
+	for (auto &i : active_runid_to_iterset_map)
+	{
+		if (i.second->get_state() == SlaveInfoRec::State::ACTIVE)
+			++snap.runs_active;
+	}
+	snap.runs_completed = model_runs_done;
+	snap.runs_failed = model_runs_failed;
+	snap.runs_timed_out = model_runs_timed_out;
+	snap.unique_failures = get_n_unique_failures();
+	snap.workers_running = stats_map["run"];
+	snap.workers_waiting = stats_map["wait"];
+	snap.workers_unavailable = stats_map["unavailable"];
+	snap.avg_run_sec = get_global_runtime_minute() * 60.0;
+	snap.overdue_reched_fac = overdue_reched_fac;
+	snap.overdue_giveup_fac = overdue_giveup_fac;
+	snap.overdue_giveup_minutes = overdue_giveup_minutes;
+	return snap;
+}
+
+PantherMetrics::WorkerSnapshot RunManagerPanther::get_worker_snapshot(const SlaveInfoRec &slave_info)
+{
+	PantherMetrics::WorkerSnapshot snap;
+	SlaveInfoRec::State state = slave_info.get_state();
+	snap.name = slave_info.get_socket_name();
+	snap.work_dir = slave_info.get_work_dir();
+	snap.state = SlaveInfoRec::get_state_name(state);
+	snap.run_id = (state == SlaveInfoRec::State::ACTIVE) ? slave_info.get_run_id() : -1;
+	snap.busy_sec = slave_info.get_busy_sec();
+	snap.idle_sec = slave_info.get_idle_sec();
+	snap.current_run_sec = (state == SlaveInfoRec::State::ACTIVE) ? slave_info.get_duration_sec() : 0.0;
+	snap.avg_run_sec = max(0.0, slave_info.get_runtime_sec());
+	snap.runs_completed = slave_info.get_n_runs_completed();
+	snap.runs_failed = slave_info.get_n_runs_failed();
+	snap.runs_killed = slave_info.get_n_runs_killed();
+	return snap;
+}
+
+vector<PantherMetrics::WorkerSnapshot> RunManagerPanther::get_worker_snapshots()
+{
+	vector<PantherMetrics::WorkerSnapshot> snaps;
+	for (auto &si : slave_info_set)
+		snaps.push_back(get_worker_snapshot(si));
+	return snaps;
+}
+
 RunManagerPanther::~RunManagerPanther(void)
 {
 	//close sockets and cleanup
 	int err;
+	if (metrics_listener >= 0)
+	{
+		w_close(metrics_listener);
+		FD_CLR(metrics_listener, &master);
+	}
 	err = w_close(listener);
 	FD_CLR(listener, &master);
 	// this is needed to ensure that the first slave closes properly
@@ -29,6 +29,7 @@
 #include "network_package.h"
 #include "RunManagerAbstract.h"
 #include "RunStorage.h"
+#include "PantherMetrics.h"
 
 class SlaveInfoRec {
 public:
@@ -44,6 +45,14 @@ public:
 	void set_run_id(int _run_id);
 	int get_group_id() const;
 	void set_group_id(int _group_id);
+	int get_base_par_group_id() const { return base_par_group_id; }
+	void set_base_par_group_id(int _group_id) { base_par_group_id = _group_id; }
+	int get_base_obs_group_id() const { return base_obs_group_id; }
+	void set_base_obs_group_id(int _group_id) { base_obs_group_id = _group_id; }
+	bool get_payload_codec() const { return payload_codec; }
+	void set_payload_codec(bool _payload_codec) { payload_codec = _payload_codec; }
+	bool get_run_delta() const { return run_delta; }
+	void set_run_delta(bool _run_delta) { run_delta = _run_delta; }
 	State get_state() const;
 	void set_state(const State &_state);
 	void set_state(const State &_state, int run_id, int group_id);
@@ -66,11 +75,25 @@ public:
 	void reset_last_ping_time();
 	void reset_runtime() { run_time = std::chrono::system_clock::duration::zero(); }
 	int seconds_since_last_ping_time() const;
+	//time spent running (or killing) models and time spent waiting for work since the slave connected
+	double get_busy_sec() const;
+	double get_idle_sec() const;
+	void add_run_completed() { ++n_runs_completed; }
+	void add_run_failed() { ++n_runs_failed; }
+	void add_run_killed() { ++n_runs_killed; }
+	int get_n_runs_completed() const { return n_runs_completed; }
+	int get_n_runs_failed() const { return n_runs_failed; }
+	int get_n_runs_killed() const { return n_runs_killed; }
+	static std::string get_state_name(const State &_state);
 	~SlaveInfoRec(){}
 private:
 	int socket_fd;
 	int run_id;
 	int group_id;
+	int base_par_group_id;
+	int base_obs_group_id;
+	bool payload_codec;
+	bool run_delta;
 	bool ping;
 	int failed_pings;
 	State state;
@@ -78,8 +101,17 @@ private:
 	std::chrono::system_clock::duration run_time;
 	std::chrono::system_clock::time_point start_time;
 	std::chrono::system_clock::time_point last_ping_time;
+	std::chrono::system_clock::time_point state_time;
+	std::chrono::system_clock::duration busy_time;
+	std::chrono::system_clock::duration idle_time;
+	int n_runs_completed;
+	int n_runs_failed;
+	int n_runs_killed;
 	std::string work_dir;
 	std::vector<string> name_info_vec;
+	void accumulate_state_time();
+	static bool is_busy_state(const State &_state);
+	static bool is_idle_state(const State &_state);
 public:
 	class CompareTimes
 	{
@@ -94,19 +126,29 @@ class RunManagerPanther : public RunManagerAbstract
 public:
 	RunManagerPanther(const std::string &stor_filename, const std::string &port, std::ofstream &_f_rmr, int _max_n_failure,
 		double overdue_reched_fac, double overdue_giveup_fac, double overdue_giveup_minutes);
+	virtual void initialize(const std::vector<std::string> &model_par_names, std::vector<std::string> &obs_names, const std::string &_filename = std::string(""));
 	virtual void initialize(const Parameters &model_pars, const Observations &obs, const std::string &_filename = std::string(""));
 	virtual void initialize_restart(const std::string &_filename);
 	virtual void reinitialize(const std::string &_filename = std::string(""));
+	virtual void reinitialize_delta(const Parameters &base_model_pars, int max_n_delta, const std::string &_filename = std::string(""));
 	virtual void free_memory();
 	virtual int add_run(const Parameters &model_pars, const std::string &info_txt="", double info_value=RunStorage::no_data);
 	virtual int add_run(const std::vector<double> &model_pars, const std::string &info_txt="", double info_valuee=RunStorage::no_data);
 	virtual int add_run(const Eigen::VectorXd &model_pars, const std::string &info_txt="", double info_valuee=RunStorage::no_data);
+	virtual int add_run_delta(const Parameters &delta_model_pars, const std::string &info_txt = "", double info_value = RunStorage::no_data);
+	virtual int replace_run(int run_id, const Parameters &model_pars, const std::string &info_txt = "", double info_value = RunStorage::no_data);
 	virtual void update_run(int run_id, const Parameters &pars, const Observations &obs);
 	virtual void run();
+	virtual bool supports_derivatives() const { return true; }
 	virtual RunManagerAbstract::RUN_UNTIL_COND run_until(RUN_UNTIL_COND condition, int n_nops = 0, double sec = 0.0);
+	//includes the runs completed by run_until() calls that returned before the run set was complete
+	virtual int get_total_runs(void) const { return run_until_pending ? total_runs + model_runs_done : total_runs; }
 	~RunManagerPanther(void);
 	int get_n_waiting_runs() { return waiting_runs.size(); }
 	void close_slaves();
+	//write periodic csv/json snapshots of the queue and slaves; http_port > 0 also serves
+	//the json snapshot on 127.0.0.1:http_port
+	void set_metrics(const std::string &csv_filename, const std::string &json_filename, double interval_sec, int http_port = 0);
 
 
 
@@ -128,18 +170,28 @@ private:
 	int model_runs_done;
 	int model_runs_failed;
 	int model_runs_timed_out;
+	bool run_until_pending; // previous call to run_until() returned before all runs were complete
 	fd_set master; // master file descriptor list
 	list<SlaveInfoRec> slave_info_set;
 	map<int, list<SlaveInfoRec>::iterator> socket_to_iter_map;
 	multimap<int, list<SlaveInfoRec>::iterator> active_runid_to_iterset_map;
 	std::deque<int> waiting_runs;
 	std::unordered_multimap<int, int> failure_map;
+	PantherMetrics metrics;
+	int metrics_listener;
+	std::unordered_map<int, std::chrono::system_clock::time_point> run_enqueue_time_map;
+	//observations of the first run completed in the current group; slaves that negotiated
+	//the payload codec return their results coded against them
+	std::vector<double> base_obs_vec;
+	std::vector<int8_t> base_obs_packed;
+	int base_obs_group_id;
 
 	int schedule_run(int run_id, std::list<list<SlaveInfoRec>::iterator> &free_slave_list, int n_responsive_slaves);
 	void unschedule_run(list<SlaveInfoRec>::iterator slave_info_iter);
 	void kill_run(list<SlaveInfoRec>::iterator slave_info_iter, const std::string &reason="UNKNOWN");
 	void kill_runs(int run_id, bool update_failure_map, const std::string &reason = "UNKNOWN");
 	void kill_all_active_runs();
+	void end_pending_runs();
 	void close_slave(int i_sock);
 	void close_slave(list<SlaveInfoRec>::iterator slave_info_iter);
 
@@ -167,7 +219,16 @@ private:
 	int get_n_responsive_slaves();
 	virtual void update_run_failed(int run_id, int socket_fd);
 	virtual void update_run_failed(int run_id);
+	virtual bool run_pending(int run_id);
+	virtual std::string get_local_derivatives_filename() const;
 	map<string, int> get_slave_stats();
+	void add_waiting_run(int run_id);
+	void set_base_obs(const std::vector<double> &obs_vec);
+	void write_metrics(bool force);
+	void serve_metrics();
+	PantherMetrics::MasterSnapshot get_master_snapshot();
+	PantherMetrics::WorkerSnapshot get_worker_snapshot(const SlaveInfoRec &slave_info);
+	std::vector<PantherMetrics::WorkerSnapshot> get_worker_snapshots();
 };
 
 class RunManagerYAMRCondor : public RunManagerPanther
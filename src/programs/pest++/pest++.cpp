@@ -276,6 +276,7 @@ int main(int argc, char* argv[])
 			throw(e);
 	 	}
 		pest_scenario.check_inputs(fout_rec);
+		perf_trace::set_enabled(pest_scenario.get_pestpp_options().get_perf_trace());
 
 		//if base jco arg read from control file, reset restart controller
 		if (!pest_scenario.get_pestpp_options().get_basejac_filename().empty())
@@ -327,6 +328,13 @@ int main(int argc, char* argv[])
 					pest_scenario.get_pestpp_options().get_overdue_giveup_fac(),
 					pest_scenario.get_pestpp_options().get_overdue_giveup_minutes());
 			}
+			const PestppOptions &ppo = pest_scenario.get_pestpp_options();
+			if ((ppo.get_panther_metrics_interval() > 0.0) || (ppo.get_panther_metrics_port() > 0))
+			{
+				double interval = (ppo.get_panther_metrics_interval() > 0.0) ? ppo.get_panther_metrics_interval() : 60.0;
+				static_cast<RunManagerPanther*>(run_manager_ptr)->set_metrics(file_manager.build_filename("panther_metrics.csv"),
+					file_manager.build_filename("panther_metrics.json"), interval, ppo.get_panther_metrics_port());
+			}
 		}
 		else if (run_manager_type == RunManagerType::GENIE)
 		{
@@ -371,6 +379,21 @@ int main(int argc, char* argv[])
 
 		ObjectiveFunc obj_func(&(pest_scenario.get_ctl_observations()), &(pest_scenario.get_ctl_observation_info()), &(pest_scenario.get_prior_info()));
 		Jacobian *base_jacobian_ptr = new Jacobian_1to1(file_manager,output_file_writer);
+		((Jacobian_1to1*)base_jacobian_ptr)->set_num_threads(pest_scenario.get_pestpp_options().get_jac_num_threads());
+		if (pest_scenario.get_control_info().jacfile != 0)
+		{
+			const ModelExecInfo &exi = pest_scenario.get_model_exec_info();
+			if (run_manager_ptr->supports_derivatives())
+			{
+				run_manager_ptr->set_derivatives_command(exi.dercom, exi.derfile);
+				((Jacobian_1to1*)base_jacobian_ptr)->set_external_derivatives(true, pest_scenario.get_pestpp_options().get_der_check_npar());
+			}
+			else
+			{
+				cout << "WARNING: the run manager does not support model supplied derivatives, all derivatives will be calculated by finite differences" << endl;
+				fout_rec << "WARNING: the run manager does not support model supplied derivatives, all derivatives will be calculated by finite differences" << endl;
+			}
+		}
 
 		TerminationController termination_ctl(pest_scenario.get_control_info().noptmax, pest_scenario.get_control_info().phiredstp,
 			pest_scenario.get_control_info().nphistp, pest_scenario.get_control_info().nphinored, pest_scenario.get_control_info().relparstp,
@@ -401,6 +424,10 @@ int main(int argc, char* argv[])
 		{
 			tran_svd->set_SVD_pack_propack();
 		}
+		else if (pest_scenario.get_pestpp_options().get_svd_pack() == PestppOptions::RANDSVD)
+		{
+			tran_svd->set_SVD_pack_randomized();
+		}
 		tran_svd->set_performance_log(&performance_log);
 
 		TranFixed *tr_svda_fixed = new TranFixed("SVDA Fixed Parameter Transformation");
@@ -500,8 +527,15 @@ int main(int argc, char* argv[])
 			run_manager_ptr->reinitialize();
 			DifferentialEvolution de_solver(pest_scenario, file_manager, &obj_func,
 				base_trans_seq, output_file_writer, &performance_log, rand_seed);
-			de_solver.initialize_population(*run_manager_ptr, np);
-			de_solver.solve(*run_manager_ptr, restart_ctl, max_gen, f, cr, dither_f, init_run);
+			if (pest_scenario.get_pestpp_options().get_de_async())
+			{
+				de_solver.solve_async(*run_manager_ptr, restart_ctl, np, max_gen, f, cr, dither_f, init_run);
+			}
+			else
+			{
+				de_solver.initialize_population(*run_manager_ptr, np);
+				de_solver.solve(*run_manager_ptr, restart_ctl, max_gen, f, cr, dither_f, init_run);
+			}
 			run_manager_ptr->free_memory();
 			exit(1);
 		}
@@ -843,6 +877,13 @@ int main(int argc, char* argv[])
 			cout << "  ---  finished uncertainty analysis calculations  ---  " << endl << endl << endl;
 		}
 
+		if (pest_scenario.get_pestpp_options().get_perf_trace())
+		{
+			performance_log.log_perf_totals("performance summary for the complete run");
+			perf_trace::write_chrome_trace(file_manager.open_ofile_ext("perf.json"));
+			file_manager.close_file("perf.json");
+		}
+
 		// clean up
 		fout_rec.close();
 		delete base_jacobian_ptr;
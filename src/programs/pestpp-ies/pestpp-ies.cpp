@@ -100,9 +100,13 @@ int main(int argc, char* argv[])
 		file_manager.initialize_path(get_filename_without_ext(filename), pathname);
 		//jwhite - something weird is happening with the machine is busy and an existing
 		//rns file is really large. so let's remove it explicitly and wait a few seconds before continuing...
+		//the rns file is kept for a restart since the stored runs are reused
 		string rns_file = file_manager.build_filename("rns");
-		int flag = remove(rns_file.c_str());
-		w_sleep(2000);
+		if (find(cmd_arg_vec.begin(), cmd_arg_vec.end(), "/r") == cmd_arg_vec.end())
+		{
+			int flag = remove(rns_file.c_str());
+			w_sleep(2000);
+		}
 		//by default use the serial run manager.  This will be changed later if another
 		//run manger is specified on the command line.
 		RunManagerType run_manager_type = RunManagerType::SERIAL;
@@ -208,7 +212,12 @@ int main(int argc, char* argv[])
 		}
 		else if (it_find_r != cmd_arg_vec.end())
 		{
-			throw runtime_error("/r option not supported by pestpp-ies");
+			restart_flag = true;
+			file_manager.open_default_files(true);
+			ofstream &fout_rec_tmp = file_manager.rec_ofstream();
+			fout_rec_tmp << endl << endl;
+			fout_rec_tmp << "Restarting pestpp-ies from checkpoint ....." << endl << endl;
+			cout << "    Restarting pestpp-ies from checkpoint ....." << endl << endl;
 		}
 		else
 		{
@@ -251,6 +260,7 @@ int main(int argc, char* argv[])
 			throw(e);
 		}
 		pest_scenario.check_inputs(fout_rec);
+		perf_trace::set_enabled(pest_scenario.get_pestpp_options().get_perf_trace());
 
 
 
@@ -292,6 +302,12 @@ int main(int argc, char* argv[])
 				pest_scenario.get_pestpp_options().get_overdue_reched_fac(),
 				pest_scenario.get_pestpp_options().get_overdue_giveup_fac(),
 				pest_scenario.get_pestpp_options().get_overdue_giveup_minutes());
+			if ((ppo->get_panther_metrics_interval() > 0.0) || (ppo->get_panther_metrics_port() > 0))
+			{
+				double interval = (ppo->get_panther_metrics_interval() > 0.0) ? ppo->get_panther_metrics_interval() : 60.0;
+				static_cast<RunManagerPanther*>(run_manager_ptr)->set_metrics(file_manager.build_filename("panther_metrics.csv"),
+					file_manager.build_filename("panther_metrics.json"), interval, ppo->get_panther_metrics_port());
+			}
 		}
 		else
 		{
@@ -317,17 +333,27 @@ int main(int argc, char* argv[])
 		//Neither of these will change over the course of the simulation
 
 
-		run_manager_ptr->initialize(base_trans_seq.ctl2model_cp(cur_ctl_parameters), pest_scenario.get_ctl_observations());
+		if (restart_flag)
+			run_manager_ptr->initialize_restart(rns_file);
+		else
+			run_manager_ptr->initialize(base_trans_seq.ctl2model_cp(cur_ctl_parameters), pest_scenario.get_ctl_observations());
 
 		IterEnsembleSmoother ies(pest_scenario, file_manager, output_file_writer, &performance_log, run_manager_ptr);
 
-		ies.initialize();
+		ies.initialize(restart_flag);
 
 		ies.iterate_2_solution();
 		ies.finalize();
 
 
 
+		if (pest_scenario.get_pestpp_options().get_perf_trace())
+		{
+			performance_log.log_perf_totals("performance summary for the complete run");
+			perf_trace::write_chrome_trace(file_manager.open_ofile_ext("perf.json"));
+			file_manager.close_file("perf.json");
+		}
+
 		// clean up
 		fout_rec.close();
 		delete run_manager_ptr;
@@ -298,6 +298,13 @@ int main(int argc, char* argv[])
 				pest_scenario.get_pestpp_options().get_overdue_reched_fac(),
 				pest_scenario.get_pestpp_options().get_overdue_giveup_fac(),
 				pest_scenario.get_pestpp_options().get_overdue_giveup_minutes());
+			const PestppOptions &ppo = pest_scenario.get_pestpp_options();
+			if ((ppo.get_panther_metrics_interval() > 0.0) || (ppo.get_panther_metrics_port() > 0))
+			{
+				double interval = (ppo.get_panther_metrics_interval() > 0.0) ? ppo.get_panther_metrics_interval() : 60.0;
+				static_cast<RunManagerPanther*>(run_manager_ptr)->set_metrics(file_manager.build_filename("panther_metrics.csv"),
+					file_manager.build_filename("panther_metrics.json"), interval, ppo.get_panther_metrics_port());
+			}
 		}
 		else if (run_manager_type == RunManagerType::GENIE)
 		{
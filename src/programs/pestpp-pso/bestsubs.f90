@@ -95,27 +95,13 @@ subroutine getpbest()
   
 ! specifications:
 !----------------------------------------------------------------------------------------  
-  integer::ipart,iparm,igp
+  integer::ipart
 !----------------------------------------------------------------------------------------
 
 ! if running standard PSO, set pbest based on composite objective function
   do ipart=1,npop
     !
-    if (obj(ipart) < objopt(ipart)) then
-      !
-      objopt(ipart)  = obj(ipart)
-      objmopt(ipart) = objm(ipart)
-      objpopt(ipart) = objp(ipart)
-      !
-      do igp=1,nobsgp
-        objgpopt(ipart,igp) = objgp(ipart,igp)
-      end do
-      !
-      do iparm=1,npar
-        pbest(ipart,iparm) = partval(ipart,iparm)
-      end do
-      !
-    end if
+    call updpbest(ipart)
     !
   end do
 
@@ -124,6 +110,43 @@ end subroutine getpbest
 
 
 
+subroutine updpbest(ipart)
+!========================================================================================
+!==== This subroutine updates the personal best position of one particle.            ====
+!========================================================================================
+!========================================================================================
+
+  use psodat
+  
+  implicit none
+  
+! specifications:
+!----------------------------------------------------------------------------------------  
+  integer,intent(in)::ipart
+  integer::iparm,igp
+!----------------------------------------------------------------------------------------
+
+  if (obj(ipart) < objopt(ipart)) then
+    !
+    objopt(ipart)  = obj(ipart)
+    objmopt(ipart) = objm(ipart)
+    objpopt(ipart) = objp(ipart)
+    !
+    do igp=1,nobsgp
+      objgpopt(ipart,igp) = objgp(ipart,igp)
+    end do
+    !
+    do iparm=1,npar
+      pbest(ipart,iparm) = partval(ipart,iparm)
+    end do
+    !
+  end if
+
+
+end subroutine updpbest
+
+
+
 subroutine pbestpareto(iiter)
 !========================================================================================
 !==== This subroutine determines the personal best particle positions for either     ====
@@ -211,6 +211,13 @@ subroutine psoest(basnam)
    
  
 
+  if (asyncpso == 1) then
+    !
+!   update each particle as soon as its run returns
+    call psoasync(basnam,gindex,gbest,gmbest,gpbest,objmin,iphistp)
+    !
+  else
+
 ! begin the PSO iterative procedure
 ! ---------------------------------
   do iiter=1,noptmax
@@ -315,6 +322,8 @@ subroutine psoest(basnam)
   end do
 ! end main loop of PSO iterative procedure
 !-----------------------------------------
+
+  end if
   
   
 ! running model one last time with best parameters
@@ -339,4 +348,211 @@ subroutine psoest(basnam)
   call writebest(gindex,basnam)
   
   
-end subroutine psoest
\ No newline at end of file
+end subroutine psoest
+
+
+
+subroutine psoasync(basnam,gindex,gbest,gmbest,gpbest,objmin,iphistp)
+!========================================================================================
+!==== This subroutine executes asynchronous pso in estimation mode. Each particle is ====
+!==== moved and resubmitted as soon as its own model run completes, so idle agents   ====
+!==== are not held up by the slowest run of an iteration. Every npop particle        ====
+!==== updates are reported as one iteration.                                         ====
+!========================================================================================
+!========================================================================================
+  use psodat
+
+  implicit none
+  
+! specifications:
+!---------------------------------------------------------------------------------------- 
+! external routines for run management via PANTHER
+!----------------------------------------------------------------------------------------
+  external rmif_run_until
+  integer rmif_run_until
+  external rmif_get_next_completed_run
+  integer rmif_get_next_completed_run
+  external rmif_delete
+  integer rmif_delete
+  
+!----------------------------------------------------------------------------------------
+! local variables
+!----------------------------------------------------------------------------------------
+  integer,intent(inout)::gindex,iphistp
+  integer::err,irun,iiter,ipart,i,igp,fail,nupd,nfail,rcond,rstat,done
+  integer,dimension(:),allocatable::partrun
+  
+  double precision,intent(inout)::gbest,gmbest,gpbest,objmin
+  
+  character(len=100),intent(in)::basnam
+!----------------------------------------------------------------------------------------
+
+  err   = 0
+  fail  = 0
+  nupd  = 0
+  nfail = 0
+  done  = 0
+  iiter = 1
+  !
+  allocate(partrun(npop))
+  partrun = -1
+  !
+! reinitialize run manager, runs are added to this single set from here on
+  call initialrm(1)
+  !
+  call witmess(iiter)
+  !
+! move every particle once and add the runs to the queue
+  do ipart=1,npop
+    !
+    call pertone(iiter,gindex,ipart)
+    call queuepart(ipart,partrun(ipart))
+    !
+  end do
+  !
+  do while (done == 0)
+    !
+!-- make runs until at least one of them has returned (RUN_RETURNED)
+    err = rmif_run_until(4,0,0.0d+00,rcond)
+    !
+    do
+      !
+      err = rmif_get_next_completed_run(irun,rstat)
+      if (irun < 0) exit
+      !
+!---- find the particle this run belongs to
+      ipart = 0
+      do i=1,npop
+        if (partrun(i) == irun) then
+          ipart = i
+          exit
+        end if
+      end do
+      if (ipart == 0) cycle
+      partrun(ipart) = -1
+      !
+      call modelrm(0,irun,fail)
+      !
+      modfail(ipart) = fail
+      nfail = nfail + fail
+      !
+      if (fail == 0) then
+        !
+        call estobjeval(ipart)
+        !
+      else
+        !
+        obj(ipart)  = 1.00d+30
+        objm(ipart) = 1.00d+30
+        objp(ipart) = 1.00d+30
+        do igp=1,nobsgp
+          objgp(ipart,igp) = 1.00d+30
+        end do
+        !
+      end if
+      !
+!---- update pbest of this particle and gbest of the swarm
+      call updpbest(ipart)
+      call getgbest(gindex,gbest,gmbest,gpbest)
+      !
+      nupd = nupd + 1
+      !
+!---- every npop updates close an iteration
+      if (nupd == npop) then
+        !
+        if (trim(rstfle) == 'restart') then
+          call writerst(basnam)
+        end if
+        !
+!       check if maximum allowable model failures has been exceeded
+        if (nfail > nforg) then
+          write(*,'(I0,A,I0)')nfail,' failed model runs greater than limit set by user, ',nforg
+          write(*,'(A)')'-- stopping execution --'
+          err = rmif_delete()
+          stop
+        end if
+        !
+!       check relative phi reduction for termination criteria
+        if ((1.0d+00 - gbest/objmin) <= phiredstp) then
+          iphistp = iphistp + 1
+        else
+          iphistp = 0
+        end if
+        !
+        call listout(iiter,gbest,gmbest,gpbest,gindex,objmin,iphistp)
+        !
+        nupd  = 0
+        nfail = 0
+        !
+        if (iphistp == nphistp) then
+          !
+!         swarm is no longer reducing phi significantly, terminate
+          write(*,'(A)')'termination due to phiredstp criteria'
+          write(*,'(A)')'-- stopping execution --'
+          !
+          done = 1
+          exit
+          !
+        end if
+        !
+        objmin = gbest
+        iiter  = iiter + 1
+        !
+        if (iiter > noptmax) then
+          done = 1
+          exit
+        end if
+        !
+        call witmess(iiter)
+        !
+      end if
+      !
+!---- move the particle with the latest gbest and resubmit it in place of its finished run
+      call pertone(iiter,gindex,ipart)
+      call queuepart(ipart,irun)
+      partrun(ipart) = irun
+      !
+    end do
+    !
+  end do
+  !
+! discard the runs still queued, active runs are killed when the run set is reinitialized
+  call initialrm(1)
+  !
+  deallocate(partrun)
+  
+
+end subroutine psoasync
+
+
+
+subroutine queuepart(ipart,irun)
+!========================================================================================
+!==== This subroutine adds the model run for the current position of one particle.   ====
+!==== A finished run of the particle (irun >= 0) is replaced rather than added, so   ====
+!==== the run set does not grow with every update.                                   ====
+!========================================================================================
+!========================================================================================
+  use psodat
+
+  implicit none
+  
+! specifications:
+!---------------------------------------------------------------------------------------- 
+  integer,intent(in)::ipart
+  integer,intent(inout)::irun
+  integer::iparm,fail
+!----------------------------------------------------------------------------------------
+
+  do iparm=1,npar
+    parval(iparm) = scale(iparm)*partval(ipart,iparm) + offset(iparm)
+  end do
+  !
+  if (irun < 0) then
+    call modelrm(1,irun,fail)
+  else
+    call modelrm(2,irun,fail)
+  end if
+  
+
+end subroutine queuepart
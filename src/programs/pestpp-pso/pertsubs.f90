@@ -12,9 +12,7 @@ subroutine pertpart(iiter,gindex)
 ! specifications:
 !----------------------------------------------------------------------------------------
   integer,intent(in)::gindex,iiter
-  integer::ipart,iparm,spin
-  
-  double precision::local,global,r1
+  integer::ipart,iparm
 !----------------------------------------------------------------------------------------    
 
 ! calculate current value for inertia
@@ -34,95 +32,7 @@ subroutine pertpart(iiter,gindex)
 ! perturb particles in their transformed rhealm
   do ipart=1,npop
     !
-    do iparm=1,npar
-      !
-      if (trim(partrans(iparm)) == 'none' .or. trim(partrans(iparm)) == 'log' .or. &
-          trim(partrans(iparm)) == 'eqlog') then
-        !
-        if (neibr == 1) then
-          call random_number(r1)
-          local  = c1*r1*(pbest(ipart,iparm) - partval(ipart,iparm))
-          call random_number(r1)
-          global = c2*r1*(pbest(gneibr(ipart),iparm) - partval(ipart,iparm))
-        else
-          call random_number(r1)
-          local  = c1*r1*(pbest(ipart,iparm) - partval(ipart,iparm))
-          call random_number(r1)
-          global = c2*r1*(pbest(gindex,iparm) - partval(ipart,iparm))
-        end if
-        !
-!       handle precision issues for when particle stops moving
-        if (dabs(local) < 1.00d-32) then
-          local = 0.0d+00
-        end if
-        if (dabs(global) < 1.00d-32) then
-          global = 0.0d+00
-        end if
-        if (dabs(partvel(ipart,iparm)) < 1.0d-32) then
-          partvel(ipart,iparm) = 0.0d+00
-        end if
-        !
-        partvel(ipart,iparm) = inertia*partvel(ipart,iparm) + local + global 
-        !
-        if (dabs(partvel(ipart,iparm)) > vmax(iparm)) then
-          if (partvel(ipart,iparm) > 0.0d+00) partvel(ipart,iparm) = vmax(iparm)
-          if (partvel(ipart,iparm) < 0.0d+00) partvel(ipart,iparm) = -vmax(iparm)
-        end if
-        !
-        partval(ipart,iparm) = partval(ipart,iparm) + partvel(ipart,iparm)
-        !
-!       keep perturbing particles if they violate parameter bounds
-        if (partval(ipart,iparm) > parubnd(iparm) .or. &
-          partval(ipart,iparm) < parlbnd(iparm)) then
-          !
-          spin = 0
-          !
-          do
-            ! 
-            spin = spin + 1
-            !
-            if (neibr == 1) then
-              call random_number(r1)
-              local  = c1*r1*(pbest(ipart,iparm) - partval(ipart,iparm))
-              call random_number(r1)
-              global = c2*r1*(pbest(gneibr(ipart),iparm) - partval(ipart,iparm))
-            else
-              call random_number(r1)
-              local  = c1*r1*(pbest(ipart,iparm) - partval(ipart,iparm))
-              call random_number(r1)
-              global = c2*r1*(pbest(gindex,iparm) - partval(ipart,iparm))
-            end if
-            !
-            partvel(ipart,iparm) = inertia*partvel(ipart,iparm) + local + global
-            !
-            if (dabs(partvel(ipart,iparm)) > vmax(iparm)) then
-              if (partvel(ipart,iparm) > 0.0d+00) partvel(ipart,iparm) = vmax(iparm)
-              if (partvel(ipart,iparm) < 0.0d+00) partvel(ipart,iparm) = -vmax(iparm)
-            end if
-            !
-            partval(ipart,iparm) = partval(ipart,iparm) + partvel(ipart,iparm)
-            !
-            if (partval(ipart,iparm) < parubnd(iparm) .and. &
-                partval(ipart,iparm) > parlbnd(iparm)) exit
-            !
-            if (spin > 1000) then
-              !
-              write(*,*)"I'm spinning my wheels trying to find a feasible parameter value:"
-              write(*,*)'-- stopping execution --'
-              write(*,*)'ipart ',ipart,'  iparm ',iparm
-              write(*,*)'partval ',partval(ipart,iparm)
-              write(*,*)'partvel ',partvel(ipart,iparm)
-              stop
-              !
-            end if
-            !
-          end do
-          !
-        end if
-        !
-      end if
-      !
-    end do
+    call movepart(ipart,gindex)
     !
   end do
   !
@@ -148,6 +58,164 @@ end subroutine pertpart
 
 
 
+subroutine movepart(ipart,gindex)
+!========================================================================================
+!==== This subroutine updates the velocity and position of one particle. Parameters  ====
+!==== must be in their transformed state.                                            ====
+!========================================================================================
+!========================================================================================
+
+  use psodat
+  
+  implicit none
+  
+! specifications:
+!----------------------------------------------------------------------------------------
+  integer,intent(in)::ipart,gindex
+  integer::iparm,spin
+  
+  double precision::local,global,r1
+!----------------------------------------------------------------------------------------    
+
+  do iparm=1,npar
+    !
+    if (trim(partrans(iparm)) == 'none' .or. trim(partrans(iparm)) == 'log' .or. &
+        trim(partrans(iparm)) == 'eqlog') then
+      !
+      if (neibr == 1) then
+        call random_number(r1)
+        local  = c1*r1*(pbest(ipart,iparm) - partval(ipart,iparm))
+        call random_number(r1)
+        global = c2*r1*(pbest(gneibr(ipart),iparm) - partval(ipart,iparm))
+      else
+        call random_number(r1)
+        local  = c1*r1*(pbest(ipart,iparm) - partval(ipart,iparm))
+        call random_number(r1)
+        global = c2*r1*(pbest(gindex,iparm) - partval(ipart,iparm))
+      end if
+      !
+!     handle precision issues for when particle stops moving
+      if (dabs(local) < 1.00d-32) then
+        local = 0.0d+00
+      end if
+      if (dabs(global) < 1.00d-32) then
+        global = 0.0d+00
+      end if
+      if (dabs(partvel(ipart,iparm)) < 1.0d-32) then
+        partvel(ipart,iparm) = 0.0d+00
+      end if
+      !
+      partvel(ipart,iparm) = inertia*partvel(ipart,iparm) + local + global 
+      !
+      if (dabs(partvel(ipart,iparm)) > vmax(iparm)) then
+        if (partvel(ipart,iparm) > 0.0d+00) partvel(ipart,iparm) = vmax(iparm)
+        if (partvel(ipart,iparm) < 0.0d+00) partvel(ipart,iparm) = -vmax(iparm)
+      end if
+      !
+      partval(ipart,iparm) = partval(ipart,iparm) + partvel(ipart,iparm)
+      !
+!     keep perturbing particles if they violate parameter bounds
+      if (partval(ipart,iparm) > parubnd(iparm) .or. &
+        partval(ipart,iparm) < parlbnd(iparm)) then
+        !
+        spin = 0
+        !
+        do
+          ! 
+          spin = spin + 1
+          !
+          if (neibr == 1) then
+            call random_number(r1)
+            local  = c1*r1*(pbest(ipart,iparm) - partval(ipart,iparm))
+            call random_number(r1)
+            global = c2*r1*(pbest(gneibr(ipart),iparm) - partval(ipart,iparm))
+          else
+            call random_number(r1)
+            local  = c1*r1*(pbest(ipart,iparm) - partval(ipart,iparm))
+            call random_number(r1)
+            global = c2*r1*(pbest(gindex,iparm) - partval(ipart,iparm))
+          end if
+          !
+          partvel(ipart,iparm) = inertia*partvel(ipart,iparm) + local + global
+          !
+          if (dabs(partvel(ipart,iparm)) > vmax(iparm)) then
+            if (partvel(ipart,iparm) > 0.0d+00) partvel(ipart,iparm) = vmax(iparm)
+            if (partvel(ipart,iparm) < 0.0d+00) partvel(ipart,iparm) = -vmax(iparm)
+          end if
+          !
+          partval(ipart,iparm) = partval(ipart,iparm) + partvel(ipart,iparm)
+          !
+          if (partval(ipart,iparm) < parubnd(iparm) .and. &
+              partval(ipart,iparm) > parlbnd(iparm)) exit
+          !
+          if (spin > 1000) then
+            !
+            write(*,*)"I'm spinning my wheels trying to find a feasible parameter value:"
+            write(*,*)'-- stopping execution --'
+            write(*,*)'ipart ',ipart,'  iparm ',iparm
+            write(*,*)'partval ',partval(ipart,iparm)
+            write(*,*)'partvel ',partvel(ipart,iparm)
+            stop
+            !
+          end if
+          !
+        end do
+        !
+      end if
+      !
+    end if
+    !
+  end do
+  
+end subroutine movepart
+
+
+
+subroutine pertone(iiter,gindex,ipart)
+!========================================================================================
+!==== This subroutine perturbs a single particle based on the PSO algorithm, using   ====
+!==== the current pbest and gbest. Used by the asynchronous PSO.                     ====
+!========================================================================================
+!========================================================================================
+
+  use psodat
+  
+  implicit none
+  
+! specifications:
+!----------------------------------------------------------------------------------------
+  integer,intent(in)::iiter,gindex,ipart
+  integer::iparm
+!----------------------------------------------------------------------------------------    
+
+! calculate current value for inertia
+  if (iiter < inerti) then
+    inertia = iinert + (finert - iinert)*(dble(iiter)/dble(inerti))
+  else
+    inertia = finert
+  end if
+  !  
+  do iparm=1,npar
+    call transpar(iparm,1)
+  end do
+  !
+  call movepart(ipart,gindex)
+  !
+  do iparm=1,npar
+    call transpar(iparm,0)
+  end do
+  !
+! tie child parameters to their parents
+  do iparm=1,npar
+    if (trim(partrans(iparm)) == 'tied') then
+      partval(ipart,iparm) = tiedrat(iparm)*partval(ipart,partied(iparm))
+    end if
+  end do
+    
+end subroutine pertone
+
+
+
 
 subroutine pertpareto(iiter)
 !========================================================================================
@@ -3,7 +3,7 @@ module psodat
 ! base data for all PSO operations
 !----------------------------------------------------------------------------------------
   integer::npar,nobs,npargp,nprior,nobsgp,ntplfle,ninsfle,noptmax,npop,iseed,&
-      modeval,initp,rstpso,ntied,nadj,nforg,inerti,nphistp,suppart,suprep,nitp
+      modeval,initp,rstpso,ntied,nadj,nforg,inerti,nphistp,suppart,suprep,nitp,asyncpso
   integer,dimension(:),allocatable::partied,unit,modfail,objmeth
   !
   double precision::c1,c2,iinert,finert,inertia,maxrange,phiredstp
@@ -72,7 +72,7 @@ subroutine readpst(pstnam)
   
 ! specifications:
 !----------------------------------------------------------------------------------------
-  integer::i,j,k,idat,eof,iparm,ipart
+  integer::i,j,k,idat,eof,iparm,ipart,ios
   
   double precision::rangelog,scl,off
   
@@ -156,7 +156,13 @@ subroutine readpst(pstnam)
 !   read PSO control data
     if (trim(line) == '* pso   ') then
       !
-      read(19,*)rstpso,nforg,suppart
+!     optional fourth entry turns on asynchronous particle updates
+      read(19,'(A)')line
+      read(line,*,iostat=ios)rstpso,nforg,suppart,asyncpso
+      if (ios /= 0) then
+        asyncpso = 0
+        read(line,*)rstpso,nforg,suppart
+      end if
       read(19,*)npop,c1,c2,iseed
       read(19,*)initp,iinert,finert,inerti
       !
@@ -195,6 +201,11 @@ subroutine readpst(pstnam)
         read(19,*)nrep,repmode,rfit,rramp
         noweak = 1
         !
+        if (asyncpso /= 0) then
+          write(*,'(A)')'Note: asynchronous updates are only available in estimation mode'
+          asyncpso = 0
+        end if
+        !
         if (repmode == 1) then
           read(19,*)ngrid
         else if (repmode == 2) then
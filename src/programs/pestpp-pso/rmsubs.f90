@@ -95,11 +95,12 @@ subroutine modelrm(sr,irun,fail)
 ! specifications:
 !----------------------------------------------------------------------------------------  
   external rmif_add_run
+  external rmif_replace_run
   external rmif_get_run
   
   integer,intent(in)::sr
   integer,intent(inout)::irun,fail
-  integer::rmif_add_run,rmif_get_run,err
+  integer::rmif_add_run,rmif_replace_run,rmif_get_run,err
 !----------------------------------------------------------------------------------------
 
   err  = 0
@@ -116,6 +117,18 @@ subroutine modelrm(sr,irun,fail)
       stop
     end if
     !
+  else if (sr == 2) then
+    !
+!   replace finished run irun, irun returns the id of the new run
+    err = rmif_replace_run(parval,npar,irun)
+    !
+    modeval = modeval + 1
+    !
+    if (err /= 0) then
+      write(*,'(A,I0)')'Model run was not replaced in the queue properly --> err = ',err
+      stop
+    end if
+    !
   else if (sr == 0) then
     !
     err = rmif_get_run(irun,parval,npar,mobsval,nobs)
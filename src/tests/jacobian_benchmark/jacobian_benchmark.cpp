@@ -0,0 +1,160 @@
+// jacobian_benchmark.cpp : times Jacobian_1to1::process_runs on a synthetic problem
+//
+// usage: jacobian_benchmark [nobs [npar [bandwidth [nthreads]]]]
+//
+// The synthetic model is linear and banded: observation j is sensitive to the
+// parameters whose scaled index lies within "bandwidth" of j.  The perturbation runs
+// are filled in directly so only the Jacobian assembly is timed.
+
+#include <iostream>
+#include <sstream>
+#include <chrono>
+#include <cmath>
+#include <unordered_map>
+#include "Pest.h"
+#include "FileManager.h"
+#include "OutputFileWriter.h"
+#include "Jacobian_1to1.h"
+#include "ParamTransformSeq.h"
+#include "PriorInformation.h"
+#include "RunManagerAbstract.h"
+
+using namespace std;
+
+class RunManagerSynthetic : public RunManagerAbstract
+{
+public:
+	RunManagerSynthetic(int _bandwidth)
+		: RunManagerAbstract(vector<string>(), vector<string>(), vector<string>(), vector<string>(), vector<string>(), ""),
+		bandwidth(_bandwidth) {}
+	virtual void run()
+	{
+		size_t n_par = get_par_name_vec().size();
+		size_t n_obs = get_obs_name_vec().size();
+		const vector<double> &base_pars = file_stor.get_base_par_vec();
+		vector<double> base_obs(n_obs);
+		for (size_t j = 0; j < n_obs; ++j)
+		{
+			base_obs[j] = 1.0 + 0.001 * j;
+		}
+		vector<int> par_idx;
+		vector<double> par_vals;
+		vector<double> obs_vec;
+		int n_runs = get_nruns();
+		for (int i_run = 0; i_run < n_runs; ++i_run)
+		{
+			file_stor.get_par_delta(i_run, par_idx, par_vals);
+			obs_vec = base_obs;
+			for (size_t k = 0; k < par_idx.size(); ++k)
+			{
+				int ipar = par_idx[k];
+				double dp = par_vals[k] - base_pars[ipar];
+				long j_mid = long(double(ipar) * n_obs / n_par);
+				long j_beg = max(0L, j_mid - bandwidth);
+				long j_end = min(long(n_obs), j_mid + bandwidth + 1);
+				for (long j = j_beg; j < j_end; ++j)
+				{
+					obs_vec[j] += sens(j, ipar) * dp;
+				}
+			}
+			file_stor.update_run_delta(i_run, par_vals, obs_vec);
+		}
+	}
+	static double sens(long iobs, long ipar)
+	{
+		return 1.0 + 0.5 * sin(double(iobs + 3 * ipar));
+	}
+private:
+	long bandwidth;
+};
+
+int main(int argc, char* argv[])
+{
+	int n_obs = 50000;
+	int n_par = 20000;
+	int bandwidth = 25;
+	int n_threads = 0;
+	if (argc > 1) n_obs = atoi(argv[1]);
+	if (argc > 2) n_par = atoi(argv[2]);
+	if (argc > 3) bandwidth = atoi(argv[3]);
+	if (argc > 4) n_threads = atoi(argv[4]);
+
+	try
+	{
+		Pest pest_scenario;
+		FileManager file_manager("jacobian_benchmark");
+		file_manager.open_ofile_ext("rec");
+		file_manager.open_ofile_ext("rst");
+		OutputFileWriter output_file_writer(file_manager, pest_scenario);
+
+		Parameters pars;
+		Observations obs;
+		ParameterGroupInfo group_info;
+		ParameterGroupRec group_rec("bench", "RELATIVE", 0.01, 0.0, "SWITCH", 2.0, "PARABOLIC");
+		group_info.insert_group("bench", group_rec);
+		for (int i = 0; i < n_par; ++i)
+		{
+			stringstream ss;
+			ss << "p" << i;
+			pars.insert(ss.str(), 1.0 + 0.0001 * i);
+			group_info.insert_parameter_link(ss.str(), "bench");
+		}
+		for (int j = 0; j < n_obs; ++j)
+		{
+			stringstream ss;
+			ss << "o" << j;
+			obs.insert(ss.str(), 0.0);
+		}
+		ParamTransformSeq par_transform;
+		PriorInformation prior_info;
+
+		RunManagerSynthetic run_manager(bandwidth);
+		run_manager.initialize(pars, obs, file_manager.build_filename("rns"));
+		run_manager.reinitialize_delta(pars, 1, file_manager.build_filename("rnj"));
+		run_manager.add_run(pars, "", 0.0);
+		for (const auto &ipar : pars)
+		{
+			Parameters delta_pars;
+			double new_val = ipar.second * 1.01;
+			delta_pars.insert(ipar.first, new_val);
+			run_manager.add_run_delta(delta_pars, ipar.first, new_val);
+		}
+		cout << "synthetic problem: " << n_obs << " observations, " << n_par << " parameters, bandwidth " << bandwidth << endl;
+		auto t0 = chrono::steady_clock::now();
+		run_manager.run();
+		auto t1 = chrono::steady_clock::now();
+		cout << "  fill run storage:  " << chrono::duration<double>(t1 - t0).count() << " sec" << endl;
+
+		Jacobian_1to1 jacobian(file_manager, output_file_writer);
+		jacobian.set_num_threads(n_threads);
+		t0 = chrono::steady_clock::now();
+		jacobian.process_runs(par_transform, group_info, run_manager, prior_info, false);
+		t1 = chrono::steady_clock::now();
+		cout << "  process_runs:      " << chrono::duration<double>(t1 - t0).count() << " sec" << endl;
+
+		// spot check a few derivatives against the synthetic sensitivities
+		const Eigen::SparseMatrix<double> &jac = *jacobian.get_matrix_ptr();
+		const vector<string> &model_par_names = run_manager.get_par_name_vec();
+		unordered_map<string, int> par_index;
+		for (int i = 0; i < model_par_names.size(); ++i)
+		{
+			par_index[model_par_names[i]] = i;
+		}
+		const vector<string> &jac_par_names = jacobian.parameter_list();
+		double max_err = 0.0;
+		for (int icol = 0; icol < jac_par_names.size(); icol += max(1, n_par / 10))
+		{
+			int ipar = par_index.at(jac_par_names[icol]);
+			long iobs = long(double(ipar) * n_obs / n_par);
+			double err = fabs(jac.coeff(iobs, icol) - RunManagerSynthetic::sens(iobs, ipar));
+			max_err = max(max_err, err);
+		}
+		cout << "  jacobian nonzeros: " << jac.nonZeros() << ", max spot check error: " << max_err << endl;
+	}
+	catch (exception &e)
+	{
+		cout << e.what() << endl;
+		return 1;
+	}
+	return 0;
+}
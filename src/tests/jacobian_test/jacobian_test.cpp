@@ -0,0 +1,220 @@
+// jacobian_test.cpp : checks of the Jacobian updates made without perturbation runs and of the
+// column selection of the selective jacobian refresh
+//
+// usage: jacobian_test
+//
+// Returns 0 if every check passes.
+
+#include <iostream>
+#include <sstream>
+#include <cmath>
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include "FileManager.h"
+#include "Jacobian.h"
+#include "Jacobian_1to1.h"
+#include "Transformable.h"
+
+using namespace std;
+
+class JacobianTester : public Jacobian
+{
+public:
+	JacobianTester(FileManager &_file_manager) : Jacobian(_file_manager) {}
+	void set(const vector<string> &par_names, const vector<string> &obs_names, const Eigen::MatrixXd &dense)
+	{
+		base_numeric_par_names = par_names;
+		base_sim_obs_names = obs_names;
+		matrix = dense.sparseView();
+	}
+};
+
+static int n_fail = 0;
+
+static void check(bool pass, const string &msg)
+{
+	cout << (pass ? "  passed: " : "  FAILED: ") << msg << endl;
+	if (!pass)
+		++n_fail;
+}
+
+// the last row is prior information and is not part of the observations given to secant_update
+static void test_secant_update(FileManager &file_manager, bool keep_pattern)
+{
+	const int n_par = 5;
+	const int n_obs = 6;
+	vector<string> par_names;
+	vector<string> obs_names;
+	for (int i = 0; i < n_par; ++i)
+		par_names.push_back("p" + to_string(i));
+	for (int i = 0; i < n_obs; ++i)
+		obs_names.push_back("o" + to_string(i));
+	obs_names.push_back("pi0");
+
+	Eigen::MatrixXd jac(n_obs + 1, n_par);
+	jac << 1.0, 0.5, 0.0, 0.0, 0.0,
+		0.0, 2.0, 0.0, 0.0, 0.3,
+		0.0, 0.0, 0.0, 0.0, 0.0,
+		0.4, 0.0, 1.5, 0.0, 0.0,
+		0.0, 0.0, 0.0, 1.0, 0.0,
+		0.2, 0.2, 0.2, 0.2, 0.2,
+		1.0, 0.0, 0.0, 0.0, 1.0;
+	// "true" sensitivities of the linear model the secant runs are made with.  Row o4 matches
+	// the jacobian so its secant residual is zero and it must not change
+	Eigen::MatrixXd jac_true = jac.topRows(n_obs);
+	jac_true(0, 0) = 1.3;
+	jac_true(1, 1) = 1.6;
+	jac_true(1, 4) = 0.6;
+	jac_true(3, 2) = 1.1;
+	jac_true(5, 3) = 0.5;
+
+	Parameters base_pars;
+	Observations base_obs;
+	Eigen::VectorXd p0(n_par);
+	Eigen::VectorXd y0(n_obs);
+	for (int i = 0; i < n_par; ++i)
+	{
+		p0[i] = 1.0 + 0.1 * i;
+		base_pars.insert(par_names[i], p0[i]);
+	}
+	for (int i = 0; i < n_obs; ++i)
+	{
+		y0[i] = 10.0 + i;
+		base_obs.insert(obs_names[i], y0[i]);
+	}
+	int n_secant = keep_pattern ? 1 : 2;
+	Eigen::MatrixXd del_par(n_par, 2);
+	del_par << 0.10, 0.02,
+		0.05, -0.03,
+		-0.02, 0.04,
+		0.00, 0.01,
+		0.03, 0.00;
+	del_par.conservativeResize(n_par, n_secant);
+	vector<Parameters> pars_vec;
+	vector<Observations> obs_vec;
+	for (int k = 0; k < n_secant; ++k)
+	{
+		Parameters pars;
+		Observations obs;
+		Eigen::VectorXd y = y0 + jac_true * del_par.col(k);
+		for (int i = 0; i < n_par; ++i)
+			pars.insert(par_names[i], p0[i] + del_par(i, k));
+		for (int i = 0; i < n_obs; ++i)
+			obs.insert(obs_names[i], y[i]);
+		pars_vec.push_back(pars);
+		obs_vec.push_back(obs);
+	}
+
+	JacobianTester jacobian(file_manager);
+	jacobian.set(par_names, obs_names, jac);
+	int n_used = jacobian.secant_update(base_pars, base_obs, pars_vec, obs_vec, keep_pattern);
+	Eigen::MatrixXd jac_new(jacobian.get_matrix());
+	string label = keep_pattern ? "Schubert " : "Broyden ";
+
+	check(n_used == n_secant, label + "update uses every secant direction");
+	// secant conditions: J_new dP = dY on the observation rows whose pattern can represent the change
+	double max_resid = 0.0;
+	for (int k = 0; k < n_secant; ++k)
+	{
+		Eigen::VectorXd resid = jac_new.topRows(n_obs) * del_par.col(k) - jac_true * del_par.col(k);
+		for (int i = 0; i < n_obs; ++i)
+		{
+			bool row_can_change = !keep_pattern || (jac.row(i).cwiseAbs() * del_par.col(k).cwiseAbs())(0) != 0.0;
+			if (row_can_change)
+				max_resid = max(max_resid, fabs(resid[i]));
+		}
+	}
+	check(max_resid < 1.0e-10, label + "update satisfies the secant conditions");
+	check((jac_new.row(n_obs) - jac.row(n_obs)).norm() == 0.0, label + "update leaves the prior information row unchanged");
+	check((jac_new.row(4) - jac.row(4)).norm() < 1.0e-12, label + "update leaves rows with no secant residual unchanged");
+	if (keep_pattern)
+	{
+		bool pattern_kept = true;
+		for (int i = 0; i < jac.rows(); ++i)
+		{
+			for (int j = 0; j < jac.cols(); ++j)
+			{
+				if (jac(i, j) == 0.0 && jac_new(i, j) != 0.0)
+					pattern_kept = false;
+			}
+		}
+		check(pattern_kept, label + "update keeps the sparsity pattern");
+	}
+}
+
+// p1 and p2 have composite sensitivities below the threshold, but only p1 has moved less than the allowed change
+static void test_refresh_tracker()
+{
+	const double sen_ratio = 0.1;
+	const double par_change = 0.1;
+	const int full_iter = 4;
+	vector<string> par_names = { "p0", "p1", "p2", "p3" };
+	Eigen::VectorXd css(4);
+	css << 10.0, 0.5, 0.05, 8.0;
+	Parameters lbnd, ubnd, pars1, pars2;
+	for (const auto &par_name : par_names)
+	{
+		lbnd.insert(par_name, 0.0);
+		ubnd.insert(par_name, 10.0);
+		pars1.insert(par_name, 5.0);
+	}
+	pars2 = pars1;
+	pars2["p1"] = 5.5;
+	pars2["p2"] = 7.0;
+
+	JacRefreshTracker tracker;
+	check(!tracker.get_full_jac_reason(1, full_iter, false).empty(), "first jacobian is full");
+	check(tracker.get_carry_forward_pars(par_names, par_names, css, sen_ratio, pars1, lbnd, ubnd, par_change).empty(),
+		"no columns are carried forward before any are computed");
+	tracker.record(1, par_names, pars1, set<string>());
+
+	check(tracker.get_full_jac_reason(2, full_iter, false).empty(), "second jacobian can be selective");
+	set<string> carry_forward_pars = tracker.get_carry_forward_pars(par_names, par_names, css, sen_ratio, pars2, lbnd, ubnd, par_change);
+	check(carry_forward_pars == set<string>({ "p1" }), "only the insensitive column with a small parameter change is carried forward");
+	tracker.record(2, par_names, pars2, carry_forward_pars);
+	check(tracker.get_col_iter("p1") == 1 && tracker.get_col_iter("p2") == 2 && tracker.get_col_iter("p0") == 2,
+		"carried forward columns keep the iteration they were computed at");
+	// p1 is now measured from its value at iteration 1
+	Parameters pars3 = pars2;
+	pars3["p1"] = 6.2;
+	check(tracker.get_carry_forward_pars(par_names, par_names, css, sen_ratio, pars3, lbnd, ubnd, par_change) == set<string>({ "p2" }),
+		"parameter change is measured from the values the column was computed at");
+
+	tracker.set_force_full();
+	check(!tracker.get_full_jac_reason(3, full_iter, false).empty(), "forced full jacobian");
+	check(tracker.get_full_jac_reason(3, full_iter, false).empty(), "force flag is cleared once used");
+	check(!tracker.get_full_jac_reason(3, full_iter, true).empty(), "failed parameter runs force a full jacobian");
+	check(!tracker.get_full_jac_reason(5, full_iter, false).empty(), "full jacobian every jac_refresh_full_iter iterations");
+
+	// a secant update replaces every column, so none are carried into the next finite difference jacobian
+	tracker.reset();
+	check(!tracker.get_full_jac_reason(3, full_iter, false).empty(), "jacobian after a secant update is full");
+	check(tracker.get_carry_forward_pars(par_names, par_names, css, sen_ratio, pars2, lbnd, ubnd, par_change).empty(),
+		"no columns are carried forward after a secant update");
+	check(tracker.get_col_iter("p1") == -1, "secant update clears the column iterations");
+}
+
+int main(int argc, char* argv[])
+{
+	try
+	{
+		FileManager file_manager("jacobian_test");
+		cout << "secant updates" << endl;
+		test_secant_update(file_manager, false);
+		test_secant_update(file_manager, true);
+		cout << "selective jacobian refresh" << endl;
+		test_refresh_tracker();
+	}
+	catch (exception &e)
+	{
+		cout << e.what() << endl;
+		return 1;
+	}
+	if (n_fail > 0)
+	{
+		cout << n_fail << " check(s) failed" << endl;
+		return 1;
+	}
+	cout << "all checks passed" << endl;
+	return 0;
+}
@@ -9,12 +9,143 @@
 #include "logger.h"
 #include "utilities.h"
 #include "linear_analysis.h"
+#include "eigen_tools.h"
+
+static int n_fail = 0;
+
+static void check(bool pass, const string &msg)
+{
+	cout << (pass ? "  passed: " : "  FAILED: ") << msg << endl;
+	if (!pass)
+		++n_fail;
+}
+
+static Eigen::SparseMatrix<double> random_sparse(int n_row, int n_col, double fill, unsigned int seed)
+{
+	srand(seed);
+	vector<Eigen::Triplet<double> > triplet_list;
+	for (int j = 0; j < n_col; ++j)
+	{
+		for (int i = 0; i < n_row; ++i)
+		{
+			if (double(rand()) / RAND_MAX < fill)
+				triplet_list.push_back(Eigen::Triplet<double>(i, j, 2.0 * double(rand()) / RAND_MAX - 1.0));
+		}
+	}
+	Eigen::SparseMatrix<double> mat(n_row, n_col);
+	mat.setFromTriplets(triplet_list.begin(), triplet_list.end());
+	return mat;
+}
+
+//compare calc_weighted_normal_matrix() with the plain sparse product J^T Q J
+static void test_weighted_normal_matrix(const string &label, const Eigen::SparseMatrix<double> &jac, const Eigen::SparseMatrix<double> &q,
+	double dense_fill)
+{
+	Eigen::MatrixXd expected = Eigen::MatrixXd(Eigen::SparseMatrix<double>(jac.transpose() * q * jac));
+	double scale = max(1.0, expected.cwiseAbs().maxCoeff());
+	for (int n_threads : {1, 4})
+	{
+		Eigen::MatrixXd jtqj = Eigen::MatrixXd(calc_weighted_normal_matrix(jac, q, n_threads, dense_fill));
+		double max_diff = (jtqj - expected).cwiseAbs().maxCoeff();
+		check(max_diff < 1.0e-10 * scale, label + " matches J^T Q J with " + to_string(n_threads) + " thread(s)");
+	}
+}
+
+static void test_weighted_normal_matrices()
+{
+	cout << "weighted normal matrix" << endl;
+	// enough rows that the dense path accumulates more than one panel of rows.  A dense_fill of zero forces the
+	// dense path, 1.0 the sparse path
+	const int n_obs = 6000;
+	const int n_par = 1500;
+	Eigen::VectorXd q_diag(n_obs);
+	for (int i = 0; i < n_obs; ++i)
+		q_diag[i] = (i % 7 == 0) ? 0.0 : 1.0 + double(i % 13);
+	Eigen::SparseMatrix<double> q = eigenvec_2_diagsparse(q_diag);
+	test_weighted_normal_matrix("dense path", random_sparse(n_obs, n_par, 0.05, 1), q, 0.0);
+	test_weighted_normal_matrix("sparse path", random_sparse(n_obs, n_par, 0.05, 2), q, 1.0);
+	// a negative weight moves a dense J to the sparse path
+	Eigen::VectorXd q_neg = q_diag;
+	q_neg[3] = -1.0;
+	test_weighted_normal_matrix("negative weight", random_sparse(n_obs, n_par, 0.05, 3), eigenvec_2_diagsparse(q_neg), 0.0);
+	// off diagonal weights fall back to the general product
+	Eigen::SparseMatrix<double> q_full = q;
+	q_full.coeffRef(0, 1) = 0.5;
+	q_full.coeffRef(1, 0) = 0.5;
+	test_weighted_normal_matrix("non-diagonal Q", random_sparse(n_obs, n_par, 0.05, 4), q_full, 0.0);
+}
+
+//the error variance curves from one svd must match first/second/third_prediction at every truncation point
+static void test_error_variance_curves(Logger *log)
+{
+	cout << "prediction error variance components" << endl;
+	const int n_obs = 12;
+	const int n_par = 9;
+	vector<string> obs_names, par_names, pred_names;
+	for (int i = 0; i < n_obs; ++i)
+		obs_names.push_back("OBS" + to_string(i));
+	pred_names.push_back("PRED0");
+	pred_names.push_back("PRED1");
+	for (auto &pred : pred_names)
+		obs_names.push_back(pred);
+	for (int i = 0; i < n_par; ++i)
+		par_names.push_back("PAR" + to_string(i));
+	Eigen::SparseMatrix<double> jac = random_sparse(obs_names.size(), n_par, 1.0, 5);
+	Eigen::VectorXd par_var(n_par), obs_var(obs_names.size());
+	for (int i = 0; i < n_par; ++i)
+		par_var[i] = 0.1 * (1 + i % 4);
+	for (int i = 0; i < obs_var.size(); ++i)
+		obs_var[i] = 0.01 * (1 + i % 3);
+
+	linear_analysis la(Mat(obs_names, par_names, jac),
+		Mat(par_names, par_names, eigenvec_2_diagsparse(par_var), Mat::MatType::DIAGONAL),
+		Mat(obs_names, obs_names, eigenvec_2_diagsparse(obs_var), Mat::MatType::DIAGONAL),
+		map<string, Mat>(), log);
+	la.set_predictions(pred_names);
+	//one omitted parameter so the third term is not zero
+	string omitted("PAR8");
+	la.extract_omitted(omitted);
+
+	vector<int> sing_vals;
+	for (int sv = 0; sv <= n_par + 1; ++sv)
+		sing_vals.push_back(sv);
+	map<string, map<string, vector<double>>> curves = la.prediction_error_variance_components(sing_vals, 2);
+	double max_rel_diff = 0.0;
+	for (size_t i = 0; i < sing_vals.size(); ++i)
+	{
+		map<string, double> first = la.first_prediction(sing_vals[i]);
+		map<string, double> second = la.second_prediction(sing_vals[i]);
+		map<string, double> third = la.third_prediction(sing_vals[i]);
+		for (auto &pred : pred_names)
+		{
+			map<string, vector<double>> &c = curves.at(pred);
+			vector<pair<double, double> > pairs;
+			pairs.push_back(make_pair(c.at("null")[i], first.at(pred)));
+			pairs.push_back(make_pair(c.at("solution")[i], second.at(pred)));
+			pairs.push_back(make_pair(c.at("omitted")[i], third.at(pred)));
+			for (auto &pr : pairs)
+			{
+				double scale = max(1.0e-12, max(fabs(pr.first), fabs(pr.second)));
+				max_rel_diff = max(max_rel_diff, fabs(pr.first - pr.second) / scale);
+			}
+		}
+	}
+	check(max_rel_diff < 1.0e-8, "null, solution and omitted curves match first, second and third_prediction");
+}
 
 
 int main(int argc, char* argv[])
 {
 	ofstream fout("linear_analysis.log");
 	Logger log(fout);
+	test_weighted_normal_matrices();
+	test_error_variance_curves(&log);
+	if (n_fail > 0)
+	{
+		cout << n_fail << " check(s) failed" << endl;
+		return 1;
+	}
+
 	log.log("analysis");
 	try
 	{
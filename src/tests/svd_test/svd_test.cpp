@@ -0,0 +1,111 @@
+// svd_test.cpp : checks of the truncated SVD packages against SVD_EIGEN
+//
+// usage: svd_test
+//
+// Returns 0 if every check passes.
+
+#include <iostream>
+#include <sstream>
+#include <cmath>
+#include <random>
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include "SVDPackage.h"
+
+using namespace std;
+
+static int n_fail = 0;
+
+static void check(bool pass, const string &msg)
+{
+	cout << (pass ? "  passed: " : "  FAILED: ") << msg << endl;
+	if (!pass)
+		++n_fail;
+}
+
+static Eigen::MatrixXd random_orthonormal(int n_row, int n_col, std::mt19937 &rand_gen)
+{
+	std::normal_distribution<double> norm_dist(0.0, 1.0);
+	Eigen::MatrixXd Y(n_row, n_col);
+	for (int j = 0; j < n_col; ++j)
+		for (int i = 0; i < n_row; ++i)
+			Y(i, j) = norm_dist(rand_gen);
+	Eigen::HouseholderQR<Eigen::MatrixXd> qr(Y);
+	return qr.householderQ() * Eigen::MatrixXd::Identity(n_row, n_col);
+}
+
+// A = U diag(s) V^T with s_i = 10^(-i/7.5), so 53 of the values are above a threshold of 1.0e-7
+static void test_randomized(int n_max_sing)
+{
+	const int n_row = 150;
+	const int n_col = 100;
+	const double eigen_thres = 1.0e-7;
+	std::mt19937 rand_gen(7);
+	Eigen::VectorXd s_known(n_col);
+	for (int i = 0; i < n_col; ++i)
+		s_known[i] = pow(10.0, -i / 7.5);
+	Eigen::MatrixXd U_known = random_orthonormal(n_row, n_col, rand_gen);
+	Eigen::MatrixXd V_known = random_orthonormal(n_col, n_col, rand_gen);
+	Eigen::MatrixXd A_dense = U_known * s_known.asDiagonal() * V_known.transpose();
+	Eigen::SparseMatrix<double> A = A_dense.sparseView();
+
+	Eigen::VectorXd Sigma_eig, Sigma_trunc_eig, Sigma, Sigma_trunc;
+	Eigen::SparseMatrix<double> U_eig, VT_eig, U, VT;
+	SVD_EIGEN svd_eigen(n_max_sing, eigen_thres);
+	svd_eigen.solve_ip(A, Sigma_eig, U_eig, VT_eig, Sigma_trunc_eig);
+	SVD_RANDOMIZED svd_rand(n_max_sing, eigen_thres);
+	svd_rand.solve_ip(A, Sigma, U, VT, Sigma_trunc);
+
+	string label = "n_max_sing = " + to_string(n_max_sing) + ": ";
+	int n_expected = min(n_max_sing, 53);
+	check(Sigma_eig.size() == n_expected, label + "SVD_EIGEN keeps the values above the threshold");
+	check(Sigma.size() == Sigma_eig.size(), label + "randomized SVD keeps as many values as SVD_EIGEN");
+	if (Sigma.size() != Sigma_eig.size())
+		return;
+	double tol = 1.0e-9 * s_known[0];
+	check((Sigma - Sigma_eig).cwiseAbs().maxCoeff() < tol, label + "randomized singular values match SVD_EIGEN");
+	check((Sigma - s_known.head(n_expected)).cwiseAbs().maxCoeff() < tol, label + "randomized singular values match the known values");
+
+	check(Sigma_trunc.size() == Sigma_trunc_eig.size(), label + "Sigma_trunc has the length of the truncated spectrum");
+	if (Sigma_trunc.size() != Sigma_trunc_eig.size())
+		return;
+	// the computed truncated values lead Sigma_trunc and the rest are zero
+	int n_computed = 0;
+	while (n_computed < Sigma_trunc.size() && Sigma_trunc[n_computed] != 0.0)
+		++n_computed;
+	check(n_computed > 0, label + "Sigma_trunc starts with the truncated values of the block");
+	bool zero_tail = true;
+	for (int i = n_computed; i < Sigma_trunc.size(); ++i)
+		zero_tail = zero_tail && (Sigma_trunc[i] == 0.0);
+	check(zero_tail, label + "Sigma_trunc values that are not computed are zero");
+	// the values just past the truncation are approximate, bounded by the block
+	check((Sigma_trunc.head(n_computed) - Sigma_trunc_eig.head(n_computed)).cwiseAbs().maxCoeff() < 1.0e-6 * s_known[0],
+		label + "computed Sigma_trunc values match SVD_EIGEN");
+
+	// the truncated factors reproduce the rank-k part of A
+	Eigen::MatrixXd A_k = U_known.leftCols(n_expected) * s_known.head(n_expected).asDiagonal() * V_known.leftCols(n_expected).transpose();
+	Eigen::MatrixXd A_rand = Eigen::MatrixXd(U) * Sigma.asDiagonal() * Eigen::MatrixXd(VT);
+	check((A_rand - A_k).cwiseAbs().maxCoeff() < 1.0e-8 * s_known[0], label + "randomized factors reproduce the truncated matrix");
+}
+
+int main(int argc, char* argv[])
+{
+	try
+	{
+		cout << "randomized SVD" << endl;
+		test_randomized(1000);
+		test_randomized(20);
+	}
+	catch (exception &e)
+	{
+		cout << e.what() << endl;
+		return 1;
+	}
+	if (n_fail > 0)
+	{
+		cout << n_fail << " check(s) failed" << endl;
+		return 1;
+	}
+	cout << "all checks passed" << endl;
+	return 0;
+}
@@ -23,6 +23,10 @@ along with PEST++.  If not, see<http://www.gnu.org/licenses/>.
 #include <fstream>
 #include <algorithm>
 #include <iterator>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 #include "config_os.h"
 #include "Pest.h"
 #include "Transformable.h"
@@ -209,54 +213,133 @@ ofstream prep_sweep_output_file(Pest &pest_scenario)
 }
 
 
-void process_sweep_runs(ofstream &csv, Pest &pest_scenario, RunManagerAbstract* run_manager_ptr, vector<int> run_ids, vector<string> listed_run_ids, ObjectiveFunc obj_func,int total_runs_done)
+// bounded queue of parameter sets, filled by a background reader thread so that
+// the run manager queue can be kept topped up while the csv is still being read
+class SweepParQueue
+{
+public:
+	SweepParQueue(size_t _max_size) : max_size(_max_size), done(false), cancelled(false) {}
+	// returns false if the queue has been cancelled
+	bool push(const string &input_run_id, const Parameters &pars)
+	{
+		unique_lock<mutex> lock(q_lock);
+		not_full.wait(lock, [this] { return (items.size() < max_size) || cancelled; });
+		if (cancelled)
+			return false;
+		items.push_back(make_pair(input_run_id, pars));
+		not_empty.notify_one();
+		return true;
+	}
+	// returns false if no parameter set is available.  If wait is true, blocks until
+	// a parameter set is available or the reader is finished
+	bool pop(string &input_run_id, Parameters &pars, bool wait)
+	{
+		unique_lock<mutex> lock(q_lock);
+		if (wait)
+			not_empty.wait(lock, [this] { return (!items.empty()) || done; });
+		if (items.empty())
+			return false;
+		input_run_id = items.front().first;
+		pars = items.front().second;
+		items.pop_front();
+		not_full.notify_one();
+		return true;
+	}
+	void set_done(const string &_error_msg = "")
+	{
+		lock_guard<mutex> lock(q_lock);
+		done = true;
+		error_msg = _error_msg;
+		not_empty.notify_all();
+	}
+	// stops the reader.  A reader blocked in push() returns and waiting pop() calls return
+	void cancel()
+	{
+		lock_guard<mutex> lock(q_lock);
+		done = true;
+		cancelled = true;
+		not_full.notify_all();
+		not_empty.notify_all();
+	}
+	bool finished()
+	{
+		lock_guard<mutex> lock(q_lock);
+		return done && items.empty();
+	}
+	string get_error()
+	{
+		lock_guard<mutex> lock(q_lock);
+		return error_msg;
+	}
+private:
+	size_t max_size;
+	bool done;
+	bool cancelled;
+	string error_msg;
+	deque<pair<string, Parameters>> items;
+	mutex q_lock;
+	condition_variable not_full, not_empty;
+};
+
+// cancels the queue and joins the reader thread when the sweep loop is left,
+// including when an exception is thrown, so the joinable thread is never destroyed
+class SweepReaderGuard
+{
+public:
+	SweepReaderGuard(SweepParQueue &_par_queue, thread &_reader) : par_queue(_par_queue), reader(_reader) {}
+	void join()
+	{
+		par_queue.cancel();
+		if (reader.joinable())
+			reader.join();
+	}
+	~SweepReaderGuard() { join(); }
+private:
+	SweepParQueue &par_queue;
+	thread &reader;
+};
+
+
+void process_sweep_run(ofstream &csv, Pest &pest_scenario, RunManagerAbstract* run_manager_ptr, int run_id, int output_run_id, const string &listed_run_id, ObjectiveFunc &obj_func)
 {
 	Parameters pars;
 	Observations obs;
 	double fail_val = -1.0E+10;
-	int run_id;
-	string listed_run_id;
-	//for (auto &run_id : run_ids)
-	for (int i = 0;i <run_ids.size();++i)
+	csv << output_run_id;
+	csv << ',' << listed_run_id;
+	// if the run was successful
+	if (run_manager_ptr->get_run(run_id, pars, obs))
 	{
-		run_id = run_ids[i];
-		listed_run_id = listed_run_ids[i];
-		csv << run_id + total_runs_done;
-		csv << ',' << listed_run_id;
-		// if the run was successful
-		if (run_manager_ptr->get_run(run_id, pars, obs))
-		{
-			PhiData phi_data = obj_func.phi_report(obs, pars, *(pest_scenario.get_regul_scheme_ptr()));
-			csv << ",0";
-
-			csv << ',' << phi_data.total();
-			csv << ',' << phi_data.meas;
-			csv << ',' << phi_data.regul;
-			for (auto &obs_grp : pest_scenario.get_ctl_ordered_obs_group_names())
-			{
-				csv << ',' << phi_data.group_phi.at(obs_grp);
-			}
-			for (auto oname : pest_scenario.get_ctl_ordered_obs_names())
-			{
-				csv << ',' << obs[oname];
-			}
-			csv << endl;
+		PhiData phi_data = obj_func.phi_report(obs, pars, *(pest_scenario.get_regul_scheme_ptr()));
+		csv << ",0";
+
+		csv << ',' << phi_data.total();
+		csv << ',' << phi_data.meas;
+		csv << ',' << phi_data.regul;
+		for (auto &obs_grp : pest_scenario.get_ctl_ordered_obs_group_names())
+		{
+			csv << ',' << phi_data.group_phi.at(obs_grp);
 		}
-		//if the run bombed
-		else
+		for (auto &oname : pest_scenario.get_ctl_ordered_obs_names())
 		{
-			csv << ",1";
-			csv << ",,,";
-			for (auto &ogrp : pest_scenario.get_ctl_ordered_obs_group_names())
-			{
-				csv << ',';
-			}
-			for (int i = 0; i < pest_scenario.get_ctl_ordered_obs_names().size(); i++)
-			{
-				csv << ',' << fail_val;
-			}
-			csv << endl;
+			csv << ',' << obs[oname];
 		}
+		csv << endl;
+	}
+	//if the run bombed
+	else
+	{
+		csv << ",1";
+		csv << ",,,";
+		for (auto &ogrp : pest_scenario.get_ctl_ordered_obs_group_names())
+		{
+			csv << ',';
+		}
+		for (int i = 0; i < pest_scenario.get_ctl_ordered_obs_names().size(); i++)
+		{
+			csv << ',' << fail_val;
+		}
+		csv << endl;
 	}
 }
 
@@ -311,7 +394,7 @@ int main(int argc, char* argv[])
 			cerr << "    ++sweep_output_csv_file(output.csv)" << endl;
 			cerr << "        - the csv to save run results to" << endl;
 			cerr << "    ++sweep_chunk(500)" << endl;
-			cerr << "        - number of runs to process in a single batch" << endl;
+			cerr << "        - max number of runs queued with the run manager at one time" << endl;
 			cerr << "--------------------------------------------------------" << endl;
 			exit(0);
 		}
@@ -602,8 +685,6 @@ int main(int argc, char* argv[])
 		ofstream obs_stream = prep_sweep_output_file(pest_scenario);
 
 		int chunk = pest_scenario.get_pestpp_options().get_sweep_chunk();
-		vector<int> run_ids;
-		pair<vector<string>,vector<Parameters>> sweep_par_info;
 
 		//if desired, add the base run to the list of runs
 		if (pest_scenario.get_pestpp_options().get_sweep_base_run())
@@ -611,83 +692,108 @@ int main(int argc, char* argv[])
 			throw runtime_error("base runs no longer supported by sweep");
 			//sweep_pars[-999] = pest_scenario.get_ctl_parameters();
 		}
-		int total_runs_done = 0;
-		while (true)
+
+		// read the parameter sets on a background thread.  At most 'chunk' parameter
+		// sets are held in the read-ahead queue and 'chunk' runs are queued with the
+		// run manager, so memory does not depend on the number of rows in the csv
+		SweepParQueue par_queue(chunk);
+		thread reader([&]()
 		{
-			//read some realizations
-			//sweep_pars.clear();
-			cout << "reading par values...";
-			if (use_jco)
+			try
 			{
-				//just use the total_runs_done counter as the run id
-				vector<string> par_names = pest_scenario.get_ctl_ordered_par_names();
-				Parameters par;
-				vector<Parameters> pars;
-				vector<string> run_ids;
-				for (int i = 0; i < chunk; i++)
+				int n_read = 0;
+				while (true)
 				{
-					if (total_runs_done + i >= jco_mat.rows())
+					pair<vector<string>, vector<Parameters>> sweep_par_info;
+					if (use_jco)
+					{
+						//just use the jco row names as the run id
+						vector<string> par_names = pest_scenario.get_ctl_ordered_par_names();
+						Parameters par;
+						for (int i = 0; i < chunk; i++)
+						{
+							if (n_read + i >= jco_mat.rows())
+								break;
+							par.update_without_clear(par_names, jco_mat.row(n_read + i));
+							sweep_par_info.second.push_back(par);
+							sweep_par_info.first.push_back(jco_col_names[n_read + i]);
+						}
+					}
+					else
+					{
+						sweep_par_info = load_parameters_from_csv(header_info, par_stream, chunk, pest_scenario.get_ctl_parameters());
+					}
+					if (sweep_par_info.first.size() == 0)
 						break;
-					par.update_without_clear(par_names, jco_mat.row(total_runs_done + i));
-					pars.push_back(par);
-					//run_ids.push_back(total_runs_done + i);
-					run_ids.push_back(jco_col_names[total_runs_done + i]);
-
+					bool cancelled = false;
+					for (int i = 0; i < sweep_par_info.first.size() && !cancelled; i++)
+						cancelled = !par_queue.push(sweep_par_info.first[i], sweep_par_info.second[i]);
+					if (cancelled)
+						break;
+					n_read += sweep_par_info.first.size();
 				}
-				sweep_par_info = pair<vector<string>, vector<Parameters>>(run_ids, pars);
-
+				par_queue.set_done();
 			}
-			else
+			catch (exception &e)
 			{
-				try {
-					performance_log.log_event("starting to read parameter csv file", 1);
-					sweep_par_info = load_parameters_from_csv(header_info, par_stream, chunk, pest_scenario.get_ctl_parameters());
-					performance_log.log_event("finished reading parameter csv file");
-				}
-				catch (exception &e)
-				{
-					stringstream ss;
-					ss << "error processing parameter csv file: " << e.what();
-					performance_log.log_event(ss.str());
-					fout_rec << endl << ss.str() << endl;
-					fout_rec.close();
+				par_queue.set_done(string("error processing parameter csv file: ") + e.what());
+			}
+		});
+		SweepReaderGuard reader_guard(par_queue, reader);
 
-					throw runtime_error(ss.str());
-				}
+		// the run storage file is drained and reset once it holds this many runs
+		int max_stor_runs = 10 * chunk;
+		int total_runs_done = 0;
+		map<int, string> pending_runs;
+		string input_run_id;
+		Parameters par;
+		performance_log.log_event("starting sweep runs", 1);
+		run_manager_ptr->reinitialize();
+		while (true)
+		{
+			if ((pending_runs.empty()) && (run_manager_ptr->get_nruns() >= max_stor_runs))
+				run_manager_ptr->reinitialize();
+
+			// top up the run manager queue
+			while ((pending_runs.size() < chunk) && (run_manager_ptr->get_nruns() < max_stor_runs) &&
+				(par_queue.pop(input_run_id, par, pending_runs.empty())))
+			{
+				int run_id = run_manager_ptr->add_run(base_trans_seq.active_ctl2model_cp(par));
+				pending_runs[run_id] = input_run_id;
 			}
-			cout << "done" << endl;
-			// if there are no parameters to run, we are done
-			if (sweep_par_info.first.size() == 0)
+			if (pending_runs.empty())
 			{
-				cout << "no more runs...done" << endl;
-				break;
+				if (par_queue.finished())
+					break;
+				continue;
 			}
-			run_manager_ptr->reinitialize();
 
-			cout << "starting runs " << total_runs_done << " --> " << total_runs_done + sweep_par_info.first.size() << endl;
+			run_manager_ptr->run_until(RunManagerAbstract::RUN_UNTIL_COND::NO_OPS, 1);
 
-			// queue up some runs
-			run_ids.clear();
-			for (auto &par : sweep_par_info.second)
+			// write any completed runs
+			for (auto it = pending_runs.begin(); it != pending_runs.end();)
 			{
-				//Parameters temp = base_trans_seq.active_ctl2model_cp(par);
-		        run_ids.push_back(run_manager_ptr->add_run(base_trans_seq.active_ctl2model_cp(par)));
-
+				if ((run_manager_ptr->run_finished(it->first)) || (run_manager_ptr->n_run_failures_exceeded(it->first)))
+				{
+					process_sweep_run(obs_stream, pest_scenario, run_manager_ptr, it->first, total_runs_done, it->second, obj_func);
+					++total_runs_done;
+					it = pending_runs.erase(it);
+				}
+				else
+					++it;
 			}
-
-			//make some runs
-
-			run_manager_ptr->run();
-
-			//process the runs
-			cout << "processing runs...";
-			//process_sweep_runs(obs_stream, pest_scenario, run_manager_ptr, run_ids, obj_func,total_runs_done);
-			process_sweep_runs(obs_stream, pest_scenario, run_manager_ptr,run_ids, sweep_par_info.first, obj_func, total_runs_done);
-
-			cout << "done" << endl;
-			total_runs_done += sweep_par_info.first.size();
-
 		}
+		reader_guard.join();
+		string reader_error = par_queue.get_error();
+		if (!reader_error.empty())
+		{
+			performance_log.log_event(reader_error);
+			fout_rec << endl << reader_error << endl;
+			fout_rec.close();
+			throw runtime_error(reader_error);
+		}
+		performance_log.log_event("finished sweep runs");
+		cout << endl << total_runs_done << " runs processed...done" << endl;
 
 		// clean up
 		fout_rec.close();